@@ -58,6 +58,12 @@ extern "C" {
  *                          when all associated handles have been closed
  *                          (either explicitly with fpgaClose() or by process
  *                          termination).
+ *                        * FPGA_OPEN_MMIO_PREMAP maps every MMIO region of
+ *                          an accelerator during fpgaOpen() and serves
+ *                          fpgaReadMMIO32/64() and fpgaWriteMMIO32/64() on
+ *                          those regions without taking the handle lock.
+ *                          The caller must not call fpgaUnmapMMIO() or
+ *                          fpgaClose() while other threads access MMIO.
  * @returns             FPGA_OK on success. FPGA_NOT_FOUND if the resource for
  *                      'token' could not be found. FPGA_INVALID_PARAM if
  *                      'token' does not refer to a resource that can be
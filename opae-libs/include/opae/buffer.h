@@ -84,6 +84,9 @@ extern "C" {
  *                        pointed at in '*buf_addr' is already allocated an
  *                        mapped into virtual memory. FPGA_BUF_READ_ONLY
  *                        pins pages with only read access from the FPGA.
+ *                        FPGA_BUF_POOLED takes the buffer from the handle's
+ *                        buffer pool (see fpgaBufferPoolConfigure()); its
+ *                        contents are not cleared when it is recycled.
  * @returns FPGA_OK on success. FPGA_NO_MEMORY if the requested memory could
  * not be allocated. FPGA_INVALID_PARAM if invalid parameters were provided, or
  * if the parameter combination is not valid. FPGA_EXCEPTION if an internal
@@ -135,6 +138,52 @@ fpga_result fpgaReleaseBuffer(fpga_handle handle, uint64_t wsid);
 fpga_result fpgaGetIOAddress(fpga_handle handle, uint64_t wsid,
 			     uint64_t *ioaddr);
 
+/**
+ * Configure the buffer pool of a handle
+ *
+ * Buffers prepared with FPGA_BUF_POOLED are not unpinned and unmapped by
+ * fpgaReleaseBuffer(). Instead they stay pinned and idle in a pool owned by
+ * the handle, and a later fpgaPrepareBuffer() with FPGA_BUF_POOLED and a
+ * length of the same size class reuses them without any system call. Size
+ * classes are the backing page footprint of the buffer: 4 KiB, 2 MiB, or a
+ * multiple of the hugepage size for larger buffers.
+ *
+ * Idle buffers are kept up to `max_idle_bytes`; a release that would exceed
+ * the limit frees the buffer instead. Lowering the limit frees idle buffers
+ * as needed. The pool is drained when the handle is closed.
+ *
+ * @param[in]  handle          Handle to previously opened accelerator resource
+ * @param[in]  max_idle_bytes  Maximum number of bytes held by idle buffers.
+ *                             0 disables recycling.
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if handle is invalid.
+ * FPGA_NOT_SUPPORTED if the plugin has no buffer pool.
+ */
+fpga_result fpgaBufferPoolConfigure(fpga_handle handle,
+				    uint64_t max_idle_bytes);
+
+/**
+ * Free all idle buffers of a handle's buffer pool
+ *
+ * Unpins and unmaps every idle buffer. Buffers that are in use are not
+ * affected.
+ *
+ * @param[in]  handle   Handle to previously opened accelerator resource
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if handle is invalid.
+ * FPGA_NOT_SUPPORTED if the plugin has no buffer pool.
+ */
+fpga_result fpgaBufferPoolTrim(fpga_handle handle);
+
+/**
+ * Retrieve buffer pool statistics
+ *
+ * @param[in]  handle   Handle to previously opened accelerator resource
+ * @param[out] stats    Hit/miss counters and pinned byte counts
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if handle or stats is
+ * invalid. FPGA_NOT_SUPPORTED if the plugin has no buffer pool.
+ */
+fpga_result fpgaBufferPoolGetStats(fpga_handle handle,
+				   fpga_buffer_pool_stats *stats);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif // __cplusplus
@@ -25,7 +25,10 @@
 // POSSIBILITY OF SUCH DAMAGE.
 #pragma once
 
+#include <map>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include <opae/types_enum.h>
 
@@ -101,6 +104,7 @@ class event {
   int os_object() const;
 
  private:
+  friend class event_set;
   event(handle::ptr_t h, event::type_t t, fpga_event_handle event_h);
   handle::ptr_t handle_;
   event::type_t type_;
@@ -108,6 +112,75 @@ class event {
   int os_object_;
 };
 
+/**
+ * @brief Wraps the fpga event set routines in OPAE C
+ *
+ * An event set waits on any number of event objects, from any number of
+ * handles, with a single call. Events added to the set are kept alive until
+ * they are removed or the set is destroyed.
+ */
+class event_set {
+ public:
+  typedef std::shared_ptr<event_set> ptr_t;
+
+  /**
+   * @brief An event that fired, as reported by wait()
+   */
+  struct fired_t {
+    /** The event object that fired. */
+    event::ptr_t ev;
+    /** Number of times it fired since it was last reported. */
+    uint64_t count;
+  };
+
+  /**
+   * @brief Remove all events and destroy the event set
+   */
+  virtual ~event_set();
+
+  /**
+   * @brief Factory function to create event_set objects
+   *
+   * @return A shared ptr to an empty event set
+   */
+  static event_set::ptr_t create();
+
+  /**
+   * @brief Add an event object to the set
+   *
+   * @param ev The event to add. It may belong to at most one set.
+   */
+  void add(event::ptr_t ev);
+
+  /**
+   * @brief Remove an event object from the set
+   *
+   * @param ev The event to remove.
+   */
+  void remove(event::ptr_t ev);
+
+  /**
+   * @brief Wait for events in the set
+   *
+   * @param timeout_ms Timeout in milliseconds, or -1 to wait indefinitely.
+   * @param max_events Maximum number of events to report.
+   *
+   * @return The events that fired; empty if the timeout expired.
+   */
+  std::vector<fired_t> wait(int timeout_ms = -1, uint32_t max_events = 64);
+
+  /**
+   * @brief Get the number of events in the set
+   */
+  size_t size() const;
+
+ private:
+  event_set(fpga_event_set set);
+  fpga_event_set set_;
+  mutable std::mutex lock_;
+  std::map<fpga_event_handle, event::ptr_t> events_;
+};
+
 }  // end of namespace types
 }  // end of namespace fpga
 }  // end of namespace opae
@@ -27,14 +27,84 @@
 #include <memory>
 #include <vector>
 
+#include <opae/cxx/core/except.h>
 #include <opae/cxx/core/token.h>
 #include <opae/enum.h>
+#include <opae/mmio.h>
 #include <opae/types.h>
 
 namespace opae {
 namespace fpga {
 namespace types {
 
+/** Direct access to one CSR space of an open handle
+ *
+ * Wraps an fpga_mmio_accessor resolved by handle::accessor().
+ * The CSR read/write members are defined inline so that hot
+ * loops do not pay for handle validation or plugin dispatch.
+ * An accessor must not outlive the handle it came from.
+ */
+class mmio_accessor {
+ public:
+  /** Wrap an accessor returned by fpgaGetMMIOAccessor().
+   */
+  explicit mmio_accessor(const fpga_mmio_accessor &accessor)
+      : accessor_(accessor) {}
+
+  /** Retrieve the underlying OPAE accessor.
+   */
+  const fpga_mmio_accessor &c_type() const { return accessor_; }
+
+  /**
+   * @brief Read 32 bits from a CSR.
+   *
+   * @param[in] offset The register offset
+   *
+   * @return The 32-bit value read from the CSR
+   */
+  uint32_t read_csr32(uint64_t offset) const {
+    uint32_t value = 0;
+    ASSERT_FPGA_OK(fpgaAccessorReadMMIO32(&accessor_, offset, &value));
+    return value;
+  }
+
+  /**
+   * @brief Write 32 bits to a CSR.
+   *
+   * @param[in] offset The register offset.
+   * @param[in] value The 32-bit value to write to the register.
+   */
+  void write_csr32(uint64_t offset, uint32_t value) const {
+    ASSERT_FPGA_OK(fpgaAccessorWriteMMIO32(&accessor_, offset, value));
+  }
+
+  /**
+   * @brief Read 64 bits from a CSR.
+   *
+   * @param[in] offset The register offset
+   *
+   * @return The 64-bit value read from the CSR
+   */
+  uint64_t read_csr64(uint64_t offset) const {
+    uint64_t value = 0;
+    ASSERT_FPGA_OK(fpgaAccessorReadMMIO64(&accessor_, offset, &value));
+    return value;
+  }
+
+  /**
+   * @brief Write 64 bits to a CSR.
+   *
+   * @param[in] offset The register offset.
+   * @param[in] value The 64-bit value to write to the register.
+   */
+  void write_csr64(uint64_t offset, uint64_t value) const {
+    ASSERT_FPGA_OK(fpgaAccessorWriteMMIO64(&accessor_, offset, value));
+  }
+
+ private:
+  fpga_mmio_accessor accessor_;
+};
+
 /** An allocated accelerator resource
  *
  * Represents an accelerator resource that has
@@ -125,6 +195,19 @@ class handle {
    */
   void write_csr64(uint64_t offset, uint64_t value, uint32_t csr_space = 0);
 
+  /**
+   * @brief Resolve a direct accessor for a CSR space.
+   *
+   * The accessor maps the CSR space once; its inline read/write
+   * members bypass the per-call validation of read_csr64() and
+   * friends.
+   *
+   * @param[in] csr_space The CSR space to access. Default is 0.
+   *
+   * @return An mmio_accessor for the given CSR space
+   */
+  mmio_accessor accessor(uint32_t csr_space = 0) const;
+
   /**
    * @brief Write 512 bits to a CSR belonging to a resource associated
    * with a handle.
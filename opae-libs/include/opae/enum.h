@@ -102,6 +102,48 @@ fpga_result fpgaEnumerate(const fpga_properties *filters,
 			  uint32_t num_filters, fpga_token *tokens,
 			  uint32_t max_tokens, uint32_t *num_matches);
 
+/**
+ * Enumerate FPGA resources and allocate the token array
+ *
+ * Single-call variant of fpgaEnumerate() that sizes the returned array to
+ * the number of matches, so callers don't need a separate call to count
+ * them first. Each loaded plugin is enumerated concurrently; tokens are
+ * returned grouped by plugin, in plugin load order.
+ *
+ * @note The returned array and the tokens in it must be released with
+ * fpgaDestroyTokens().
+ *
+ * @param[in] filters      Array of `fpga_properties` objects, as for
+ *                         fpgaEnumerate().
+ * @param[in] num_filters  Number of entries in the `filters` array, or 0 to
+ *                         match all FPGA resources when `filters` is NULL.
+ * @param[out] tokens      Set to a newly allocated array of matching tokens,
+ *                         or NULL if there were no matches.
+ * @param[out] num_tokens  Number of tokens in the `tokens` array.
+ * @returns                FPGA_OK on success.
+ *                         FPGA_INVALID_PARAM if invalid pointers or objects
+ *                         are passed into the function.
+ *                         FPGA_EXCEPTION if any plugin failed to enumerate.
+ *                         FPGA_NO_MEMORY if there was not enough memory to
+ *                         create tokens.
+ */
+fpga_result fpgaEnumerateAlloc(const fpga_properties *filters,
+			       uint32_t num_filters, fpga_token **tokens,
+			       uint32_t *num_tokens);
+
+/**
+ * Destroy an array of tokens
+ *
+ * Destroys each token in an array returned by fpgaEnumerateAlloc() and
+ * frees the array.
+ *
+ * @param[in,out] tokens   Address of the token array. Set to NULL on return.
+ * @param[in] num_tokens   Number of tokens in the array.
+ * @returns                FPGA_OK on success, or the first error reported
+ *                         by fpgaDestroyToken().
+ */
+fpga_result fpgaDestroyTokens(fpga_token **tokens, uint32_t num_tokens);
+
 /**
  * Clone a fpga_token object
  *
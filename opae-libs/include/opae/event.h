@@ -153,6 +153,120 @@ fpga_result fpgaUnregisterEvent(fpga_handle handle,
 					     fpga_event_type event_type,
 					     fpga_event_handle event_handle);
 
+/**
+ * Event reported by fpgaEventSetWait()
+ *
+ * Describes one event source of an `fpga_event_set` that was signaled.
+ */
+typedef struct fpga_event_set_event {
+	/** Handle passed to fpgaEventSetAdd() for this event source. */
+	fpga_handle handle;
+	/** Event handle that was signaled. */
+	fpga_event_handle event_handle;
+	/** Event type passed to fpgaEventSetAdd() for this event source. */
+	fpga_event_type event_type;
+	/** Number of times the event fired since it was last reported. */
+	uint64_t count;
+	/** Context pointer passed to fpgaEventSetAdd(). */
+	void *context;
+} fpga_event_set_event;
+
+/**
+ * Create an event set
+ *
+ * An event set aggregates any number of registered event handles, from any
+ * number of FPGA handles, behind one OS wait object (an epoll instance on
+ * Linux). A single call to fpgaEventSetWait() then waits for all of them and
+ * reports every source that fired.
+ *
+ * @param[out] set Pointer to the event set variable.
+ *
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if `set` is NULL.
+ * FPGA_NO_MEMORY if allocation fails. FPGA_EXCEPTION if the OS wait object
+ * could not be created.
+ */
+fpga_result fpgaCreateEventSet(fpga_event_set *set);
+
+/**
+ * Add an event handle to an event set
+ *
+ * `event_handle` must already have been registered with fpgaRegisterEvent().
+ * `handle`, `event_type` and `context` are not interpreted by the event set;
+ * they are returned in each fpga_event_set_event reported for
+ * `event_handle`. An event handle may belong to at most one event set, and
+ * once added its OS object should not be read by the application.
+ *
+ * @param[in] set          Event set created by fpgaCreateEventSet().
+ * @param[in] handle       Handle the event was registered on.
+ * @param[in] event_handle Registered event handle to add.
+ * @param[in] event_type   Type the event was registered with.
+ * @param[in] context      Optional user data reported with each event.
+ *
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if any handle is invalid,
+ * if `event_handle` has not been registered, or if it is already part of
+ * `set`. FPGA_NO_MEMORY if allocation fails. FPGA_EXCEPTION if the OS wait
+ * object could not be updated.
+ */
+fpga_result fpgaEventSetAdd(fpga_event_set set, fpga_handle handle,
+			    fpga_event_handle event_handle,
+			    fpga_event_type event_type, void *context);
+
+/**
+ * Remove an event handle from an event set
+ *
+ * Events already pending on `event_handle` are not reported after this
+ * function returns, even to a concurrent fpgaEventSetWait(). Event handles
+ * must be removed before they are unregistered or destroyed.
+ *
+ * @param[in] set          Event set created by fpgaCreateEventSet().
+ * @param[in] event_handle Event handle previously added with
+ *                         fpgaEventSetAdd().
+ *
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if `set` is invalid.
+ * FPGA_NOT_FOUND if `event_handle` is not part of `set`.
+ */
+fpga_result fpgaEventSetRemove(fpga_event_set set,
+			       fpga_event_handle event_handle);
+
+/**
+ * Wait for events in an event set
+ *
+ * Blocks until at least one event source in `set` fires, or until
+ * `timeout_ms` milliseconds elapse, then reports up to `max_events`
+ * signaled sources in `events`. The pending count of each reported source
+ * is consumed, so a source is reported again only after it fires again.
+ * Concurrent callers are serialized.
+ *
+ * @param[in]  set        Event set created by fpgaCreateEventSet().
+ * @param[out] events     Array receiving at least `max_events` entries.
+ * @param[in]  max_events Capacity of `events`; must be non-zero.
+ * @param[in]  timeout_ms Timeout in milliseconds. 0 polls without blocking;
+ *                        -1 waits indefinitely.
+ * @param[out] num_events Number of entries written to `events`. 0 if the
+ *                        timeout expired or the wait was interrupted by a
+ *                        signal.
+ *
+ * @returns FPGA_OK on success, including timeout. FPGA_INVALID_PARAM if any
+ * parameter is invalid. FPGA_NO_MEMORY if allocation fails. FPGA_EXCEPTION
+ * if waiting on the OS wait object failed.
+ */
+fpga_result fpgaEventSetWait(fpga_event_set set, fpga_event_set_event *events,
+			     uint32_t max_events, int timeout_ms,
+			     uint32_t *num_events);
+
+/**
+ * Destroy an event set
+ *
+ * Releases the OS wait object and all memory held by `*set`. The event
+ * handles in the set are neither unregistered nor destroyed. No thread may
+ * be waiting on the set when it is destroyed.
+ *
+ * @param[in,out] set Pointer to the event set; set to NULL on success.
+ *
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if `set` is invalid.
+ */
+fpga_result fpgaDestroyEventSet(fpga_event_set *set);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif // __cplusplus
@@ -132,6 +132,227 @@ fpga_result fpgaGetMetricsThresholdInfo(fpga_handle handle,
 				struct metric_threshold *metric_thresholds,
 				uint32_t *num_thresholds);
 
+/**
+ * Prepare a set of metrics for repeated sampling
+ *
+ * Resolves the metrics in `metric_num` once, along with anything needed
+ * to read them (e.g. the BMC sensor records). The session must be
+ * destroyed before `handle` is closed.
+ *
+ * @param[in] handle Handle to previously opened fpga resource
+ * @param[in] metric_num Array of metric indexes, as reported by
+ * fpgaGetMetricsInfo()
+ * @param[in] num_metric_indexes Size of metric index array
+ * @param[out] session Pointer to memory to store the session in
+ *
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if any of the supplied
+ * parameters is invalid. FPGA_NOT_FOUND if none of the metrics was found.
+ * FPGA_NO_MEMORY if the session could not be allocated.
+ *
+ */
+fpga_result fpgaCreateMetricsSession(fpga_handle handle,
+				const uint64_t *metric_num,
+				uint64_t num_metric_indexes,
+				fpga_metrics_session *session);
+
+/**
+ * Sample the metrics of a session
+ *
+ * Reads the current value of every metric of the session into `metrics`,
+ * in the order the metric indexes were given to fpgaCreateMetricsSession().
+ * The isvalid member of each entry tells whether its value was read.
+ *
+ * @param[in] session Session created by fpgaCreateMetricsSession()
+ * @param[out] metrics Array of at least num_metric_indexes metric structs
+ *
+ * @returns FPGA_OK if at least one metric was read. FPGA_NOT_FOUND if
+ * none could be read. FPGA_INVALID_PARAM if any of the supplied
+ * parameters is invalid.
+ *
+ */
+fpga_result fpgaSampleMetricsSession(fpga_metrics_session session,
+				fpga_metric *metrics);
+
+/**
+ * Free the resources of a metrics session
+ *
+ * @param[in] session Pointer to the session to destroy
+ *
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if the session is
+ * invalid.
+ *
+ */
+fpga_result fpgaDestroyMetricsSession(fpga_metrics_session *session);
+
+/**
+ * Start sampling a set of metrics in the background
+ *
+ * Creates a thread that samples the metrics in `metric_num` every
+ * `period_usec` microseconds, as fpgaSampleMetricsSession() would, and
+ * keeps the last `depth` samples. Readers of the collector never wait
+ * for the sampling thread or for the handle. The collector must be
+ * destroyed before `handle` is closed.
+ *
+ * @param[in] handle Handle to previously opened fpga resource
+ * @param[in] metric_num Array of metric indexes, as reported by
+ * fpgaGetMetricsInfo()
+ * @param[in] num_metric_indexes Size of metric index array
+ * @param[in] period_usec Sampling period in microseconds
+ * @param[in] depth Number of samples to keep. Rounded up to a power of
+ * two; 0 selects a default of 64.
+ * @param[out] collector Pointer to memory to store the collector in
+ *
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if any of the supplied
+ * parameters is invalid. FPGA_NOT_FOUND if none of the metrics was found.
+ * FPGA_NO_MEMORY if the collector could not be allocated. FPGA_EXCEPTION
+ * if the sampling thread could not be started.
+ *
+ */
+fpga_result fpgaCreateMetricsCollector(fpga_handle handle,
+				const uint64_t *metric_num,
+				uint64_t num_metric_indexes,
+				uint32_t period_usec,
+				uint32_t depth,
+				fpga_metrics_collector *collector);
+
+/**
+ * Read the most recent sample of a collector
+ *
+ * @param[in] collector Collector created by fpgaCreateMetricsCollector()
+ * @param[out] metrics Array of at least num_metric_indexes metric structs,
+ * filled in the order the metric indexes were given
+ * @param[out] sequence Sequence number of the sample, counting from 0.
+ * May be NULL.
+ *
+ * @returns FPGA_OK on success. FPGA_NOT_FOUND if no sample has been
+ * taken yet. FPGA_INVALID_PARAM if any of the supplied parameters is
+ * invalid.
+ *
+ */
+fpga_result fpgaReadLatestMetrics(fpga_metrics_collector collector,
+				fpga_metric *metrics,
+				uint64_t *sequence);
+
+/**
+ * Drain the sample history of a collector
+ *
+ * Copies the samples from sequence number `*cursor` on, oldest first, and
+ * advances `*cursor` past the last sample returned. Start with a cursor
+ * of 0. Samples that have already been overwritten are skipped; the
+ * cursor then advances by more than `*num_samples`.
+ *
+ * @param[in] collector Collector created by fpgaCreateMetricsCollector()
+ * @param[inout] cursor Sequence number of the next sample to read
+ * @param[out] metrics Array of at least max_samples * num_metric_indexes
+ * metric structs
+ * @param[in] max_samples Maximum number of samples to return
+ * @param[out] num_samples Number of samples returned
+ *
+ * @returns FPGA_OK on success, including when no new sample is
+ * available. FPGA_INVALID_PARAM if any of the supplied parameters is
+ * invalid.
+ *
+ */
+fpga_result fpgaReadMetricsHistory(fpga_metrics_collector collector,
+				uint64_t *cursor,
+				fpga_metric *metrics,
+				uint64_t max_samples,
+				uint64_t *num_samples);
+
+/**
+ * Stop a metrics collector and free its resources
+ *
+ * No reader may use the collector once this is called.
+ *
+ * @param[in] collector Pointer to the collector to destroy
+ *
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if the collector is
+ * invalid.
+ *
+ */
+fpga_result fpgaDestroyMetricsCollector(fpga_metrics_collector *collector);
+
+/**
+ * Create a threshold monitor for a set of metrics
+ *
+ * Reads the thresholds of the metrics in `metric_num` once. Samples of
+ * those metrics (e.g. from fpgaSampleMetricsSession() or
+ * fpgaReadLatestMetrics()) are then checked with fpgaEvaluateThresholds(),
+ * which reports only the metrics whose threshold state changed: through
+ * `callback`, and by signalling `event_handle`, whose OS object
+ * (fpgaGetOSObjectFromEventHandle()) can be polled. Both are optional.
+ *
+ * The event handle must outlive the monitor.
+ *
+ * @param[in] handle Handle to previously opened fpga resource
+ * @param[in] metric_num Array of metric indexes, as reported by
+ * fpgaGetMetricsInfo()
+ * @param[in] num_metric_indexes Size of metric index array
+ * @param[in] callback Function called for each state change, or NULL
+ * @param[in] context Passed to `callback`
+ * @param[in] event_handle Event handle created with fpgaCreateEventHandle()
+ * to signal on state changes, or NULL
+ * @param[out] monitor Pointer to memory to store the monitor in
+ *
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if any of the supplied
+ * parameters is invalid. FPGA_NOT_FOUND if none of the metrics has
+ * thresholds. FPGA_NO_MEMORY if the monitor could not be allocated.
+ *
+ */
+fpga_result fpgaCreateThresholdMonitor(fpga_handle handle,
+				const uint64_t *metric_num,
+				uint64_t num_metric_indexes,
+				fpga_threshold_callback callback,
+				void *context,
+				fpga_event_handle event_handle,
+				fpga_threshold_monitor *monitor);
+
+/**
+ * Check a sample against the thresholds of a monitor
+ *
+ * A threshold is crossed when the value reaches it. Once crossed, it is
+ * only cleared after the value has moved back by the hysteresis of the
+ * metric, if it has one. Invalid entries of `metrics` leave the state of
+ * their metric unchanged.
+ *
+ * @param[in] monitor Monitor created by fpgaCreateThresholdMonitor()
+ * @param[in] metrics Array of num_metric_indexes metric structs, in the
+ * order the metric indexes were given to fpgaCreateThresholdMonitor()
+ * @param[out] num_transitions Number of metrics whose state changed.
+ * May be NULL.
+ *
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if any of the supplied
+ * parameters is invalid.
+ *
+ */
+fpga_result fpgaEvaluateThresholds(fpga_threshold_monitor monitor,
+				const fpga_metric *metrics,
+				uint64_t *num_transitions);
+
+/**
+ * Get the current threshold state of the metrics of a monitor
+ *
+ * @param[in] monitor Monitor created by fpgaCreateThresholdMonitor()
+ * @param[out] states Array of num_metric_indexes FPGA_THRESHOLD_* masks
+ *
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if any of the supplied
+ * parameters is invalid.
+ *
+ */
+fpga_result fpgaGetThresholdStates(fpga_threshold_monitor monitor,
+				uint32_t *states);
+
+/**
+ * Free the resources of a threshold monitor
+ *
+ * @param[in] monitor Pointer to the monitor to destroy
+ *
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if the monitor is
+ * invalid.
+ *
+ */
+fpga_result fpgaDestroyThresholdMonitor(fpga_threshold_monitor *monitor);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif // __cplusplus
@@ -138,6 +138,94 @@ fpga_result fpgaWriteMMIO512(fpga_handle handle,
 			    uint32_t mmio_num, uint64_t offset,
 			    const void *value);
 
+/**
+ * Read a list of 64 bit values from MMIO space
+ *
+ * Reads `count` registers at the byte offsets given in `offsets` in a single
+ * call. Plugins that support batched access validate all offsets up front and
+ * perform the reads under one acquisition of the handle; other plugins fall
+ * back to one fpgaReadMMIO64() per element.
+ *
+ * @param[in]  handle   Handle to previously opened accelerator resource
+ * @param[in]  mmio_num Number of MMIO space to access
+ * @param[in]  offsets  Array of `count` byte offsets into MMIO space
+ * @param[out] values   Array receiving the `count` values read (64 bit)
+ * @param[in]  count    Number of registers to read
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if any of the supplied
+ * parameters, including any offset, is invalid. FPGA_EXCEPTION if an internal
+ * exception occurred while trying to access the handle.
+ */
+fpga_result fpgaReadMMIO64Vec(fpga_handle handle,
+			      uint32_t mmio_num,
+			      const uint64_t *offsets,
+			      uint64_t *values,
+			      uint32_t count);
+
+/**
+ * Write a list of 64 bit values to MMIO space
+ *
+ * Writes `values[i]` to byte offset `offsets[i]` for each of the `count`
+ * elements, in array order. See fpgaReadMMIO64Vec() for the batching
+ * behavior.
+ *
+ * @param[in]  handle   Handle to previously opened accelerator resource
+ * @param[in]  mmio_num Number of MMIO space to access
+ * @param[in]  offsets  Array of `count` byte offsets into MMIO space
+ * @param[in]  values   Array of `count` values to write (64 bit)
+ * @param[in]  count    Number of registers to write
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if any of the supplied
+ * parameters, including any offset, is invalid. FPGA_EXCEPTION if an internal
+ * exception occurred while trying to access the handle.
+ */
+fpga_result fpgaWriteMMIO64Vec(fpga_handle handle,
+			       uint32_t mmio_num,
+			       const uint64_t *offsets,
+			       const uint64_t *values,
+			       uint32_t count);
+
+/**
+ * Read a contiguous range of 64 bit values from MMIO space
+ *
+ * Reads `count` consecutive registers starting at byte offset `offset`.
+ * See fpgaReadMMIO64Vec() for the batching behavior.
+ *
+ * @param[in]  handle   Handle to previously opened accelerator resource
+ * @param[in]  mmio_num Number of MMIO space to access
+ * @param[in]  offset   Byte offset of the first register
+ * @param[out] values   Array receiving the `count` values read (64 bit)
+ * @param[in]  count    Number of registers to read
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if any of the supplied
+ * parameters is invalid or the range exceeds the MMIO space. FPGA_EXCEPTION
+ * if an internal exception occurred while trying to access the handle.
+ */
+fpga_result fpgaReadMMIO64Range(fpga_handle handle,
+				uint32_t mmio_num,
+				uint64_t offset,
+				uint64_t *values,
+				uint32_t count);
+
+/**
+ * Write a contiguous range of 64 bit values to MMIO space
+ *
+ * Writes `count` consecutive registers starting at byte offset `offset`,
+ * in ascending address order. See fpgaReadMMIO64Vec() for the batching
+ * behavior.
+ *
+ * @param[in]  handle   Handle to previously opened accelerator resource
+ * @param[in]  mmio_num Number of MMIO space to access
+ * @param[in]  offset   Byte offset of the first register
+ * @param[in]  values   Array of `count` values to write (64 bit)
+ * @param[in]  count    Number of registers to write
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if any of the supplied
+ * parameters is invalid or the range exceeds the MMIO space. FPGA_EXCEPTION
+ * if an internal exception occurred while trying to access the handle.
+ */
+fpga_result fpgaWriteMMIO64Range(fpga_handle handle,
+				 uint32_t mmio_num,
+				 uint64_t offset,
+				 const uint64_t *values,
+				 uint32_t count);
+
 /**
  * Map MMIO space
  *
@@ -200,6 +288,111 @@ fpga_result fpgaMapMMIO(fpga_handle handle,
 fpga_result fpgaUnmapMMIO(fpga_handle handle,
 			  uint32_t mmio_num);
 
+/**
+ * Resolve an MMIO accessor
+ *
+ * Maps the requested MMIO space (if not already mapped) and fills in an
+ * fpga_mmio_accessor that can be used with the inline accessor functions.
+ *
+ * @param[in]  handle   Handle to previously opened accelerator resource
+ * @param[in]  mmio_num Number of MMIO space to access
+ * @param[out] accessor Pointer to the accessor to fill in
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if any of the supplied
+ * parameters is invalid. FPGA_EXCEPTION if an internal exception occurred
+ * while trying to access the handle. FPGA_NO_ACCESS if the process'
+ * permissions are not sufficient to map the requested MMIO space.
+ */
+fpga_result fpgaGetMMIOAccessor(fpga_handle handle, uint32_t mmio_num,
+				fpga_mmio_accessor *accessor);
+
+/**
+ * Read 64 bit value through an MMIO accessor
+ *
+ * @param[in]  accessor Accessor returned by fpgaGetMMIOAccessor()
+ * @param[in]  offset   Byte offset into MMIO space
+ * @param[out] value    Pointer to memory where read value is returned (64 bit)
+ * @returns See fpgaReadMMIO64().
+ */
+static inline fpga_result
+fpgaAccessorReadMMIO64(const fpga_mmio_accessor *accessor, uint64_t offset,
+		       uint64_t *value)
+{
+	if (accessor->base && !(offset % sizeof(uint64_t)) &&
+	    accessor->len >= sizeof(uint64_t) &&
+	    offset <= accessor->len - sizeof(uint64_t)) {
+		*value = *((volatile uint64_t *)(accessor->base + offset));
+		return FPGA_OK;
+	}
+	return fpgaReadMMIO64(accessor->handle, accessor->mmio_num,
+			      offset, value);
+}
+
+/**
+ * Write 64 bit value through an MMIO accessor
+ *
+ * @param[in]  accessor Accessor returned by fpgaGetMMIOAccessor()
+ * @param[in]  offset   Byte offset into MMIO space
+ * @param[in]  value    Value to write (64 bit)
+ * @returns See fpgaWriteMMIO64().
+ */
+static inline fpga_result
+fpgaAccessorWriteMMIO64(const fpga_mmio_accessor *accessor, uint64_t offset,
+			uint64_t value)
+{
+	if (accessor->base && !(offset % sizeof(uint64_t)) &&
+	    accessor->len >= sizeof(uint64_t) &&
+	    offset <= accessor->len - sizeof(uint64_t)) {
+		*((volatile uint64_t *)(accessor->base + offset)) = value;
+		return FPGA_OK;
+	}
+	return fpgaWriteMMIO64(accessor->handle, accessor->mmio_num,
+			       offset, value);
+}
+
+/**
+ * Read 32 bit value through an MMIO accessor
+ *
+ * @param[in]  accessor Accessor returned by fpgaGetMMIOAccessor()
+ * @param[in]  offset   Byte offset into MMIO space
+ * @param[out] value    Pointer to memory where read value is returned (32 bit)
+ * @returns See fpgaReadMMIO32().
+ */
+static inline fpga_result
+fpgaAccessorReadMMIO32(const fpga_mmio_accessor *accessor, uint64_t offset,
+		       uint32_t *value)
+{
+	if (accessor->base && !(offset % sizeof(uint32_t)) &&
+	    accessor->len >= sizeof(uint32_t) &&
+	    offset <= accessor->len - sizeof(uint32_t)) {
+		*value = *((volatile uint32_t *)(accessor->base + offset));
+		return FPGA_OK;
+	}
+	return fpgaReadMMIO32(accessor->handle, accessor->mmio_num,
+			      offset, value);
+}
+
+/**
+ * Write 32 bit value through an MMIO accessor
+ *
+ * @param[in]  accessor Accessor returned by fpgaGetMMIOAccessor()
+ * @param[in]  offset   Byte offset into MMIO space
+ * @param[in]  value    Value to write (32 bit)
+ * @returns See fpgaWriteMMIO32().
+ */
+static inline fpga_result
+fpgaAccessorWriteMMIO32(const fpga_mmio_accessor *accessor, uint64_t offset,
+			uint32_t value)
+{
+	if (accessor->base && !(offset % sizeof(uint32_t)) &&
+	    accessor->len >= sizeof(uint32_t) &&
+	    offset <= accessor->len - sizeof(uint32_t)) {
+		*((volatile uint32_t *)(accessor->base + offset)) = value;
+		return FPGA_OK;
+	}
+	return fpgaWriteMMIO32(accessor->handle, accessor->mmio_num,
+			       offset, value);
+}
+
 #ifdef __cplusplus
 } // extern "C"
 #endif // __cplusplus
@@ -235,6 +235,67 @@ fpga_result fpgaObjectRead64(fpga_object obj, uint64_t *value, int flags);
  */
 fpga_result fpgaObjectWrite64(fpga_object obj, uint64_t value, int flags);
 
+/**
+ * @brief Compile a read plan for the attributes of an object
+ * Resolves every attribute at or below `obj` whose value is an integer
+ * (for example the counters of an FME perf group) and keeps it open for
+ * sampling with fpgaReadPlanRead(). Symbolic links are not followed.
+ * Attributes are ordered by their path relative to `obj`.
+ * @param[in] obj An fpga_object instance: a container or an attribute.
+ * @param[out] plan Pointer to memory to store the read plan in.
+ * @return FPGA_OK on success. FPGA_INVALID_PARAM if any of the supplied
+ * parameters is invalid. FPGA_NOT_FOUND if no integer attribute was found.
+ * FPGA_NO_MEMORY if the plan could not be allocated.
+ */
+fpga_result fpgaObjectCreateReadPlan(fpga_object obj, fpga_read_plan *plan);
+
+/**
+ * @brief Retrieve the number of attributes in a read plan
+ * @param[in] plan A read plan created by fpgaObjectCreateReadPlan().
+ * @param[out] count Pointer to variable to store the count in.
+ * @return FPGA_OK on success, FPGA_INVALID_PARAM if any of the supplied
+ * parameters is invalid.
+ */
+fpga_result fpgaReadPlanGetCount(fpga_read_plan plan, uint32_t *count);
+
+/**
+ * @brief Retrieve the name of an attribute in a read plan
+ * The name is the attribute's path relative to the object the plan was
+ * created from, e.g. "cache/read_hit".
+ * @param[in] plan A read plan created by fpgaObjectCreateReadPlan().
+ * @param[in] index Index of the attribute, less than the plan's count.
+ * @param[out] name Buffer to store the name in.
+ * @param[in] max_len Size of the name buffer.
+ * @return FPGA_OK on success, FPGA_INVALID_PARAM if any of the supplied
+ * parameters is invalid.
+ */
+fpga_result fpgaReadPlanGetName(fpga_read_plan plan, uint32_t index,
+				char *name, size_t max_len);
+
+/**
+ * @brief Sample every attribute of a read plan
+ * Reads the current value of the first `count` attributes of the plan into
+ * `values`, in plan order. Samples for several points in time can be kept
+ * in one flat array by passing successive rows of it.
+ * @param[in] plan A read plan created by fpgaObjectCreateReadPlan().
+ * @param[out] values Array of at least `count` values.
+ * @param[in] count Number of values to read, at most the plan's count.
+ * @param[out] timestamp_ns Optional pointer to receive the CLOCK_MONOTONIC
+ * time, in nanoseconds, at which sampling started. Pass NULL to ignore.
+ * @return FPGA_OK on success, FPGA_INVALID_PARAM if any of the supplied
+ * parameters is invalid. FPGA_EXCEPTION if an attribute could not be read;
+ * its value is set to UINT64_MAX and the other values are still read.
+ */
+fpga_result fpgaReadPlanRead(fpga_read_plan plan, uint64_t *values,
+			     uint32_t count, uint64_t *timestamp_ns);
+
+/**
+ * @brief Free the resources of a read plan
+ * @param[in] plan Pointer to the read plan to destroy.
+ * @return FPGA_OK on success, FPGA_INVALID_PARAM if the plan is invalid.
+ */
+fpga_result fpgaDestroyReadPlan(fpga_read_plan *plan);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif // __cplusplus
@@ -145,6 +145,38 @@ typedef struct {
 	uint16_t patch;       /**< Revision or patchlevel */
 } fpga_version;
 
+/** Resolved MMIO space of an open handle
+ *
+ * Describes one MMIO space of an open handle, resolved once by
+ * fpgaGetMMIOAccessor(). The fpgaAccessorReadMMIO*() and
+ * fpgaAccessorWriteMMIO*() functions in mmio.h are inlined into the caller and
+ * access the mapped space directly, without validating the handle or
+ * dispatching to the plugin. When the target does not support memory-mapped
+ * MMIO, `base` is NULL and every access is forwarded to fpgaReadMMIO32(),
+ * fpgaWriteMMIO32(), fpgaReadMMIO64() or fpgaWriteMMIO64().
+ *
+ * An accessor becomes invalid when its MMIO space is unmapped with
+ * fpgaUnmapMMIO() or its handle is closed.
+ */
+typedef struct _fpga_mmio_accessor {
+	volatile uint8_t *base; /**< Mapped MMIO space, NULL if not mappable */
+	uint64_t len;           /**< Length of the MMIO space in bytes */
+	fpga_handle handle;     /**< Handle the accessor was resolved from */
+	uint32_t mmio_num;      /**< Number of the MMIO space */
+} fpga_mmio_accessor;
+
+/** Buffer pool statistics
+ *
+ * Counters of the per-handle pool that recycles buffers prepared with
+ * FPGA_BUF_POOLED. See fpgaBufferPoolGetStats().
+ */
+typedef struct _fpga_buffer_pool_stats {
+	uint64_t hits;         /**< Prepares served from an idle buffer */
+	uint64_t misses;       /**< Prepares that allocated and pinned memory */
+	uint64_t pinned_bytes; /**< Bytes pinned by pooled buffers (in use or idle) */
+	uint64_t idle_bytes;   /**< Bytes pinned by idle pooled buffers */
+} fpga_buffer_pool_stats;
+
 /** Handle to an event object
  *
  * OPAE provides an interface to asynchronous events that can be generated by
@@ -159,6 +191,14 @@ typedef struct {
  */
 typedef void *fpga_event_handle;
 
+/** Handle to a set of event objects
+ *
+ * An `fpga_event_set` aggregates registered `fpga_event_handle`s from any
+ * number of `fpga_handle`s so that a single thread can wait on all of them
+ * with one call. See fpgaCreateEventSet().
+ */
+typedef void *fpga_event_set;
+
 /** Information about an error register
  *
  * This data structure captures information about an error register exposed by
@@ -188,6 +228,30 @@ struct fpga_error_info {
  */
 typedef void *fpga_object;
 
+/** Compiled read plan for a group of sysobject attributes
+ *
+ * A read plan resolves the numeric attributes below an `fpga_object` once,
+ * so that all of them can be sampled by a single fpgaReadPlanRead() call
+ * without any further name resolution.
+ */
+typedef void *fpga_read_plan;
+
+/** Prepared set of metrics
+ *
+ * A metrics session resolves a fixed set of metric indexes once, so that
+ * their values can be sampled repeatedly by fpgaSampleMetricsSession()
+ * without re-discovering the metrics of the resource.
+ */
+typedef void *fpga_metrics_session;
+
+/** Background metrics sampler
+ *
+ * A metrics collector samples a fixed set of metrics at a configured
+ * period on its own thread and keeps the most recent samples, so that
+ * any number of readers share the cost of one sampling loop.
+ */
+typedef void *fpga_metrics_collector;
+
 /** FPGA Metric string size
  *
  *
@@ -252,4 +316,36 @@ typedef struct metric_threshold {
 	threshold hysteresis;                          // Hysteresis
 } metric_threshold;
 
+/** Threshold states reported by a threshold monitor
+ *
+ * One bit per threshold of a metric_threshold; a bit is set while the
+ * metric value is beyond that threshold.
+ */
+#define FPGA_THRESHOLD_LOWER_NC  0x01   // Lower Non-Critical Threshold
+#define FPGA_THRESHOLD_LOWER_C   0x02   // Lower Critical Threshold
+#define FPGA_THRESHOLD_LOWER_NR  0x04   // Lower Non-Recoverable Threshold
+#define FPGA_THRESHOLD_UPPER_NC  0x08   // Upper Non-Critical Threshold
+#define FPGA_THRESHOLD_UPPER_C   0x10   // Upper Critical Threshold
+#define FPGA_THRESHOLD_UPPER_NR  0x20   // Upper Non-Recoverable Threshold
+
+/** Threshold transition callback
+ *
+ * Called by fpgaEvaluateThresholds() for each metric whose threshold
+ * state changed. `prev_state` and `state` are FPGA_THRESHOLD_* bit masks.
+ * It runs after the monitor has been updated and unlocked, so it may call
+ * fpgaGetThresholdStates() or fpgaEvaluateThresholds() on that monitor.
+ */
+typedef void (*fpga_threshold_callback)(uint64_t metric_num,
+					uint32_t prev_state,
+					uint32_t state,
+					double value,
+					void *context);
+
+/** Threshold monitor
+ *
+ * A threshold monitor holds the thresholds of a fixed set of metrics and
+ * their current state, and reports only the changes of that state.
+ */
+typedef void *fpga_threshold_monitor;
+
 #endif // __FPGA_TYPES_H__
@@ -122,7 +122,8 @@ typedef enum {
 enum fpga_buffer_flags {
 	FPGA_BUF_PREALLOCATED = (1u << 0), /**< Use existing buffer */
 	FPGA_BUF_QUIET = (1u << 1),        /**< Suppress error messages */
-	FPGA_BUF_READ_ONLY = (1u << 2)     /**< Buffer is read-only */
+	FPGA_BUF_READ_ONLY = (1u << 2),    /**< Buffer is read-only */
+	FPGA_BUF_POOLED = (1u << 3)        /**< Recycle via the buffer pool */
 };
 
 /**
@@ -132,7 +133,9 @@ enum fpga_buffer_flags {
  */
 enum fpga_open_flags {
 	/** Open FPGA resource for shared access */
-	FPGA_OPEN_SHARED = (1u << 0)
+	FPGA_OPEN_SHARED = (1u << 0),
+	/** Map all MMIO regions at open time and access them without locking */
+	FPGA_OPEN_MMIO_PREMAP = (1u << 1)
 };
 
 /**
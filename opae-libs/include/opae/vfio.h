@@ -47,15 +47,28 @@
 
 #include <linux/vfio.h>
 
+/**
+ * Free IO Virtual Address block
+ *
+ * A run of unallocated offsets within an IOVA range.
+ */
+struct opae_vfio_iova_block {
+	uint64_t start;				/**< First free offset. */
+	uint64_t end;				/**< Last free offset. */
+	struct opae_vfio_iova_block *next;	/**< Next block, by address. */
+};
+
 /**
  * IO Virtual Address Range
  *
  * A range of allocatable IOVA offsets. Used for mapping DMA buffers.
+ * Offsets released by opae_vfio_buffer_free are returned to the free
+ * list and merged with adjacent free blocks.
  */
 struct opae_vfio_iova_range {
 	uint64_t start;				/**< Start of this range of offsets. */
 	uint64_t end;				/**< End of this range of offsets. */
-	uint64_t next_ptr;			/**< The next allocatable offset. */
+	struct opae_vfio_iova_block *free_blocks;	/**< Free offsets, sorted. */
 	struct opae_vfio_iova_range *next;	/**< Pointer to next in list. */
 };
 
@@ -119,9 +132,13 @@ struct opae_vfio_buffer {
 	uint8_t *buffer_ptr;		/**< Buffer virtual address. */
 	size_t buffer_size;		/**< Buffer size. */
 	uint64_t buffer_iova;		/**< Buffer IOVA address. */
-	struct opae_vfio_buffer *next;	/**< Pointer to next in list. */
+	struct opae_vfio_buffer *next;	/**< Next in virtual address bucket. */
+	struct opae_vfio_buffer *iova_next;	/**< Next in IOVA bucket. */
 };
 
+/** Number of hash buckets used to index DMA buffers. */
+#define OPAE_VFIO_BUFFER_BUCKETS 1024
+
 /**
  * OPAE VFIO device abstraction
  *
@@ -137,7 +154,8 @@ struct opae_vfio {
 	struct opae_vfio_iova_range *cont_ranges;	/**< List of IOVA ranges. */
 	struct opae_vfio_group group;			/**< The VFIO device group. */
 	struct opae_vfio_device device;			/**< The VFIO device. */
-	struct opae_vfio_buffer *cont_buffers;		/**< List of allocated DMA buffers. */
+	struct opae_vfio_buffer **cont_buffers;		/**< DMA buffers hashed by virtual address. */
+	struct opae_vfio_buffer **cont_buffers_iova;	/**< DMA buffers hashed by IOVA. */
 };
 
 #ifdef __cplusplus
@@ -214,7 +232,7 @@ int opae_vfio_region_get(struct opae_vfio *v,
  * Allocate and map system buffer
  *
  * Allocate, map, and retrieve info for a system buffer capable of
- * DMA. Saves an entry in the v->cont_buffers list. If the buffer
+ * DMA. Saves an entry in the v->cont_buffers table. If the buffer
  * is not explicitly freed by opae_vfio_buffer_free, it will be
  * freed during opae_vfio_close.
  *
@@ -238,6 +256,9 @@ int opae_vfio_region_get(struct opae_vfio *v,
  * @note Be sure that the IOMMU is also enabled using the follow kernel
  * boot command: intel_iommu=on
  *
+ * The IOVA of a buffer of at least 2MB (1GB) is aligned to 2MB (1GB),
+ * so that the IOMMU can map it with large pages.
+ *
  * @param[in, out] v    The open OPAE VFIO device.
  * @param[in, out] size A pointer to the requested size. The size
  *                      may be rounded to the next page size prior
@@ -288,7 +309,8 @@ int opae_vfio_buffer_allocate(struct opae_vfio *v,
  * Unmap and free a system buffer
  *
  * The buffer corresponding to buf must have been created by a
- * previous call to opae_vfio_buffer_allocate.
+ * previous call to opae_vfio_buffer_allocate. Its IOVA offsets
+ * become available to subsequent allocations.
  *
  * @param[in, out] v   The open OPAE VFIO device.
  * @param[in]      buf The virtual address corresponding to
@@ -319,6 +341,26 @@ int opae_vfio_buffer_allocate(struct opae_vfio *v,
 int opae_vfio_buffer_free(struct opae_vfio *v,
 			  uint8_t *buf);
 
+/**
+ * Find a system buffer by IOVA
+ *
+ * Retrieves the buffer whose IOVA address is iova, e.g. to resolve
+ * an address reported in a device completion record.
+ *
+ * @param[in]  v    The open OPAE VFIO device.
+ * @param[in]  iova The IOVA address returned by
+ *                  opae_vfio_buffer_allocate for the buffer.
+ * @param[out] buf  Optional pointer to receive the virtual address
+ *                  for the buffer. Pass NULL to ignore.
+ * @param[out] size Optional pointer to receive the size of the
+ *                  buffer. Pass NULL to ignore.
+ * @returns Non-zero on error (including no such buffer). Zero on success.
+ */
+int opae_vfio_buffer_find_iova(struct opae_vfio *v,
+			       uint64_t iova,
+			       uint8_t **buf,
+			       size_t *size);
+
 /**
  * Release and close a VFIO device
  *
@@ -71,11 +71,35 @@ typedef struct _opae_api_adapter_table {
 	fpga_result (*fpgaWriteMMIO512)(fpga_handle handle, uint32_t mmio_num,
 				       uint64_t offset, void *value);
 
+	fpga_result (*fpgaReadMMIO64Vec)(fpga_handle handle, uint32_t mmio_num,
+					 const uint64_t *offsets,
+					 uint64_t *values, uint32_t count);
+
+	fpga_result (*fpgaWriteMMIO64Vec)(fpga_handle handle,
+					  uint32_t mmio_num,
+					  const uint64_t *offsets,
+					  const uint64_t *values,
+					  uint32_t count);
+
+	fpga_result (*fpgaReadMMIO64Range)(fpga_handle handle,
+					   uint32_t mmio_num, uint64_t offset,
+					   uint64_t *values, uint32_t count);
+
+	fpga_result (*fpgaWriteMMIO64Range)(fpga_handle handle,
+					    uint32_t mmio_num,
+					    uint64_t offset,
+					    const uint64_t *values,
+					    uint32_t count);
+
 	fpga_result (*fpgaMapMMIO)(fpga_handle handle, uint32_t mmio_num,
 				   uint64_t **mmio_ptr);
 
 	fpga_result (*fpgaUnmapMMIO)(fpga_handle handle, uint32_t mmio_num);
 
+	fpga_result (*fpgaGetMMIOAccessor)(fpga_handle handle,
+					   uint32_t mmio_num,
+					   fpga_mmio_accessor *accessor);
+
 	fpga_result (*fpgaEnumerate)(const fpga_properties *filters,
 				     uint32_t num_filters, fpga_token *tokens,
 				     uint32_t max_tokens,
@@ -102,6 +126,14 @@ typedef struct _opae_api_adapter_table {
 
 	fpga_result (*fpgaGetIOAddress)(fpga_handle handle, uint64_t wsid,
 					uint64_t *ioaddr);
+
+	fpga_result (*fpgaBufferPoolConfigure)(fpga_handle handle,
+					       uint64_t max_idle_bytes);
+
+	fpga_result (*fpgaBufferPoolTrim)(fpga_handle handle);
+
+	fpga_result (*fpgaBufferPoolGetStats)(fpga_handle handle,
+					      fpga_buffer_pool_stats *stats);
 	/*
 	**	fpga_result (*fpgaGetOPAECVersion)(fpga_version *version);
 	**
@@ -187,6 +219,20 @@ typedef struct _opae_api_adapter_table {
 	fpga_result (*fpgaObjectWrite64)(fpga_object obj, uint64_t value,
 					 int flags);
 
+	fpga_result (*fpgaObjectCreateReadPlan)(fpga_object obj,
+						fpga_read_plan *plan);
+
+	fpga_result (*fpgaReadPlanGetCount)(fpga_read_plan plan,
+					    uint32_t *count);
+
+	fpga_result (*fpgaReadPlanGetName)(fpga_read_plan plan, uint32_t index,
+					   char *name, size_t max_len);
+
+	fpga_result (*fpgaReadPlanRead)(fpga_read_plan plan, uint64_t *values,
+					uint32_t count, uint64_t *timestamp_ns);
+
+	fpga_result (*fpgaDestroyReadPlan)(fpga_read_plan *plan);
+
 	fpga_result (*fpgaSetUserClock)(fpga_handle handle, uint64_t high_clk,
 					uint64_t low_clk, int flags);
 
@@ -213,6 +259,55 @@ typedef struct _opae_api_adapter_table {
 		metric_threshold *metric_thresholds,
 		uint32_t *num_thresholds);
 
+	fpga_result (*fpgaCreateMetricsSession)(fpga_handle handle,
+					const uint64_t *metric_num,
+					uint64_t num_metric_indexes,
+					fpga_metrics_session *session);
+
+	fpga_result (*fpgaSampleMetricsSession)(fpga_metrics_session session,
+					fpga_metric *metrics);
+
+	fpga_result (*fpgaDestroyMetricsSession)(
+					fpga_metrics_session *session);
+
+	fpga_result (*fpgaCreateMetricsCollector)(fpga_handle handle,
+					const uint64_t *metric_num,
+					uint64_t num_metric_indexes,
+					uint32_t period_usec,
+					uint32_t depth,
+					fpga_metrics_collector *collector);
+
+	fpga_result (*fpgaReadLatestMetrics)(fpga_metrics_collector collector,
+					fpga_metric *metrics,
+					uint64_t *sequence);
+
+	fpga_result (*fpgaReadMetricsHistory)(fpga_metrics_collector collector,
+					uint64_t *cursor,
+					fpga_metric *metrics,
+					uint64_t max_samples,
+					uint64_t *num_samples);
+
+	fpga_result (*fpgaDestroyMetricsCollector)(
+					fpga_metrics_collector *collector);
+
+	fpga_result (*fpgaCreateThresholdMonitor)(fpga_handle handle,
+					const uint64_t *metric_num,
+					uint64_t num_metric_indexes,
+					fpga_threshold_callback callback,
+					void *context,
+					fpga_event_handle event_handle,
+					fpga_threshold_monitor *monitor);
+
+	fpga_result (*fpgaEvaluateThresholds)(fpga_threshold_monitor monitor,
+					const fpga_metric *metrics,
+					uint64_t *num_transitions);
+
+	fpga_result (*fpgaGetThresholdStates)(fpga_threshold_monitor monitor,
+					uint32_t *states);
+
+	fpga_result (*fpgaDestroyThresholdMonitor)(
+					fpga_threshold_monitor *monitor);
+
 	// configuration functions
 	int (*initialize)(void);
 	int (*finalize)(void);
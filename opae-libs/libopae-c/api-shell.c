@@ -131,6 +131,73 @@ opae_allocate_wrapped_object(fpga_object opae_object,
 	return wobj;
 }
 
+opae_wrapped_read_plan *
+opae_allocate_wrapped_read_plan(fpga_read_plan opae_plan,
+				opae_api_adapter_table *adapter)
+{
+	opae_wrapped_read_plan *wplan =
+		(opae_wrapped_read_plan *)malloc(sizeof(opae_wrapped_read_plan));
+
+	if (wplan) {
+		wplan->magic = OPAE_WRAPPED_READ_PLAN_MAGIC;
+		wplan->opae_plan = opae_plan;
+		wplan->adapter_table = adapter;
+	}
+
+	return wplan;
+}
+
+opae_wrapped_metrics_session *
+opae_allocate_wrapped_metrics_session(fpga_metrics_session opae_session,
+				      opae_api_adapter_table *adapter)
+{
+	opae_wrapped_metrics_session *wsession =
+		(opae_wrapped_metrics_session *)malloc(
+			sizeof(opae_wrapped_metrics_session));
+
+	if (wsession) {
+		wsession->magic = OPAE_WRAPPED_METRICS_SESSION_MAGIC;
+		wsession->opae_session = opae_session;
+		wsession->adapter_table = adapter;
+	}
+
+	return wsession;
+}
+
+opae_wrapped_metrics_collector *
+opae_allocate_wrapped_metrics_collector(fpga_metrics_collector opae_collector,
+					opae_api_adapter_table *adapter)
+{
+	opae_wrapped_metrics_collector *wcollector =
+		(opae_wrapped_metrics_collector *)malloc(
+			sizeof(opae_wrapped_metrics_collector));
+
+	if (wcollector) {
+		wcollector->magic = OPAE_WRAPPED_METRICS_COLLECTOR_MAGIC;
+		wcollector->opae_collector = opae_collector;
+		wcollector->adapter_table = adapter;
+	}
+
+	return wcollector;
+}
+
+opae_wrapped_threshold_monitor *
+opae_allocate_wrapped_threshold_monitor(fpga_threshold_monitor opae_monitor,
+					opae_api_adapter_table *adapter)
+{
+	opae_wrapped_threshold_monitor *wmonitor =
+		(opae_wrapped_threshold_monitor *)malloc(
+			sizeof(opae_wrapped_threshold_monitor));
+
+	if (wmonitor) {
+		wmonitor->magic = OPAE_WRAPPED_THRESHOLD_MONITOR_MAGIC;
+		wmonitor->opae_monitor = opae_monitor;
+		wmonitor->adapter_table = adapter;
+	}
+
+	return wmonitor;
+}
+
 fpga_result __OPAE_API__ fpgaInitialize(const char *config_file)
 {
 	return opae_plugin_mgr_initialize(config_file) ? FPGA_EXCEPTION
@@ -459,6 +526,140 @@ fpga_result __OPAE_API__ fpgaWriteMMIO512(fpga_handle handle,
 		wrapped_handle->opae_handle, mmio_num, offset, value);
 }
 
+fpga_result __OPAE_API__ fpgaReadMMIO64Vec(fpga_handle handle,
+					   uint32_t mmio_num,
+					   const uint64_t *offsets,
+					   uint64_t *values,
+					   uint32_t count)
+{
+	fpga_result res;
+	uint32_t i;
+	opae_wrapped_handle *wrapped_handle =
+		opae_validate_wrapped_handle(handle);
+
+	ASSERT_NOT_NULL(wrapped_handle);
+	ASSERT_NOT_NULL(offsets);
+	ASSERT_NOT_NULL(values);
+
+	if (wrapped_handle->adapter_table->fpgaReadMMIO64Vec)
+		return wrapped_handle->adapter_table->fpgaReadMMIO64Vec(
+			wrapped_handle->opae_handle, mmio_num,
+			offsets, values, count);
+
+	// Generic fallback for plugins without native batch support.
+	ASSERT_NOT_NULL_RESULT(wrapped_handle->adapter_table->fpgaReadMMIO64,
+			       FPGA_NOT_SUPPORTED);
+
+	for (i = 0 ; i < count ; ++i) {
+		res = wrapped_handle->adapter_table->fpgaReadMMIO64(
+			wrapped_handle->opae_handle, mmio_num,
+			offsets[i], &values[i]);
+		ASSERT_RESULT(res);
+	}
+
+	return FPGA_OK;
+}
+
+fpga_result __OPAE_API__ fpgaWriteMMIO64Vec(fpga_handle handle,
+					    uint32_t mmio_num,
+					    const uint64_t *offsets,
+					    const uint64_t *values,
+					    uint32_t count)
+{
+	fpga_result res;
+	uint32_t i;
+	opae_wrapped_handle *wrapped_handle =
+		opae_validate_wrapped_handle(handle);
+
+	ASSERT_NOT_NULL(wrapped_handle);
+	ASSERT_NOT_NULL(offsets);
+	ASSERT_NOT_NULL(values);
+
+	if (wrapped_handle->adapter_table->fpgaWriteMMIO64Vec)
+		return wrapped_handle->adapter_table->fpgaWriteMMIO64Vec(
+			wrapped_handle->opae_handle, mmio_num,
+			offsets, values, count);
+
+	// Generic fallback for plugins without native batch support.
+	ASSERT_NOT_NULL_RESULT(wrapped_handle->adapter_table->fpgaWriteMMIO64,
+			       FPGA_NOT_SUPPORTED);
+
+	for (i = 0 ; i < count ; ++i) {
+		res = wrapped_handle->adapter_table->fpgaWriteMMIO64(
+			wrapped_handle->opae_handle, mmio_num,
+			offsets[i], values[i]);
+		ASSERT_RESULT(res);
+	}
+
+	return FPGA_OK;
+}
+
+fpga_result __OPAE_API__ fpgaReadMMIO64Range(fpga_handle handle,
+					     uint32_t mmio_num,
+					     uint64_t offset,
+					     uint64_t *values,
+					     uint32_t count)
+{
+	fpga_result res;
+	uint32_t i;
+	opae_wrapped_handle *wrapped_handle =
+		opae_validate_wrapped_handle(handle);
+
+	ASSERT_NOT_NULL(wrapped_handle);
+	ASSERT_NOT_NULL(values);
+
+	if (wrapped_handle->adapter_table->fpgaReadMMIO64Range)
+		return wrapped_handle->adapter_table->fpgaReadMMIO64Range(
+			wrapped_handle->opae_handle, mmio_num,
+			offset, values, count);
+
+	// Generic fallback for plugins without native batch support.
+	ASSERT_NOT_NULL_RESULT(wrapped_handle->adapter_table->fpgaReadMMIO64,
+			       FPGA_NOT_SUPPORTED);
+
+	for (i = 0 ; i < count ; ++i) {
+		res = wrapped_handle->adapter_table->fpgaReadMMIO64(
+			wrapped_handle->opae_handle, mmio_num,
+			offset + i * sizeof(uint64_t), &values[i]);
+		ASSERT_RESULT(res);
+	}
+
+	return FPGA_OK;
+}
+
+fpga_result __OPAE_API__ fpgaWriteMMIO64Range(fpga_handle handle,
+					      uint32_t mmio_num,
+					      uint64_t offset,
+					      const uint64_t *values,
+					      uint32_t count)
+{
+	fpga_result res;
+	uint32_t i;
+	opae_wrapped_handle *wrapped_handle =
+		opae_validate_wrapped_handle(handle);
+
+	ASSERT_NOT_NULL(wrapped_handle);
+	ASSERT_NOT_NULL(values);
+
+	if (wrapped_handle->adapter_table->fpgaWriteMMIO64Range)
+		return wrapped_handle->adapter_table->fpgaWriteMMIO64Range(
+			wrapped_handle->opae_handle, mmio_num,
+			offset, values, count);
+
+	// Generic fallback for plugins without native batch support.
+	ASSERT_NOT_NULL_RESULT(wrapped_handle->adapter_table->fpgaWriteMMIO64,
+			       FPGA_NOT_SUPPORTED);
+
+	for (i = 0 ; i < count ; ++i) {
+		res = wrapped_handle->adapter_table->fpgaWriteMMIO64(
+			wrapped_handle->opae_handle, mmio_num,
+			offset + i * sizeof(uint64_t), values[i]);
+		ASSERT_RESULT(res);
+	}
+
+	return FPGA_OK;
+}
+
 fpga_result __OPAE_API__ fpgaMapMMIO(fpga_handle handle, uint32_t mmio_num,
 			uint64_t **mmio_ptr)
 {
@@ -486,27 +687,87 @@ fpga_result __OPAE_API__ fpgaUnmapMMIO(fpga_handle handle, uint32_t mmio_num)
 		wrapped_handle->opae_handle, mmio_num);
 }
 
+fpga_result __OPAE_API__ fpgaGetMMIOAccessor(fpga_handle handle,
+					     uint32_t mmio_num,
+					     fpga_mmio_accessor *accessor)
+{
+	fpga_result res;
+	opae_wrapped_handle *wrapped_handle =
+		opae_validate_wrapped_handle(handle);
+
+	ASSERT_NOT_NULL(wrapped_handle);
+	ASSERT_NOT_NULL(accessor);
+
+	accessor->base = NULL;
+	accessor->len = 0;
+	accessor->handle = handle;
+	accessor->mmio_num = mmio_num;
+
+	// Without a mapped base, the inline accessors forward every
+	// access to fpgaReadMMIO*() / fpgaWriteMMIO*().
+	if (!wrapped_handle->adapter_table->fpgaGetMMIOAccessor)
+		return FPGA_OK;
+
+	res = wrapped_handle->adapter_table->fpgaGetMMIOAccessor(
+		wrapped_handle->opae_handle, mmio_num, accessor);
+
+	accessor->handle = handle;
+	accessor->mmio_num = mmio_num;
+
+	if (res == FPGA_NOT_SUPPORTED) {
+		accessor->base = NULL;
+		accessor->len = 0;
+		res = FPGA_OK;
+	}
+
+	return res;
+}
+
+// per-adapter enumeration result
+typedef struct _opae_adapter_enum_result {
+	const opae_api_adapter_table *adapter;
+	fpga_result res;
+	uint32_t num_matches;
+	fpga_token *tokens; // unwrapped adapter tokens
+	uint32_t num_tokens;
+} opae_adapter_enum_result;
+
 typedef struct _opae_enumeration_context {
-	// <verbatim from fpgaEnumerate>
 	const fpga_properties *filters;
 	uint32_t num_filters;
-	fpga_token *wrapped_tokens;
-	uint32_t max_wrapped_tokens;
-	uint32_t *num_matches;
-	// </verbatim from fpgaEnumerate>
-
-	fpga_token *adapter_tokens;
-	uint32_t num_wrapped_tokens;
-	uint32_t errors;
+	// token capacity given to each adapter
+	uint32_t max_tokens;
+	// grow the capacity until it holds every match
+	bool grow;
+	opae_adapter_enum_result *results;
 } opae_enumeration_context;
 
-static int opae_enumerate(const opae_api_adapter_table *adapter, void *context)
+// initial per-adapter capacity for fpgaEnumerateAlloc()
+#define OPAE_ENUM_ALLOC_TOKENS 16
+
+static void opae_release_adapter_tokens(opae_adapter_enum_result *r)
 {
-	opae_enumeration_context *ctx = (opae_enumeration_context *)context;
-	fpga_result res;
-	uint32_t num_matches = 0;
 	uint32_t i;
-	uint32_t space_remaining;
+
+	for (i = 0; i < r->num_tokens; ++i) {
+		if (r->adapter->fpgaDestroyToken)
+			r->adapter->fpgaDestroyToken(&r->tokens[i]);
+	}
+
+	free(r->tokens);
+	r->tokens = NULL;
+	r->num_tokens = 0;
+}
+
+static void opae_enumerate(const opae_api_adapter_table *adapter,
+			   uint32_t index, void *context)
+{
+	opae_enumeration_context *ctx = (opae_enumeration_context *)context;
+	opae_adapter_enum_result *r = &ctx->results[index];
+	uint32_t capacity = ctx->grow ? OPAE_ENUM_ALLOC_TOKENS : ctx->max_tokens;
+
+	r->adapter = adapter;
+	r->res = FPGA_OK;
 
 	// TODO: accept/reject this adapter, based on device support
 	if (adapter->supports_device) {
@@ -516,66 +777,57 @@ static int opae_enumerate(const opae_api_adapter_table *adapter, void *context)
 	if (adapter->supports_host) {
 	}
 
-	space_remaining = ctx->max_wrapped_tokens - ctx->num_wrapped_tokens;
-
-	if (ctx->wrapped_tokens && !space_remaining)
-		return OPAE_ENUM_STOP;
-
 	if (!adapter->fpgaEnumerate) {
 		OPAE_MSG("NULL fpgaEnumerate in adapter \"%s\"",
 			 adapter->plugin.path);
-		return OPAE_ENUM_CONTINUE;
+		return;
 	}
 
-	res = adapter->fpgaEnumerate(ctx->filters, ctx->num_filters,
-				     ctx->adapter_tokens, space_remaining,
-				     &num_matches);
-
-	if (res != FPGA_OK) {
-		OPAE_ERR("fpgaEnumerate() failed for \"%s\"",
-			 adapter->plugin.path);
-		++ctx->errors;
-		return OPAE_ENUM_CONTINUE;
-	}
-
-	*ctx->num_matches += num_matches;
+	while (1) {
+		if (capacity) {
+			r->tokens = (fpga_token *)calloc(capacity,
+							 sizeof(fpga_token));
+			if (!r->tokens) {
+				OPAE_ERR("out of memory");
+				r->res = FPGA_NO_MEMORY;
+				return;
+			}
+		}
 
-	if (!ctx->adapter_tokens) {
-		// requesting token count, only.
-		return OPAE_ENUM_CONTINUE;
-	}
+		r->res = adapter->fpgaEnumerate(ctx->filters, ctx->num_filters,
+						r->tokens, capacity,
+						&r->num_matches);
+		if (r->res != FPGA_OK) {
+			OPAE_ERR("fpgaEnumerate() failed for \"%s\"",
+				 adapter->plugin.path);
+			free(r->tokens);
+			r->tokens = NULL;
+			return;
+		}
 
-	if (space_remaining > num_matches)
-		space_remaining = num_matches;
+		r->num_tokens = r->num_matches < capacity ?
+			r->num_matches : capacity;
 
-	for (i = 0; i < space_remaining; ++i) {
-		opae_wrapped_token *wt = opae_allocate_wrapped_token(
-			ctx->adapter_tokens[i], adapter);
-		if (!wt) {
-			++ctx->errors;
-			return OPAE_ENUM_STOP;
-		}
+		if (!ctx->grow || r->num_matches <= capacity)
+			return;
 
-		if (ctx->wrapped_tokens) {
-			ctx->wrapped_tokens[ctx->num_wrapped_tokens++] = wt;
-		} else {
-			opae_destroy_wrapped_token(wt);
-		}
+		// More matches than we had room for: retry with exact size.
+		capacity = r->num_matches;
+		opae_release_adapter_tokens(r);
 	}
-
-	return ctx->num_wrapped_tokens == ctx->max_wrapped_tokens
-		       ? OPAE_ENUM_STOP
-		       : OPAE_ENUM_CONTINUE;
 }
 
-fpga_result __OPAE_API__ fpgaEnumerate(const fpga_properties *filters,
-	uint32_t num_filters, fpga_token *tokens, uint32_t max_tokens,
-	uint32_t *num_matches)
+STATIC fpga_result opae_enumerate_all(const fpga_properties *filters,
+				      uint32_t num_filters,
+				      fpga_token *tokens, uint32_t max_tokens,
+				      fpga_token **alloc_tokens,
+				      uint32_t *num_matches)
 {
 	fpga_result res = FPGA_EXCEPTION;
-	fpga_token *adapter_tokens = NULL;
-
 	opae_enumeration_context enum_context;
+	uint32_t num_adapters;
+	uint32_t num_wrapped = 0;
+	uint32_t errors = 0;
 
 	typedef struct _parent_token_fixup {
 		struct _parent_token_fixup *next;
@@ -585,45 +837,26 @@ fpga_result __OPAE_API__ fpgaEnumerate(const fpga_properties *filters,
 
 	parent_token_fixup *ptf_list = NULL;
 	uint32_t i;
-
-	ASSERT_NOT_NULL(num_matches);
-
-	if ((max_tokens > 0) && !tokens) {
-		OPAE_ERR("max_tokens > 0 with NULL tokens");
-		return FPGA_INVALID_PARAM;
-	}
-
-	if ((num_filters > 0) && !filters) {
-		OPAE_ERR("num_filters > 0 with NULL filters");
-		return FPGA_INVALID_PARAM;
-	}
-
-	if ((num_filters == 0) && (filters != NULL)) {
-		OPAE_ERR("num_filters == 0 with non-NULL filters");
-		return FPGA_INVALID_PARAM;
-	}
+	uint32_t j;
 
 	*num_matches = 0;
 
 	enum_context.filters = filters;
 	enum_context.num_filters = num_filters;
-	enum_context.wrapped_tokens = tokens;
-	enum_context.max_wrapped_tokens = max_tokens;
-	enum_context.num_matches = num_matches;
-
-	if (tokens) {
-		adapter_tokens =
-			(fpga_token *)calloc(max_tokens, sizeof(fpga_token));
-		if (!adapter_tokens) {
+	enum_context.max_tokens = max_tokens;
+	enum_context.grow = (alloc_tokens != NULL);
+	enum_context.results = NULL;
+
+	num_adapters = opae_plugin_mgr_adapter_count();
+	if (num_adapters) {
+		enum_context.results = (opae_adapter_enum_result *)calloc(
+			num_adapters, sizeof(opae_adapter_enum_result));
+		if (!enum_context.results) {
 			OPAE_ERR("out of memory");
 			return FPGA_NO_MEMORY;
 		}
 	}
 
-	enum_context.adapter_tokens = adapter_tokens;
-	enum_context.num_wrapped_tokens = 0;
-	enum_context.errors = 0;
-
 	// If any of the input filters has a parent token set,
 	// then it will be wrapped. We need to unwrap it here,
 	// then re-wrap below.
@@ -635,7 +868,7 @@ fpga_result __OPAE_API__ fpgaEnumerate(const fpga_properties *filters,
 		if (!p) {
 			OPAE_ERR("Invalid input filter");
 			res = FPGA_INVALID_PARAM;
-			goto out_free_tokens;
+			goto out_free_results;
 		}
 
 		if (FIELD_VALID(p, FPGA_PROPERTY_PARENT)) {
@@ -647,7 +880,7 @@ fpga_result __OPAE_API__ fpgaEnumerate(const fpga_properties *filters,
 				OPAE_ERR("Invalid wrapped parent in filter");
 				res = FPGA_INVALID_PARAM;
 				opae_mutex_unlock(err, &p->lock);
-				goto out_free_tokens;
+				goto out_free_results;
 			}
 
 			fixup = (parent_token_fixup *)malloc(
@@ -657,7 +890,7 @@ fpga_result __OPAE_API__ fpgaEnumerate(const fpga_properties *filters,
 				OPAE_ERR("malloc failed");
 				res = FPGA_NO_MEMORY;
 				opae_mutex_unlock(err, &p->lock);
-				goto out_free_tokens;
+				goto out_free_results;
 			}
 
 			fixup->next = NULL;
@@ -678,14 +911,68 @@ fpga_result __OPAE_API__ fpgaEnumerate(const fpga_properties *filters,
 		opae_mutex_unlock(err, &p->lock);
 	}
 
-	// perform the enumeration.
-	opae_plugin_mgr_for_each_adapter(opae_enumerate, &enum_context);
+	// perform the enumeration, one job per adapter.
+	num_adapters = opae_plugin_mgr_for_each_adapter_parallel(
+		opae_enumerate, &enum_context, num_adapters);
+
+	// Merge in adapter list order, so that the token order
+	// doesn't depend on which adapter finished first.
+	for (i = 0; i < num_adapters; ++i) {
+		opae_adapter_enum_result *r = &enum_context.results[i];
+
+		if (r->res != FPGA_OK)
+			++errors;
+		else
+			*num_matches += r->num_matches;
+
+		if (alloc_tokens)
+			max_tokens += r->num_tokens;
+	}
+
+	if (alloc_tokens && max_tokens) {
+		tokens = (fpga_token *)calloc(max_tokens, sizeof(fpga_token));
+		if (!tokens) {
+			OPAE_ERR("out of memory");
+			++errors;
+			max_tokens = 0;
+		}
+	}
+
+	for (i = 0; i < num_adapters; ++i) {
+		opae_adapter_enum_result *r = &enum_context.results[i];
+
+		for (j = 0; j < r->num_tokens && num_wrapped < max_tokens;
+		     ++j) {
+			opae_wrapped_token *wt = opae_allocate_wrapped_token(
+				r->tokens[j], r->adapter);
+			if (!wt) {
+				++errors;
+				break;
+			}
+
+			tokens[num_wrapped++] = wt;
+			r->tokens[j] = NULL;
+		}
+
+		// Release whatever didn't fit.
+		for (; j < r->num_tokens; ++j) {
+			if (r->tokens[j] && r->adapter->fpgaDestroyToken)
+				r->adapter->fpgaDestroyToken(&r->tokens[j]);
+		}
+
+		free(r->tokens);
+	}
+
+	if (alloc_tokens) {
+		*alloc_tokens = tokens;
+		*num_matches = num_wrapped;
+	}
 
-	res = (enum_context.errors > 0) ? FPGA_EXCEPTION : FPGA_OK;
+	res = (errors > 0) ? FPGA_EXCEPTION : FPGA_OK;
 
-out_free_tokens:
-	if (adapter_tokens)
-		free(adapter_tokens);
+out_free_results:
+	if (enum_context.results)
+		free(enum_context.results);
 
 	// Re-establish any wrapped parent tokens.
 	while (ptf_list) {
@@ -706,6 +993,53 @@ out_free_tokens:
 	return res;
 }
 
+fpga_result __OPAE_API__ fpgaEnumerate(const fpga_properties *filters,
+	uint32_t num_filters, fpga_token *tokens, uint32_t max_tokens,
+	uint32_t *num_matches)
+{
+	ASSERT_NOT_NULL(num_matches);
+
+	if ((max_tokens > 0) && !tokens) {
+		OPAE_ERR("max_tokens > 0 with NULL tokens");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if ((num_filters > 0) && !filters) {
+		OPAE_ERR("num_filters > 0 with NULL filters");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if ((num_filters == 0) && (filters != NULL)) {
+		OPAE_ERR("num_filters == 0 with non-NULL filters");
+		return FPGA_INVALID_PARAM;
+	}
+
+	return opae_enumerate_all(filters, num_filters, tokens, max_tokens,
+				  NULL, num_matches);
+}
+
+fpga_result __OPAE_API__ fpgaEnumerateAlloc(const fpga_properties *filters,
+	uint32_t num_filters, fpga_token **tokens, uint32_t *num_tokens)
+{
+	ASSERT_NOT_NULL(tokens);
+	ASSERT_NOT_NULL(num_tokens);
+
+	if ((num_filters > 0) && !filters) {
+		OPAE_ERR("num_filters > 0 with NULL filters");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if ((num_filters == 0) && (filters != NULL)) {
+		OPAE_ERR("num_filters == 0 with non-NULL filters");
+		return FPGA_INVALID_PARAM;
+	}
+
+	*tokens = NULL;
+
+	return opae_enumerate_all(filters, num_filters, NULL, 0,
+				  tokens, num_tokens);
+}
+
 fpga_result __OPAE_API__ fpgaCloneToken(fpga_token src, fpga_token *dst)
 {
 	fpga_result res;
@@ -764,6 +1098,31 @@ fpga_result __OPAE_API__ fpgaDestroyToken(fpga_token *token)
 	return res;
 }
 
+fpga_result __OPAE_API__ fpgaDestroyTokens(fpga_token **tokens,
+					   uint32_t num_tokens)
+{
+	fpga_result res = FPGA_OK;
+	uint32_t i;
+
+	ASSERT_NOT_NULL(tokens);
+
+	if (!*tokens)
+		return FPGA_OK;
+
+	for (i = 0; i < num_tokens; ++i) {
+		if ((*tokens)[i]) {
+			fpga_result r = fpgaDestroyToken(&(*tokens)[i]);
+			if (r != FPGA_OK)
+				res = r;
+		}
+	}
+
+	free(*tokens);
+	*tokens = NULL;
+
+	return res;
+}
+
 fpga_result __OPAE_API__ fpgaGetNumUmsg(fpga_handle handle, uint64_t *value)
 {
 	UNUSED_PARAM(handle);
@@ -844,6 +1203,50 @@ fpga_result __OPAE_API__ fpgaGetIOAddress(fpga_handle handle, uint64_t wsid,
 		wrapped_handle->opae_handle, wsid, ioaddr);
 }
 
+fpga_result __OPAE_API__ fpgaBufferPoolConfigure(fpga_handle handle,
+						 uint64_t max_idle_bytes)
+{
+	opae_wrapped_handle *wrapped_handle =
+		opae_validate_wrapped_handle(handle);
+
+	ASSERT_NOT_NULL(wrapped_handle);
+	ASSERT_NOT_NULL_RESULT(
+		wrapped_handle->adapter_table->fpgaBufferPoolConfigure,
+		FPGA_NOT_SUPPORTED);
+
+	return wrapped_handle->adapter_table->fpgaBufferPoolConfigure(
+		wrapped_handle->opae_handle, max_idle_bytes);
+}
+
+fpga_result __OPAE_API__ fpgaBufferPoolTrim(fpga_handle handle)
+{
+	opae_wrapped_handle *wrapped_handle =
+		opae_validate_wrapped_handle(handle);
+
+	ASSERT_NOT_NULL(wrapped_handle);
+	ASSERT_NOT_NULL_RESULT(wrapped_handle->adapter_table->fpgaBufferPoolTrim,
+			       FPGA_NOT_SUPPORTED);
+
+	return wrapped_handle->adapter_table->fpgaBufferPoolTrim(
+		wrapped_handle->opae_handle);
+}
+
+fpga_result __OPAE_API__ fpgaBufferPoolGetStats(fpga_handle handle,
+						fpga_buffer_pool_stats *stats)
+{
+	opae_wrapped_handle *wrapped_handle =
+		opae_validate_wrapped_handle(handle);
+
+	ASSERT_NOT_NULL(wrapped_handle);
+	ASSERT_NOT_NULL(stats);
+	ASSERT_NOT_NULL_RESULT(
+		wrapped_handle->adapter_table->fpgaBufferPoolGetStats,
+		FPGA_NOT_SUPPORTED);
+
+	return wrapped_handle->adapter_table->fpgaBufferPoolGetStats(
+		wrapped_handle->opae_handle, stats);
+}
+
 fpga_result __OPAE_API__ fpgaGetOPAECVersion(fpga_version *version)
 {
 	ASSERT_NOT_NULL(version);
@@ -1488,6 +1891,112 @@ fpga_result __OPAE_API__ fpgaObjectWrite64(fpga_object obj, uint64_t value,
 		wrapped_object->opae_object, value, flags);
 }
 
+fpga_result __OPAE_API__ fpgaObjectCreateReadPlan(fpga_object obj,
+						  fpga_read_plan *plan)
+{
+	fpga_result res;
+	fpga_result dres = FPGA_OK;
+	fpga_read_plan opae_plan = NULL;
+	opae_wrapped_read_plan *wrapped_plan;
+	opae_wrapped_object *wrapped_object = opae_validate_wrapped_object(obj);
+
+	ASSERT_NOT_NULL(wrapped_object);
+	ASSERT_NOT_NULL(plan);
+	ASSERT_NOT_NULL_RESULT(
+		wrapped_object->adapter_table->fpgaObjectCreateReadPlan,
+		FPGA_NOT_SUPPORTED);
+	ASSERT_NOT_NULL_RESULT(wrapped_object->adapter_table->fpgaDestroyReadPlan,
+			       FPGA_NOT_SUPPORTED);
+
+	res = wrapped_object->adapter_table->fpgaObjectCreateReadPlan(
+		wrapped_object->opae_object, &opae_plan);
+
+	ASSERT_RESULT(res);
+
+	wrapped_plan = opae_allocate_wrapped_read_plan(
+		opae_plan, wrapped_object->adapter_table);
+
+	if (!wrapped_plan) {
+		OPAE_ERR("malloc failed");
+		res = FPGA_NO_MEMORY;
+		dres = wrapped_object->adapter_table->fpgaDestroyReadPlan(
+			&opae_plan);
+	}
+
+	*plan = wrapped_plan;
+
+	return res != FPGA_OK ? res : dres;
+}
+
+fpga_result __OPAE_API__ fpgaReadPlanGetCount(fpga_read_plan plan,
+					      uint32_t *count)
+{
+	opae_wrapped_read_plan *wrapped_plan =
+		opae_validate_wrapped_read_plan(plan);
+
+	ASSERT_NOT_NULL(wrapped_plan);
+	ASSERT_NOT_NULL(count);
+	ASSERT_NOT_NULL_RESULT(wrapped_plan->adapter_table->fpgaReadPlanGetCount,
+			       FPGA_NOT_SUPPORTED);
+
+	return wrapped_plan->adapter_table->fpgaReadPlanGetCount(
+		wrapped_plan->opae_plan, count);
+}
+
+fpga_result __OPAE_API__ fpgaReadPlanGetName(fpga_read_plan plan,
+					     uint32_t index, char *name,
+					     size_t max_len)
+{
+	opae_wrapped_read_plan *wrapped_plan =
+		opae_validate_wrapped_read_plan(plan);
+
+	ASSERT_NOT_NULL(wrapped_plan);
+	ASSERT_NOT_NULL(name);
+	ASSERT_NOT_NULL_RESULT(wrapped_plan->adapter_table->fpgaReadPlanGetName,
+			       FPGA_NOT_SUPPORTED);
+
+	return wrapped_plan->adapter_table->fpgaReadPlanGetName(
+		wrapped_plan->opae_plan, index, name, max_len);
+}
+
+fpga_result __OPAE_API__ fpgaReadPlanRead(fpga_read_plan plan,
+					  uint64_t *values, uint32_t count,
+					  uint64_t *timestamp_ns)
+{
+	opae_wrapped_read_plan *wrapped_plan =
+		opae_validate_wrapped_read_plan(plan);
+
+	ASSERT_NOT_NULL(wrapped_plan);
+	ASSERT_NOT_NULL(values);
+	ASSERT_NOT_NULL_RESULT(wrapped_plan->adapter_table->fpgaReadPlanRead,
+			       FPGA_NOT_SUPPORTED);
+
+	return wrapped_plan->adapter_table->fpgaReadPlanRead(
+		wrapped_plan->opae_plan, values, count, timestamp_ns);
+}
+
+fpga_result __OPAE_API__ fpgaDestroyReadPlan(fpga_read_plan *plan)
+{
+	fpga_result res;
+	opae_wrapped_read_plan *wrapped_plan;
+
+	ASSERT_NOT_NULL(plan);
+
+	wrapped_plan = opae_validate_wrapped_read_plan(*plan);
+
+	ASSERT_NOT_NULL(wrapped_plan);
+	ASSERT_NOT_NULL_RESULT(wrapped_plan->adapter_table->fpgaDestroyReadPlan,
+			       FPGA_NOT_SUPPORTED);
+
+	res = wrapped_plan->adapter_table->fpgaDestroyReadPlan(
+		&wrapped_plan->opae_plan);
+
+	opae_destroy_wrapped_read_plan(wrapped_plan);
+	*plan = NULL;
+
+	return res;
+}
+
 fpga_result __OPAE_API__ fpgaSetUserClock(fpga_handle handle,
 	uint64_t high_clk, uint64_t low_clk, int flags)
 {
@@ -1605,3 +2114,331 @@ fpga_result __OPAE_API__ fpgaGetMetricsThresholdInfo(fpga_handle handle,
 	return wrapped_handle->adapter_table->fpgaGetMetricsThresholdInfo(
 		wrapped_handle->opae_handle, metric_thresholds, num_thresholds);
 }
+
+fpga_result __OPAE_API__ fpgaCreateMetricsSession(fpga_handle handle,
+	const uint64_t *metric_num,
+	uint64_t num_metric_indexes,
+	fpga_metrics_session *session)
+{
+	fpga_result res;
+	fpga_result dres = FPGA_OK;
+	fpga_metrics_session opae_session = NULL;
+	opae_wrapped_metrics_session *wrapped_session;
+	opae_wrapped_handle *wrapped_handle =
+		opae_validate_wrapped_handle(handle);
+
+	ASSERT_NOT_NULL(wrapped_handle);
+	ASSERT_NOT_NULL(metric_num);
+	ASSERT_NOT_NULL(session);
+
+	ASSERT_NOT_NULL_RESULT(wrapped_handle->adapter_table->fpgaCreateMetricsSession,
+		FPGA_NOT_SUPPORTED);
+	ASSERT_NOT_NULL_RESULT(wrapped_handle->adapter_table->fpgaDestroyMetricsSession,
+		FPGA_NOT_SUPPORTED);
+
+	res = wrapped_handle->adapter_table->fpgaCreateMetricsSession(
+		wrapped_handle->opae_handle, metric_num, num_metric_indexes,
+		&opae_session);
+
+	ASSERT_RESULT(res);
+
+	wrapped_session = opae_allocate_wrapped_metrics_session(
+		opae_session, wrapped_handle->adapter_table);
+
+	if (!wrapped_session) {
+		OPAE_ERR("malloc failed");
+		res = FPGA_NO_MEMORY;
+		dres = wrapped_handle->adapter_table->fpgaDestroyMetricsSession(
+			&opae_session);
+	}
+
+	*session = wrapped_session;
+
+	return res != FPGA_OK ? res : dres;
+}
+
+fpga_result __OPAE_API__ fpgaSampleMetricsSession(fpga_metrics_session session,
+	fpga_metric *metrics)
+{
+	opae_wrapped_metrics_session *wrapped_session =
+		opae_validate_wrapped_metrics_session(session);
+
+	ASSERT_NOT_NULL(wrapped_session);
+	ASSERT_NOT_NULL(metrics);
+
+	ASSERT_NOT_NULL_RESULT(wrapped_session->adapter_table->fpgaSampleMetricsSession,
+		FPGA_NOT_SUPPORTED);
+
+	return wrapped_session->adapter_table->fpgaSampleMetricsSession(
+		wrapped_session->opae_session, metrics);
+}
+
+fpga_result __OPAE_API__ fpgaDestroyMetricsSession(fpga_metrics_session *session)
+{
+	fpga_result res;
+	opae_wrapped_metrics_session *wrapped_session;
+
+	ASSERT_NOT_NULL(session);
+
+	wrapped_session = opae_validate_wrapped_metrics_session(*session);
+
+	ASSERT_NOT_NULL(wrapped_session);
+	ASSERT_NOT_NULL_RESULT(wrapped_session->adapter_table->fpgaDestroyMetricsSession,
+		FPGA_NOT_SUPPORTED);
+
+	res = wrapped_session->adapter_table->fpgaDestroyMetricsSession(
+		&wrapped_session->opae_session);
+
+	opae_destroy_wrapped_metrics_session(wrapped_session);
+	*session = NULL;
+
+	return res;
+}
+
+fpga_result __OPAE_API__ fpgaCreateMetricsCollector(fpga_handle handle,
+	const uint64_t *metric_num,
+	uint64_t num_metric_indexes,
+	uint32_t period_usec,
+	uint32_t depth,
+	fpga_metrics_collector *collector)
+{
+	fpga_result res;
+	fpga_result dres = FPGA_OK;
+	fpga_metrics_collector opae_collector = NULL;
+	opae_wrapped_metrics_collector *wrapped_collector;
+	opae_wrapped_handle *wrapped_handle =
+		opae_validate_wrapped_handle(handle);
+
+	ASSERT_NOT_NULL(wrapped_handle);
+	ASSERT_NOT_NULL(metric_num);
+	ASSERT_NOT_NULL(collector);
+
+	ASSERT_NOT_NULL_RESULT(wrapped_handle->adapter_table->fpgaCreateMetricsCollector,
+		FPGA_NOT_SUPPORTED);
+	ASSERT_NOT_NULL_RESULT(wrapped_handle->adapter_table->fpgaDestroyMetricsCollector,
+		FPGA_NOT_SUPPORTED);
+
+	res = wrapped_handle->adapter_table->fpgaCreateMetricsCollector(
+		wrapped_handle->opae_handle, metric_num, num_metric_indexes,
+		period_usec, depth, &opae_collector);
+
+	ASSERT_RESULT(res);
+
+	wrapped_collector = opae_allocate_wrapped_metrics_collector(
+		opae_collector, wrapped_handle->adapter_table);
+
+	if (!wrapped_collector) {
+		OPAE_ERR("malloc failed");
+		res = FPGA_NO_MEMORY;
+		dres = wrapped_handle->adapter_table->fpgaDestroyMetricsCollector(
+			&opae_collector);
+	}
+
+	*collector = wrapped_collector;
+
+	return res != FPGA_OK ? res : dres;
+}
+
+fpga_result __OPAE_API__ fpgaReadLatestMetrics(fpga_metrics_collector collector,
+	fpga_metric *metrics,
+	uint64_t *sequence)
+{
+	opae_wrapped_metrics_collector *wrapped_collector =
+		opae_validate_wrapped_metrics_collector(collector);
+
+	ASSERT_NOT_NULL(wrapped_collector);
+	ASSERT_NOT_NULL(metrics);
+
+	ASSERT_NOT_NULL_RESULT(wrapped_collector->adapter_table->fpgaReadLatestMetrics,
+		FPGA_NOT_SUPPORTED);
+
+	return wrapped_collector->adapter_table->fpgaReadLatestMetrics(
+		wrapped_collector->opae_collector, metrics, sequence);
+}
+
+fpga_result __OPAE_API__ fpgaReadMetricsHistory(fpga_metrics_collector collector,
+	uint64_t *cursor,
+	fpga_metric *metrics,
+	uint64_t max_samples,
+	uint64_t *num_samples)
+{
+	opae_wrapped_metrics_collector *wrapped_collector =
+		opae_validate_wrapped_metrics_collector(collector);
+
+	ASSERT_NOT_NULL(wrapped_collector);
+	ASSERT_NOT_NULL(cursor);
+	ASSERT_NOT_NULL(metrics);
+	ASSERT_NOT_NULL(num_samples);
+
+	ASSERT_NOT_NULL_RESULT(wrapped_collector->adapter_table->fpgaReadMetricsHistory,
+		FPGA_NOT_SUPPORTED);
+
+	return wrapped_collector->adapter_table->fpgaReadMetricsHistory(
+		wrapped_collector->opae_collector, cursor, metrics,
+		max_samples, num_samples);
+}
+
+fpga_result __OPAE_API__ fpgaDestroyMetricsCollector(fpga_metrics_collector *collector)
+{
+	fpga_result res;
+	opae_wrapped_metrics_collector *wrapped_collector;
+
+	ASSERT_NOT_NULL(collector);
+
+	wrapped_collector = opae_validate_wrapped_metrics_collector(*collector);
+
+	ASSERT_NOT_NULL(wrapped_collector);
+	ASSERT_NOT_NULL_RESULT(wrapped_collector->adapter_table->fpgaDestroyMetricsCollector,
+		FPGA_NOT_SUPPORTED);
+
+	res = wrapped_collector->adapter_table->fpgaDestroyMetricsCollector(
+		&wrapped_collector->opae_collector);
+
+	opae_destroy_wrapped_metrics_collector(wrapped_collector);
+	*collector = NULL;
+
+	return res;
+}
+
+fpga_result __OPAE_API__ fpgaCreateThresholdMonitor(fpga_handle handle,
+	const uint64_t *metric_num,
+	uint64_t num_metric_indexes,
+	fpga_threshold_callback callback,
+	void *context,
+	fpga_event_handle event_handle,
+	fpga_threshold_monitor *monitor)
+{
+	fpga_result res;
+	fpga_result dres = FPGA_OK;
+	fpga_event_handle opae_event_handle = NULL;
+	fpga_threshold_monitor opae_monitor = NULL;
+	opae_wrapped_threshold_monitor *wrapped_monitor;
+	opae_wrapped_event_handle *wrapped_event_handle;
+	opae_wrapped_handle *wrapped_handle =
+		opae_validate_wrapped_handle(handle);
+	int ires;
+
+	ASSERT_NOT_NULL(wrapped_handle);
+	ASSERT_NOT_NULL(metric_num);
+	ASSERT_NOT_NULL(monitor);
+
+	if (event_handle) {
+		wrapped_event_handle =
+			opae_validate_wrapped_event_handle(event_handle);
+		ASSERT_NOT_NULL(wrapped_event_handle);
+
+		opae_mutex_lock(ires, &wrapped_event_handle->lock);
+
+		// The event handle may not have been registered yet; create
+		// it in the handle's plugin, as fpgaRegisterEvent() would.
+		if (!(wrapped_event_handle->flags
+		      & OPAE_WRAPPED_EVENT_HANDLE_CREATED)) {
+			if (!wrapped_handle->adapter_table->fpgaCreateEventHandle) {
+				OPAE_ERR("NULL fpgaCreateEventHandle() in adapter.");
+				opae_mutex_unlock(ires, &wrapped_event_handle->lock);
+				return FPGA_NOT_SUPPORTED;
+			}
+
+			res = wrapped_handle->adapter_table->fpgaCreateEventHandle(
+				&wrapped_event_handle->opae_event_handle);
+			if (res != FPGA_OK) {
+				opae_mutex_unlock(ires, &wrapped_event_handle->lock);
+				return res;
+			}
+
+			wrapped_event_handle->adapter_table =
+				wrapped_handle->adapter_table;
+			wrapped_event_handle->flags |=
+				OPAE_WRAPPED_EVENT_HANDLE_CREATED;
+		} else if (wrapped_event_handle->adapter_table !=
+			   wrapped_handle->adapter_table) {
+			OPAE_ERR("event handle belongs to another plugin.");
+			opae_mutex_unlock(ires, &wrapped_event_handle->lock);
+			return FPGA_INVALID_PARAM;
+		}
+
+		opae_event_handle = wrapped_event_handle->opae_event_handle;
+
+		opae_mutex_unlock(ires, &wrapped_event_handle->lock);
+	}
+
+	ASSERT_NOT_NULL_RESULT(wrapped_handle->adapter_table->fpgaCreateThresholdMonitor,
+		FPGA_NOT_SUPPORTED);
+	ASSERT_NOT_NULL_RESULT(wrapped_handle->adapter_table->fpgaDestroyThresholdMonitor,
+		FPGA_NOT_SUPPORTED);
+
+	res = wrapped_handle->adapter_table->fpgaCreateThresholdMonitor(
+		wrapped_handle->opae_handle, metric_num, num_metric_indexes,
+		callback, context, opae_event_handle, &opae_monitor);
+
+	ASSERT_RESULT(res);
+
+	wrapped_monitor = opae_allocate_wrapped_threshold_monitor(
+		opae_monitor, wrapped_handle->adapter_table);
+
+	if (!wrapped_monitor) {
+		OPAE_ERR("malloc failed");
+		res = FPGA_NO_MEMORY;
+		dres = wrapped_handle->adapter_table->fpgaDestroyThresholdMonitor(
+			&opae_monitor);
+	}
+
+	*monitor = wrapped_monitor;
+
+	return res != FPGA_OK ? res : dres;
+}
+
+fpga_result __OPAE_API__ fpgaEvaluateThresholds(fpga_threshold_monitor monitor,
+	const fpga_metric *metrics,
+	uint64_t *num_transitions)
+{
+	opae_wrapped_threshold_monitor *wrapped_monitor =
+		opae_validate_wrapped_threshold_monitor(monitor);
+
+	ASSERT_NOT_NULL(wrapped_monitor);
+	ASSERT_NOT_NULL(metrics);
+
+	ASSERT_NOT_NULL_RESULT(wrapped_monitor->adapter_table->fpgaEvaluateThresholds,
+		FPGA_NOT_SUPPORTED);
+
+	return wrapped_monitor->adapter_table->fpgaEvaluateThresholds(
+		wrapped_monitor->opae_monitor, metrics, num_transitions);
+}
+
+fpga_result __OPAE_API__ fpgaGetThresholdStates(fpga_threshold_monitor monitor,
+	uint32_t *states)
+{
+	opae_wrapped_threshold_monitor *wrapped_monitor =
+		opae_validate_wrapped_threshold_monitor(monitor);
+
+	ASSERT_NOT_NULL(wrapped_monitor);
+	ASSERT_NOT_NULL(states);
+
+	ASSERT_NOT_NULL_RESULT(wrapped_monitor->adapter_table->fpgaGetThresholdStates,
+		FPGA_NOT_SUPPORTED);
+
+	return wrapped_monitor->adapter_table->fpgaGetThresholdStates(
+		wrapped_monitor->opae_monitor, states);
+}
+
+fpga_result __OPAE_API__ fpgaDestroyThresholdMonitor(fpga_threshold_monitor *monitor)
+{
+	fpga_result res;
+	opae_wrapped_threshold_monitor *wrapped_monitor;
+
+	ASSERT_NOT_NULL(monitor);
+
+	wrapped_monitor = opae_validate_wrapped_threshold_monitor(*monitor);
+
+	ASSERT_NOT_NULL(wrapped_monitor);
+	ASSERT_NOT_NULL_RESULT(wrapped_monitor->adapter_table->fpgaDestroyThresholdMonitor,
+		FPGA_NOT_SUPPORTED);
+
+	res = wrapped_monitor->adapter_table->fpgaDestroyThresholdMonitor(
+		&wrapped_monitor->opae_monitor);
+
+	opae_destroy_wrapped_threshold_monitor(wrapped_monitor);
+	*monitor = NULL;
+
+	return res;
+}
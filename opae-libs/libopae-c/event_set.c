@@ -0,0 +1,409 @@
+// Copyright(c) 2020, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif // HAVE_CONFIG_H
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+#include <stdbool.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/epoll.h>
+
+#include <opae/event.h>
+
+#include "opae_int.h"
+
+//                         t s v e
+#define OPAE_EVENT_SET_MAGIC 0x74737665
+
+#define OPAE_EVENT_SET_MIN_ENTRIES 16
+#define OPAE_EVENT_SET_NO_ENTRY    UINT32_MAX
+
+/*
+ * Each event source occupies one slot of the entries table. The epoll data
+ * carries the slot index together with the slot's generation, so that an
+ * event already dequeued by a waiter for a source that has since been
+ * removed (and whose slot may have been reused) is recognized and dropped.
+ */
+typedef struct _opae_event_set_entry {
+	fpga_handle handle;
+	fpga_event_handle event_handle;
+	fpga_event_type event_type;
+	void *context;
+	int fd;
+	uint32_t generation;
+	uint32_t next_free;
+	bool in_use;
+} opae_event_set_entry;
+
+typedef struct _opae_event_set {
+	uint32_t magic;
+	int epfd;
+	pthread_mutex_t lock;      // guards the entries table
+	pthread_mutex_t wait_lock; // serializes fpgaEventSetWait()
+	opae_event_set_entry *entries;
+	uint32_t num_entries;
+	uint32_t first_free;
+	struct epoll_event *ready; // guarded by wait_lock
+	uint32_t num_ready;
+} opae_event_set;
+
+static inline opae_event_set *opae_validate_event_set(fpga_event_set s)
+{
+	opae_event_set *es;
+	if (!s)
+		return NULL;
+	es = (opae_event_set *)s;
+	return (es->magic == OPAE_EVENT_SET_MAGIC) ? es : NULL;
+}
+
+static inline uint64_t opae_event_set_key(opae_event_set *es, uint32_t index)
+{
+	return ((uint64_t)es->entries[index].generation << 32) | index;
+}
+
+// Called with es->lock held.
+static fpga_result opae_event_set_grow(opae_event_set *es)
+{
+	opae_event_set_entry *entries;
+	uint32_t num_entries;
+	uint32_t i;
+
+	num_entries = es->num_entries ?
+		es->num_entries * 2 : OPAE_EVENT_SET_MIN_ENTRIES;
+
+	entries = realloc(es->entries, num_entries * sizeof(*entries));
+	if (!entries) {
+		OPAE_ERR("Failed to grow event set");
+		return FPGA_NO_MEMORY;
+	}
+
+	memset(&entries[es->num_entries], 0,
+	       (num_entries - es->num_entries) * sizeof(*entries));
+
+	for (i = es->num_entries ; i < num_entries ; ++i) {
+		entries[i].fd = -1;
+		entries[i].next_free = (i + 1 < num_entries) ?
+			i + 1 : es->first_free;
+	}
+
+	es->first_free = es->num_entries;
+	es->entries = entries;
+	es->num_entries = num_entries;
+
+	return FPGA_OK;
+}
+
+fpga_result __OPAE_API__ fpgaCreateEventSet(fpga_event_set *set)
+{
+	opae_event_set *es;
+	pthread_mutexattr_t mattr;
+
+	ASSERT_NOT_NULL(set);
+
+	es = (opae_event_set *)calloc(1, sizeof(opae_event_set));
+	if (!es) {
+		OPAE_ERR("Failed to allocate event set");
+		return FPGA_NO_MEMORY;
+	}
+
+	es->epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (es->epfd < 0) {
+		OPAE_ERR("epoll_create1() failed: %s", strerror(errno));
+		free(es);
+		return FPGA_EXCEPTION;
+	}
+
+	if (pthread_mutexattr_init(&mattr)) {
+		OPAE_ERR("pthread_mutexattr_init() failed");
+		goto out_close;
+	}
+
+	if (pthread_mutexattr_settype(&mattr, PTHREAD_MUTEX_RECURSIVE)) {
+		OPAE_ERR("pthread_mutexattr_settype() failed");
+		goto out_destroy_attr;
+	}
+
+	if (pthread_mutex_init(&es->lock, &mattr)) {
+		OPAE_ERR("pthread_mutex_init() failed");
+		goto out_destroy_attr;
+	}
+
+	if (pthread_mutex_init(&es->wait_lock, &mattr)) {
+		OPAE_ERR("pthread_mutex_init() failed");
+		pthread_mutex_destroy(&es->lock);
+		goto out_destroy_attr;
+	}
+
+	pthread_mutexattr_destroy(&mattr);
+
+	es->first_free = OPAE_EVENT_SET_NO_ENTRY;
+	es->magic = OPAE_EVENT_SET_MAGIC;
+
+	*set = es;
+
+	return FPGA_OK;
+
+out_destroy_attr:
+	pthread_mutexattr_destroy(&mattr);
+out_close:
+	close(es->epfd);
+	free(es);
+	return FPGA_EXCEPTION;
+}
+
+fpga_result __OPAE_API__ fpgaEventSetAdd(fpga_event_set set,
+					 fpga_handle handle,
+					 fpga_event_handle event_handle,
+					 fpga_event_type event_type,
+					 void *context)
+{
+	fpga_result res;
+	opae_event_set *es = opae_validate_event_set(set);
+	opae_wrapped_handle *wrapped_handle =
+		opae_validate_wrapped_handle(handle);
+	opae_event_set_entry *entry;
+	struct epoll_event ev;
+	uint32_t index;
+	int fd = -1;
+	int ires;
+
+	ASSERT_NOT_NULL(es);
+	ASSERT_NOT_NULL(wrapped_handle);
+
+	// Fails for event handles that have not been registered.
+	res = fpgaGetOSObjectFromEventHandle(event_handle, &fd);
+	ASSERT_RESULT(res);
+
+	if (opae_mutex_lock(ires, &es->lock))
+		return FPGA_EXCEPTION;
+
+	if (es->first_free == OPAE_EVENT_SET_NO_ENTRY) {
+		res = opae_event_set_grow(es);
+		if (res != FPGA_OK)
+			goto out_unlock;
+	}
+
+	index = es->first_free;
+	entry = &es->entries[index];
+
+	ev.events = EPOLLIN;
+	ev.data.u64 = opae_event_set_key(es, index);
+
+	if (epoll_ctl(es->epfd, EPOLL_CTL_ADD, fd, &ev)) {
+		if (errno == EEXIST) {
+			OPAE_ERR("event handle is already in the event set");
+			res = FPGA_INVALID_PARAM;
+		} else {
+			OPAE_ERR("epoll_ctl() failed: %s", strerror(errno));
+			res = FPGA_EXCEPTION;
+		}
+		goto out_unlock;
+	}
+
+	es->first_free = entry->next_free;
+
+	entry->handle = handle;
+	entry->event_handle = event_handle;
+	entry->event_type = event_type;
+	entry->context = context;
+	entry->fd = fd;
+	entry->next_free = OPAE_EVENT_SET_NO_ENTRY;
+	entry->in_use = true;
+
+out_unlock:
+	opae_mutex_unlock(ires, &es->lock);
+	return res;
+}
+
+fpga_result __OPAE_API__ fpgaEventSetRemove(fpga_event_set set,
+					    fpga_event_handle event_handle)
+{
+	fpga_result res = FPGA_NOT_FOUND;
+	opae_event_set *es = opae_validate_event_set(set);
+	opae_event_set_entry *entry;
+	uint32_t i;
+	int ires;
+
+	ASSERT_NOT_NULL(es);
+	ASSERT_NOT_NULL(event_handle);
+
+	if (opae_mutex_lock(ires, &es->lock))
+		return FPGA_EXCEPTION;
+
+	for (i = 0 ; i < es->num_entries ; ++i) {
+		entry = &es->entries[i];
+
+		if (!entry->in_use || entry->event_handle != event_handle)
+			continue;
+
+		if (epoll_ctl(es->epfd, EPOLL_CTL_DEL, entry->fd, NULL))
+			OPAE_MSG("epoll_ctl() failed: %s", strerror(errno));
+
+		entry->in_use = false;
+		entry->fd = -1;
+		++entry->generation;
+		entry->next_free = es->first_free;
+		es->first_free = i;
+
+		res = FPGA_OK;
+		break;
+	}
+
+	opae_mutex_unlock(ires, &es->lock);
+	return res;
+}
+
+fpga_result __OPAE_API__ fpgaEventSetWait(fpga_event_set set,
+					  fpga_event_set_event *events,
+					  uint32_t max_events, int timeout_ms,
+					  uint32_t *num_events)
+{
+	fpga_result res = FPGA_OK;
+	opae_event_set *es = opae_validate_event_set(set);
+	opae_event_set_entry *entry;
+	struct epoll_event *ready;
+	struct pollfd pfd;
+	uint64_t count;
+	uint32_t index;
+	uint32_t n = 0;
+	int num_ready;
+	int i;
+	int ires;
+
+	ASSERT_NOT_NULL(es);
+	ASSERT_NOT_NULL(events);
+	ASSERT_NOT_NULL(num_events);
+
+	if (!max_events || max_events > INT32_MAX) {
+		OPAE_ERR("invalid max_events: %u", max_events);
+		return FPGA_INVALID_PARAM;
+	}
+
+	*num_events = 0;
+
+	if (opae_mutex_lock(ires, &es->wait_lock))
+		return FPGA_EXCEPTION;
+
+	if (es->num_ready < max_events) {
+		ready = realloc(es->ready, max_events * sizeof(*ready));
+		if (!ready) {
+			OPAE_ERR("Failed to allocate epoll events");
+			res = FPGA_NO_MEMORY;
+			goto out_unlock_wait;
+		}
+		es->ready = ready;
+		es->num_ready = max_events;
+	}
+
+	num_ready = epoll_wait(es->epfd, es->ready, (int)max_events,
+			       timeout_ms);
+	if (num_ready < 0) {
+		if (errno != EINTR) {
+			OPAE_ERR("epoll_wait() failed: %s", strerror(errno));
+			res = FPGA_EXCEPTION;
+		}
+		goto out_unlock_wait;
+	}
+
+	if (!num_ready)
+		goto out_unlock_wait;
+
+	if (opae_mutex_lock(ires, &es->lock)) {
+		res = FPGA_EXCEPTION;
+		goto out_unlock_wait;
+	}
+
+	for (i = 0 ; i < num_ready ; ++i) {
+		index = (uint32_t)es->ready[i].data.u64;
+
+		// Drop events for sources removed after epoll_wait().
+		if (index >= es->num_entries ||
+		    es->ready[i].data.u64 != opae_event_set_key(es, index))
+			continue;
+
+		entry = &es->entries[index];
+		if (!entry->in_use)
+			continue;
+
+		// The application's fd may be blocking, and its count may
+		// have been drained since epoll_wait(), so read only if it is
+		// still readable.
+		pfd.fd = entry->fd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		if (poll(&pfd, 1, 0) != 1 || !(pfd.revents & POLLIN))
+			continue;
+
+		// Consume the pending count so the source is not reported
+		// again until it fires again.
+		if (read(entry->fd, &count, sizeof(count)) != sizeof(count))
+			continue;
+
+		events[n].handle = entry->handle;
+		events[n].event_handle = entry->event_handle;
+		events[n].event_type = entry->event_type;
+		events[n].count = count;
+		events[n].context = entry->context;
+		++n;
+	}
+
+	opae_mutex_unlock(ires, &es->lock);
+
+	*num_events = n;
+
+out_unlock_wait:
+	opae_mutex_unlock(ires, &es->wait_lock);
+	return res;
+}
+
+fpga_result __OPAE_API__ fpgaDestroyEventSet(fpga_event_set *set)
+{
+	opae_event_set *es;
+
+	ASSERT_NOT_NULL(set);
+
+	es = opae_validate_event_set(*set);
+	ASSERT_NOT_NULL(es);
+
+	es->magic = 0;
+
+	close(es->epfd);
+	pthread_mutex_destroy(&es->wait_lock);
+	pthread_mutex_destroy(&es->lock);
+	free(es->ready);
+	free(es->entries);
+	free(es);
+
+	*set = NULL;
+
+	return FPGA_OK;
+}
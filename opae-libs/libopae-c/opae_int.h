@@ -216,4 +216,123 @@ static inline void opae_destroy_wrapped_object(opae_wrapped_object *wo)
 	free(wo);
 }
 
+//                                      n a l p
+#define OPAE_WRAPPED_READ_PLAN_MAGIC 0x6e616c70
+
+typedef struct _opae_wrapped_read_plan {
+	uint32_t magic;
+	fpga_read_plan opae_plan;
+	opae_api_adapter_table *adapter_table;
+} opae_wrapped_read_plan;
+
+opae_wrapped_read_plan *
+opae_allocate_wrapped_read_plan(fpga_read_plan opae_plan,
+				opae_api_adapter_table *adapter);
+
+static inline opae_wrapped_read_plan *
+opae_validate_wrapped_read_plan(fpga_read_plan p)
+{
+	opae_wrapped_read_plan *wp;
+	if (!p)
+		return NULL;
+	wp = (opae_wrapped_read_plan *)p;
+	return (wp->magic == OPAE_WRAPPED_READ_PLAN_MAGIC) ? wp : NULL;
+}
+
+static inline void opae_destroy_wrapped_read_plan(opae_wrapped_read_plan *wp)
+{
+	wp->magic = 0;
+	free(wp);
+}
+
+//                                            s s e m
+#define OPAE_WRAPPED_METRICS_SESSION_MAGIC 0x7373656d
+
+typedef struct _opae_wrapped_metrics_session {
+	uint32_t magic;
+	fpga_metrics_session opae_session;
+	opae_api_adapter_table *adapter_table;
+} opae_wrapped_metrics_session;
+
+opae_wrapped_metrics_session *
+opae_allocate_wrapped_metrics_session(fpga_metrics_session opae_session,
+				      opae_api_adapter_table *adapter);
+
+static inline opae_wrapped_metrics_session *
+opae_validate_wrapped_metrics_session(fpga_metrics_session s)
+{
+	opae_wrapped_metrics_session *ws;
+	if (!s)
+		return NULL;
+	ws = (opae_wrapped_metrics_session *)s;
+	return (ws->magic == OPAE_WRAPPED_METRICS_SESSION_MAGIC) ? ws : NULL;
+}
+
+static inline void
+opae_destroy_wrapped_metrics_session(opae_wrapped_metrics_session *ws)
+{
+	ws->magic = 0;
+	free(ws);
+}
+
+//                                              l l o c
+#define OPAE_WRAPPED_METRICS_COLLECTOR_MAGIC 0x6c6c6f63
+
+typedef struct _opae_wrapped_metrics_collector {
+	uint32_t magic;
+	fpga_metrics_collector opae_collector;
+	opae_api_adapter_table *adapter_table;
+} opae_wrapped_metrics_collector;
+
+opae_wrapped_metrics_collector *
+opae_allocate_wrapped_metrics_collector(fpga_metrics_collector opae_collector,
+					opae_api_adapter_table *adapter);
+
+static inline opae_wrapped_metrics_collector *
+opae_validate_wrapped_metrics_collector(fpga_metrics_collector c)
+{
+	opae_wrapped_metrics_collector *wc;
+	if (!c)
+		return NULL;
+	wc = (opae_wrapped_metrics_collector *)c;
+	return (wc->magic == OPAE_WRAPPED_METRICS_COLLECTOR_MAGIC) ? wc : NULL;
+}
+
+static inline void
+opae_destroy_wrapped_metrics_collector(opae_wrapped_metrics_collector *wc)
+{
+	wc->magic = 0;
+	free(wc);
+}
+
+//                                             n o m t
+#define OPAE_WRAPPED_THRESHOLD_MONITOR_MAGIC 0x6e6f6d74
+
+typedef struct _opae_wrapped_threshold_monitor {
+	uint32_t magic;
+	fpga_threshold_monitor opae_monitor;
+	opae_api_adapter_table *adapter_table;
+} opae_wrapped_threshold_monitor;
+
+opae_wrapped_threshold_monitor *
+opae_allocate_wrapped_threshold_monitor(fpga_threshold_monitor opae_monitor,
+					opae_api_adapter_table *adapter);
+
+static inline opae_wrapped_threshold_monitor *
+opae_validate_wrapped_threshold_monitor(fpga_threshold_monitor m)
+{
+	opae_wrapped_threshold_monitor *wm;
+	if (!m)
+		return NULL;
+	wm = (opae_wrapped_threshold_monitor *)m;
+	return (wm->magic == OPAE_WRAPPED_THRESHOLD_MONITOR_MAGIC) ? wm : NULL;
+}
+
+static inline void
+opae_destroy_wrapped_threshold_monitor(opae_wrapped_threshold_monitor *wm)
+{
+	wm->magic = 0;
+	free(wm);
+}
+
 #endif // ___OPAE_OPAE_INT_H__
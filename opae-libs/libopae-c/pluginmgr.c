@@ -803,3 +803,93 @@ int opae_plugin_mgr_for_each_adapter
 
 	return cb_res;
 }
+
+uint32_t opae_plugin_mgr_adapter_count(void)
+{
+	int res;
+	uint32_t count = 0;
+	opae_api_adapter_table *aptr;
+
+	opae_mutex_lock(res, &adapter_list_lock);
+
+	for (aptr = adapter_list; aptr; aptr = aptr->next)
+		++count;
+
+	opae_mutex_unlock(res, &adapter_list_lock);
+
+	return count;
+}
+
+typedef struct _opae_parallel_context {
+	opae_api_adapter_table *adapters[MAX_PLUGINS];
+	uint32_t num_adapters;
+	uint32_t next;
+	opae_adapter_job job;
+	void *context;
+} opae_parallel_context;
+
+STATIC void *opae_plugin_mgr_worker(void *arg)
+{
+	opae_parallel_context *ctx = (opae_parallel_context *)arg;
+	uint32_t i;
+
+	while ((i = __sync_fetch_and_add(&ctx->next, 1)) < ctx->num_adapters)
+		ctx->job(ctx->adapters[i], i, ctx->context);
+
+	return NULL;
+}
+
+uint32_t opae_plugin_mgr_for_each_adapter_parallel(opae_adapter_job job,
+						   void *context,
+						   uint32_t max_adapters)
+{
+	int res;
+	opae_parallel_context ctx;
+	pthread_t threads[OPAE_PLUGIN_MGR_MAX_THREADS - 1];
+	uint32_t num_threads = 0;
+	uint32_t i;
+	opae_api_adapter_table *aptr;
+
+	if (!job) {
+		OPAE_ERR("NULL job passed to %s()", __func__);
+		return 0;
+	}
+
+	if (max_adapters > MAX_PLUGINS)
+		max_adapters = MAX_PLUGINS;
+
+	ctx.num_adapters = 0;
+	ctx.next = 0;
+	ctx.job = job;
+	ctx.context = context;
+
+	opae_mutex_lock(res, &adapter_list_lock);
+
+	for (aptr = adapter_list;
+	     aptr && ctx.num_adapters < max_adapters;
+	     aptr = aptr->next)
+		ctx.adapters[ctx.num_adapters++] = aptr;
+
+	// The calling thread is one of the workers, so a single
+	// adapter never pays for a thread.
+	for (i = 1; i < ctx.num_adapters &&
+		    i < OPAE_PLUGIN_MGR_MAX_THREADS; ++i) {
+		if (pthread_create(&threads[num_threads], NULL,
+				   opae_plugin_mgr_worker, &ctx)) {
+			OPAE_MSG("pthread_create failed, "
+				 "continuing with %u thread(s)",
+				 num_threads + 1);
+			break;
+		}
+		++num_threads;
+	}
+
+	opae_plugin_mgr_worker(&ctx);
+
+	for (i = 0; i < num_threads; ++i)
+		pthread_join(threads[i], NULL);
+
+	opae_mutex_unlock(res, &adapter_list_lock);
+
+	return ctx.num_adapters;
+}
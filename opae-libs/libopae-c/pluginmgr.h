@@ -41,6 +41,21 @@ int opae_plugin_mgr_finalize_all(void);
 int opae_plugin_mgr_for_each_adapter(
 	int (*callback)(const opae_api_adapter_table *, void *), void *context);
 
+// number of loaded adapters.
+uint32_t opae_plugin_mgr_adapter_count(void);
+
+// Runs job once for each of the first max_adapters adapters, spread over
+// up to OPAE_PLUGIN_MGR_MAX_THREADS threads. index is the position of the
+// adapter in the adapter list, so callers can keep per-adapter results
+// and merge them in a deterministic order. Returns the number of
+// adapters visited.
+#define OPAE_PLUGIN_MGR_MAX_THREADS 4
+typedef void (*opae_adapter_job)(const opae_api_adapter_table *adapter,
+				 uint32_t index, void *context);
+uint32_t opae_plugin_mgr_for_each_adapter_parallel(opae_adapter_job job,
+						   void *context,
+						   uint32_t max_adapters);
+
 #define PLUGIN_SUPPORTED_DEVICES_MAX 256
 #define PLUGIN_NAME_MAX 64
 typedef struct _plugin_cfg {
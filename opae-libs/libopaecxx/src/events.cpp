@@ -69,6 +69,76 @@ int event::os_object() const { return os_object_; }
 event::event(handle::ptr_t h, event::type_t t, fpga_event_handle eh)
     : handle_(h), type_(t), event_handle_(eh), os_object_(-1) {}
 
+event_set::~event_set() {
+  for (auto &kv : events_) {
+    auto res = fpgaEventSetRemove(set_, kv.first);
+    if (res != FPGA_OK) {
+      std::cerr << "Error while calling fpgaEventSetRemove: "
+                << fpgaErrStr(res) << "\n";
+    }
+  }
+
+  auto res = fpgaDestroyEventSet(&set_);
+  if (res != FPGA_OK) {
+    std::cerr << "Error while calling fpgaDestroyEventSet: "
+              << fpgaErrStr(res) << "\n";
+  }
+}
+
+event_set::ptr_t event_set::create() {
+  fpga_event_set set;
+  ASSERT_FPGA_OK(fpgaCreateEventSet(&set));
+  return event_set::ptr_t(new event_set(set));
+}
+
+void event_set::add(event::ptr_t ev) {
+  if (!ev) {
+    throw std::invalid_argument("event object is null");
+  }
+
+  std::lock_guard<std::mutex> guard(lock_);
+  ASSERT_FPGA_OK(fpgaEventSetAdd(set_, *ev->handle_, ev->event_handle_,
+                                 ev->type_, nullptr));
+  events_[ev->event_handle_] = ev;
+}
+
+void event_set::remove(event::ptr_t ev) {
+  if (!ev) {
+    throw std::invalid_argument("event object is null");
+  }
+
+  std::lock_guard<std::mutex> guard(lock_);
+  ASSERT_FPGA_OK(fpgaEventSetRemove(set_, ev->event_handle_));
+  events_.erase(ev->event_handle_);
+}
+
+std::vector<event_set::fired_t> event_set::wait(int timeout_ms,
+                                                uint32_t max_events) {
+  std::vector<fpga_event_set_event> events(max_events);
+  uint32_t num_events = 0;
+  ASSERT_FPGA_OK(fpgaEventSetWait(set_, events.data(), max_events,
+                                  timeout_ms, &num_events));
+
+  std::vector<fired_t> fired;
+  fired.reserve(num_events);
+
+  std::lock_guard<std::mutex> guard(lock_);
+  for (uint32_t i = 0; i < num_events; ++i) {
+    auto it = events_.find(events[i].event_handle);
+    if (it != events_.end()) {
+      fired.push_back({it->second, events[i].count});
+    }
+  }
+  return fired;
+}
+
+size_t event_set::size() const {
+  std::lock_guard<std::mutex> guard(lock_);
+  return events_.size();
+}
+
+event_set::event_set(fpga_event_set set) : set_(set) {}
+
 }  // end of namespace types
 }  // end of namespace fpga
 }  // end of namespace opae
@@ -109,6 +109,12 @@ void handle::write_csr64(uint64_t offset, uint64_t value, uint32_t csr_space) {
   ASSERT_FPGA_OK(fpgaWriteMMIO64(handle_, csr_space, offset, value));
 }
 
+mmio_accessor handle::accessor(uint32_t csr_space) const {
+  fpga_mmio_accessor accessor;
+  ASSERT_FPGA_OK(fpgaGetMMIOAccessor(handle_, csr_space, &accessor));
+  return mmio_accessor(accessor);
+}
+
 void handle::write_csr512(uint64_t offset, const void *value,
                           uint32_t csr_space) {
   ASSERT_FPGA_OK(fpgaWriteMMIO512(handle_, csr_space, offset, value));
@@ -43,32 +43,114 @@
 #include <stdbool.h>
 #include <unistd.h>
 
+/*
+ * Buffers larger than 2 MiB are first tried with 2 MiB pages. 1 GiB pages
+ * are used directly when rounding up to them costs at most this much more
+ * memory than rounding up to 2 MiB pages.
+ */
+#define BUFFER_1G_SLACK (64 * MB)
+
+#define ROUND_UP(x, a) (((x) + ((a) - 1)) & ~((uint64_t)(a) - 1))
+
+/* Hugepages currently backing buffers allocated by this plugin */
+static uint64_t buffer_pages_2m;
+static uint64_t buffer_pages_1g;
+
+/*
+ * Set once the port driver has refused to map a buffer made of several
+ * 2 MiB pages. Those pages are not physically contiguous, and the driver
+ * only maps physically contiguous memory. From then on, buffers larger
+ * than 2 MiB are backed by 1 GiB pages, as mmap.c does.
+ */
+STATIC bool buffer_2m_spans_rejected;
+
+/*
+ * Page size used to back a buffer of len bytes
+ */
+STATIC uint64_t buffer_page_size(uint64_t len)
+{
+	if (len <= 4 * KB)
+		return 4 * KB;
+
+	if (len <= 2 * MB)
+		return 2 * MB;
+
+	if (__atomic_load_n(&buffer_2m_spans_rejected, __ATOMIC_RELAXED))
+		return GB;
+
+	if (ROUND_UP(len, GB) - ROUND_UP(len, 2 * MB) <= BUFFER_1G_SLACK)
+		return GB;
+
+	return 2 * MB;
+}
+
+STATIC void buffer_account(uint64_t page_size, uint64_t len, bool add)
+{
+	uint64_t *pages;
+	uint64_t count;
+
+	if (page_size == GB)
+		pages = &buffer_pages_1g;
+	else if (page_size == 2 * MB)
+		pages = &buffer_pages_2m;
+	else
+		return;
+
+	count = ROUND_UP(len, page_size) / page_size;
+
+	if (add)
+		__sync_fetch_and_add(pages, count);
+	else
+		__sync_fetch_and_sub(pages, count);
+}
+
+STATIC void *buffer_mmap(uint64_t len, uint64_t page_size)
+{
+	int map_flags = FLAGS_4K;
+
+	if (page_size == GB)
+		map_flags = FLAGS_1G;
+	else if (page_size == 2 * MB)
+		map_flags = FLAGS_2M;
+
+	return mmap(ADDR, ROUND_UP(len, page_size), PROTECTION, map_flags, 0, 0);
+}
+
 /*
  * Allocate (mmap) new buffer
+ * On success, *page_size holds the size of the backing pages.
  */
-STATIC fpga_result buffer_allocate(void **addr, uint64_t len, int flags)
+STATIC fpga_result buffer_allocate(void **addr, uint64_t len,
+				   uint64_t *page_size, int flags)
 {
 	void *addr_local = NULL;
+	uint64_t pg_size;
 
 	UNUSED_PARAM(flags);
 
 	ASSERT_NOT_NULL(addr);
+	ASSERT_NOT_NULL(page_size);
+
+	pg_size = buffer_page_size(len);
+
+	addr_local = buffer_mmap(len, pg_size);
+
+	/* A buffer larger than 2 MiB can be backed by either hugepage
+	 * size, unless the driver has refused several 2 MiB pages; when one
+	 * pool is exhausted, try the other. */
+	if (addr_local == MAP_FAILED && errno == ENOMEM && len > 2 * MB &&
+	    (pg_size == 2 * MB ||
+	     !__atomic_load_n(&buffer_2m_spans_rejected, __ATOMIC_RELAXED))) {
+		pg_size = (pg_size == GB) ? 2 * MB : GB;
+		addr_local = buffer_mmap(len, pg_size);
+	}
 
-	/* ! FPGA_BUF_PREALLOCATED, allocate memory using huge pages
-	   For buffer > 2M, use 1G-hugepage to ensure pages are
-	   contiguous */
-	if (len > 2 * MB)
-		addr_local = mmap(ADDR, len, PROTECTION, FLAGS_1G, 0, 0);
-	else if (len > 4 * KB)
-		addr_local = mmap(ADDR, len, PROTECTION, FLAGS_2M, 0, 0);
-	else
-		addr_local = mmap(ADDR, len, PROTECTION, FLAGS_4K, 0, 0);
 	if (addr_local == MAP_FAILED) {
 		if (errno == ENOMEM) {
 			if (len > 2 * MB)
-				OPAE_MSG("Could not allocate buffer (no free 1 "
-					 "GiB huge pages)");
-			if (len > 4 * KB)
+				OPAE_MSG("Could not allocate buffer (no free 2 "
+					 "MiB or 1 GiB huge pages)");
+			else if (len > 4 * KB)
 				OPAE_MSG("Could not allocate buffer (no free 2 "
 					 "MiB huge pages)");
 			else
@@ -80,43 +162,280 @@ STATIC fpga_result buffer_allocate(void **addr, uint64_t len, int flags)
 		return FPGA_INVALID_PARAM;
 	}
 
+	OPAE_DBG("buffer of %lu bytes backed by %lu bytes of %lu byte pages",
+		 len, ROUND_UP(len, pg_size), pg_size);
+
+	buffer_account(pg_size, len, true);
+
 	*addr = addr_local;
+	*page_size = pg_size;
 	return FPGA_OK;
 }
 
 /*
  * Release (unmap) allocated buffer
  */
-STATIC fpga_result buffer_release(void *addr, uint64_t len)
+STATIC fpga_result buffer_release(void *addr, uint64_t len,
+				  uint64_t page_size)
 {
 	/* If the buffer allocation was backed by hugepages, then
-	 * len must be rounded up to the nearest hugepage size,
+	 * len must be rounded up to the backing page size,
 	 * otherwise munmap will fail.
-	 *
-	 * Buffer with size larger than 2MB is backed by 1GB page(s),
-	 * round up the size to the nearest GB boundary.
-	 *
-	 * Buffer with size smaller than 2MB but larger than 4KB is
-	 * backed by a 2MB pages, round up the size to 2MB.
-	 *
-	 * Buffer with size smaller than 4KB is backed by a 4KB page,
-	 * and its size is already 4KB aligned.
 	 */
-
-	if (len > 2 * MB)
-		len = (len + (1 * GB - 1)) & (~(1 * GB - 1));
-	else if (len > 4 * KB)
-		len = 2 * MB;
-
-	if (munmap(addr, len)) {
+	if (munmap(addr, ROUND_UP(len, page_size))) {
 		OPAE_MSG("FPGA buffer munmap failed: %s",
 			 strerror(errno));
 		return FPGA_INVALID_PARAM;
 	}
 
+	buffer_account(page_size, len, false);
+
 	return FPGA_OK;
 }
 
+fpga_result __XFPGA_API__ xfpga_buffer_hugepages(uint64_t *pages_2m,
+						 uint64_t *pages_1g)
+{
+	ASSERT_NOT_NULL(pages_2m);
+	ASSERT_NOT_NULL(pages_1g);
+
+	*pages_2m = __sync_fetch_and_add(&buffer_pages_2m, 0);
+	*pages_1g = __sync_fetch_and_add(&buffer_pages_1g, 0);
+
+	return FPGA_OK;
+}
+
+/*
+ * Whether an idle pooled buffer can serve a request for len bytes:
+ * it must have the footprint a fresh allocation would have, allowing
+ * for the hugepage size fallback of buffers larger than 2 MiB.
+ */
+STATIC bool buffer_pool_fits(const struct _fpga_pooled_buffer *b,
+			     uint64_t len)
+{
+	if (len > 2 * MB)
+		return b->len == ROUND_UP(len, b->page_size);
+
+	return b->page_size == buffer_page_size(len);
+}
+
+/*
+ * Take an idle buffer for len bytes from the pool of a locked handle.
+ * On a hit, *len is updated to the mapped footprint of the buffer.
+ */
+STATIC bool buffer_pool_take(struct _fpga_handle *_handle, uint64_t *len,
+			     int flags, void **addr, uint64_t *iova,
+			     uint64_t *page_size)
+{
+	struct _fpga_buffer_pool *pool = &_handle->buffer_pool;
+	struct _fpga_pooled_buffer **pb;
+	struct _fpga_pooled_buffer *b;
+
+	for (pb = &pool->idle ; *pb ; pb = &(*pb)->next) {
+		b = *pb;
+		if (b->flags != (flags & FPGA_BUF_READ_ONLY) ||
+		    !buffer_pool_fits(b, *len))
+			continue;
+
+		*pb = b->next;
+		pool->idle_bytes -= b->len;
+		++pool->hits;
+
+		*addr = (void *)b->addr;
+		*iova = b->iova;
+		*len = b->len;
+		*page_size = b->page_size;
+
+		free(b);
+		return true;
+	}
+
+	++pool->misses;
+	return false;
+}
+
+/*
+ * Keep a released pooled buffer pinned and idle, if the idle limit of
+ * the (locked) handle's pool allows.
+ */
+STATIC bool buffer_pool_put(struct _fpga_handle *_handle, void *addr,
+			    uint64_t iova, uint64_t len, uint64_t page_size,
+			    int flags)
+{
+	struct _fpga_buffer_pool *pool = &_handle->buffer_pool;
+	struct _fpga_pooled_buffer *b;
+
+	if (pool->idle_bytes + len > pool->max_idle_bytes)
+		return false;
+
+	b = malloc(sizeof(*b));
+	if (!b)
+		return false;
+
+	b->addr = (uint64_t)addr;
+	b->iova = iova;
+	b->len = len;
+	b->page_size = page_size;
+	b->flags = flags & FPGA_BUF_READ_ONLY;
+
+	b->next = pool->idle;
+	pool->idle = b;
+	pool->idle_bytes += len;
+
+	return true;
+}
+
+/*
+ * Unpin and free idle buffers of a locked handle until at most limit
+ * idle bytes remain. The most recently released buffers are kept.
+ */
+STATIC void buffer_pool_shrink(struct _fpga_handle *_handle, uint64_t limit)
+{
+	struct _fpga_buffer_pool *pool = &_handle->buffer_pool;
+	struct _fpga_pooled_buffer **pb = &pool->idle;
+	struct _fpga_pooled_buffer *b;
+	uint64_t kept = 0;
+
+	while (*pb) {
+		b = *pb;
+		if (kept + b->len <= limit) {
+			kept += b->len;
+			pb = &b->next;
+			continue;
+		}
+
+		*pb = b->next;
+
+		if (opae_port_unmap(_handle->fddev, b->iova))
+			OPAE_MSG("FPGA_PORT_DMA_UNMAP ioctl failed: %s",
+				 strerror(errno));
+		buffer_release((void *)b->addr, b->len, b->page_size);
+
+		pool->idle_bytes -= b->len;
+		pool->pinned_bytes -= b->len;
+		free(b);
+	}
+}
+
+void buffer_pool_drain(fpga_handle handle)
+{
+	buffer_pool_shrink((struct _fpga_handle *)handle, 0);
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaBufferPoolConfigure(fpga_handle handle,
+						    uint64_t max_idle_bytes)
+{
+	struct _fpga_handle *_handle = (struct _fpga_handle *)handle;
+	fpga_result result;
+	int err;
+
+	result = handle_check_and_lock(_handle);
+	if (result)
+		return result;
+
+	_handle->buffer_pool.max_idle_bytes = max_idle_bytes;
+	buffer_pool_shrink(_handle, max_idle_bytes);
+
+	err = pthread_mutex_unlock(&_handle->lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+	return FPGA_OK;
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaBufferPoolTrim(fpga_handle handle)
+{
+	struct _fpga_handle *_handle = (struct _fpga_handle *)handle;
+	fpga_result result;
+	int err;
+
+	result = handle_check_and_lock(_handle);
+	if (result)
+		return result;
+
+	buffer_pool_shrink(_handle, 0);
+
+	err = pthread_mutex_unlock(&_handle->lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+	return FPGA_OK;
+}
+
+fpga_result __XFPGA_API__
+xfpga_fpgaBufferPoolGetStats(fpga_handle handle, fpga_buffer_pool_stats *stats)
+{
+	struct _fpga_handle *_handle = (struct _fpga_handle *)handle;
+	fpga_result result;
+	int err;
+
+	ASSERT_NOT_NULL(stats);
+
+	result = handle_check_and_lock(_handle);
+	if (result)
+		return result;
+
+	stats->hits = _handle->buffer_pool.hits;
+	stats->misses = _handle->buffer_pool.misses;
+	stats->pinned_bytes = _handle->buffer_pool.pinned_bytes;
+	stats->idle_bytes = _handle->buffer_pool.idle_bytes;
+
+	err = pthread_mutex_unlock(&_handle->lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+	return FPGA_OK;
+}
+
+/*
+ * Allocate a buffer of len bytes and map it for DMA. A pooled buffer is
+ * mapped in full, and *len is updated to its footprint. When the driver
+ * refuses a buffer of several 2 MiB pages, it is allocated again with
+ * 1 GiB pages.
+ */
+STATIC fpga_result buffer_allocate_map(struct _fpga_handle *_handle,
+				       uint64_t *len, bool pooled, int flags,
+				       uint32_t map_flags, void **addr,
+				       uint64_t *io_addr, uint64_t *page_size)
+{
+	fpga_result result;
+	uint64_t map_len;
+	int map_errno;
+
+	while (1) {
+		result = buffer_allocate(addr, *len, page_size, flags);
+		if (result != FPGA_OK)
+			return result;
+
+		/* Pin the whole footprint of a pooled buffer, so that
+		 * it can serve any length of its size class. */
+		map_len = pooled ? ROUND_UP(*len, *page_size) : *len;
+
+		if (!opae_port_map(_handle->fddev, *addr, map_len, map_flags,
+				   io_addr)) {
+			*len = map_len;
+			return FPGA_OK;
+		}
+
+		map_errno = errno;
+		buffer_release(*addr, map_len, *page_size);
+		errno = map_errno;
+
+		if (*page_size != 2 * MB || *len <= 2 * MB) {
+			if (!(flags & FPGA_BUF_QUIET)) {
+				OPAE_MSG("FPGA_PORT_DMA_MAP ioctl failed: %s",
+					 strerror(map_errno));
+			}
+			return FPGA_INVALID_PARAM;
+		}
+
+		OPAE_DBG("2 MiB pages of a %lu byte buffer not mapped; "
+			 "using 1 GiB pages", *len);
+		__atomic_store_n(&buffer_2m_spans_rejected, true,
+				 __ATOMIC_RELAXED);
+	}
+}
+
 fpga_result __XFPGA_API__ xfpga_fpgaPrepareBuffer(fpga_handle handle, uint64_t len,
 					   void **buf_addr, uint64_t *wsid,
 					   int flags)
@@ -129,11 +448,14 @@ fpga_result __XFPGA_API__ xfpga_fpgaPrepareBuffer(fpga_handle handle, uint64_t l
 
 	bool preallocated = (flags & FPGA_BUF_PREALLOCATED);
 	bool quiet = (flags & FPGA_BUF_QUIET);
+	bool pooled = (flags & FPGA_BUF_POOLED);
+	bool pool_hit = false;
 
 	bool read_only = (flags & FPGA_BUF_READ_ONLY);
 	uint32_t map_flags = (read_only ? FPGA_DMA_TO_DEV : 0);
 
 	uint64_t pg_size;
+	uint64_t backing_pg_size = 0;
 
 	result = handle_check_and_lock(_handle);
 	if (result)
@@ -147,12 +469,18 @@ fpga_result __XFPGA_API__ xfpga_fpgaPrepareBuffer(fpga_handle handle, uint64_t l
 	}
 
 	if (flags & (~(FPGA_BUF_PREALLOCATED | FPGA_BUF_QUIET |
-		       FPGA_BUF_READ_ONLY))) {
+		       FPGA_BUF_READ_ONLY | FPGA_BUF_POOLED))) {
 		OPAE_MSG("Unrecognized flags");
 		result = FPGA_INVALID_PARAM;
 		goto out_unlock;
 	}
 
+	if (preallocated && pooled) {
+		OPAE_MSG("Preallocated buffers cannot be pooled");
+		result = FPGA_INVALID_PARAM;
+		goto out_unlock;
+	}
+
 	pg_size = (uint64_t) sysconf(_SC_PAGE_SIZE);
 
 	if (preallocated) {
@@ -201,17 +529,23 @@ fpga_result __XFPGA_API__ xfpga_fpgaPrepareBuffer(fpga_handle handle, uint64_t l
 			len = pg_size + (len & ~(pg_size - 1));
 		}
 
-		result = buffer_allocate(&addr, len, flags);
-		if (result != FPGA_OK) {
-			goto out_unlock;
+		if (pooled)
+			pool_hit = buffer_pool_take(_handle, &len, flags, &addr,
+						    &io_addr, &backing_pg_size);
+
+		if (!pool_hit) {
+			result = buffer_allocate_map(_handle, &len, pooled,
+						     flags, map_flags, &addr,
+						     &io_addr,
+						     &backing_pg_size);
+			if (result != FPGA_OK) {
+				goto out_unlock;
+			}
 		}
 	}
 
-	if (opae_port_map(_handle->fddev, addr, len, map_flags, &io_addr)) {
-		if (!preallocated) {
-			buffer_release(addr, len);
-		}
-
+	if (preallocated &&
+	    opae_port_map(_handle->fddev, addr, len, map_flags, &io_addr)) {
 		if (!quiet) {
 			OPAE_MSG("FPGA_PORT_DMA_MAP ioctl failed: %s",
 				 strerror(errno));
@@ -221,15 +555,18 @@ fpga_result __XFPGA_API__ xfpga_fpgaPrepareBuffer(fpga_handle handle, uint64_t l
 		goto out_unlock;
 	}
 
+	if (pooled && !pool_hit)
+		_handle->buffer_pool.pinned_bytes += len;
 
 	/* Generate unique workspace ID */
 	*wsid = wsid_gen();
 
-	/* Add to workspace id in order to store buffer length */
+	/* Add to workspace id in order to store buffer length.
+	 * Buffers keep their backing page size in the offset field. */
 	if (!wsid_add(_handle->wsid_root, *wsid, (uint64_t)addr, io_addr, len,
-		      0, 0, flags)) {
+		      backing_pg_size, 0, flags)) {
 		if (!preallocated) {
-			buffer_release(addr, len);
+			buffer_release(addr, len, backing_pg_size);
 		}
 
 		OPAE_MSG("Failed to add workspace id %lu", *wsid);
@@ -282,6 +619,16 @@ xfpga_fpgaReleaseBuffer(fpga_handle handle, uint64_t wsid)
 
 	bool preallocated = (wm->flags & FPGA_BUF_PREALLOCATED);
 
+	/* Pooled buffers stay pinned for reuse while the pool has room. */
+	if (wm->flags & FPGA_BUF_POOLED) {
+		if (buffer_pool_put(_handle, buf_addr, iova, len, wm->offset,
+				    wm->flags)) {
+			result = FPGA_OK;
+			goto ws_free;
+		}
+		_handle->buffer_pool.pinned_bytes -= len;
+	}
+
 	if (opae_port_unmap(_handle->fddev, iova)) {
 		OPAE_MSG("FPGA_PORT_DMA_UNMAP ioctl failed: %s",
 			 strerror(errno));
@@ -293,7 +640,7 @@ xfpga_fpgaReleaseBuffer(fpga_handle handle, uint64_t wsid)
 	 * preallocated), we need to unmap it here. Otherwise (if it was
 	 * preallocated) the mapping needs to stay intact. */
 	if (!preallocated) {
-		result = buffer_release(buf_addr, len);
+		result = buffer_release(buf_addr, len, wm->offset);
 		if (result != FPGA_OK) {
 			OPAE_MSG("Buffer release failed");
 			goto ws_free;
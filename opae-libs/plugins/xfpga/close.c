@@ -29,6 +29,7 @@
 #endif // HAVE_CONFIG_H
 
 #include <opae/access.h>
+#include "xfpga.h"
 #include "common_int.h"
 #include "wsid_list_int.h"
 #include "metrics/metrics_int.h"
@@ -64,6 +65,7 @@ fpga_result __XFPGA_API__ xfpga_fpgaClose(fpga_handle handle)
 		return FPGA_INVALID_PARAM;
 	}
 
+	buffer_pool_drain(_handle);
 	wsid_tracker_cleanup(_handle->wsid_root, NULL);
 	wsid_tracker_cleanup(_handle->mmio_root, unmap_mmio_region);
 	free_umsg_buffer(handle);
@@ -71,9 +73,10 @@ fpga_result __XFPGA_API__ xfpga_fpgaClose(fpga_handle handle)
 	// free metric enum vector
 	free_fpga_enum_metrics_vector(_handle);
 
+	// drop registrations made through the event daemon
+	event_daemon_release(handle);
+
 	close(_handle->fddev);
-	if (_handle->fdfpgad >= 0)
-		close(_handle->fdfpgad);
 
 	// invalidate magic (just in case)
 	_handle->magic = FPGA_INVALID_MAGIC;
@@ -89,5 +92,8 @@ fpga_result __XFPGA_API__ xfpga_fpgaClose(fpga_handle handle)
 
 	free(_handle);
 
+	// accelerator state may have changed
+	xfpga_enum_cache_invalidate();
+
 	return FPGA_OK;
 }
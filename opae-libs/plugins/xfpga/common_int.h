@@ -89,4 +89,12 @@ fpga_result prop_check_and_lock(struct _fpga_properties *prop);
 fpga_result handle_check_and_lock(struct _fpga_handle *handle);
 fpga_result event_handle_check_and_lock(struct _fpga_event_handle *eh);
 
+/* Shared connection to the event daemon (fpgad) */
+fpga_result event_daemon_register(fpga_handle handle, uint64_t object_id,
+				  fpga_event_type event_type, int fd);
+fpga_result event_daemon_unregister(fpga_handle handle,
+				    fpga_event_type event_type);
+void event_daemon_release(fpga_handle handle);
+void event_daemon_finalize(void);
+
 #endif // ___FPGA_COMMON_INT_H__
@@ -36,6 +36,8 @@
 #include <dirent.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <time.h>
+#include <sys/inotify.h>
 
 #include "xfpga.h"
 #include "common_int.h"
@@ -66,6 +68,7 @@ struct dev_list {
 	fpga_accelerator_state accelerator_state;
 	uint32_t accelerator_num_mmios;
 	uint32_t accelerator_num_irqs;
+	bool synced;
 	struct dev_list *next;
 	struct dev_list *parent;
 	struct dev_list *fme;
@@ -597,15 +600,369 @@ bool include_afu(const fpga_properties *filters, uint32_t num_filters)
 	return false;
 }
 
+STATIC void free_dev_list(struct dev_list *head)
+{
+	struct dev_list *lptr;
+
+	for (lptr = head->next; NULL != lptr;) {
+		struct dev_list *trash = lptr;
+		lptr = lptr->next;
+		free(trash);
+	}
+	head->next = NULL;
+}
+
+/*
+ * Walk a device list, register a token for each usable node and
+ * clone the ones matching the filters into tokens[]. Nodes of a
+ * freshly-scanned list are synced here; nodes of the cached snapshot
+ * were synced when the snapshot was built.
+ */
+STATIC fpga_result emit_tokens(struct dev_list *head, bool cached,
+			       bool include_port,
+			       const fpga_properties *filters,
+			       uint32_t num_filters, fpga_token *tokens,
+			       uint32_t max_tokens, uint32_t *num_matches)
+{
+	struct dev_list *lptr;
+
+	for (lptr = head->next; NULL != lptr; lptr = lptr->next) {
+		struct _fpga_token *_tok;
+
+		// Skip the "container" device list nodes.
+		if (!lptr->devpath[0])
+			continue;
+
+		if (cached) {
+			if (!lptr->synced)
+				continue;
+			if (!include_port && lptr->objtype == FPGA_ACCELERATOR)
+				continue;
+		} else if (lptr->objtype == FPGA_DEVICE &&
+			   sync_fme(lptr) != FPGA_OK) {
+			continue;
+		} else if (lptr->objtype == FPGA_ACCELERATOR &&
+			   sync_afu(lptr) != FPGA_OK) {
+			continue;
+		}
+
+		/* FIXME: do we need to keep a global list of tokens? */
+		/* For now we do becaue it is used in xfpga_fpgaUpdateProperties
+		 * to lookup a parent from the global list of tokens...*/
+		_tok = token_add(lptr->sysfspath, lptr->devpath);
+
+		if (NULL == _tok) {
+			OPAE_MSG("Failed to allocate memory for token");
+			return FPGA_NO_MEMORY;
+		}
+
+		if (matches_filters(lptr, filters, num_filters)) {
+			if (*num_matches < max_tokens) {
+				if (xfpga_fpgaCloneToken(_tok, &tokens[*num_matches])
+				    != FPGA_OK) {
+					// FIXME: should we error out here?
+					OPAE_MSG("Error cloning token");
+				}
+			}
+			++(*num_matches);
+		}
+	}
+
+	return FPGA_OK;
+}
+
+/*
+ * Enumeration cache
+ *
+ * When enabled (max_age_ms > 0), the synced device list is kept across
+ * calls to xfpga_fpgaEnumerate(). The snapshot is rebuilt when:
+ *  - it is older than max_age_ms (UINT64_MAX means no age limit),
+ *  - inotify reports an FPGA device node or sysfs class entry being
+ *    created or removed, or a cached device node going away,
+ *  - this process opens, closes or reconfigures an FPGA resource,
+ *  - xfpga_enum_cache_invalidate() is called.
+ * Accelerator state changes caused by other processes are only picked
+ * up once the snapshot ages out.
+ */
+#define ENUM_CACHE_CLASS_EVENTS (IN_CREATE | IN_DELETE | IN_MOVED_FROM | \
+				 IN_MOVED_TO | IN_DELETE_SELF)
+#define ENUM_CACHE_DEV_EVENTS   (IN_CREATE | IN_DELETE | IN_MOVED_FROM | \
+				 IN_MOVED_TO)
+#define ENUM_CACHE_NODE_EVENTS  (IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF)
+
+static struct {
+	pthread_mutex_t lock;
+	struct dev_list head;
+	bool valid;
+	uint64_t max_age_ms;
+	struct timespec stamp;
+	int inotify_fd;
+	int dev_wd;
+	uint64_t hits;
+	uint64_t misses;
+} enum_cache = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.inotify_fd = -1,
+	.dev_wd = -1,
+};
+
+STATIC uint64_t elapsed_ms(const struct timespec *since)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)(now.tv_sec - since->tv_sec) * 1000 +
+	       (now.tv_nsec - since->tv_nsec) / 1000000;
+}
+
+STATIC bool is_fpga_dev_name(const char *name)
+{
+	return !strncmp(name, "dfl-", 4) || !strncmp(name, "intel-fpga-", 11);
+}
+
+STATIC void enum_cache_unwatch(void)
+{
+	if (enum_cache.inotify_fd >= 0) {
+		close(enum_cache.inotify_fd);
+		enum_cache.inotify_fd = -1;
+	}
+	enum_cache.dev_wd = -1;
+}
+
+// Must be called with enum_cache.lock held.
+STATIC void enum_cache_watch(void)
+{
+	struct dev_list *lptr;
+	int fd;
+
+	enum_cache_unwatch();
+
+	fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fd < 0) {
+		OPAE_DBG("inotify_init1() failed: %s", strerror(errno));
+		return;
+	}
+
+	// A missing class directory just means that driver isn't loaded.
+	inotify_add_watch(fd, FPGA_SYSFS_CLASS_PATH_DFL,
+			  ENUM_CACHE_CLASS_EVENTS);
+	inotify_add_watch(fd, FPGA_SYSFS_CLASS_PATH_INTEL,
+			  ENUM_CACHE_CLASS_EVENTS);
+
+	enum_cache.dev_wd = inotify_add_watch(fd, FPGA_DEV_PATH,
+					      ENUM_CACHE_DEV_EVENTS);
+	if (enum_cache.dev_wd < 0)
+		OPAE_DBG("failed to watch %s: %s",
+			 FPGA_DEV_PATH, strerror(errno));
+
+	for (lptr = enum_cache.head.next; NULL != lptr; lptr = lptr->next) {
+		if (lptr->devpath[0] && lptr->synced &&
+		    inotify_add_watch(fd, lptr->devpath,
+				      ENUM_CACHE_NODE_EVENTS) < 0) {
+			OPAE_DBG("failed to watch %s: %s",
+				 lptr->devpath, strerror(errno));
+		}
+	}
+
+	enum_cache.inotify_fd = fd;
+}
+
+// Drain pending inotify events. Returns true if any affects the snapshot.
+// Must be called with enum_cache.lock held.
+STATIC bool enum_cache_changed(void)
+{
+	char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	bool changed = false;
+	ssize_t len;
+
+	if (enum_cache.inotify_fd < 0)
+		return false;
+
+	while ((len = read(enum_cache.inotify_fd, buf, sizeof(buf))) > 0) {
+		char *ptr = buf;
+
+		while (ptr < buf + len) {
+			const struct inotify_event *ev =
+				(const struct inotify_event *)ptr;
+
+			if (ev->mask & IN_Q_OVERFLOW)
+				changed = true;
+			else if (ev->wd != enum_cache.dev_wd)
+				changed = true;
+			else if (ev->len && is_fpga_dev_name(ev->name))
+				changed = true;
+
+			ptr += sizeof(struct inotify_event) + ev->len;
+		}
+	}
+
+	return changed;
+}
+
+// Must be called with enum_cache.lock held.
+STATIC fpga_result enum_cache_rebuild(void)
+{
+	struct dev_list *lptr;
+	fpga_result result;
+
+	enum_cache.valid = false;
+	free_dev_list(&enum_cache.head);
+
+	result = enum_fpga_region_resources(&enum_cache.head, true);
+	if (result != FPGA_OK) {
+		free_dev_list(&enum_cache.head);
+		return result;
+	}
+
+	for (lptr = enum_cache.head.next; NULL != lptr; lptr = lptr->next) {
+		if (!lptr->devpath[0])
+			continue;
+
+		if (lptr->objtype == FPGA_DEVICE)
+			lptr->synced = (sync_fme(lptr) == FPGA_OK);
+		else if (lptr->objtype == FPGA_ACCELERATOR)
+			lptr->synced = (sync_afu(lptr) == FPGA_OK);
+	}
+
+	enum_cache_watch();
+	clock_gettime(CLOCK_MONOTONIC, &enum_cache.stamp);
+	enum_cache.valid = true;
+
+	return FPGA_OK;
+}
+
+void __XFPGA_API__ xfpga_enum_cache_configure(uint64_t max_age_ms)
+{
+	int err;
+
+	if (pthread_mutex_lock(&enum_cache.lock)) {
+		OPAE_MSG("Failed to lock enum cache mutex");
+		return;
+	}
+
+	enum_cache.max_age_ms = max_age_ms;
+
+	if (!max_age_ms) {
+		enum_cache.valid = false;
+		free_dev_list(&enum_cache.head);
+		enum_cache_unwatch();
+		enum_cache.hits = enum_cache.misses = 0;
+	}
+
+	err = pthread_mutex_unlock(&enum_cache.lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+}
+
+void __XFPGA_API__ xfpga_enum_cache_invalidate(void)
+{
+	int err;
+
+	if (pthread_mutex_lock(&enum_cache.lock)) {
+		OPAE_MSG("Failed to lock enum cache mutex");
+		return;
+	}
+
+	enum_cache.valid = false;
+
+	err = pthread_mutex_unlock(&enum_cache.lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+}
+
+fpga_result __XFPGA_API__ xfpga_enum_cache_stats(uint64_t *hits,
+						 uint64_t *misses)
+{
+	int err;
+
+	if (!hits || !misses) {
+		OPAE_MSG("NULL hits or misses");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if (pthread_mutex_lock(&enum_cache.lock)) {
+		OPAE_MSG("Failed to lock enum cache mutex");
+		return FPGA_EXCEPTION;
+	}
+
+	*hits = enum_cache.hits;
+	*misses = enum_cache.misses;
+
+	err = pthread_mutex_unlock(&enum_cache.lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+	return FPGA_OK;
+}
+
+/*
+ * Enumerate from the cache. *cached is set to false, and nothing is
+ * enumerated, when the cache is disabled.
+ */
+STATIC fpga_result enum_cached(const fpga_properties *filters,
+			       uint32_t num_filters, fpga_token *tokens,
+			       uint32_t max_tokens, uint32_t *num_matches,
+			       bool *cached)
+{
+	fpga_result result = FPGA_OK;
+	int err;
+
+	*cached = true;
+
+	if (pthread_mutex_lock(&enum_cache.lock)) {
+		OPAE_MSG("Failed to lock enum cache mutex");
+		return FPGA_EXCEPTION;
+	}
+
+	if (!enum_cache.max_age_ms) {
+		*cached = false;
+		goto out_unlock;
+	}
+
+	if (enum_cache_changed()) {
+		enum_cache.valid = false;
+		// sysfs paths of devices that came or went may be cached
+		sysfs_glob_cache_flush();
+	}
+
+	if (enum_cache.valid &&
+	    (enum_cache.max_age_ms == UINT64_MAX ||
+	     elapsed_ms(&enum_cache.stamp) < enum_cache.max_age_ms)) {
+		++enum_cache.hits;
+	} else {
+		++enum_cache.misses;
+		result = enum_cache_rebuild();
+		if (result != FPGA_OK) {
+			OPAE_MSG("No FPGA resources found");
+			goto out_unlock;
+		}
+	}
+
+	result = emit_tokens(&enum_cache.head, true,
+			     include_afu(filters, num_filters),
+			     filters, num_filters,
+			     tokens, max_tokens, num_matches);
+
+out_unlock:
+	err = pthread_mutex_unlock(&enum_cache.lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+	return result;
+}
+
 fpga_result __XFPGA_API__ xfpga_fpgaEnumerate(const fpga_properties *filters,
 				       uint32_t num_filters, fpga_token *tokens,
 				       uint32_t max_tokens,
 				       uint32_t *num_matches)
 {
 	fpga_result result = FPGA_NOT_FOUND;
+	bool include_port;
+	bool cached;
 
 	struct dev_list head;
-	struct dev_list *lptr;
 
 	if (NULL == num_matches) {
 		OPAE_MSG("num_matches is NULL");
@@ -631,11 +988,16 @@ fpga_result __XFPGA_API__ xfpga_fpgaEnumerate(const fpga_properties *filters,
 
 	*num_matches = 0;
 
+	result = enum_cached(filters, num_filters,
+			     tokens, max_tokens, num_matches, &cached);
+	if (cached)
+		return result;
+
 	memset(&head, 0, sizeof(head));
 
 	// enum FPGA regions & resources
-	result = enum_fpga_region_resources(&head,
-				include_afu(filters, num_filters));
+	include_port = include_afu(filters, num_filters);
+	result = enum_fpga_region_resources(&head, include_port);
 
 	if (result != FPGA_OK) {
 		OPAE_MSG("No FPGA resources found");
@@ -643,50 +1005,11 @@ fpga_result __XFPGA_API__ xfpga_fpgaEnumerate(const fpga_properties *filters,
 	}
 
 	/* create and populate token data structures */
-	for (lptr = head.next; NULL != lptr; lptr = lptr->next) {
-		struct _fpga_token *_tok;
-
-		// Skip the "container" device list nodes.
-		if (!lptr->devpath[0])
-			continue;
-
-		if (lptr->objtype == FPGA_DEVICE &&
-		    sync_fme(lptr) != FPGA_OK) {
-			continue;
-		} else if (lptr->objtype == FPGA_ACCELERATOR &&
-			   sync_afu(lptr) != FPGA_OK) {
-			continue;
-		}
+	result = emit_tokens(&head, false, include_port,
+			     filters, num_filters,
+			     tokens, max_tokens, num_matches);
 
-		/* FIXME: do we need to keep a global list of tokens? */
-		/* For now we do becaue it is used in xfpga_fpgaUpdateProperties
-		 * to lookup a parent from the global list of tokens...*/
-		_tok = token_add(lptr->sysfspath, lptr->devpath);
-
-		if (NULL == _tok) {
-			OPAE_MSG("Failed to allocate memory for token");
-			result = FPGA_NO_MEMORY;
-			goto out_free_trash;
-		}
-
-		if (matches_filters(lptr, filters, num_filters)) {
-			if (*num_matches < max_tokens) {
-				if (xfpga_fpgaCloneToken(_tok, &tokens[*num_matches])
-				    != FPGA_OK) {
-					// FIXME: should we error out here?
-					OPAE_MSG("Error cloning token");
-				}
-			}
-			++(*num_matches);
-		}
-	}
-
-out_free_trash:
-	for (lptr = head.next; NULL != lptr;) {
-		struct dev_list *trash = lptr;
-		lptr = lptr->next;
-		free(trash);
-	}
+	free_dev_list(&head);
 
 	return result;
 }
@@ -32,7 +32,11 @@
 #define _GNU_SOURCE
 #endif // _GNU_SOURCE
 
+#include <fcntl.h>
+#include <poll.h>
+#include <stdbool.h>
 #include <string.h>
+#include <unistd.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <sys/eventfd.h>
@@ -56,43 +60,426 @@ struct event_request {
 	uint64_t object_id;
 };
 
-fpga_result send_event_request(int conn_socket, int fd,
-			       struct event_request *req)
+/*
+ * All handles in the process share one connection to the event daemon.
+ * fpgad ties registrations to the connection they arrived on, so every
+ * registration sent over it is recorded here: to release a handle's
+ * registrations when the handle is closed, and to replay all of them when
+ * the connection has to be re-established (e.g. after fpgad restarts).
+ */
+struct event_daemon_registration {
+	fpga_handle handle;
+	uint64_t object_id;
+	fpga_event_type event;
+	int fd; // private duplicate of the event handle's eventfd
+};
+
+#define EVENT_DAEMON_BATCH 64
+
+STATIC const char *event_daemon_socket = EVENT_SOCKET_NAME;
+
+static struct {
+	pthread_mutex_t lock;
+	int conn;
+	struct event_daemon_registration *regs;
+	size_t num_regs;
+	size_t max_regs;
+} event_daemon = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.conn = -1,
+	.regs = NULL,
+	.num_regs = 0,
+	.max_regs = 0,
+};
+
+/*
+ * Send count requests in batches of sendmmsg(). Each request keeps its own
+ * message and, when fds[i] >= 0, its own SCM_RIGHTS descriptor, so the
+ * daemon sees exactly the framing of individual sendmsg() calls.
+ */
+STATIC fpga_result event_daemon_send(int conn,
+				     struct event_request *reqs,
+				     const int *fds, size_t count)
 {
-	struct msghdr mh;
+	struct mmsghdr msgs[EVENT_DAEMON_BATCH];
+	struct iovec iov[EVENT_DAEMON_BATCH];
+	union {
+		char buf[CMSG_SPACE(sizeof(int))];
+		struct cmsghdr align;
+	} ctl[EVENT_DAEMON_BATCH];
 	struct cmsghdr *cmh;
-	struct iovec iov[1];
-	char buf[CMSG_SPACE(sizeof(int))];
-	ssize_t n;
-	int *fd_ptr;
-
-	/* set up ancillary data message header */
-	iov[0].iov_base = req;
-	iov[0].iov_len = sizeof(*req);
-	memset(buf, 0, sizeof(buf));
-	mh.msg_name = NULL;
-	mh.msg_namelen = 0;
-	mh.msg_iov = iov;
-	mh.msg_iovlen = sizeof(iov) / sizeof(iov[0]);
-	mh.msg_control = buf;
-	mh.msg_controllen = CMSG_LEN(sizeof(int));
-	mh.msg_flags = 0;
-	cmh = CMSG_FIRSTHDR(&mh);
-	cmh->cmsg_len = CMSG_LEN(sizeof(int));
-	cmh->cmsg_level = SOL_SOCKET;
-	cmh->cmsg_type = SCM_RIGHTS;
-	fd_ptr = (int *)CMSG_DATA(cmh);
-	*fd_ptr = fd;
-	/* send ancillary data */
-	n = sendmsg(conn_socket, &mh, 0);
-	if (n < 0) {
-		OPAE_ERR("sendmsg failed: %s", strerror(errno));
-		return FPGA_EXCEPTION;
+	size_t i, n, sent;
+	int res;
+
+	while (count) {
+		n = (count < EVENT_DAEMON_BATCH) ? count : EVENT_DAEMON_BATCH;
+
+		memset(msgs, 0, n * sizeof(msgs[0]));
+		for (i = 0 ; i < n ; ++i) {
+			iov[i].iov_base = &reqs[i];
+			iov[i].iov_len = sizeof(reqs[i]);
+			msgs[i].msg_hdr.msg_iov = &iov[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+
+			if (fds[i] < 0)
+				continue;
+
+			memset(ctl[i].buf, 0, sizeof(ctl[i].buf));
+			msgs[i].msg_hdr.msg_control = ctl[i].buf;
+			msgs[i].msg_hdr.msg_controllen =
+				CMSG_LEN(sizeof(int));
+			cmh = CMSG_FIRSTHDR(&msgs[i].msg_hdr);
+			cmh->cmsg_len = CMSG_LEN(sizeof(int));
+			cmh->cmsg_level = SOL_SOCKET;
+			cmh->cmsg_type = SCM_RIGHTS;
+			memcpy(CMSG_DATA(cmh), &fds[i], sizeof(int));
+		}
+
+		sent = 0;
+		while (sent < n) {
+			res = sendmmsg(conn, &msgs[sent], n - sent,
+				       MSG_NOSIGNAL);
+			if (res < 0) {
+				if (errno == EINTR)
+					continue;
+				OPAE_ERR("sendmmsg failed: %s",
+					 strerror(errno));
+				return FPGA_EXCEPTION;
+			}
+			sent += res;
+		}
+
+		reqs += n;
+		fds += n;
+		count -= n;
 	}
 
 	return FPGA_OK;
 }
 
+// Called with event_daemon.lock held.
+static void event_daemon_disconnect(void)
+{
+	if (event_daemon.conn >= 0) {
+		close(event_daemon.conn);
+		event_daemon.conn = -1;
+	}
+}
+
+/*
+ * Make sure the shared connection is up, re-establishing it if the daemon
+ * hung up. A new connection starts by replaying every recorded
+ * registration; *fresh tells the caller that this happened.
+ *
+ * Called with event_daemon.lock held.
+ */
+static fpga_result event_daemon_connect(bool *fresh)
+{
+	struct sockaddr_un addr;
+	struct pollfd pfd;
+	struct event_request *reqs;
+	int *fds;
+	fpga_result res;
+	size_t i;
+
+	*fresh = false;
+
+	if (event_daemon.conn >= 0) {
+		// fpgad never writes to the socket: any event is a hangup.
+		pfd.fd = event_daemon.conn;
+		pfd.events = POLLIN | POLLRDHUP;
+		pfd.revents = 0;
+		if (!poll(&pfd, 1, 0))
+			return FPGA_OK;
+		OPAE_MSG("event daemon connection lost, reconnecting");
+		event_daemon_disconnect();
+	}
+
+	event_daemon.conn = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (event_daemon.conn < 0) {
+		OPAE_ERR("socket: %s", strerror(errno));
+		return FPGA_EXCEPTION;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, event_daemon_socket,
+		sizeof(addr.sun_path) - 1);
+
+	if (connect(event_daemon.conn, (struct sockaddr *)&addr,
+		    sizeof(addr)) < 0) {
+		OPAE_DBG("connect: %s", strerror(errno));
+		event_daemon_disconnect();
+		return FPGA_NO_DAEMON;
+	}
+
+	*fresh = true;
+
+	if (!event_daemon.num_regs)
+		return FPGA_OK;
+
+	reqs = malloc(event_daemon.num_regs * sizeof(*reqs));
+	fds = malloc(event_daemon.num_regs * sizeof(*fds));
+	if (!reqs || !fds) {
+		OPAE_ERR("Could not allocate event daemon requests");
+		res = FPGA_NO_MEMORY;
+		goto out_free;
+	}
+
+	for (i = 0 ; i < event_daemon.num_regs ; ++i) {
+		reqs[i].type = REGISTER_EVENT;
+		reqs[i].event = event_daemon.regs[i].event;
+		reqs[i].object_id = event_daemon.regs[i].object_id;
+		fds[i] = event_daemon.regs[i].fd;
+	}
+
+	res = event_daemon_send(event_daemon.conn, reqs, fds,
+				event_daemon.num_regs);
+	if (res == FPGA_OK)
+		OPAE_MSG("replayed %zu event registrations",
+			 event_daemon.num_regs);
+
+out_free:
+	if (res != FPGA_OK)
+		event_daemon_disconnect();
+	free(fds);
+	free(reqs);
+	return res;
+}
+
+/*
+ * Send requests over the shared connection, reconnecting once if sending
+ * fails. If replayed is true, the requests only describe changes already
+ * made to the registry, and a fresh connection (whose replay reflects the
+ * registry) makes sending them unnecessary.
+ *
+ * Called with event_daemon.lock held.
+ */
+static fpga_result event_daemon_submit(struct event_request *reqs,
+				       const int *fds, size_t count,
+				       bool replayed)
+{
+	fpga_result res;
+	bool fresh;
+
+	res = event_daemon_connect(&fresh);
+	if (res != FPGA_OK || (fresh && replayed))
+		return res;
+
+	res = event_daemon_send(event_daemon.conn, reqs, fds, count);
+	if (res == FPGA_OK)
+		return res;
+
+	event_daemon_disconnect();
+
+	res = event_daemon_connect(&fresh);
+	if (res != FPGA_OK || replayed)
+		return res;
+
+	return event_daemon_send(event_daemon.conn, reqs, fds, count);
+}
+
+/*
+ * Drop the registry entry at index and tell the daemon. fpgad identifies a
+ * registration only by its connection, event type and object ID, so when
+ * other handles hold registrations for the same pair, all of them are
+ * unregistered and the survivors are registered again.
+ *
+ * Called with event_daemon.lock held.
+ */
+static fpga_result event_daemon_remove(size_t index)
+{
+	struct event_daemon_registration reg = event_daemon.regs[index];
+	struct event_request *reqs;
+	int *fds;
+	size_t i, n = 0, max;
+	fpga_result res;
+
+	event_daemon.regs[index] =
+		event_daemon.regs[--event_daemon.num_regs];
+
+	max = 1 + 2 * event_daemon.num_regs;
+	reqs = malloc(max * sizeof(*reqs));
+	fds = malloc(max * sizeof(*fds));
+	if (!reqs || !fds) {
+		OPAE_ERR("Could not allocate event daemon requests");
+		res = FPGA_NO_MEMORY;
+		goto out_free;
+	}
+
+	reqs[n].type = UNREGISTER_EVENT;
+	reqs[n].event = reg.event;
+	reqs[n].object_id = reg.object_id;
+	fds[n++] = -1;
+
+	for (i = 0 ; i < event_daemon.num_regs ; ++i) {
+		if (event_daemon.regs[i].event != reg.event ||
+		    event_daemon.regs[i].object_id != reg.object_id)
+			continue;
+		reqs[n] = reqs[0];
+		fds[n++] = -1;
+	}
+
+	for (i = 0 ; i < event_daemon.num_regs ; ++i) {
+		if (event_daemon.regs[i].event != reg.event ||
+		    event_daemon.regs[i].object_id != reg.object_id)
+			continue;
+		reqs[n].type = REGISTER_EVENT;
+		reqs[n].event = reg.event;
+		reqs[n].object_id = reg.object_id;
+		fds[n++] = event_daemon.regs[i].fd;
+	}
+
+	res = event_daemon_submit(reqs, fds, n, true);
+
+	// Without a daemon there is nothing left to unregister.
+	if (res == FPGA_NO_DAEMON)
+		res = FPGA_OK;
+
+out_free:
+	free(fds);
+	free(reqs);
+	close(reg.fd);
+	return res;
+}
+
+fpga_result event_daemon_register(fpga_handle handle, uint64_t object_id,
+				  fpga_event_type event_type, int fd)
+{
+	struct event_daemon_registration *regs;
+	struct event_request req;
+	fpga_result res;
+	size_t max;
+	int dupfd;
+	int err;
+
+	dupfd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+	if (dupfd < 0) {
+		OPAE_ERR("fcntl: %s", strerror(errno));
+		return FPGA_EXCEPTION;
+	}
+
+	err = pthread_mutex_lock(&event_daemon.lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_lock() failed: %s", strerror(err));
+		close(dupfd);
+		return FPGA_EXCEPTION;
+	}
+
+	if (event_daemon.num_regs == event_daemon.max_regs) {
+		max = event_daemon.max_regs ? 2 * event_daemon.max_regs : 16;
+		regs = realloc(event_daemon.regs, max * sizeof(*regs));
+		if (!regs) {
+			OPAE_ERR("Could not allocate event registrations");
+			res = FPGA_NO_MEMORY;
+			goto out_unlock;
+		}
+		event_daemon.regs = regs;
+		event_daemon.max_regs = max;
+	}
+
+	req.type = REGISTER_EVENT;
+	req.event = event_type;
+	req.object_id = object_id;
+
+	res = event_daemon_submit(&req, &dupfd, 1, false);
+	if (res != FPGA_OK)
+		goto out_unlock;
+
+	regs = &event_daemon.regs[event_daemon.num_regs++];
+	regs->handle = handle;
+	regs->object_id = object_id;
+	regs->event = event_type;
+	regs->fd = dupfd;
+	dupfd = -1;
+
+out_unlock:
+	err = pthread_mutex_unlock(&event_daemon.lock);
+	if (err)
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	if (dupfd >= 0)
+		close(dupfd);
+	return res;
+}
+
+fpga_result event_daemon_unregister(fpga_handle handle,
+				    fpga_event_type event_type)
+{
+	fpga_result res = FPGA_INVALID_PARAM;
+	size_t i;
+	int err;
+
+	err = pthread_mutex_lock(&event_daemon.lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_lock() failed: %s", strerror(err));
+		return FPGA_EXCEPTION;
+	}
+
+	for (i = 0 ; i < event_daemon.num_regs ; ++i) {
+		if (event_daemon.regs[i].handle == handle &&
+		    event_daemon.regs[i].event == event_type) {
+			res = event_daemon_remove(i);
+			break;
+		}
+	}
+
+	if (res == FPGA_INVALID_PARAM)
+		OPAE_MSG("No fpgad registration for event");
+
+	err = pthread_mutex_unlock(&event_daemon.lock);
+	if (err)
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	return res;
+}
+
+void event_daemon_release(fpga_handle handle)
+{
+	size_t i = 0;
+	int err;
+
+	err = pthread_mutex_lock(&event_daemon.lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_lock() failed: %s", strerror(err));
+		return;
+	}
+
+	while (i < event_daemon.num_regs) {
+		if (event_daemon.regs[i].handle == handle)
+			event_daemon_remove(i); // refills slot i
+		else
+			++i;
+	}
+
+	err = pthread_mutex_unlock(&event_daemon.lock);
+	if (err)
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+}
+
+void event_daemon_finalize(void)
+{
+	size_t i;
+	int err;
+
+	err = pthread_mutex_lock(&event_daemon.lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_lock() failed: %s", strerror(err));
+		return;
+	}
+
+	event_daemon_disconnect();
+
+	for (i = 0 ; i < event_daemon.num_regs ; ++i)
+		close(event_daemon.regs[i].fd);
+	free(event_daemon.regs);
+	event_daemon.regs = NULL;
+	event_daemon.num_regs = 0;
+	event_daemon.max_regs = 0;
+
+	err = pthread_mutex_unlock(&event_daemon.lock);
+	if (err)
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+}
+
 STATIC fpga_result send_fme_event_request(fpga_handle handle,
 					  fpga_event_handle event_handle,
 					  int fme_operation)
@@ -459,128 +846,38 @@ STATIC fpga_result daemon_register_event(fpga_handle handle,
 {
 	int fd = FILE_DESCRIPTOR(event_handle);
 	fpga_result result = FPGA_OK;
-	struct sockaddr_un addr;
-	struct event_request req;
-	struct _fpga_handle *_handle = (struct _fpga_handle *)handle;
 	fpga_properties prop = NULL;
 	uint64_t object_id = (uint64_t) -1;
 
 	UNUSED_PARAM(flags);
 
-	if (_handle->fdfpgad < 0) {
-
-		/* connect to event socket */
-		_handle->fdfpgad = socket(AF_UNIX, SOCK_STREAM, 0);
-		if (_handle->fdfpgad < 0) {
-			OPAE_ERR("socket: %s", strerror(errno));
-			return FPGA_EXCEPTION;
-		}
-
-		addr.sun_family = AF_UNIX;
-		strncpy(addr.sun_path, EVENT_SOCKET_NAME,
-			EVENT_SOCKET_NAME_LEN);
-
-		if (connect(_handle->fdfpgad, (struct sockaddr *)&addr,
-			    sizeof(addr))
-		    < 0) {
-			OPAE_DBG("connect: %s", strerror(errno));
-			result = FPGA_NO_DAEMON;
-			goto out_close_conn;
-		}
-	}
-
 	/* get the requestor's object ID */
 	result = xfpga_fpgaGetPropertiesFromHandle(handle, &prop);
 	if (result != FPGA_OK) {
 		OPAE_ERR("failed to get props");
-		goto out_close_conn;
+		return result;
 	}
 
 	result = fpgaPropertiesGetObjectID(prop, &object_id);
 	if (result != FPGA_OK) {
 		fpgaDestroyProperties(&prop);
 		OPAE_ERR("failed to get object ID");
-		goto out_close_conn;
+		return result;
 	}
 
 	result = fpgaDestroyProperties(&prop);
 	if (result != FPGA_OK) {
 		OPAE_ERR("failed to destroy props");
-		goto out_close_conn;
-	}
-
-	/* create event registration request */
-	req.type = REGISTER_EVENT;
-	req.event = event_type;
-	req.object_id = object_id;
-
-	/* send event packet */
-	result = send_event_request(_handle->fdfpgad, fd, &req);
-	if (result != FPGA_OK) {
-		OPAE_ERR("send_event_request failed");
-		goto out_close_conn;
+		return result;
 	}
 
-	return result;
-
-out_close_conn:
-	close(_handle->fdfpgad);
-	_handle->fdfpgad = -1;
-	return result;
+	return event_daemon_register(handle, object_id, event_type, fd);
 }
 
 STATIC fpga_result daemon_unregister_event(fpga_handle handle,
 					   fpga_event_type event_type)
 {
-	fpga_result result = FPGA_OK;
-	struct _fpga_handle *_handle = (struct _fpga_handle *)handle;
-	struct event_request req;
-	ssize_t n;
-	fpga_properties prop = NULL;
-	uint64_t object_id = (uint64_t) -1;
-
-	if (_handle->fdfpgad < 0) {
-		OPAE_MSG("No fpgad connection");
-		return FPGA_INVALID_PARAM;
-	}
-
-	/* get the requestor's object ID */
-	result = xfpga_fpgaGetPropertiesFromHandle(handle, &prop);
-	if (result != FPGA_OK) {
-		OPAE_ERR("failed to get properties");
-		goto out_close_conn;
-	}
-
-	result = fpgaPropertiesGetObjectID(prop, &object_id);
-	if (result != FPGA_OK) {
-		fpgaDestroyProperties(&prop);
-		OPAE_ERR("failed to get object ID");
-		goto out_close_conn;
-	}
-
-	result = fpgaDestroyProperties(&prop);
-	if (result != FPGA_OK) {
-		OPAE_ERR("failed to destroy properties");
-		goto out_close_conn;
-	}
-
-	req.type = UNREGISTER_EVENT;
-	req.event = event_type;
-	req.object_id = object_id;
-
-	n = send(_handle->fdfpgad, &req, sizeof(req), 0);
-	if (n < 0) {
-		OPAE_ERR("send : %s", strerror(errno));
-		result = FPGA_EXCEPTION;
-		goto out_close_conn;
-	}
-
-	return result;
-
-out_close_conn:
-	close(_handle->fdfpgad);
-	_handle->fdfpgad = -1;
-	return result;
+	return event_daemon_unregister(handle, event_type);
 }
 
 fpga_result __XFPGA_API__
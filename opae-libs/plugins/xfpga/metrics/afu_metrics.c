@@ -130,10 +130,8 @@ fpga_result get_afu_metric_value(fpga_handle handle,
 				struct fpga_metric *fpga_metric)
 {
 	fpga_result result                           = FPGA_OK;
-	uint64_t index                               = 0;
 	struct metric_bbb_value metric_csr;
 	struct _fpga_enum_metric *_fpga_enum_metric  = NULL;
-	uint64_t num_enun_metrics                    = 0;
 
 	if (handle == NULL ||
 		enum_vector == NULL ||
@@ -144,28 +142,18 @@ fpga_result get_afu_metric_value(fpga_handle handle,
 
 	memset(&metric_csr, 0, sizeof(metric_csr));
 
-	result = fpga_vector_total(enum_vector, &num_enun_metrics);
-	if (result != FPGA_OK) {
-		OPAE_ERR("Failed to get metric total");
+	_fpga_enum_metric = find_fpga_enum_metric((struct _fpga_handle *)handle,
+						  enum_vector,
+						  metric_num);
+	if (_fpga_enum_metric == NULL)
 		return FPGA_NOT_FOUND;
-	}
-
-	result = FPGA_NOT_FOUND;
-	for (index = 0; index < num_enun_metrics; index++) {
-
-		_fpga_enum_metric = (struct _fpga_enum_metric *)	fpga_vector_get(enum_vector, index);
-
-		if (metric_num == _fpga_enum_metric->metric_num) {
-
-			result = xfpga_fpgaReadMMIO64(handle, 0, _fpga_enum_metric->mmio_offset, &metric_csr.csr);
-			if (result != FPGA_OK) {
-				OPAE_ERR("Failed to get metric");
-				break;
-			}
-			fpga_metric->value.ivalue = metric_csr.value;
-		}
 
+	result = xfpga_fpgaReadMMIO64(handle, 0, _fpga_enum_metric->mmio_offset, &metric_csr.csr);
+	if (result != FPGA_OK) {
+		OPAE_ERR("Failed to get metric");
+		return result;
 	}
+	fpga_metric->value.ivalue = metric_csr.value;
 
 	return result;
 }
@@ -0,0 +1,182 @@
+// Copyright(c) 2020, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif // HAVE_CONFIG_H
+
+/**
+* \file metric_index.c
+* \brief case-insensitive metric name index
+*
+* Open-addressed hash table keyed on qualifier:name, compared without
+* regard to case, so that name lookups don't walk the metric vector.
+*/
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "metric_index.h"
+
+#define FNV_OFFSET_BASIS 0x811c9dc5u
+#define FNV_PRIME        0x01000193u
+
+static uint32_t metric_index_hash_str(uint32_t h, const char *s)
+{
+	while (*s) {
+		h ^= (uint8_t)tolower((unsigned char)*s++);
+		h *= FNV_PRIME;
+	}
+	return h;
+}
+
+static uint32_t metric_index_hash(const char *qualifier, const char *name)
+{
+	uint32_t h = FNV_OFFSET_BASIS;
+
+	if (qualifier) {
+		h = metric_index_hash_str(h, qualifier);
+		h ^= (uint8_t)':';
+		h *= FNV_PRIME;
+	}
+	return metric_index_hash_str(h, name);
+}
+
+static int metric_index_match(const struct metric_index_entry *e,
+			      uint32_t hash,
+			      const char *qualifier,
+			      const char *name)
+{
+	if (e->hash != hash)
+		return 0;
+	if ((e->qualifier == NULL) != (qualifier == NULL))
+		return 0;
+	if (qualifier && strcasecmp(e->qualifier, qualifier))
+		return 0;
+	return !strcasecmp(e->name, name);
+}
+
+fpga_result metric_index_init(metric_index *index, uint64_t capacity)
+{
+	uint64_t size = 16;
+
+	if (index == NULL)
+		return FPGA_INVALID_PARAM;
+
+	// Keep the load factor at or below 1/2.
+	while (size < capacity * 2)
+		size <<= 1;
+
+	index->entries = calloc(size, sizeof(struct metric_index_entry));
+	if (index->entries == NULL) {
+		index->size = index->count = 0;
+		return FPGA_NO_MEMORY;
+	}
+
+	index->size = size;
+	index->count = 0;
+
+	return FPGA_OK;
+}
+
+void metric_index_free(metric_index *index)
+{
+	if (index == NULL)
+		return;
+
+	free(index->entries);
+	index->entries = NULL;
+	index->size = index->count = 0;
+}
+
+fpga_result metric_index_add(metric_index *index,
+			const char *qualifier,
+			const char *name,
+			uint64_t slot)
+{
+	struct metric_index_entry *e;
+	uint32_t hash;
+	uint64_t i;
+
+	if (index == NULL ||
+	    name == NULL)
+		return FPGA_INVALID_PARAM;
+
+	if (!index->size || (index->count + 1) * 2 > index->size)
+		return FPGA_NO_MEMORY;
+
+	hash = metric_index_hash(qualifier, name);
+
+	for (i = hash & (index->size - 1) ; ;
+	     i = (i + 1) & (index->size - 1)) {
+		e = &index->entries[i];
+		if (!e->name)
+			break;
+		if (metric_index_match(e, hash, qualifier, name))
+			return FPGA_OK;
+	}
+
+	e->qualifier = qualifier;
+	e->name = name;
+	e->slot = slot;
+	e->hash = hash;
+	++index->count;
+
+	return FPGA_OK;
+}
+
+fpga_result metric_index_find(const metric_index *index,
+			const char *qualifier,
+			const char *name,
+			uint64_t *slot)
+{
+	const struct metric_index_entry *e;
+	uint32_t hash;
+	uint64_t i;
+
+	if (index == NULL ||
+	    name == NULL ||
+	    slot == NULL)
+		return FPGA_INVALID_PARAM;
+
+	if (!index->size)
+		return FPGA_NOT_FOUND;
+
+	hash = metric_index_hash(qualifier, name);
+
+	for (i = hash & (index->size - 1) ; ;
+	     i = (i + 1) & (index->size - 1)) {
+		e = &index->entries[i];
+		if (!e->name)
+			return FPGA_NOT_FOUND;
+		if (metric_index_match(e, hash, qualifier, name)) {
+			*slot = e->slot;
+			return FPGA_OK;
+		}
+	}
+}
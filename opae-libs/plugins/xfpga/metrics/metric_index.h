@@ -0,0 +1,68 @@
+// Copyright(c) 2020, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+/**
+* \file metric_index.h
+* \brief case-insensitive metric name index
+*/
+
+#ifndef __FPGA_METRICS_INDEX_H__
+#define __FPGA_METRICS_INDEX_H__
+
+#include <stdint.h>
+#include <opae/types.h>
+
+// Key strings are borrowed; they must outlive the index.
+struct metric_index_entry {
+	const char *qualifier;  // NULL for unqualified keys
+	const char *name;       // NULL marks an empty slot
+	uint64_t slot;
+	uint32_t hash;
+};
+
+typedef struct metric_index {
+	struct metric_index_entry *entries;
+	uint64_t size;          // power of two, 0 until initialized
+	uint64_t count;
+} metric_index;
+
+
+fpga_result metric_index_init(metric_index *index, uint64_t capacity);
+
+void metric_index_free(metric_index *index);
+
+// Adds qualifier:name -> slot. The first slot added for a key is kept.
+fpga_result metric_index_add(metric_index *index,
+			const char *qualifier,
+			const char *name,
+			uint64_t slot);
+
+fpga_result metric_index_find(const metric_index *index,
+			const char *qualifier,
+			const char *name,
+			uint64_t *slot);
+
+#endif // __FPGA_METRICS_INDEX_H__
@@ -35,11 +35,13 @@
 
 #include "opae/access.h"
 #include "opae/utils.h"
+#include "xfpga.h"
 #include "common_int.h"
 #include "types_int.h"
 #include "opae/metrics.h"
 #include "metrics/vector.h"
 #include "metrics/metrics_int.h"
+#include "metrics/metrics_max10.h"
 
 //Wrong search string invalid array index
 #define METRIC_ARRAY_INVALID_INDEX     0xFFFFFF
@@ -345,8 +347,8 @@ fpga_result __XFPGA_API__ xfpga_fpgaGetMetricsByName(fpga_handle handle,
 	if (objtype == FPGA_ACCELERATOR) {
 		// get AFU metrics
 		for (i = 0; i < num_metric_names; i++) {
-			result = parse_metric_num_name(metrics_names[i],
-							&(_handle->fpga_enum_metric_vector),
+			result = find_metric_num_name(_handle,
+							metrics_names[i],
 							&metric_num);
 			if (result != FPGA_OK) {
 				OPAE_MSG("Invalid input metrics string= %s", metrics_names[i]);
@@ -377,8 +379,8 @@ fpga_result __XFPGA_API__ xfpga_fpgaGetMetricsByName(fpga_handle handle,
 		// get FME metrics
 		for (i = 0; i < num_metric_names; i++) {
 
-			result = parse_metric_num_name(metrics_names[i],
-							&(_handle->fpga_enum_metric_vector),
+			result = find_metric_num_name(_handle,
+							metrics_names[i],
 							&metric_num);
 			if (result != FPGA_OK) {
 				OPAE_ERR("Invalid input metrics string= %s", metrics_names[i]);
@@ -420,3 +422,313 @@ out_unlock:
 	}
 	return result;
 }
+
+STATIC bool is_bmc_metric(const struct _fpga_enum_metric *_enum_metric)
+{
+	return _enum_metric->hw_type == FPGA_HW_DCP_RC &&
+		(_enum_metric->metric_type == FPGA_METRIC_TYPE_POWER ||
+		_enum_metric->metric_type == FPGA_METRIC_TYPE_THERMAL);
+}
+
+STATIC bool is_max10_metric(const struct _fpga_enum_metric *_enum_metric)
+{
+	return (_enum_metric->hw_type == FPGA_HW_DCP_N3000 ||
+		_enum_metric->hw_type == FPGA_HW_DCP_D5005) &&
+		(_enum_metric->metric_type == FPGA_METRIC_TYPE_POWER ||
+		_enum_metric->metric_type == FPGA_METRIC_TYPE_THERMAL);
+}
+
+// Loads the BMC SDRs once and maps each BMC metric to its sensor number.
+STATIC fpga_result metrics_session_bind_bmc(struct _fpga_metrics_session *_session)
+{
+	fpga_result result         = FPGA_OK;
+	uint32_t num_sensors       = 0;
+	uint32_t num_values        = 0;
+	uint32_t x                 = 0;
+	uint64_t i                 = 0;
+	bmc_values_handle values;
+	sdr_details details;
+
+	result = xfpga_bmcLoadSDRs(_session->handle, &_session->bmc_records,
+				&num_sensors);
+	if (result != FPGA_OK) {
+		OPAE_ERR("Failed to load BMC SDR.");
+		_session->bmc_records = NULL;
+		return result;
+	}
+
+	result = xfpga_bmcReadSensorValues(_session->handle, _session->bmc_records,
+				&values, &num_values);
+	if (result != FPGA_OK) {
+		OPAE_ERR("Failed to read BMC sensor values.");
+		return result;
+	}
+
+	for (x = 0; x < num_sensors; x++) {
+
+		if (xfpga_bmcGetSDRDetails(_session->handle, values, x, &details) != FPGA_OK) {
+			OPAE_MSG("Failed to get SDR details.");
+			continue;
+		}
+
+		for (i = 0; i < _session->num_metrics; i++) {
+			if (_session->enum_metrics[i] &&
+				is_bmc_metric(_session->enum_metrics[i]) &&
+				!strcasecmp(details.name, _session->enum_metrics[i]->metric_name))
+				_session->bmc_sensor[i] = (int32_t)x;
+		}
+	}
+
+	result = xfpga_bmcDestroySensorValues(_session->handle, &values);
+	if (result != FPGA_OK) {
+		OPAE_MSG("Failed to Destroy Sensor value.");
+	}
+
+	return FPGA_OK;
+}
+
+STATIC void metrics_session_free(struct _fpga_metrics_session *_session)
+{
+	if (_session->bmc_records &&
+		xfpga_bmcDestroySDRs(_session->handle, &_session->bmc_records) != FPGA_OK) {
+		OPAE_ERR("Failed to Destroy SDR.");
+	}
+
+	free(_session->bmc_sensor);
+	free(_session->enum_metrics);
+	free(_session->metric_num);
+	free(_session);
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaCreateMetricsSession(fpga_handle handle,
+						const uint64_t *metric_num,
+						uint64_t num_metric_indexes,
+						fpga_metrics_session *session)
+{
+	fpga_result result                         = FPGA_OK;
+	struct _fpga_handle *_handle               = (struct _fpga_handle *)handle;
+	struct _fpga_metrics_session *_session     = NULL;
+	struct _fpga_enum_metric *_enum_metric     = NULL;
+	uint64_t found                             = 0;
+	uint64_t i                                 = 0;
+	bool bmc                                   = false;
+	int err                                    = 0;
+
+	if (_handle == NULL) {
+		OPAE_ERR("NULL fpga handle");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if (metric_num == NULL ||
+		session == NULL ||
+		num_metric_indexes == 0) {
+		OPAE_ERR("Invalid Input parameters");
+		return FPGA_INVALID_PARAM;
+	}
+
+	result = handle_check_and_lock(_handle);
+	if (result)
+		return result;
+
+	if (_handle->fddev < 0) {
+		OPAE_ERR("Invalid handle file descriptor");
+		result = FPGA_INVALID_PARAM;
+		goto out_unlock;
+	}
+
+	result = enum_fpga_metrics(handle);
+	if (result != FPGA_OK) {
+		OPAE_ERR("Failed to Discover Metrics");
+		result = FPGA_NOT_FOUND;
+		goto out_unlock;
+	}
+
+	_session = calloc(1, sizeof(struct _fpga_metrics_session));
+	if (_session == NULL) {
+		OPAE_ERR("Failed to allocate memory");
+		result = FPGA_NO_MEMORY;
+		goto out_unlock;
+	}
+
+	_session->handle = _handle;
+	_session->num_metrics = num_metric_indexes;
+	_session->metric_num = calloc(num_metric_indexes, sizeof(uint64_t));
+	_session->enum_metrics = calloc(num_metric_indexes,
+					sizeof(struct _fpga_enum_metric *));
+	_session->bmc_sensor = calloc(num_metric_indexes, sizeof(int32_t));
+	if (_session->metric_num == NULL ||
+		_session->enum_metrics == NULL ||
+		_session->bmc_sensor == NULL) {
+		OPAE_ERR("Failed to allocate memory");
+		result = FPGA_NO_MEMORY;
+		goto out_free;
+	}
+
+	// resolve each index once, so sampling needs no vector search
+	for (i = 0; i < num_metric_indexes; i++) {
+
+		_session->metric_num[i] = metric_num[i];
+		_session->bmc_sensor[i] = -1;
+
+		_enum_metric = find_fpga_enum_metric(_handle,
+				&(_handle->fpga_enum_metric_vector),
+				metric_num[i]);
+		if (_enum_metric) {
+			_session->enum_metrics[i] = _enum_metric;
+			bmc = bmc || is_bmc_metric(_enum_metric);
+			found++;
+		}
+
+		if (_session->enum_metrics[i] == NULL)
+			OPAE_MSG("Metric not found at Index = %ld", metric_num[i]);
+	}
+
+	if (found == 0) {
+		result = FPGA_NOT_FOUND;
+		goto out_free;
+	}
+
+	if (bmc) {
+		result = metrics_session_bind_bmc(_session);
+		if (result != FPGA_OK)
+			goto out_free;
+	}
+
+	*session = (fpga_metrics_session)_session;
+	goto out_unlock;
+
+out_free:
+	metrics_session_free(_session);
+
+out_unlock:
+	err = pthread_mutex_unlock(&_handle->lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+
+	return result;
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaSampleMetricsSession(fpga_metrics_session session,
+						fpga_metric *metrics)
+{
+	fpga_result result                         = FPGA_OK;
+	struct _fpga_metrics_session *_session     = (struct _fpga_metrics_session *)session;
+	struct _fpga_enum_metric *_enum_metric     = NULL;
+	struct _fpga_handle *_handle               = NULL;
+	bmc_values_handle values                   = NULL;
+	struct metric_bbb_value metric_csr;
+	uint32_t num_values                        = 0;
+	uint32_t is_valid                          = 0;
+	uint64_t found                             = 0;
+	uint64_t i                                 = 0;
+	int err                                    = 0;
+
+	if (_session == NULL ||
+		metrics == NULL) {
+		OPAE_ERR("Invalid Input parameters");
+		return FPGA_INVALID_PARAM;
+	}
+
+	_handle = _session->handle;
+
+	result = handle_check_and_lock(_handle);
+	if (result)
+		return result;
+
+	// one BMC transaction covers every BMC sensor in the session
+	if (_session->bmc_records &&
+		xfpga_bmcReadSensorValues(_handle, _session->bmc_records,
+			&values, &num_values) != FPGA_OK) {
+		OPAE_MSG("Failed to read BMC sensor values.");
+		values = NULL;
+	}
+
+	for (i = 0; i < _session->num_metrics; i++) {
+
+		_enum_metric = _session->enum_metrics[i];
+		metrics[i].metric_num = _session->metric_num[i];
+		metrics[i].isvalid = false;
+
+		if (_enum_metric == NULL)
+			continue;
+
+		memset(&metrics[i].value, 0, sizeof(metrics[i].value));
+
+		if (_enum_metric->metric_type == FPGA_METRIC_TYPE_AFU) {
+
+			metric_csr.csr = 0;
+			result = xfpga_fpgaReadMMIO64((fpga_handle)_handle, 0,
+				_enum_metric->mmio_offset, &metric_csr.csr);
+			if (result == FPGA_OK) {
+				metrics[i].value.ivalue = metric_csr.value;
+				metrics[i].isvalid = true;
+			}
+
+		} else if (is_bmc_metric(_enum_metric)) {
+
+			if (values && _session->bmc_sensor[i] >= 0) {
+				result = xfpga_bmcGetSensorReading(_handle, values,
+					(uint32_t)_session->bmc_sensor[i],
+					&is_valid, &metrics[i].value.dvalue);
+				metrics[i].isvalid = (result == FPGA_OK) && is_valid;
+			}
+
+		} else if (is_max10_metric(_enum_metric)) {
+
+			result = read_max10_value(_enum_metric, &metrics[i].value.dvalue);
+			metrics[i].isvalid = (result == FPGA_OK);
+		}
+
+		if (metrics[i].isvalid)
+			found++;
+		else
+			OPAE_MSG("Failed to get metric value  at Index = %ld",
+				_session->metric_num[i]);
+	}
+
+	if (values &&
+		xfpga_bmcDestroySensorValues(_handle, &values) != FPGA_OK) {
+		OPAE_MSG("Failed to Destroy Sensor value.");
+	}
+
+	result = found ? FPGA_OK : FPGA_NOT_FOUND;
+
+	err = pthread_mutex_unlock(&_handle->lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+
+	return result;
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaDestroyMetricsSession(fpga_metrics_session *session)
+{
+	struct _fpga_metrics_session *_session = NULL;
+	struct _fpga_handle *_handle           = NULL;
+	fpga_result result                     = FPGA_OK;
+	int err                                = 0;
+
+	if (session == NULL ||
+		*session == NULL) {
+		OPAE_ERR("Invalid Input parameters");
+		return FPGA_INVALID_PARAM;
+	}
+
+	_session = (struct _fpga_metrics_session *)*session;
+	_handle = _session->handle;
+
+	result = handle_check_and_lock(_handle);
+	if (result)
+		return result;
+
+	metrics_session_free(_session);
+	*session = NULL;
+
+	err = pthread_mutex_unlock(&_handle->lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+
+	return FPGA_OK;
+}
@@ -0,0 +1,356 @@
+// Copyright(c) 2020, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+/**
+* \file metrics_collector.c
+* \brief background metrics sampling into a lock-free ring
+*
+* A collector thread samples a metrics session at a fixed period and
+* publishes each sample into a ring of slots. Each slot carries a
+* sequence word (odd while being written, 2 * (n + 1) once sample n is
+* complete) so that any number of readers can copy samples out without
+* taking a lock: a copy is good if the slot's sequence was the expected
+* even value both before and after it.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif // HAVE_CONFIG_H
+
+#include <errno.h>
+#include <time.h>
+
+#include "xfpga.h"
+#include "common_int.h"
+#include "types_int.h"
+#include "opae/metrics.h"
+#include "metrics/metrics_int.h"
+
+#define METRICS_COLLECTOR_DEFAULT_DEPTH 64
+#define METRICS_COLLECTOR_MAX_DEPTH     65536
+#define METRICS_COLLECTOR_MIN_PERIOD    100 // usec
+
+static inline uint64_t collector_slot_done(uint64_t sample)
+{
+	return 2 * (sample + 1);
+}
+
+// Copies sample n out of the ring. Returns false if it was overwritten
+// (or is being overwritten) by a later sample.
+STATIC bool collector_copy_sample(struct _fpga_metrics_collector *c,
+				  uint64_t sample,
+				  fpga_metric *metrics)
+{
+	uint64_t slot = sample & (c->depth - 1);
+	uint64_t seq;
+
+	seq = __atomic_load_n(&c->slot_seq[slot], __ATOMIC_ACQUIRE);
+	if (seq != collector_slot_done(sample))
+		return false;
+
+	memcpy(metrics, &c->samples[slot * c->num_metrics],
+	       c->num_metrics * sizeof(fpga_metric));
+
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+	return __atomic_load_n(&c->slot_seq[slot], __ATOMIC_RELAXED) == seq;
+}
+
+STATIC void collector_publish(struct _fpga_metrics_collector *c)
+{
+	uint64_t sample = c->head;
+	uint64_t slot = sample & (c->depth - 1);
+
+	__atomic_store_n(&c->slot_seq[slot], collector_slot_done(sample) - 1,
+			 __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	memcpy(&c->samples[slot * c->num_metrics], c->scratch,
+	       c->num_metrics * sizeof(fpga_metric));
+
+	__atomic_store_n(&c->slot_seq[slot], collector_slot_done(sample),
+			 __ATOMIC_RELEASE);
+	__atomic_store_n(&c->head, sample + 1, __ATOMIC_RELEASE);
+}
+
+static void collector_deadline(struct timespec *ts, uint64_t usec)
+{
+	ts->tv_sec += usec / 1000000;
+	ts->tv_nsec += (usec % 1000000) * 1000;
+	if (ts->tv_nsec >= 1000000000) {
+		ts->tv_sec++;
+		ts->tv_nsec -= 1000000000;
+	}
+}
+
+STATIC void *collector_thread(void *arg)
+{
+	struct _fpga_metrics_collector *c = (struct _fpga_metrics_collector *)arg;
+	struct timespec next;
+	struct timespec now;
+	int err;
+
+	clock_gettime(CLOCK_MONOTONIC, &next);
+
+	pthread_mutex_lock(&c->lock);
+	while (!c->stop) {
+		pthread_mutex_unlock(&c->lock);
+
+		// the session takes the handle lock; readers never do
+		xfpga_fpgaSampleMetricsSession(c->session, c->scratch);
+		collector_publish(c);
+
+		collector_deadline(&next, c->period_usec);
+
+		// don't burst to catch up after a sample that overran the period
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		if (now.tv_sec > next.tv_sec ||
+		    (now.tv_sec == next.tv_sec && now.tv_nsec > next.tv_nsec))
+			next = now;
+
+		pthread_mutex_lock(&c->lock);
+		do {
+			err = pthread_cond_timedwait(&c->wake, &c->lock, &next);
+		} while (!c->stop && err != ETIMEDOUT);
+	}
+	pthread_mutex_unlock(&c->lock);
+
+	return NULL;
+}
+
+STATIC void collector_free(struct _fpga_metrics_collector *c)
+{
+	if (c->session &&
+	    xfpga_fpgaDestroyMetricsSession(&c->session) != FPGA_OK)
+		OPAE_MSG("Failed to destroy metrics session");
+
+	free(c->scratch);
+	free(c->samples);
+	free(c->slot_seq);
+	free(c);
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaCreateMetricsCollector(fpga_handle handle,
+					const uint64_t *metric_num,
+					uint64_t num_metric_indexes,
+					uint32_t period_usec,
+					uint32_t depth,
+					fpga_metrics_collector *collector)
+{
+	fpga_result result                    = FPGA_OK;
+	struct _fpga_metrics_collector *c     = NULL;
+	pthread_condattr_t cattr;
+	uint32_t size                         = 1;
+	int err                               = 0;
+
+	if (handle == NULL ||
+		metric_num == NULL ||
+		num_metric_indexes == 0 ||
+		collector == NULL) {
+		OPAE_ERR("Invalid Input parameters");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if (depth == 0)
+		depth = METRICS_COLLECTOR_DEFAULT_DEPTH;
+
+	if (depth > METRICS_COLLECTOR_MAX_DEPTH) {
+		OPAE_ERR("Collector depth %u exceeds %u", depth,
+			 METRICS_COLLECTOR_MAX_DEPTH);
+		return FPGA_INVALID_PARAM;
+	}
+
+	while (size < depth)
+		size <<= 1;
+
+	if (period_usec < METRICS_COLLECTOR_MIN_PERIOD)
+		period_usec = METRICS_COLLECTOR_MIN_PERIOD;
+
+	c = calloc(1, sizeof(struct _fpga_metrics_collector));
+	if (c == NULL) {
+		OPAE_ERR("Failed to allocate memory");
+		return FPGA_NO_MEMORY;
+	}
+
+	c->num_metrics = num_metric_indexes;
+	c->depth = size;
+	c->period_usec = period_usec;
+	c->slot_seq = calloc(size, sizeof(uint64_t));
+	c->samples = calloc(size * num_metric_indexes, sizeof(fpga_metric));
+	c->scratch = calloc(num_metric_indexes, sizeof(fpga_metric));
+	if (c->slot_seq == NULL ||
+		c->samples == NULL ||
+		c->scratch == NULL) {
+		OPAE_ERR("Failed to allocate memory");
+		result = FPGA_NO_MEMORY;
+		goto out_free;
+	}
+
+	result = xfpga_fpgaCreateMetricsSession(handle, metric_num,
+						num_metric_indexes, &c->session);
+	if (result != FPGA_OK) {
+		OPAE_ERR("Failed to create metrics session");
+		goto out_free;
+	}
+
+	// the wait deadline is on CLOCK_MONOTONIC, immune to clock changes
+	if (pthread_condattr_init(&cattr)) {
+		OPAE_ERR("Failed to init collector condition");
+		result = FPGA_EXCEPTION;
+		goto out_free;
+	}
+	err = pthread_condattr_setclock(&cattr, CLOCK_MONOTONIC);
+	if (!err)
+		err = pthread_cond_init(&c->wake, &cattr);
+	pthread_condattr_destroy(&cattr);
+	if (err) {
+		OPAE_ERR("Failed to init collector condition");
+		result = FPGA_EXCEPTION;
+		goto out_free;
+	}
+
+	if (pthread_mutex_init(&c->lock, NULL)) {
+		OPAE_ERR("Failed to init collector mutex");
+		result = FPGA_EXCEPTION;
+		goto out_destroy_cond;
+	}
+
+	err = pthread_create(&c->thread, NULL, collector_thread, c);
+	if (err) {
+		OPAE_ERR("pthread_create() failed: %s", strerror(err));
+		result = FPGA_EXCEPTION;
+		goto out_destroy_mutex;
+	}
+
+	*collector = (fpga_metrics_collector)c;
+	return FPGA_OK;
+
+out_destroy_mutex:
+	pthread_mutex_destroy(&c->lock);
+out_destroy_cond:
+	pthread_cond_destroy(&c->wake);
+out_free:
+	collector_free(c);
+	return result;
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaReadLatestMetrics(fpga_metrics_collector collector,
+					fpga_metric *metrics,
+					uint64_t *sequence)
+{
+	struct _fpga_metrics_collector *c = (struct _fpga_metrics_collector *)collector;
+	uint64_t head;
+
+	if (c == NULL ||
+		metrics == NULL) {
+		OPAE_ERR("Invalid Input parameters");
+		return FPGA_INVALID_PARAM;
+	}
+
+	// retry until a copy is not torn by the collector lapping us
+	do {
+		head = __atomic_load_n(&c->head, __ATOMIC_ACQUIRE);
+		if (head == 0)
+			return FPGA_NOT_FOUND;
+	} while (!collector_copy_sample(c, head - 1, metrics));
+
+	if (sequence)
+		*sequence = head - 1;
+
+	return FPGA_OK;
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaReadMetricsHistory(fpga_metrics_collector collector,
+					uint64_t *cursor,
+					fpga_metric *metrics,
+					uint64_t max_samples,
+					uint64_t *num_samples)
+{
+	struct _fpga_metrics_collector *c = (struct _fpga_metrics_collector *)collector;
+	uint64_t head;
+	uint64_t next;
+	uint64_t n = 0;
+
+	if (c == NULL ||
+		cursor == NULL ||
+		metrics == NULL ||
+		num_samples == NULL) {
+		OPAE_ERR("Invalid Input parameters");
+		return FPGA_INVALID_PARAM;
+	}
+
+	head = __atomic_load_n(&c->head, __ATOMIC_ACQUIRE);
+	next = *cursor;
+
+	if (next > head)
+		next = head;
+
+	// samples older than the ring depth have been overwritten
+	if (head - next > c->depth)
+		next = head - c->depth;
+
+	while (next < head && n < max_samples) {
+		if (collector_copy_sample(c, next,
+					  &metrics[n * c->num_metrics]))
+			n++;
+		next++;
+	}
+
+	*cursor = next;
+	*num_samples = n;
+
+	return FPGA_OK;
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaDestroyMetricsCollector(fpga_metrics_collector *collector)
+{
+	struct _fpga_metrics_collector *c = NULL;
+	int err                           = 0;
+
+	if (collector == NULL ||
+		*collector == NULL) {
+		OPAE_ERR("Invalid Input parameters");
+		return FPGA_INVALID_PARAM;
+	}
+
+	c = (struct _fpga_metrics_collector *)*collector;
+
+	pthread_mutex_lock(&c->lock);
+	c->stop = true;
+	pthread_cond_signal(&c->wake);
+	pthread_mutex_unlock(&c->lock);
+
+	err = pthread_join(c->thread, NULL);
+	if (err)
+		OPAE_ERR("pthread_join() failed: %s", strerror(err));
+
+	pthread_mutex_destroy(&c->lock);
+	pthread_cond_destroy(&c->wake);
+	collector_free(c);
+	*collector = NULL;
+
+	return FPGA_OK;
+}
@@ -143,6 +143,32 @@ struct metric_bbb_value {
 	};
 };
 
+// Metric set prepared by xfpga_fpgaCreateMetricsSession()
+struct _fpga_metrics_session {
+	struct _fpga_handle *handle;
+	uint64_t num_metrics;
+	uint64_t *metric_num;
+	struct _fpga_enum_metric **enum_metrics;  // NULL if not found
+	int32_t *bmc_sensor;                      // BMC sensor number or -1
+	bmc_sdr_handle bmc_records;               // NULL if no BMC metrics
+};
+
+// Background sampler created by xfpga_fpgaCreateMetricsCollector()
+struct _fpga_metrics_collector {
+	fpga_metrics_session session;
+	uint64_t num_metrics;
+	uint64_t depth;             // ring slots, power of two
+	uint32_t period_usec;
+	uint64_t head;              // number of samples published
+	uint64_t *slot_seq;         // per slot, see metrics_collector.c
+	fpga_metric *samples;       // depth * num_metrics
+	fpga_metric *scratch;       // sample being taken
+	pthread_t thread;
+	pthread_mutex_t lock;       // protects stop; never held by readers
+	pthread_cond_t wake;
+	bool stop;
+};
+
 // Metrics utils functions
 fpga_result metric_sysfs_path_is_file(const char *path);
 
@@ -202,6 +228,16 @@ fpga_result parse_metric_num_name(const char *search_string,
 				fpga_metric_vector *fpga_enum_metrics_vector,
 				uint64_t *metric_num);
 
+fpga_result find_metric_num_name(struct _fpga_handle *_handle,
+				const char *search_string,
+				uint64_t *metric_num);
+
+fpga_result index_fpga_metrics(struct _fpga_handle *_handle);
+
+struct _fpga_enum_metric *find_fpga_enum_metric(struct _fpga_handle *_handle,
+						fpga_metric_vector *enum_vector,
+						uint64_t metric_num);
+
 fpga_result enum_bmc_metrics_info(struct _fpga_handle *_handle,
 				fpga_metric_vector *vector,
 				uint64_t *metric_id,
@@ -414,6 +414,13 @@ fpga_result free_fpga_enum_metrics_vector(struct _fpga_handle *_handle)
 
 	fpga_vector_free(&(_handle->fpga_enum_metric_vector));
 
+	metric_index_free(&_handle->metric_names);
+	if (_handle->metric_slots) {
+		free(_handle->metric_slots);
+		_handle->metric_slots = NULL;
+	}
+	_handle->num_metric_slots = 0;
+
 	if (_handle->bmc_handle) {
 		dlclose(_handle->bmc_handle);
 		_handle->bmc_handle = NULL;
@@ -477,6 +484,114 @@ void *metrics_load_bmc_lib(void)
 	return NULL;
 }
 
+// builds the name and metric_num lookup tables for the enumerated metrics
+fpga_result index_fpga_metrics(struct _fpga_handle *_handle)
+{
+	fpga_result result                          = FPGA_OK;
+	struct _fpga_enum_metric *_fpga_enum_metric = NULL;
+	uint64_t num_enun_metrics                   = 0;
+	uint64_t max_metric_num                     = 0;
+	uint64_t i                                  = 0;
+
+	if (_handle == NULL) {
+		OPAE_ERR("Invalid handle ");
+		return FPGA_INVALID_PARAM;
+	}
+
+	result = fpga_vector_total(&(_handle->fpga_enum_metric_vector), &num_enun_metrics);
+	if (result != FPGA_OK) {
+		OPAE_ERR("Failed to get metric total");
+		return result;
+	}
+
+	metric_index_free(&_handle->metric_names);
+	result = metric_index_init(&_handle->metric_names, num_enun_metrics);
+	if (result != FPGA_OK) {
+		OPAE_ERR("Failed to allocate metric index");
+		return result;
+	}
+
+	for (i = 0; i < num_enun_metrics; i++) {
+		_fpga_enum_metric = (struct _fpga_enum_metric *)fpga_vector_get(&(_handle->fpga_enum_metric_vector), i);
+
+		result = metric_index_add(&_handle->metric_names,
+					  _fpga_enum_metric->qualifier_name,
+					  _fpga_enum_metric->metric_name,
+					  i);
+		if (result != FPGA_OK) {
+			OPAE_ERR("Failed to index metric");
+			return result;
+		}
+
+		if (_fpga_enum_metric->metric_num > max_metric_num)
+			max_metric_num = _fpga_enum_metric->metric_num;
+	}
+
+	if (_handle->metric_slots) {
+		free(_handle->metric_slots);
+		_handle->metric_slots = NULL;
+	}
+	_handle->num_metric_slots = 0;
+
+	// metric_num is normally assigned densely from 0. Don't build
+	// a direct map when it isn't; lookups will scan the vector.
+	if (!num_enun_metrics ||
+	    max_metric_num >= 4 * num_enun_metrics + 16)
+		return FPGA_OK;
+
+	_handle->metric_slots = malloc((max_metric_num + 1) * sizeof(uint64_t));
+	if (_handle->metric_slots == NULL) {
+		OPAE_ERR("Failed to allocate memory");
+		return FPGA_NO_MEMORY;
+	}
+
+	for (i = 0; i <= max_metric_num; i++)
+		_handle->metric_slots[i] = UINT64_MAX;
+
+	for (i = num_enun_metrics; i > 0; i--) {
+		_fpga_enum_metric = (struct _fpga_enum_metric *)fpga_vector_get(&(_handle->fpga_enum_metric_vector), i - 1);
+		// walk backwards so the first match wins, as in a linear scan
+		_handle->metric_slots[_fpga_enum_metric->metric_num] = i - 1;
+	}
+
+	_handle->num_metric_slots = max_metric_num + 1;
+
+	return FPGA_OK;
+}
+
+// finds the enumerated metric with the given metric_num
+struct _fpga_enum_metric *find_fpga_enum_metric(struct _fpga_handle *_handle,
+						fpga_metric_vector *enum_vector,
+						uint64_t metric_num)
+{
+	struct _fpga_enum_metric *_fpga_enum_metric = NULL;
+	uint64_t num_enun_metrics                   = 0;
+	uint64_t index                              = 0;
+
+	if (fpga_vector_total(enum_vector, &num_enun_metrics) != FPGA_OK)
+		return NULL;
+
+	if (_handle &&
+	    enum_vector == &_handle->fpga_enum_metric_vector &&
+	    metric_num < _handle->num_metric_slots) {
+		index = _handle->metric_slots[metric_num];
+		if (index < num_enun_metrics) {
+			_fpga_enum_metric = (struct _fpga_enum_metric *)fpga_vector_get(enum_vector, index);
+			if (_fpga_enum_metric &&
+			    _fpga_enum_metric->metric_num == metric_num)
+				return _fpga_enum_metric;
+		}
+	}
+
+	for (index = 0; index < num_enun_metrics; index++) {
+		_fpga_enum_metric = (struct _fpga_enum_metric *)fpga_vector_get(enum_vector, index);
+		if (_fpga_enum_metric->metric_num == metric_num)
+			return _fpga_enum_metric;
+	}
+
+	return NULL;
+}
+
 // enumerates FME & AFU metrics info
 fpga_result enum_fpga_metrics(fpga_handle handle)
 {
@@ -604,6 +719,9 @@ fpga_result enum_fpga_metrics(fpga_handle handle)
 
 	} // if Object type
 
+	if (result == FPGA_OK)
+		result = index_fpga_metrics(_handle);
+
 	if (result != FPGA_OK)
 		free_fpga_enum_metrics_vector(_handle);
 
@@ -669,6 +787,20 @@ fpga_result get_bmc_metrics_values(fpga_handle handle,
 
 	struct _fpga_handle *_handle = (struct _fpga_handle *)handle;
 
+	if (_handle->_bmc_metric_cache_value &&
+	    _handle->bmc_metric_names.size) {
+		uint64_t slot = 0;
+
+		if (metric_index_find(&_handle->bmc_metric_names,
+				      NULL,
+				      _fpga_enum_metric->metric_name,
+				      &slot) != FPGA_OK)
+			return FPGA_NOT_FOUND;
+
+		fpga_metric->value.dvalue = _handle->_bmc_metric_cache_value[slot].fpga_metric.value.dvalue;
+		return result;
+	}
+
 	if (_handle->_bmc_metric_cache_value) {
 
 		for (x = 0; x < _handle->num_bmc_metric; x++) {
@@ -736,6 +868,19 @@ fpga_result get_bmc_metrics_values(fpga_handle handle,
 
 	}
 
+	// index the cached readings for the remaining lookups of this call
+	metric_index_free(&_handle->bmc_metric_names);
+	if (metric_index_init(&_handle->bmc_metric_names, num_sensors) == FPGA_OK) {
+		for (x = 0; x < num_sensors; x++) {
+			if (_handle->_bmc_metric_cache_value[x].metric_name[0] == '\0')
+				continue;
+			metric_index_add(&_handle->bmc_metric_names,
+					 NULL,
+					 _handle->_bmc_metric_cache_value[x].metric_name,
+					 x);
+		}
+	}
+
 
 	result = xfpga_bmcDestroySensorValues(_handle, &values);
 	if (result != FPGA_OK) {
@@ -786,9 +931,7 @@ fpga_result  get_fme_metric_value(fpga_handle handle,
 					struct fpga_metric *fpga_metric)
 {
 	fpga_result result                          = FPGA_OK;
-	uint64_t index                              = 0;
 	struct _fpga_enum_metric *_fpga_enum_metric = NULL;
-	uint64_t num_enun_metrics                  = 0;
 	metric_value value = {0};
 
 	if (enum_vector == NULL ||
@@ -797,64 +940,84 @@ fpga_result  get_fme_metric_value(fpga_handle handle,
 		return FPGA_INVALID_PARAM;
 	}
 
-	result = fpga_vector_total(enum_vector, &num_enun_metrics);
-	if (result != FPGA_OK) {
-		OPAE_ERR("Failed to get metric total");
+	fpga_metric->isvalid = false;
+
+	_fpga_enum_metric = find_fpga_enum_metric((struct _fpga_handle *)handle,
+						  enum_vector,
+						  metric_num);
+	if (_fpga_enum_metric == NULL)
 		return FPGA_NOT_FOUND;
-	}
 
-	fpga_metric->isvalid = false;
+	// Found Metic
 	result = FPGA_NOT_FOUND;
-	for (index = 0; index < num_enun_metrics ; index++) {
+	memset(&value, 0, sizeof(value));
 
-		_fpga_enum_metric = (struct _fpga_enum_metric *)	fpga_vector_get(enum_vector, index);
+	// DCP Power & Thermal
+	if ((_fpga_enum_metric->hw_type == FPGA_HW_DCP_RC) &&
+		((_fpga_enum_metric->metric_type == FPGA_METRIC_TYPE_POWER) ||
+		(_fpga_enum_metric->metric_type == FPGA_METRIC_TYPE_THERMAL))) {
 
-		if (metric_num == _fpga_enum_metric->metric_num) {
 
-			// Found Metic
-			memset(&value, 0, sizeof(value));
+		result  = get_bmc_metrics_values(handle, _fpga_enum_metric, fpga_metric);
+		if (result != FPGA_OK) {
+			OPAE_MSG("Failed to get BMC metric value");
+		} else {
+			fpga_metric->isvalid = true;
+		}
+		fpga_metric->metric_num = metric_num;
 
-			// DCP Power & Thermal
-			if ((_fpga_enum_metric->hw_type == FPGA_HW_DCP_RC) &&
-				((_fpga_enum_metric->metric_type == FPGA_METRIC_TYPE_POWER) ||
-				(_fpga_enum_metric->metric_type == FPGA_METRIC_TYPE_THERMAL))) {
+	 }
 
 
-				result  = get_bmc_metrics_values(handle, _fpga_enum_metric, fpga_metric);
-				if (result != FPGA_OK) {
-					OPAE_MSG("Failed to get BMC metric value");
-				} else {
-					fpga_metric->isvalid = true;
-				}
-				fpga_metric->metric_num = metric_num;
+	// Read power theraml values from Max10
+	if (((_fpga_enum_metric->hw_type == FPGA_HW_DCP_N3000) ||
+		(_fpga_enum_metric->hw_type == FPGA_HW_DCP_D5005)) &&
+		((_fpga_enum_metric->metric_type == FPGA_METRIC_TYPE_POWER) ||
+		(_fpga_enum_metric->metric_type == FPGA_METRIC_TYPE_THERMAL))) {
 
-			 }
+		result = read_max10_value(_fpga_enum_metric, &value.dvalue);
+		if (result != FPGA_OK) {
+			OPAE_MSG("Failed to get Max10 metric value");
+		} else {
+			fpga_metric->isvalid = true;
+		}
+		fpga_metric->value = value;
+		fpga_metric->metric_num = metric_num;
 
+	}
 
-			// Read power theraml values from Max10
-			if (((_fpga_enum_metric->hw_type == FPGA_HW_DCP_N3000) ||
-				(_fpga_enum_metric->hw_type == FPGA_HW_DCP_D5005)) &&
-				((_fpga_enum_metric->metric_type == FPGA_METRIC_TYPE_POWER) ||
-				(_fpga_enum_metric->metric_type == FPGA_METRIC_TYPE_THERMAL))) {
+	return result;
+}
 
-				result = read_max10_value(_fpga_enum_metric, &value.dvalue);
-				if (result != FPGA_OK) {
-					OPAE_MSG("Failed to get Max10 metric value");
-				} else {
-					fpga_metric->isvalid = true;
-				}
-				fpga_metric->value = value;
-				fpga_metric->metric_num = metric_num;
 
-			}
+// splits a "qualifier:metric" search string at its last ':'
+STATIC fpga_result split_metric_num_name(const char *search_string,
+					  char *qualifier_name,
+					  char *metrics_name)
+{
+	char *str                                   = NULL;
+	size_t len;
 
-			break;
-		}
+	str = strrchr(search_string, ':');
+	if (!str) {
+		OPAE_ERR("Invalid Input Paramters");
+		return FPGA_INVALID_PARAM;
 	}
 
-	return result;
-}
+	// Metric Name
+	len = strnlen(str + 1, FPGA_METRIC_STR_SIZE - 1);
+	memcpy(metrics_name, str + 1, len);
+	metrics_name[len] = '\0';
 
+	// qualifier_name
+	len = str - search_string;
+	if (len > SYSFS_PATH_MAX - 1)
+		len = SYSFS_PATH_MAX - 1;
+	memcpy(qualifier_name, search_string, len);
+	qualifier_name[len] = '\0';
+
+	return FPGA_OK;
+}
 
 // parses metric name strings
 fpga_result  parse_metric_num_name(const char *search_string,
@@ -862,8 +1025,6 @@ fpga_result  parse_metric_num_name(const char *search_string,
 				uint64_t *metric_num)
 {
 	fpga_result result                          = FPGA_OK;
-	char *str                                   = NULL;
-	char *str_last                              = NULL;
 	uint64_t i                                  = 0;
 	struct _fpga_enum_metric *fpga_enum_metric  = NULL;
 	char qualifier_name[SYSFS_PATH_MAX]         = { 0, };
@@ -871,7 +1032,6 @@ fpga_result  parse_metric_num_name(const char *search_string,
 	int qualifier_indicator                     = 0;
 	int metric_indicator                        = 0;
 	uint64_t num_enun_metrics                   = 0;
-	size_t len;
 
 	if (search_string == NULL ||
 		fpga_enum_metrics_vector == NULL ||
@@ -880,26 +1040,9 @@ fpga_result  parse_metric_num_name(const char *search_string,
 		return FPGA_INVALID_PARAM;
 	}
 
-	str = strrchr(search_string, ':');
-	if (!str) {
-		OPAE_ERR("Invalid Input Paramters");
-		return FPGA_INVALID_PARAM;
-	}
-
-	// Metric Name
-	len = strnlen(str + 1, FPGA_METRIC_STR_SIZE - 1);
-	memcpy(metrics_name, str + 1, len);
-	metrics_name[len] = '\0';
-
-	// qualifier_name
-	str_last = strrchr(search_string, ':');
-	if (!str_last) {
-		OPAE_ERR("Invalid Input Paramters");
-		return FPGA_INVALID_PARAM;
-	}
-
-	memcpy(qualifier_name, search_string, str_last - search_string);
-	qualifier_name[str_last - search_string] = '\0';
+	result = split_metric_num_name(search_string, qualifier_name, metrics_name);
+	if (result != FPGA_OK)
+		return result;
 
 	result = fpga_vector_total(fpga_enum_metrics_vector, &num_enun_metrics);
 	if (result != FPGA_OK) {
@@ -926,6 +1069,52 @@ fpga_result  parse_metric_num_name(const char *search_string,
 	return FPGA_NOT_FOUND;
 }
 
+// looks up a "qualifier:metric" string in the handle's metric name index
+fpga_result find_metric_num_name(struct _fpga_handle *_handle,
+				const char *search_string,
+				uint64_t *metric_num)
+{
+	fpga_result result                          = FPGA_OK;
+	struct _fpga_enum_metric *fpga_enum_metric  = NULL;
+	char qualifier_name[SYSFS_PATH_MAX]         = { 0, };
+	char metrics_name[SYSFS_PATH_MAX]           = { 0, };
+	uint64_t num_enun_metrics                   = 0;
+	uint64_t slot                               = 0;
+
+	if (_handle == NULL ||
+		search_string == NULL ||
+		metric_num == NULL) {
+		OPAE_ERR("Invalid Input Paramters");
+		return FPGA_INVALID_PARAM;
+	}
+
+	// not indexed (yet): fall back to scanning the vector
+	if (!_handle->metric_names.size)
+		return parse_metric_num_name(search_string,
+					     &(_handle->fpga_enum_metric_vector),
+					     metric_num);
+
+	result = split_metric_num_name(search_string, qualifier_name, metrics_name);
+	if (result != FPGA_OK)
+		return result;
+
+	result = metric_index_find(&_handle->metric_names,
+				   qualifier_name,
+				   metrics_name,
+				   &slot);
+	if (result != FPGA_OK)
+		return result;
+
+	result = fpga_vector_total(&(_handle->fpga_enum_metric_vector), &num_enun_metrics);
+	if (result != FPGA_OK || slot >= num_enun_metrics)
+		return FPGA_NOT_FOUND;
+
+	fpga_enum_metric = (struct _fpga_enum_metric *)fpga_vector_get(&(_handle->fpga_enum_metric_vector), slot);
+	*metric_num = fpga_enum_metric->metric_num;
+
+	return FPGA_OK;
+}
+
 // clears BMC values
 fpga_result  clear_cached_values(fpga_handle handle)
 {
@@ -937,6 +1126,7 @@ fpga_result  clear_cached_values(fpga_handle handle)
 		_handle->_bmc_metric_cache_value = NULL;
 	}
 
+	metric_index_free(&_handle->bmc_metric_names);
 	_handle->num_bmc_metric = 0;
 	return result;
 }
@@ -41,7 +41,9 @@
 #include <dlfcn.h>
 #include <fcntl.h>
 #include <glob.h>
+#include <math.h>
 
+#include "xfpga.h"
 #include "types_int.h"
 #include "metrics_int.h"
 #include "common_int.h"
@@ -493,3 +495,387 @@ out:
 	globfree(&pglob);
 	return result;
 }
+
+STATIC void threshold_monitor_free(struct _fpga_threshold_monitor *m)
+{
+	free(m->limit[0]);
+	free(m->hysteresis);
+	free(m->values);
+	free(m->state);
+	free(m->next_state);
+	free(m->metric_num);
+	free(m);
+}
+
+STATIC struct _fpga_threshold_monitor *threshold_monitor_alloc(uint64_t num_metrics)
+{
+	struct _fpga_threshold_monitor *m = NULL;
+	uint64_t i                        = 0;
+	int k                             = 0;
+
+	m = calloc(1, sizeof(struct _fpga_threshold_monitor));
+	if (m == NULL)
+		return NULL;
+
+	m->num_metrics = num_metrics;
+	m->event_fd = -1;
+	m->metric_num = calloc(num_metrics, sizeof(uint64_t));
+	m->limit[0] = calloc(num_metrics * THRESHOLD_LEVELS, sizeof(double));
+	m->hysteresis = calloc(num_metrics, sizeof(double));
+	m->values = calloc(num_metrics, sizeof(double));
+	m->state = calloc(num_metrics, sizeof(uint32_t));
+	m->next_state = calloc(num_metrics, sizeof(uint32_t));
+	if (m->metric_num == NULL ||
+		m->limit[0] == NULL ||
+		m->hysteresis == NULL ||
+		m->values == NULL ||
+		m->state == NULL ||
+		m->next_state == NULL) {
+		threshold_monitor_free(m);
+		return NULL;
+	}
+
+	for (k = 0; k < THRESHOLD_LEVELS; k++) {
+		m->limit[k] = m->limit[0] + k * num_metrics;
+		for (i = 0; i < num_metrics; i++)
+			m->limit[k][i] = (k < THRESHOLD_UPPER_NC) ? -INFINITY : INFINITY;
+	}
+
+	return m;
+}
+
+// Copies the thresholds of each monitored metric, matched by name, into
+// the per-level arrays. Returns the number of metrics that have any.
+STATIC uint64_t threshold_monitor_compile(struct _fpga_threshold_monitor *m,
+					  const char **metric_names,
+					  const metric_threshold *thresholds,
+					  uint32_t num_thresholds)
+{
+	const metric_threshold *t = NULL;
+	metric_index names;
+	uint64_t found            = 0;
+	uint64_t slot             = 0;
+	uint64_t i                = 0;
+
+	if (metric_index_init(&names, num_thresholds) != FPGA_OK)
+		return 0;
+
+	for (i = 0; i < num_thresholds; i++) {
+		if (thresholds[i].metric_name[0])
+			metric_index_add(&names, NULL, thresholds[i].metric_name, i);
+	}
+
+	for (i = 0; i < m->num_metrics; i++) {
+
+		if (metric_names[i] == NULL ||
+		    metric_index_find(&names, NULL, metric_names[i], &slot) != FPGA_OK)
+			continue;
+
+		t = &thresholds[slot];
+
+		if (t->lower_nc_threshold.is_valid)
+			m->limit[THRESHOLD_LOWER_NC][i] = t->lower_nc_threshold.value;
+		if (t->lower_c_threshold.is_valid)
+			m->limit[THRESHOLD_LOWER_C][i] = t->lower_c_threshold.value;
+		if (t->lower_nr_threshold.is_valid)
+			m->limit[THRESHOLD_LOWER_NR][i] = t->lower_nr_threshold.value;
+		if (t->upper_nc_threshold.is_valid)
+			m->limit[THRESHOLD_UPPER_NC][i] = t->upper_nc_threshold.value;
+		if (t->upper_c_threshold.is_valid)
+			m->limit[THRESHOLD_UPPER_C][i] = t->upper_c_threshold.value;
+		if (t->upper_nr_threshold.is_valid)
+			m->limit[THRESHOLD_UPPER_NR][i] = t->upper_nr_threshold.value;
+		if (t->hysteresis.is_valid)
+			m->hysteresis[i] = t->hysteresis.value;
+
+		if (t->lower_nc_threshold.is_valid ||
+		    t->lower_c_threshold.is_valid ||
+		    t->lower_nr_threshold.is_valid ||
+		    t->upper_nc_threshold.is_valid ||
+		    t->upper_c_threshold.is_valid ||
+		    t->upper_nr_threshold.is_valid)
+			found++;
+	}
+
+	metric_index_free(&names);
+	return found;
+}
+
+// Checks one sample against every level and records the metrics whose
+// state changed in events, when given, for the caller to report once
+// m->lock is released. Must be called with m->lock held.
+STATIC uint64_t threshold_monitor_evaluate(struct _fpga_threshold_monitor *m,
+					   const fpga_metric *metrics,
+					   struct threshold_event *events)
+{
+	const uint64_t n    = m->num_metrics;
+	double *values      = m->values;
+	uint32_t *state     = m->state;
+	uint32_t *next      = m->next_state;
+	uint64_t changed    = 0;
+	uint64_t i          = 0;
+	int k               = 0;
+
+	for (i = 0; i < n; i++) {
+		values[i] = metrics[i].value.dvalue;
+		next[i] = 0;
+	}
+
+	// Branch-free passes over contiguous arrays; a set state bit moves
+	// its threshold back by the hysteresis until the value clears it.
+	for (k = THRESHOLD_LOWER_NC; k < THRESHOLD_UPPER_NC; k++) {
+		const double *limit = m->limit[k];
+		for (i = 0; i < n; i++) {
+			double held = (double)((state[i] >> k) & 1);
+			next[i] |= (uint32_t)(values[i] <= limit[i] + held * m->hysteresis[i]) << k;
+		}
+	}
+
+	for (k = THRESHOLD_UPPER_NC; k < THRESHOLD_LEVELS; k++) {
+		const double *limit = m->limit[k];
+		for (i = 0; i < n; i++) {
+			double held = (double)((state[i] >> k) & 1);
+			next[i] |= (uint32_t)(values[i] >= limit[i] - held * m->hysteresis[i]) << k;
+		}
+	}
+
+	for (i = 0; i < n; i++) {
+		if (!metrics[i].isvalid || next[i] == state[i])
+			continue;
+
+		if (events) {
+			events[changed].metric_num = m->metric_num[i];
+			events[changed].prev_state = state[i];
+			events[changed].state = next[i];
+			events[changed].value = values[i];
+		}
+
+		state[i] = next[i];
+		changed++;
+	}
+
+	if (changed && m->event_fd >= 0) {
+		uint64_t count = changed;
+		if (write(m->event_fd, &count, sizeof(count)) != sizeof(count))
+			OPAE_MSG("Failed to signal threshold event: %s",
+				 strerror(errno));
+	}
+
+	return changed;
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaCreateThresholdMonitor(fpga_handle handle,
+					const uint64_t *metric_num,
+					uint64_t num_metric_indexes,
+					fpga_threshold_callback callback,
+					void *context,
+					fpga_event_handle event_handle,
+					fpga_threshold_monitor *monitor)
+{
+	fpga_result result                     = FPGA_OK;
+	struct _fpga_handle *_handle           = (struct _fpga_handle *)handle;
+	struct _fpga_threshold_monitor *m      = NULL;
+	struct _fpga_enum_metric *_enum_metric = NULL;
+	metric_threshold *thresholds           = NULL;
+	const char **metric_names              = NULL;
+	uint32_t num_thresholds                = 0;
+	uint64_t i                             = 0;
+	int err                                = 0;
+
+	if (_handle == NULL ||
+		metric_num == NULL ||
+		num_metric_indexes == 0 ||
+		monitor == NULL) {
+		OPAE_ERR("Invalid Input parameters");
+		return FPGA_INVALID_PARAM;
+	}
+
+	m = threshold_monitor_alloc(num_metric_indexes);
+	metric_names = calloc(num_metric_indexes, sizeof(const char *));
+	if (m == NULL ||
+		metric_names == NULL) {
+		OPAE_ERR("Failed to allocate memory");
+		result = FPGA_NO_MEMORY;
+		goto out_free;
+	}
+
+	m->callback = callback;
+	m->context = context;
+
+	if (event_handle) {
+		result = xfpga_fpgaGetOSObjectFromEventHandle(event_handle, &m->event_fd);
+		if (result != FPGA_OK) {
+			OPAE_ERR("Invalid event handle");
+			goto out_free;
+		}
+	}
+
+	result = handle_check_and_lock(_handle);
+	if (result)
+		goto out_free;
+
+	result = enum_fpga_metrics(handle);
+	if (result != FPGA_OK) {
+		OPAE_ERR("Failed to Discover Metrics");
+		result = FPGA_NOT_FOUND;
+		goto out_unlock;
+	}
+
+	for (i = 0; i < num_metric_indexes; i++) {
+		m->metric_num[i] = metric_num[i];
+		_enum_metric = find_fpga_enum_metric(_handle,
+				&(_handle->fpga_enum_metric_vector),
+				metric_num[i]);
+		if (_enum_metric)
+			metric_names[i] = _enum_metric->metric_name;
+		else
+			OPAE_MSG("Metric not found at Index = %ld", metric_num[i]);
+	}
+
+	result = xfpga_fpgaGetMetricsThresholdInfo(handle, NULL, &num_thresholds);
+	if (result != FPGA_OK || num_thresholds == 0) {
+		OPAE_ERR("Failed to get thresholds");
+		result = FPGA_NOT_FOUND;
+		goto out_unlock;
+	}
+
+	thresholds = calloc(num_thresholds, sizeof(metric_threshold));
+	if (thresholds == NULL) {
+		OPAE_ERR("Failed to allocate memory");
+		result = FPGA_NO_MEMORY;
+		goto out_unlock;
+	}
+
+	result = xfpga_fpgaGetMetricsThresholdInfo(handle, thresholds, &num_thresholds);
+	if (result != FPGA_OK) {
+		OPAE_ERR("Failed to get thresholds");
+		goto out_unlock;
+	}
+
+	if (!threshold_monitor_compile(m, metric_names, thresholds, num_thresholds)) {
+		OPAE_ERR("None of the metrics has thresholds");
+		result = FPGA_NOT_FOUND;
+		goto out_unlock;
+	}
+
+	if (pthread_mutex_init(&m->lock, NULL)) {
+		OPAE_ERR("Failed to init monitor mutex");
+		result = FPGA_EXCEPTION;
+		goto out_unlock;
+	}
+
+	*monitor = (fpga_threshold_monitor)m;
+	m = NULL;
+
+out_unlock:
+	err = pthread_mutex_unlock(&_handle->lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+
+out_free:
+	if (m)
+		threshold_monitor_free(m);
+	free(thresholds);
+	free(metric_names);
+	return result;
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaEvaluateThresholds(fpga_threshold_monitor monitor,
+					const fpga_metric *metrics,
+					uint64_t *num_transitions)
+{
+	struct _fpga_threshold_monitor *m = (struct _fpga_threshold_monitor *)monitor;
+	struct threshold_event *events    = NULL;
+	uint64_t changed                  = 0;
+	uint64_t i                        = 0;
+	int err                           = 0;
+
+	if (m == NULL ||
+		metrics == NULL) {
+		OPAE_ERR("Invalid Input parameters");
+		return FPGA_INVALID_PARAM;
+	}
+
+	// The callback runs without m->lock so that it may query or
+	// evaluate this monitor again.
+	if (m->callback) {
+		events = malloc(m->num_metrics * sizeof(struct threshold_event));
+		if (events == NULL) {
+			OPAE_ERR("Failed to allocate memory");
+			return FPGA_NO_MEMORY;
+		}
+	}
+
+	if (pthread_mutex_lock(&m->lock)) {
+		OPAE_ERR("pthread_mutex_lock failed");
+		free(events);
+		return FPGA_EXCEPTION;
+	}
+
+	changed = threshold_monitor_evaluate(m, metrics, events);
+
+	err = pthread_mutex_unlock(&m->lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+
+	for (i = 0; events && i < changed; i++)
+		m->callback(events[i].metric_num, events[i].prev_state,
+			    events[i].state, events[i].value, m->context);
+
+	free(events);
+
+	if (num_transitions)
+		*num_transitions = changed;
+
+	return FPGA_OK;
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaGetThresholdStates(fpga_threshold_monitor monitor,
+					uint32_t *states)
+{
+	struct _fpga_threshold_monitor *m = (struct _fpga_threshold_monitor *)monitor;
+	int err                           = 0;
+
+	if (m == NULL ||
+		states == NULL) {
+		OPAE_ERR("Invalid Input parameters");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if (pthread_mutex_lock(&m->lock)) {
+		OPAE_ERR("pthread_mutex_lock failed");
+		return FPGA_EXCEPTION;
+	}
+
+	memcpy(states, m->state, m->num_metrics * sizeof(uint32_t));
+
+	err = pthread_mutex_unlock(&m->lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+
+	return FPGA_OK;
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaDestroyThresholdMonitor(fpga_threshold_monitor *monitor)
+{
+	struct _fpga_threshold_monitor *m = NULL;
+
+	if (monitor == NULL ||
+		*monitor == NULL) {
+		OPAE_ERR("Invalid Input parameters");
+		return FPGA_INVALID_PARAM;
+	}
+
+	m = (struct _fpga_threshold_monitor *)*monitor;
+
+	if (pthread_mutex_destroy(&m->lock))
+		OPAE_ERR("pthread_mutex_destroy() failed");
+
+	threshold_monitor_free(m);
+	*monitor = NULL;
+
+	return FPGA_OK;
+}
@@ -31,6 +31,7 @@
 #ifndef FPGA_THRESHOLD_H
 #define FPGA_THRESHOLD_H
 
+#include <pthread.h>
 #include <opae/fpga.h>
 #include "bmc/bmc_types.h"
 
@@ -52,6 +53,41 @@
 #define  SYSFS_LOW_WARN                         "low_warn"
 
 
+// Threshold levels, in FPGA_THRESHOLD_* bit order
+#define THRESHOLD_LOWER_NC                     0
+#define THRESHOLD_LOWER_C                      1
+#define THRESHOLD_LOWER_NR                     2
+#define THRESHOLD_UPPER_NC                     3
+#define THRESHOLD_UPPER_C                      4
+#define THRESHOLD_UPPER_NR                     5
+#define THRESHOLD_LEVELS                       6
+
+// Thresholds compiled by xfpga_fpgaCreateThresholdMonitor(). Each level
+// is an array over the monitored metrics so that a sample is checked one
+// level at a time; unset thresholds are +/-INFINITY and never trip.
+struct _fpga_threshold_monitor {
+	pthread_mutex_t lock;
+	uint64_t num_metrics;
+	uint64_t *metric_num;
+	double *limit[THRESHOLD_LEVELS];
+	double *hysteresis;
+	double *values;                 // sample being evaluated
+	uint32_t *state;                // FPGA_THRESHOLD_* per metric
+	uint32_t *next_state;
+	fpga_threshold_callback callback;
+	void *context;
+	int event_fd;                   // -1 when not signalling
+};
+
+// One state change found by an evaluation, reported to the monitor's
+// callback once its lock has been dropped.
+struct threshold_event {
+	uint64_t metric_num;
+	uint32_t prev_state;
+	uint32_t state;
+	double value;
+};
+
 fpga_result get_bmc_threshold_info(fpga_handle handle,
 	metric_threshold *metric_thresholds,
 	uint32_t *num_thresholds);
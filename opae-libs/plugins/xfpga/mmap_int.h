@@ -46,4 +46,17 @@ int free_buffer(void *addr,
  */
 fpga_result free_umsg_buffer(fpga_handle handle);
 
+/*
+ * Map all MMIO regions of resource 'handle' and cache them in
+ * handle->mmio_regions for FPGA_OPEN_MMIO_PREMAP
+ * Implemented in mmio.c
+ */
+fpga_result premap_mmio_regions(fpga_handle handle);
+
+/*
+ * Unmap and free all idle buffers in the buffer pool of resource 'handle'
+ * Implemented in buffer.c
+ */
+void buffer_pool_drain(fpga_handle handle);
+
 #endif // ___FPGA_MMAP_INT_H__
@@ -31,6 +31,7 @@
 #include "opae/access.h"
 #include "opae/utils.h"
 #include "common_int.h"
+#include "xfpga.h"
 #include "opae_drv.h"
 #include "intel-fpga.h"
 
@@ -162,6 +163,62 @@ STATIC fpga_result find_or_map_wm(fpga_handle handle, uint32_t mmio_num,
 	return FPGA_OK;
 }
 
+/* Region mapped at open time (FPGA_OPEN_MMIO_PREMAP), or NULL if none */
+static inline struct _fpga_mmio_region *
+premapped_region(struct _fpga_handle *_handle, uint32_t mmio_num)
+{
+	struct _fpga_mmio_region *region;
+
+	if (!_handle || (_handle->magic != FPGA_HANDLE_MAGIC) ||
+	    !(_handle->flags & OPAE_FLAG_MMIO_PREMAP) ||
+	    (mmio_num >= XFPGA_MAX_MMIO_REGIONS))
+		return NULL;
+
+	region = &_handle->mmio_regions[mmio_num];
+	return region->base ? region : NULL;
+}
+
+fpga_result premap_mmio_regions(fpga_handle handle)
+{
+	struct _fpga_handle *_handle = (struct _fpga_handle *)handle;
+	struct wsid_map *wm = NULL;
+	opae_port_info pinfo = { 0 };
+	fpga_result result;
+	uint32_t i;
+
+	result = opae_get_port_info(_handle->fddev, &pinfo);
+	if (result) {
+		OPAE_MSG("MMIO premap requires an accelerator resource");
+		return FPGA_INVALID_PARAM;
+	}
+
+	for (i = 0; i < pinfo.num_regions; ++i) {
+		if (i >= XFPGA_MAX_MMIO_REGIONS) {
+			OPAE_MSG("MMIO region %d not premapped", i);
+			continue;
+		}
+
+		result = find_or_map_wm(handle, i, &wm);
+		if (result == FPGA_NO_ACCESS)
+			continue; // not a mappable UAFU region
+		if (result)
+			goto out_unmap;
+
+		_handle->mmio_regions[i].base = (uint8_t *)wm->offset;
+		_handle->mmio_regions[i].len = wm->len;
+	}
+
+	_handle->flags |= OPAE_FLAG_MMIO_PREMAP;
+	return FPGA_OK;
+
+out_unmap:
+	while (i--) {
+		if (_handle->mmio_regions[i].base)
+			xfpga_fpgaUnmapMMIO(handle, i);
+	}
+	return result;
+}
+
 fpga_result __XFPGA_API__ xfpga_fpgaWriteMMIO32(fpga_handle handle,
 					 uint32_t mmio_num,
 					 uint64_t offset,
@@ -170,6 +227,7 @@ fpga_result __XFPGA_API__ xfpga_fpgaWriteMMIO32(fpga_handle handle,
 
 	int err;
 	struct _fpga_handle *_handle = (struct _fpga_handle *) handle;
+	struct _fpga_mmio_region *region;
 	struct wsid_map *wm = NULL;
 	fpga_result result = FPGA_OK;
 
@@ -178,6 +236,16 @@ fpga_result __XFPGA_API__ xfpga_fpgaWriteMMIO32(fpga_handle handle,
 		return FPGA_INVALID_PARAM;
 	}
 
+	region = premapped_region(_handle, mmio_num);
+	if (region) {
+		if (offset > region->len - sizeof(uint32_t)) {
+			OPAE_MSG("offset out of bounds");
+			return FPGA_INVALID_PARAM;
+		}
+		*((volatile uint32_t *) (region->base + offset)) = value;
+		return FPGA_OK;
+	}
+
 	result = handle_check_and_lock(_handle);
 	if (result)
 		return result;
@@ -209,6 +277,7 @@ fpga_result __XFPGA_API__ xfpga_fpgaReadMMIO32(fpga_handle handle,
 {
 	int err;
 	struct _fpga_handle *_handle = (struct _fpga_handle *) handle;
+	struct _fpga_mmio_region *region;
 	struct wsid_map *wm = NULL;
 	fpga_result result = FPGA_OK;
 
@@ -217,6 +286,16 @@ fpga_result __XFPGA_API__ xfpga_fpgaReadMMIO32(fpga_handle handle,
 		return FPGA_INVALID_PARAM;
 	}
 
+	region = premapped_region(_handle, mmio_num);
+	if (region) {
+		if (offset > region->len - sizeof(uint32_t)) {
+			OPAE_MSG("offset out of bounds");
+			return FPGA_INVALID_PARAM;
+		}
+		*value = *((volatile uint32_t *) (region->base + offset));
+		return FPGA_OK;
+	}
+
 	result = handle_check_and_lock(_handle);
 	if (result)
 		return result;
@@ -248,6 +327,7 @@ fpga_result __XFPGA_API__ xfpga_fpgaWriteMMIO64(fpga_handle handle,
 {
 	int err;
 	struct _fpga_handle *_handle = (struct _fpga_handle *) handle;
+	struct _fpga_mmio_region *region;
 	struct wsid_map *wm = NULL;
 	fpga_result result = FPGA_OK;
 
@@ -256,6 +336,16 @@ fpga_result __XFPGA_API__ xfpga_fpgaWriteMMIO64(fpga_handle handle,
 		return FPGA_INVALID_PARAM;
 	}
 
+	region = premapped_region(_handle, mmio_num);
+	if (region) {
+		if (offset > region->len - sizeof(uint64_t)) {
+			OPAE_MSG("offset out of bounds");
+			return FPGA_INVALID_PARAM;
+		}
+		*((volatile uint64_t *) (region->base + offset)) = value;
+		return FPGA_OK;
+	}
+
 	result = handle_check_and_lock(_handle);
 	if (result)
 		return result;
@@ -287,6 +377,7 @@ fpga_result __XFPGA_API__ xfpga_fpgaReadMMIO64(fpga_handle handle,
 {
 	int err;
 	struct _fpga_handle *_handle = (struct _fpga_handle *) handle;
+	struct _fpga_mmio_region *region;
 	struct wsid_map *wm = NULL;
 	fpga_result result = FPGA_OK;
 
@@ -295,6 +386,16 @@ fpga_result __XFPGA_API__ xfpga_fpgaReadMMIO64(fpga_handle handle,
 		return FPGA_INVALID_PARAM;
 	}
 
+	region = premapped_region(_handle, mmio_num);
+	if (region) {
+		if (offset > region->len - sizeof(uint64_t)) {
+			OPAE_MSG("offset out of bounds");
+			return FPGA_INVALID_PARAM;
+		}
+		*value = *((volatile uint64_t *) (region->base + offset));
+		return FPGA_OK;
+	}
+
 	result = handle_check_and_lock(_handle);
 	if (result)
 		return result;
@@ -319,6 +420,125 @@ out_unlock:
 	return result;
 }
 
+/*
+ * Batched 64-bit access. When 'offsets' is NULL, the registers are the
+ * 'count' consecutive qwords starting at 'offset'. All offsets are checked
+ * before any register is touched, and the whole batch runs under a single
+ * acquisition of the handle lock (or none for FPGA_OPEN_MMIO_PREMAP).
+ */
+STATIC fpga_result mmio64_batch(fpga_handle handle, uint32_t mmio_num,
+				const uint64_t *offsets, uint64_t offset,
+				uint64_t *values, uint32_t count, bool write)
+{
+	int err;
+	struct _fpga_handle *_handle = (struct _fpga_handle *) handle;
+	struct _fpga_mmio_region *region;
+	struct wsid_map *wm = NULL;
+	volatile uint8_t *base;
+	uint64_t len;
+	uint64_t off;
+	uint32_t i;
+	bool locked = false;
+	fpga_result result = FPGA_OK;
+
+	ASSERT_NOT_NULL(values);
+
+	region = premapped_region(_handle, mmio_num);
+	if (region) {
+		base = region->base;
+		len = region->len;
+	} else {
+		result = handle_check_and_lock(_handle);
+		if (result)
+			return result;
+		locked = true;
+
+		result = find_or_map_wm(handle, mmio_num, &wm);
+		if (result)
+			goto out_unlock;
+
+		base = (volatile uint8_t *)wm->offset;
+		len = wm->len;
+	}
+
+	if (offsets) {
+		for (i = 0 ; i < count ; ++i) {
+			if ((offsets[i] % sizeof(uint64_t)) ||
+			    (offsets[i] > len - sizeof(uint64_t))) {
+				OPAE_MSG("invalid MMIO offset 0x%lx",
+					 offsets[i]);
+				result = FPGA_INVALID_PARAM;
+				goto out_unlock;
+			}
+		}
+	} else if ((offset % sizeof(uint64_t)) || (offset > len) ||
+		   ((uint64_t)count * sizeof(uint64_t) > len - offset)) {
+		OPAE_MSG("MMIO range out of bounds");
+		result = FPGA_INVALID_PARAM;
+		goto out_unlock;
+	}
+
+	for (i = 0 ; i < count ; ++i) {
+		off = offsets ? offsets[i] : offset + i * sizeof(uint64_t);
+		if (write)
+			*((volatile uint64_t *) (base + off)) = values[i];
+		else
+			values[i] = *((volatile uint64_t *) (base + off));
+	}
+
+out_unlock:
+	if (locked) {
+		err = pthread_mutex_unlock(&_handle->lock);
+		if (err) {
+			OPAE_ERR("pthread_mutex_unlock() failed: %s",
+				 strerror(err));
+		}
+	}
+	return result;
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaReadMMIO64Vec(fpga_handle handle,
+					   uint32_t mmio_num,
+					   const uint64_t *offsets,
+					   uint64_t *values,
+					   uint32_t count)
+{
+	ASSERT_NOT_NULL(offsets);
+	return mmio64_batch(handle, mmio_num, offsets, 0,
+			    values, count, false);
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaWriteMMIO64Vec(fpga_handle handle,
+					    uint32_t mmio_num,
+					    const uint64_t *offsets,
+					    const uint64_t *values,
+					    uint32_t count)
+{
+	ASSERT_NOT_NULL(offsets);
+	return mmio64_batch(handle, mmio_num, offsets, 0,
+			    (uint64_t *)values, count, true);
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaReadMMIO64Range(fpga_handle handle,
+					     uint32_t mmio_num,
+					     uint64_t offset,
+					     uint64_t *values,
+					     uint32_t count)
+{
+	return mmio64_batch(handle, mmio_num, NULL, offset,
+			    values, count, false);
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaWriteMMIO64Range(fpga_handle handle,
+					      uint32_t mmio_num,
+					      uint64_t offset,
+					      const uint64_t *values,
+					      uint32_t count)
+{
+	return mmio64_batch(handle, mmio_num, NULL, offset,
+			    (uint64_t *)values, count, true);
+}
+
 static inline void copy512(const void *src, void *dst)
 {
     asm volatile("vmovdqu64 (%0), %%zmm0;"
@@ -400,6 +620,36 @@ out_unlock:
 	return result;
 }
 
+fpga_result __XFPGA_API__ xfpga_fpgaGetMMIOAccessor(fpga_handle handle,
+					     uint32_t mmio_num,
+					     fpga_mmio_accessor *accessor)
+{
+	struct _fpga_handle *_handle = (struct _fpga_handle *)handle;
+	struct wsid_map *wm = NULL;
+	fpga_result result = FPGA_OK;
+	int err;
+
+	ASSERT_NOT_NULL(accessor);
+
+	result = handle_check_and_lock(_handle);
+	if (result)
+		return result;
+
+	result = find_or_map_wm(handle, mmio_num, &wm);
+	if (result)
+		goto out_unlock;
+
+	accessor->base = (volatile uint8_t *)wm->offset;
+	accessor->len = wm->len;
+
+out_unlock:
+	err = pthread_mutex_unlock(&_handle->lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+	return result;
+}
+
 fpga_result __XFPGA_API__ xfpga_fpgaUnmapMMIO(fpga_handle handle,
 				       uint32_t mmio_num)
 {
@@ -420,6 +670,12 @@ fpga_result __XFPGA_API__ xfpga_fpgaUnmapMMIO(fpga_handle handle,
 		goto out_unlock;
 	}
 
+	/* Drop the lock-free alias before the mapping goes away */
+	if (mmio_num < XFPGA_MAX_MMIO_REGIONS) {
+		_handle->mmio_regions[mmio_num].base = NULL;
+		_handle->mmio_regions[mmio_num].len = 0;
+	}
+
 	/* Unmap UAFU MMIO */
 	mmio_ptr = (void *) wm->offset;
 	if (munmap((void *) mmio_ptr, wm->len)) {
@@ -28,6 +28,7 @@
 #include <config.h>
 #endif // HAVE_CONFIG_H
 
+#include "xfpga.h"
 #include "common_int.h"
 #include <opae/access.h>
 #include <opae/utils.h>
@@ -58,7 +59,7 @@ xfpga_fpgaOpen(fpga_token token, fpga_handle *handle, int flags)
 		return FPGA_INVALID_PARAM;
 	}
 
-	if (flags & ~FPGA_OPEN_SHARED) {
+	if (flags & ~(FPGA_OPEN_SHARED | FPGA_OPEN_MMIO_PREMAP)) {
 		OPAE_MSG("unrecognized flags");
 		return FPGA_INVALID_PARAM;
 	}
@@ -83,8 +84,6 @@ xfpga_fpgaOpen(fpga_token token, fpga_handle *handle, int flags)
 
 	_handle->token = token;
 
-	_handle->fdfpgad = -1;
-
 	// Init MMIO table
 	_handle->mmio_root = wsid_tracker_init(4);
 	if (NULL == _handle->mmio_root) {
@@ -99,6 +98,9 @@ xfpga_fpgaOpen(fpga_token token, fpga_handle *handle, int flags)
 		goto out_free2;
 	}
 
+	// Init buffer pool
+	_handle->buffer_pool.max_idle_bytes = XFPGA_BUFFER_POOL_IDLE_DEFAULT;
+
 	// Init metric enum
 	_handle->metric_enum_status = false;
 	_handle->bmc_handle = NULL;
@@ -149,11 +151,26 @@ xfpga_fpgaOpen(fpga_token token, fpga_handle *handle, int flags)
 	}
 #endif
 
+	if (flags & FPGA_OPEN_MMIO_PREMAP) {
+		result = premap_mmio_regions(_handle);
+		if (result) {
+			OPAE_MSG("Failed to premap MMIO regions");
+			goto out_mutex_destroy;
+		}
+	}
+
 	// set handle return value
 	*handle = (void *)_handle;
 
+	// accelerator state may have changed
+	xfpga_enum_cache_invalidate();
+
 	return FPGA_OK;
 
+out_mutex_destroy:
+	pthread_mutex_destroy(&_handle->lock);
+	goto out_free;
+
 out_attr_destroy:
 	pthread_mutexattr_destroy(&mattr);
 
@@ -29,6 +29,7 @@
 #endif // HAVE_CONFIG_H
 
 #include <dlfcn.h>
+#include <stdlib.h>
 
 #include "xfpga.h"
 #include "adapter.h"
@@ -38,11 +39,29 @@
 
 int __XFPGA_API__ xfpga_plugin_initialize(void)
 {
+	const char *cache_ms;
+	const char *fd_cache;
+	const char *glob_cache;
 	int res = sysfs_initialize();
 	if (res) {
 		return res;
 	}
 
+	// LIBOPAE_ENUM_CACHE_MS=<ms> enables the enumeration cache.
+	cache_ms = getenv("LIBOPAE_ENUM_CACHE_MS");
+	if (cache_ms)
+		xfpga_enum_cache_configure(strtoull(cache_ms, NULL, 0));
+
+	// LIBOPAE_SYSFS_FD_CACHE=<n> bounds the sysfs attribute fd cache.
+	fd_cache = getenv("LIBOPAE_SYSFS_FD_CACHE");
+	if (fd_cache)
+		xfpga_sysfs_fd_cache_configure(strtoul(fd_cache, NULL, 0));
+
+	// LIBOPAE_SYSFS_GLOB_CACHE=<n> enables the glob resolution cache.
+	glob_cache = getenv("LIBOPAE_SYSFS_GLOB_CACHE");
+	if (glob_cache)
+		xfpga_sysfs_glob_cache_configure(strtoul(glob_cache, NULL, 0));
+
 	res = opae_ioctl_initialize();
 	if (res) {
 		return res;
@@ -52,6 +71,8 @@ int __XFPGA_API__ xfpga_plugin_initialize(void)
 
 int __XFPGA_API__ xfpga_plugin_finalize(void)
 {
+	xfpga_enum_cache_configure(0);
+	event_daemon_finalize();
 	sysfs_finalize();
 	return 0;
 }
@@ -94,10 +115,20 @@ int __XFPGA_API__ opae_plugin_configure(opae_api_adapter_table *adapter,
 		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaReadMMIO32");
 	adapter->fpgaWriteMMIO512 =
 		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaWriteMMIO512");
+	adapter->fpgaReadMMIO64Vec =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaReadMMIO64Vec");
+	adapter->fpgaWriteMMIO64Vec =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaWriteMMIO64Vec");
+	adapter->fpgaReadMMIO64Range =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaReadMMIO64Range");
+	adapter->fpgaWriteMMIO64Range =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaWriteMMIO64Range");
 	adapter->fpgaMapMMIO =
 		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaMapMMIO");
 	adapter->fpgaUnmapMMIO =
 		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaUnmapMMIO");
+	adapter->fpgaGetMMIOAccessor =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaGetMMIOAccessor");
 	adapter->fpgaEnumerate =
 		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaEnumerate");
 	adapter->fpgaCloneToken =
@@ -116,6 +147,12 @@ int __XFPGA_API__ opae_plugin_configure(opae_api_adapter_table *adapter,
 		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaPrepareBuffer");
 	adapter->fpgaReleaseBuffer =
 		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaReleaseBuffer");
+	adapter->fpgaBufferPoolConfigure =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaBufferPoolConfigure");
+	adapter->fpgaBufferPoolTrim =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaBufferPoolTrim");
+	adapter->fpgaBufferPoolGetStats =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaBufferPoolGetStats");
 	adapter->fpgaGetIOAddress =
 		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaGetIOAddress");
 	/*
@@ -173,6 +210,16 @@ int __XFPGA_API__ opae_plugin_configure(opae_api_adapter_table *adapter,
 		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaObjectGetType");
 	adapter->fpgaObjectWrite64 =
 		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaObjectWrite64");
+	adapter->fpgaObjectCreateReadPlan =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaObjectCreateReadPlan");
+	adapter->fpgaReadPlanGetCount =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaReadPlanGetCount");
+	adapter->fpgaReadPlanGetName =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaReadPlanGetName");
+	adapter->fpgaReadPlanRead =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaReadPlanRead");
+	adapter->fpgaDestroyReadPlan =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaDestroyReadPlan");
 	adapter->fpgaSetUserClock =
 		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaSetUserClock");
 	adapter->fpgaGetUserClock =
@@ -203,6 +250,39 @@ int __XFPGA_API__ opae_plugin_configure(opae_api_adapter_table *adapter,
 	adapter->fpgaGetMetricsThresholdInfo =
 		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaGetMetricsThresholdInfo");
 
+	adapter->fpgaCreateMetricsSession =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaCreateMetricsSession");
+
+	adapter->fpgaSampleMetricsSession =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaSampleMetricsSession");
+
+	adapter->fpgaDestroyMetricsSession =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaDestroyMetricsSession");
+
+	adapter->fpgaCreateMetricsCollector =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaCreateMetricsCollector");
+
+	adapter->fpgaReadLatestMetrics =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaReadLatestMetrics");
+
+	adapter->fpgaReadMetricsHistory =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaReadMetricsHistory");
+
+	adapter->fpgaDestroyMetricsCollector =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaDestroyMetricsCollector");
+
+	adapter->fpgaCreateThresholdMonitor =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaCreateThresholdMonitor");
+
+	adapter->fpgaEvaluateThresholds =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaEvaluateThresholds");
+
+	adapter->fpgaGetThresholdStates =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaGetThresholdStates");
+
+	adapter->fpgaDestroyThresholdMonitor =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaDestroyThresholdMonitor");
+
 	return 0;
 }
 
@@ -409,5 +409,11 @@ out_unlock:
 	err = pthread_mutex_unlock(&_handle->lock);
 	if (err)
 		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+
+	// the AFU ID has likely changed, and the port's sysfs
+	// attributes may have been re-created
+	xfpga_enum_cache_invalidate();
+	sysfs_fd_cache_flush();
+	sysfs_glob_cache_flush();
 	return result;
 }
@@ -40,6 +40,7 @@
 #include <errno.h>
 #include <sys/stat.h>
 #include <regex.h>
+#include <time.h>
 #undef _GNU_SOURCE
 
 #include <opae/types.h>
@@ -583,6 +584,363 @@ out_unlock:
 	return result;
 }
 
+/*
+ * sysfs attribute fd cache
+ *
+ * Reading a sysfs attribute from offset 0 calls its show() method
+ * again, so an fd kept open from a previous read can be re-read with
+ * pread() instead of open()/read()/close(). At most sysfs_fd_cache.max
+ * fds are kept open; the least recently used idle one is closed to
+ * make room for a new attribute.
+ */
+#define SYSFS_FD_CACHE_DEFAULT 64
+#define SYSFS_FD_CACHE_BUCKETS 64
+
+struct sysfs_fd_entry {
+	char path[SYSFS_PATH_MAX];
+	int flags;
+	int fd;
+	uint32_t refs;		// readers using fd
+	bool stale;		// dropped from the cache while in use
+	struct sysfs_fd_entry *hash_next;
+	struct sysfs_fd_entry *lru_prev;
+	struct sysfs_fd_entry *lru_next;
+};
+
+static struct {
+	pthread_mutex_t lock;
+	struct sysfs_fd_entry *buckets[SYSFS_FD_CACHE_BUCKETS];
+	struct sysfs_fd_entry *lru_head;	// most recently used
+	struct sysfs_fd_entry *lru_tail;
+	uint32_t count;
+	uint32_t max;
+	uint64_t hits;
+	uint64_t misses;
+} sysfs_fd_cache = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.max = SYSFS_FD_CACHE_DEFAULT,
+};
+
+STATIC uint32_t sysfs_path_hash(const char *path, uint32_t seed)
+{
+	// FNV-1a
+	uint32_t h = 2166136261u ^ seed;
+
+	while (*path) {
+		h ^= (uint8_t)*path++;
+		h *= 16777619u;
+	}
+
+	return h;
+}
+
+STATIC uint32_t sysfs_fd_hash(const char *path, int flags)
+{
+	return sysfs_path_hash(path, (uint32_t)flags) % SYSFS_FD_CACHE_BUCKETS;
+}
+
+STATIC void sysfs_fd_lru_unlink(struct sysfs_fd_entry *e)
+{
+	if (e->lru_prev)
+		e->lru_prev->lru_next = e->lru_next;
+	else
+		sysfs_fd_cache.lru_head = e->lru_next;
+
+	if (e->lru_next)
+		e->lru_next->lru_prev = e->lru_prev;
+	else
+		sysfs_fd_cache.lru_tail = e->lru_prev;
+
+	e->lru_prev = e->lru_next = NULL;
+}
+
+STATIC void sysfs_fd_lru_push(struct sysfs_fd_entry *e)
+{
+	e->lru_prev = NULL;
+	e->lru_next = sysfs_fd_cache.lru_head;
+
+	if (sysfs_fd_cache.lru_head)
+		sysfs_fd_cache.lru_head->lru_prev = e;
+	else
+		sysfs_fd_cache.lru_tail = e;
+
+	sysfs_fd_cache.lru_head = e;
+}
+
+/*
+ * Remove an entry from the cache (lock held). Its fd is closed now,
+ * or by the last reader still using it.
+ */
+STATIC void sysfs_fd_drop(struct sysfs_fd_entry *e)
+{
+	struct sysfs_fd_entry **pe;
+
+	pe = &sysfs_fd_cache.buckets[sysfs_fd_hash(e->path, e->flags)];
+	while (*pe != e)
+		pe = &(*pe)->hash_next;
+	*pe = e->hash_next;
+
+	sysfs_fd_lru_unlink(e);
+	--sysfs_fd_cache.count;
+
+	if (e->refs) {
+		e->stale = true;
+	} else {
+		close(e->fd);
+		free(e);
+	}
+}
+
+/*
+ * Close the least recently used idle fds (lock held) until at most
+ * limit remain open.
+ */
+STATIC void sysfs_fd_trim(uint32_t limit)
+{
+	struct sysfs_fd_entry *e = sysfs_fd_cache.lru_tail;
+	struct sysfs_fd_entry *prev;
+
+	while (e && sysfs_fd_cache.count > limit) {
+		prev = e->lru_prev;
+		if (!e->refs)
+			sysfs_fd_drop(e);
+		e = prev;
+	}
+}
+
+/*
+ * Get an fd for path, opened with flags. When *entry is set on return,
+ * the fd belongs to the cache and must be given back with
+ * sysfs_fd_release(); otherwise the caller closes it.
+ */
+STATIC int sysfs_fd_acquire(const char *path, int flags,
+			    struct sysfs_fd_entry **entry)
+{
+	struct sysfs_fd_entry *e;
+	uint32_t h;
+	int fd;
+	int err;
+
+	*entry = NULL;
+
+	if (pthread_mutex_lock(&sysfs_fd_cache.lock)) {
+		OPAE_MSG("Failed to lock sysfs fd cache mutex");
+		return open(path, flags | O_CLOEXEC);
+	}
+
+	h = sysfs_fd_hash(path, flags);
+
+	for (e = sysfs_fd_cache.buckets[h] ; e ; e = e->hash_next) {
+		if (e->flags == flags && !strcmp(e->path, path)) {
+			++sysfs_fd_cache.hits;
+			++e->refs;
+			sysfs_fd_lru_unlink(e);
+			sysfs_fd_lru_push(e);
+			*entry = e;
+			fd = e->fd;
+			goto out_unlock;
+		}
+	}
+
+	++sysfs_fd_cache.misses;
+
+	fd = open(path, flags | O_CLOEXEC);
+	if (fd < 0 || !sysfs_fd_cache.max ||
+	    strlen(path) >= sizeof(e->path))
+		goto out_unlock;
+
+	sysfs_fd_trim(sysfs_fd_cache.max - 1);
+	if (sysfs_fd_cache.count >= sysfs_fd_cache.max)
+		goto out_unlock; // every cached fd is in use
+
+	e = calloc(1, sizeof(*e));
+	if (!e)
+		goto out_unlock;
+
+	strcpy(e->path, path);
+	e->flags = flags;
+	e->fd = fd;
+	e->refs = 1;
+
+	e->hash_next = sysfs_fd_cache.buckets[h];
+	sysfs_fd_cache.buckets[h] = e;
+	sysfs_fd_lru_push(e);
+	++sysfs_fd_cache.count;
+
+	*entry = e;
+
+out_unlock:
+	err = pthread_mutex_unlock(&sysfs_fd_cache.lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+	return fd;
+}
+
+STATIC void sysfs_fd_release(struct sysfs_fd_entry *e, bool failed)
+{
+	int err;
+
+	if (pthread_mutex_lock(&sysfs_fd_cache.lock)) {
+		OPAE_MSG("Failed to lock sysfs fd cache mutex");
+		return;
+	}
+
+	--e->refs;
+
+	if (e->stale) {
+		if (!e->refs) {
+			close(e->fd);
+			free(e);
+		}
+	} else if (failed) {
+		sysfs_fd_drop(e);
+	}
+
+	err = pthread_mutex_unlock(&sysfs_fd_cache.lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+}
+
+STATIC ssize_t sysfs_pread_all(int fd, void *buf, size_t count)
+{
+	ssize_t bytes_read;
+	size_t total_read = 0;
+	char *ptr = buf;
+
+	while (total_read < count) {
+		bytes_read = pread(fd, ptr + total_read, count - total_read,
+				   total_read);
+		if (bytes_read < 0) {
+			if (errno == EINTR)
+				continue;
+			return bytes_read;
+		}
+		if (!bytes_read)
+			break;
+		total_read += bytes_read;
+	}
+
+	return total_read;
+}
+
+ssize_t sysfs_cached_read(const char *path, int flags, void *buf, size_t count)
+{
+	struct sysfs_fd_entry *e = NULL;
+	ssize_t bytes_read;
+	int fd;
+
+	fd = sysfs_fd_acquire(path, flags, &e);
+	if (fd < 0)
+		return -1;
+
+	bytes_read = sysfs_pread_all(fd, buf, count);
+
+	if (!e) {
+		close(fd);
+		return bytes_read;
+	}
+
+	sysfs_fd_release(e, bytes_read < 0);
+
+	// A cached fd goes bad when its device is removed; open the
+	// attribute again in case it was re-created.
+	if (bytes_read < 0) {
+		fd = open(path, flags | O_CLOEXEC);
+		if (fd < 0)
+			return -1;
+		bytes_read = sysfs_pread_all(fd, buf, count);
+		close(fd);
+	}
+
+	return bytes_read;
+}
+
+void __XFPGA_API__ xfpga_sysfs_fd_cache_configure(uint32_t max_fds)
+{
+	int err;
+
+	if (pthread_mutex_lock(&sysfs_fd_cache.lock)) {
+		OPAE_MSG("Failed to lock sysfs fd cache mutex");
+		return;
+	}
+
+	sysfs_fd_cache.max = max_fds;
+	sysfs_fd_trim(max_fds);
+
+	if (!max_fds)
+		sysfs_fd_cache.hits = sysfs_fd_cache.misses = 0;
+
+	err = pthread_mutex_unlock(&sysfs_fd_cache.lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+}
+
+void sysfs_fd_cache_flush(void)
+{
+	int err;
+
+	if (pthread_mutex_lock(&sysfs_fd_cache.lock)) {
+		OPAE_MSG("Failed to lock sysfs fd cache mutex");
+		return;
+	}
+
+	while (sysfs_fd_cache.lru_head)
+		sysfs_fd_drop(sysfs_fd_cache.lru_head);
+
+	err = pthread_mutex_unlock(&sysfs_fd_cache.lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+}
+
+fpga_result __XFPGA_API__ xfpga_sysfs_fd_cache_stats(uint64_t *hits,
+						     uint64_t *misses,
+						     uint32_t *open_fds)
+{
+	int err;
+
+	ASSERT_NOT_NULL(hits);
+	ASSERT_NOT_NULL(misses);
+	ASSERT_NOT_NULL(open_fds);
+
+	if (pthread_mutex_lock(&sysfs_fd_cache.lock)) {
+		OPAE_MSG("Failed to lock sysfs fd cache mutex");
+		return FPGA_EXCEPTION;
+	}
+
+	*hits = sysfs_fd_cache.hits;
+	*misses = sysfs_fd_cache.misses;
+	*open_fds = sysfs_fd_cache.count;
+
+	err = pthread_mutex_unlock(&sysfs_fd_cache.lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+	return FPGA_OK;
+}
+
+/*
+ * Read a newline-terminated attribute into buf, dropping the newline
+ */
+STATIC fpga_result sysfs_read_attr(const char *path, char *buf, size_t size)
+{
+	ssize_t b;
+
+	b = sysfs_cached_read(path, O_RDONLY, buf, size);
+	if (b <= 0) {
+		OPAE_MSG("Read from %s failed", path);
+		return FPGA_NOT_FOUND;
+	}
+
+	// erase \n
+	buf[b - 1] = 0;
+
+	return FPGA_OK;
+}
+
 int sysfs_initialize(void)
 {
 	int stat_res = -1;
@@ -681,6 +1039,8 @@ int sysfs_finalize(void)
 	}
 	_sysfs_device_count = 0;
 	_sysfs_format_ptr = NULL;
+	sysfs_fd_cache_flush();
+	sysfs_glob_cache_flush();
 	if (opae_mutex_unlock(res, &_sysfs_device_lock)) {
 		OPAE_ERR("Error unlocking mutex");
 		return FPGA_EXCEPTION;
@@ -1034,116 +1394,43 @@ fpga_result sysfs_get_fme_path(const char *sysfs_port, char *sysfs_fme)
 
 fpga_result sysfs_read_int(const char *path, int *i)
 {
-	int fd;
-	int res;
 	char buf[SYSFS_PATH_MAX];
-	int b;
 
 	if (path == NULL) {
 		OPAE_ERR("Invalid input path");
 		return FPGA_INVALID_PARAM;
 	}
 
-	fd = open(path, O_RDONLY);
-	if (fd < 0) {
-		OPAE_MSG("open(%s) failed", path);
+	if (sysfs_read_attr(path, buf, sizeof(buf)))
 		return FPGA_NOT_FOUND;
-	}
-
-	if ((off_t)-1 == lseek(fd, 0, SEEK_SET)) {
-		OPAE_MSG("seek failed");
-		goto out_close;
-	}
-
-	b = 0;
-
-	do {
-		res = read(fd, buf + b, sizeof(buf) - b);
-		if (res <= 0) {
-			OPAE_MSG("Read from %s failed", path);
-			goto out_close;
-		}
-		b += res;
-		if (((unsigned)b > sizeof(buf)) || (b <= 0)) {
-			OPAE_MSG("Unexpected size reading from %s", path);
-			goto out_close;
-		}
-	} while (buf[b - 1] != '\n' && buf[b - 1] != '\0'
-		 && (unsigned)b < sizeof(buf));
-
-	// erase \n
-	buf[b - 1] = 0;
 
 	*i = atoi(buf);
 
-	close(fd);
 	return FPGA_OK;
-
-out_close:
-	close(fd);
-	return FPGA_NOT_FOUND;
 }
 
 fpga_result sysfs_read_u32(const char *path, uint32_t *u)
 {
-	int fd;
-	int res;
 	char buf[SYSFS_PATH_MAX];
-	int b;
 
 	if (path == NULL) {
 		OPAE_ERR("Invalid input path");
 		return FPGA_INVALID_PARAM;
 	}
 
-	fd = open(path, O_RDONLY);
-	if (fd < 0) {
-		OPAE_MSG("open(%s) failed", path);
+	if (sysfs_read_attr(path, buf, sizeof(buf)))
 		return FPGA_NOT_FOUND;
-	}
-
-	if ((off_t)-1 == lseek(fd, 0, SEEK_SET)) {
-		OPAE_MSG("seek failed");
-		goto out_close;
-	}
-
-	b = 0;
-
-	do {
-		res = read(fd, buf + b, sizeof(buf) - b);
-		if (res <= 0) {
-			OPAE_MSG("Read from %s failed", path);
-			goto out_close;
-		}
-		b += res;
-		if (((unsigned)b > sizeof(buf)) || (b <= 0)) {
-			OPAE_MSG("Unexpected size reading from %s", path);
-			goto out_close;
-		}
-	} while (buf[b - 1] != '\n' && buf[b - 1] != '\0'
-		 && (unsigned)b < sizeof(buf));
-
-	// erase \n
-	buf[b - 1] = 0;
 
 	*u = strtoul(buf, NULL, 0);
 
-	close(fd);
 	return FPGA_OK;
-
-out_close:
-	close(fd);
-	return FPGA_NOT_FOUND;
 }
 
 // read tuple separated by 'sep' character
 fpga_result sysfs_read_u32_pair(const char *path, uint32_t *u1, uint32_t *u2,
 				char sep)
 {
-	int fd;
-	int res;
 	char buf[SYSFS_PATH_MAX];
-	int b;
 	char *c;
 	uint32_t x1, x2;
 
@@ -1157,109 +1444,44 @@ fpga_result sysfs_read_u32_pair(const char *path, uint32_t *u1, uint32_t *u2,
 		return FPGA_INVALID_PARAM;
 	}
 
-	fd = open(path, O_RDONLY);
-	if (fd < 0) {
-		OPAE_MSG("open(%s) failed", path);
+	if (sysfs_read_attr(path, buf, sizeof(buf)))
 		return FPGA_NOT_FOUND;
-	}
-
-	if ((off_t)-1 == lseek(fd, 0, SEEK_SET)) {
-		OPAE_MSG("seek failed");
-		goto out_close;
-	}
-
-	b = 0;
-
-	do {
-		res = read(fd, buf + b, sizeof(buf) - b);
-		if (res <= 0) {
-			OPAE_MSG("Read from %s failed", path);
-			goto out_close;
-		}
-		b += res;
-		if (((unsigned)b > sizeof(buf)) || (b <= 0)) {
-			OPAE_MSG("Unexpected size reading from %s", path);
-			goto out_close;
-		}
-	} while (buf[b - 1] != '\n' && buf[b - 1] != '\0'
-		 && (unsigned)b < sizeof(buf));
-
-	// erase \n
-	buf[b - 1] = 0;
 
 	// read first value
 	x1 = strtoul(buf, &c, 0);
 	if (*c != sep) {
 		OPAE_MSG("couldn't find separation character '%c' in '%s'", sep,
 			 path);
-		goto out_close;
+		return FPGA_NOT_FOUND;
 	}
 	// read second value
 	x2 = strtoul(c + 1, &c, 0);
 	if (*c != '\0') {
 		OPAE_MSG("unexpected character '%c' in '%s'", *c, path);
-		goto out_close;
+		return FPGA_NOT_FOUND;
 	}
 
 	*u1 = x1;
 	*u2 = x2;
 
-	close(fd);
 	return FPGA_OK;
-
-out_close:
-	close(fd);
-	return FPGA_NOT_FOUND;
 }
 
 fpga_result sysfs_read_u64(const char *path, uint64_t *u)
 {
-	int fd = -1;
-	int res = 0;
 	char buf[SYSFS_PATH_MAX] = {0};
-	int b = 0;
 
 	if (path == NULL) {
 		OPAE_ERR("Invalid input path");
 		return FPGA_INVALID_PARAM;
 	}
 
-	fd = open(path, O_RDONLY);
-	if (fd < 0) {
-		OPAE_MSG("open(%s) failed", path);
+	if (sysfs_read_attr(path, buf, sizeof(buf)))
 		return FPGA_NOT_FOUND;
-	}
-
-	if ((off_t)-1 == lseek(fd, 0, SEEK_SET)) {
-		OPAE_MSG("seek failed");
-		goto out_close;
-	}
-
-	do {
-		res = read(fd, buf + b, sizeof(buf) - b);
-		if (res <= 0) {
-			OPAE_MSG("Read from %s failed", path);
-			goto out_close;
-		}
-		b += res;
-		if (((unsigned)b > sizeof(buf)) || (b <= 0)) {
-			OPAE_MSG("Unexpected size reading from %s", path);
-			goto out_close;
-		}
-	} while (buf[b - 1] != '\n' && buf[b - 1] != '\0'
-		 && (unsigned)b < sizeof(buf));
-
-	// erase \n
-	buf[b - 1] = 0;
 
 	*u = strtoull(buf, NULL, 0);
 
-	close(fd);
 	return FPGA_OK;
-
-out_close:
-	close(fd);
-	return FPGA_NOT_FOUND;
 }
 
 fpga_result sysfs_write_u64(const char *path, uint64_t u)
@@ -1365,10 +1587,7 @@ out_close:
 
 fpga_result sysfs_read_guid(const char *path, fpga_guid guid)
 {
-	int fd;
-	int res;
 	char buf[SYSFS_PATH_MAX] = { 0, };
-	int b;
 
 	int i;
 	char tmp;
@@ -1379,35 +1598,8 @@ fpga_result sysfs_read_guid(const char *path, fpga_guid guid)
 		return FPGA_INVALID_PARAM;
 	}
 
-	fd = open(path, O_RDONLY);
-	if (fd < 0) {
-		OPAE_MSG("open(%s) failed", path);
+	if (sysfs_read_attr(path, buf, sizeof(buf)))
 		return FPGA_NOT_FOUND;
-	}
-
-	if ((off_t)-1 == lseek(fd, 0, SEEK_SET)) {
-		OPAE_MSG("seek failed");
-		goto out_close;
-	}
-
-	b = 0;
-
-	do {
-		res = read(fd, buf + b, sizeof(buf) - b);
-		if (res <= 0) {
-			OPAE_MSG("Read from %s failed", path);
-			goto out_close;
-		}
-		b += res;
-		if (((unsigned)b > sizeof(buf)) || (b <= 0)) {
-			OPAE_MSG("Unexpected size reading from %s", path);
-			goto out_close;
-		}
-	} while (buf[b - 1] != '\n' && buf[b - 1] != '\0'
-		 && (unsigned)b < sizeof(buf));
-
-	// erase \n
-	buf[b - 1] = 0;
 
 	for (i = 0; i < 32; i += 2) {
 		tmp = buf[i + 2];
@@ -1420,12 +1612,7 @@ fpga_result sysfs_read_guid(const char *path, fpga_guid guid)
 		buf[i + 2] = tmp;
 	}
 
-	close(fd);
 	return FPGA_OK;
-
-out_close:
-	close(fd);
-	return FPGA_NOT_FOUND;
 }
 
 fpga_result check_sysfs_path_is_valid(const char *sysfs_path)
@@ -2045,72 +2232,327 @@ fpga_result destroy_fpga_object(struct _fpga_object *obj)
 	return res;
 }
 
-fpga_result opae_glob_path(char *path, size_t len)
+/*
+ * Glob resolution cache
+ *
+ * FPGA_OBJECT_GLOB lookups are made relative to a token's sysfs path, so
+ * a pattern identifies its token as well as the objects it names. The
+ * paths a pattern resolved to are remembered, so that repeated lookups
+ * skip glob()'s directory walk. The cache is off unless a budget is given
+ * (LIBOPAE_SYSFS_GLOB_CACHE), and entries are dropped when:
+ *  - any path they resolved to no longer exists,
+ *  - the modification time of the directory holding the first wildcard,
+ *    or of a directory holding a resolved path, has changed,
+ *  - enumeration notices FPGA devices coming or going,
+ *  - a device is reconfigured,
+ *  - the least recently used entry makes room for a new pattern.
+ * Directories whose modification time falls in the timestamp tick the
+ * pattern was resolved in are not trusted, so the lookup is repeated.
+ * New matches under a directory that held no match are not noticed, and
+ * sysfs doesn't update every directory's modification time, which is why
+ * the cache is opt-in. Patterns that match nothing are not remembered.
+ */
+#define SYSFS_GLOB_CACHE_BUCKETS 64
+
+struct sysfs_glob_entry {
+	char *pattern;
+	size_t num_paths;
+	char **paths;
+	size_t num_dirs;
+	char **dirs;
+	struct timespec *mtimes;
+	struct timespec resolved;
+	struct sysfs_glob_entry *hash_next;
+	struct sysfs_glob_entry *lru_prev;
+	struct sysfs_glob_entry *lru_next;
+};
+
+static struct {
+	pthread_mutex_t lock;
+	struct sysfs_glob_entry *buckets[SYSFS_GLOB_CACHE_BUCKETS];
+	struct sysfs_glob_entry *lru_head;	// most recently used
+	struct sysfs_glob_entry *lru_tail;
+	uint32_t count;
+	uint32_t max;
+	uint64_t hits;
+	uint64_t misses;
+} sysfs_glob_cache = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+STATIC void sysfs_glob_entry_free(struct sysfs_glob_entry *e)
 {
-	fpga_result res = FPGA_OK;
-	glob_t pglob;
-	pglob.gl_pathc = 0;
-	pglob.gl_pathv = NULL;
-	int globres = glob(path, 0, NULL, &pglob);
-	size_t glob_len;
-	if (!globres) {
-		if (pglob.gl_pathc > 1) {
-			OPAE_MSG("Ambiguous object key - using first one");
-		}
-		glob_len = strnlen(pglob.gl_pathv[0], len-1);
-		memcpy(path, pglob.gl_pathv[0], glob_len);
-		path[glob_len] = '\0';
-		globfree(&pglob);
-	} else {
-		switch (globres) {
-		case GLOB_NOSPACE:
-			res = FPGA_NO_MEMORY;
-			break;
-		case GLOB_NOMATCH:
-			res = FPGA_NOT_FOUND;
-			break;
-		default:
-			res = FPGA_EXCEPTION;
-		}
-		if (pglob.gl_pathv) {
-			globfree(&pglob);
-		}
+	size_t i;
+
+	for (i = 0; i < e->num_paths; ++i)
+		free(e->paths[i]);
+	for (i = 0; i < e->num_dirs; ++i)
+		free(e->dirs[i]);
+	free(e->paths);
+	free(e->dirs);
+	free(e->mtimes);
+	free(e->pattern);
+	free(e);
+}
+
+/*
+ * Remember the modification time of the first len characters of path,
+ * unless that directory is already remembered.
+ */
+STATIC int sysfs_glob_entry_add_dir(struct sysfs_glob_entry *e,
+				    const char *path, size_t len)
+{
+	struct stat st;
+	size_t i;
+	char *dir;
+
+	if (!len)
+		len = 1; // "/"
+
+	for (i = 0; i < e->num_dirs; ++i) {
+		if (!strncmp(e->dirs[i], path, len) && !e->dirs[i][len])
+			return 0;
 	}
-	return res;
+
+	dir = strndup(path, len);
+	if (!dir)
+		return -1;
+
+	if (stat(dir, &st)) {
+		free(dir);
+		return -1;
+	}
+
+	e->dirs[e->num_dirs] = dir;
+	e->mtimes[e->num_dirs] = st.st_mtim;
+	++e->num_dirs;
+	return 0;
 }
 
+STATIC struct sysfs_glob_entry *sysfs_glob_entry_alloc(const char *pattern,
+						       const glob_t *pglob,
+						       const struct timespec *resolved)
+{
+	struct sysfs_glob_entry *e;
+	const char *slash;
+	size_t i;
 
-fpga_result opae_glob_paths(const char *path, size_t found_max, char *found[],
-			    size_t *num_found)
+	e = calloc(1, sizeof(*e));
+	if (!e)
+		return NULL;
+
+	e->pattern = strdup(pattern);
+	e->paths = calloc(pglob->gl_pathc, sizeof(char *));
+	e->dirs = calloc(pglob->gl_pathc + 1, sizeof(char *));
+	e->mtimes = calloc(pglob->gl_pathc + 1, sizeof(struct timespec));
+	if (!e->pattern || !e->paths || !e->dirs || !e->mtimes)
+		goto out_free;
+
+	e->resolved = *resolved;
+
+	// the directory glob() lists for the first wildcard
+	slash = pattern + strcspn(pattern, "*?[");
+	while (slash > pattern && *slash != '/')
+		--slash;
+	if (*slash == '/' &&
+	    sysfs_glob_entry_add_dir(e, pattern, slash - pattern))
+		goto out_free;
+
+	for (i = 0; i < pglob->gl_pathc; ++i) {
+		e->paths[i] = strdup(pglob->gl_pathv[i]);
+		if (!e->paths[i])
+			goto out_free;
+		++e->num_paths;
+
+		slash = strrchr(e->paths[i], '/');
+		if (slash && sysfs_glob_entry_add_dir(e, e->paths[i],
+							slash - e->paths[i]))
+			goto out_free;
+	}
+
+	return e;
+
+out_free:
+	sysfs_glob_entry_free(e);
+	return NULL;
+}
+
+/*
+ * Whether the paths e resolved to may no longer be what its pattern
+ * matches.
+ */
+STATIC bool sysfs_glob_entry_stale(const struct sysfs_glob_entry *e)
+{
+	struct stat st;
+	size_t i;
+
+	for (i = 0; i < e->num_paths; ++i) {
+		if (stat(e->paths[i], &st))
+			return true;
+	}
+
+	for (i = 0; i < e->num_dirs; ++i) {
+		if (stat(e->dirs[i], &st))
+			return true;
+
+		if (st.st_mtim.tv_sec != e->mtimes[i].tv_sec ||
+		    st.st_mtim.tv_nsec != e->mtimes[i].tv_nsec)
+			return true;
+
+		// Changed in the tick the pattern was resolved in?
+		if (e->mtimes[i].tv_sec > e->resolved.tv_sec ||
+		    (e->mtimes[i].tv_sec == e->resolved.tv_sec &&
+		     e->mtimes[i].tv_nsec >= e->resolved.tv_nsec))
+			return true;
+	}
+
+	return false;
+}
+
+STATIC void sysfs_glob_lru_unlink(struct sysfs_glob_entry *e)
+{
+	if (e->lru_prev)
+		e->lru_prev->lru_next = e->lru_next;
+	else
+		sysfs_glob_cache.lru_head = e->lru_next;
+
+	if (e->lru_next)
+		e->lru_next->lru_prev = e->lru_prev;
+	else
+		sysfs_glob_cache.lru_tail = e->lru_prev;
+
+	e->lru_prev = e->lru_next = NULL;
+}
+
+STATIC void sysfs_glob_lru_push(struct sysfs_glob_entry *e)
+{
+	e->lru_prev = NULL;
+	e->lru_next = sysfs_glob_cache.lru_head;
+
+	if (sysfs_glob_cache.lru_head)
+		sysfs_glob_cache.lru_head->lru_prev = e;
+	else
+		sysfs_glob_cache.lru_tail = e;
+
+	sysfs_glob_cache.lru_head = e;
+}
+
+// Must be called with sysfs_glob_cache.lock held.
+STATIC void sysfs_glob_drop(struct sysfs_glob_entry *e)
+{
+	struct sysfs_glob_entry **pe;
+
+	pe = &sysfs_glob_cache.buckets[sysfs_path_hash(e->pattern, 0) %
+				       SYSFS_GLOB_CACHE_BUCKETS];
+	while (*pe != e)
+		pe = &(*pe)->hash_next;
+	*pe = e->hash_next;
+
+	sysfs_glob_lru_unlink(e);
+	--sysfs_glob_cache.count;
+	sysfs_glob_entry_free(e);
+}
+
+// Must be called with sysfs_glob_cache.lock held.
+STATIC void sysfs_glob_trim(uint32_t limit)
 {
+	while (sysfs_glob_cache.count > limit)
+		sysfs_glob_drop(sysfs_glob_cache.lru_tail);
+}
+
+// Must be called with sysfs_glob_cache.lock held.
+STATIC struct sysfs_glob_entry *sysfs_glob_find(const char *pattern,
+						uint32_t h)
+{
+	struct sysfs_glob_entry *e;
+
+	for (e = sysfs_glob_cache.buckets[h] ; e ; e = e->hash_next) {
+		if (!strcmp(e->pattern, pattern))
+			return e;
+	}
+
+	return NULL;
+}
+
+/*
+ * Copy the first found_max paths of a resolved pattern to found[],
+ * which the caller frees.
+ */
+STATIC fpga_result sysfs_glob_copy(char * const paths[], size_t num_paths,
+				   size_t found_max, char *found[])
+{
+	size_t i;
+
+	for (i = 0; found && i < num_paths && i < found_max; ++i) {
+		found[i] = cstr_dup(paths[i]);
+		if (!found[i]) {
+			// we had an error duplicating the string
+			// undo what we've duplicated so far
+			while (i) {
+				free(found[--i]);
+				found[i] = NULL;
+			}
+			OPAE_ERR("Could not copy globbed path");
+			return FPGA_EXCEPTION;
+		}
+	}
+
+	return FPGA_OK;
+}
+
+/*
+ * Resolve pattern to the paths it matches, using the glob cache.
+ * Up to found_max of them are copied to found[], and the number of
+ * matches is returned in *num_found.
+ */
+STATIC fpga_result sysfs_glob(const char *pattern, size_t found_max,
+			      char *found[], size_t *num_found)
+{
+	struct sysfs_glob_entry *e;
 	fpga_result res = FPGA_OK;
+	struct timespec resolved;
 	glob_t pglob;
+	int globres;
+	uint32_t h;
+	int err;
+
+	h = sysfs_path_hash(pattern, 0) % SYSFS_GLOB_CACHE_BUCKETS;
+
+	if (pthread_mutex_lock(&sysfs_glob_cache.lock)) {
+		OPAE_MSG("Failed to lock sysfs glob cache mutex");
+		return FPGA_EXCEPTION;
+	}
+
+	e = sysfs_glob_find(pattern, h);
+	if (e && sysfs_glob_entry_stale(e)) {
+		sysfs_glob_drop(e);
+		e = NULL;
+	}
+
+	if (e) {
+		++sysfs_glob_cache.hits;
+		sysfs_glob_lru_unlink(e);
+		sysfs_glob_lru_push(e);
+		*num_found = e->num_paths;
+		res = sysfs_glob_copy(e->paths, e->num_paths, found_max, found);
+		goto out_unlock;
+	}
+
+	++sysfs_glob_cache.misses;
+
+	// Don't hold the cache lock while glob() walks sysfs.
+	err = pthread_mutex_unlock(&sysfs_glob_cache.lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+
+	// File timestamps come from the coarse clock.
+	clock_gettime(CLOCK_REALTIME_COARSE, &resolved);
+
 	pglob.gl_pathc = 0;
 	pglob.gl_pathv = NULL;
-	int globres = glob(path, 0, NULL, &pglob);
-	size_t i = 0;
-	size_t to_copy = 0;
-
-	if (!globres) {
-		*num_found = pglob.gl_pathc;
-		to_copy = *num_found < found_max ? *num_found : found_max;
-		while (found && i < to_copy) {
-			found[i] = cstr_dup(pglob.gl_pathv[i]);
-			if (!found[i]) {
-				// we had an error duplicating the string
-				// undo what we've duplicated so far
-				while (i) {
-					free(found[--i]);
-					found[i] = NULL;
-				}
-				OPAE_ERR("Could not copy globbed path");
-				res = FPGA_EXCEPTION;
-				goto out_free;
-			}
-			i++;
-		}
-
-	} else {
+	globres = glob(pattern, 0, NULL, &pglob);
+	if (globres) {
 		switch (globres) {
 		case GLOB_NOSPACE:
 			res = FPGA_NO_MEMORY;
@@ -2121,33 +2563,156 @@ fpga_result opae_glob_paths(const char *path, size_t found_max, char *found[],
 		default:
 			res = FPGA_EXCEPTION;
 		}
+		goto out_free;
 	}
+
+	*num_found = pglob.gl_pathc;
+	res = sysfs_glob_copy(pglob.gl_pathv, pglob.gl_pathc, found_max, found);
+	if (res != FPGA_OK)
+		goto out_free;
+
+	if (pthread_mutex_lock(&sysfs_glob_cache.lock)) {
+		OPAE_MSG("Failed to lock sysfs glob cache mutex");
+		goto out_free;
+	}
+
+	// Another thread may have resolved the same pattern meanwhile.
+	if (sysfs_glob_cache.max && !sysfs_glob_find(pattern, h)) {
+		e = sysfs_glob_entry_alloc(pattern, &pglob, &resolved);
+		if (e) {
+			sysfs_glob_trim(sysfs_glob_cache.max - 1);
+			e->hash_next = sysfs_glob_cache.buckets[h];
+			sysfs_glob_cache.buckets[h] = e;
+			sysfs_glob_lru_push(e);
+			++sysfs_glob_cache.count;
+		}
+	}
+
+	err = pthread_mutex_unlock(&sysfs_glob_cache.lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+
 out_free:
 	if (pglob.gl_pathv) {
 		globfree(&pglob);
 	}
 	return res;
+
+out_unlock:
+	err = pthread_mutex_unlock(&sysfs_glob_cache.lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+	return res;
+}
+
+void __XFPGA_API__ xfpga_sysfs_glob_cache_configure(uint32_t max_entries)
+{
+	int err;
+
+	if (pthread_mutex_lock(&sysfs_glob_cache.lock)) {
+		OPAE_MSG("Failed to lock sysfs glob cache mutex");
+		return;
+	}
+
+	sysfs_glob_cache.max = max_entries;
+	sysfs_glob_trim(max_entries);
+
+	if (!max_entries)
+		sysfs_glob_cache.hits = sysfs_glob_cache.misses = 0;
+
+	err = pthread_mutex_unlock(&sysfs_glob_cache.lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+}
+
+void sysfs_glob_cache_flush(void)
+{
+	int err;
+
+	if (pthread_mutex_lock(&sysfs_glob_cache.lock)) {
+		OPAE_MSG("Failed to lock sysfs glob cache mutex");
+		return;
+	}
+
+	sysfs_glob_trim(0);
+
+	err = pthread_mutex_unlock(&sysfs_glob_cache.lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+}
+
+fpga_result __XFPGA_API__ xfpga_sysfs_glob_cache_stats(uint64_t *hits,
+						       uint64_t *misses,
+						       uint32_t *entries)
+{
+	int err;
+
+	ASSERT_NOT_NULL(hits);
+	ASSERT_NOT_NULL(misses);
+	ASSERT_NOT_NULL(entries);
+
+	if (pthread_mutex_lock(&sysfs_glob_cache.lock)) {
+		OPAE_MSG("Failed to lock sysfs glob cache mutex");
+		return FPGA_EXCEPTION;
+	}
+
+	*hits = sysfs_glob_cache.hits;
+	*misses = sysfs_glob_cache.misses;
+	*entries = sysfs_glob_cache.count;
+
+	err = pthread_mutex_unlock(&sysfs_glob_cache.lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+	return FPGA_OK;
+}
+
+fpga_result opae_glob_path(char *path, size_t len)
+{
+	fpga_result res;
+	char *found = NULL;
+	size_t num_found = 0;
+	size_t glob_len;
+
+	res = sysfs_glob(path, 1, &found, &num_found);
+	if (res != FPGA_OK)
+		return res;
+
+	if (num_found > 1) {
+		OPAE_MSG("Ambiguous object key - using first one");
+	}
+	glob_len = strnlen(found, len-1);
+	memcpy(path, found, glob_len);
+	path[glob_len] = '\0';
+	free(found);
+
+	return FPGA_OK;
+}
+
+
+fpga_result opae_glob_paths(const char *path, size_t found_max, char *found[],
+			    size_t *num_found)
+{
+	return sysfs_glob(path, found_max, found, num_found);
 }
 
 fpga_result sync_object(fpga_object obj)
 {
 	struct _fpga_object *_obj;
-	int fd = -1;
 	ssize_t bytes_read = 0;
 	ASSERT_NOT_NULL(obj);
 	_obj = (struct _fpga_object *)obj;
-	fd = open(_obj->path, _obj->perm);
-	if (fd < 0) {
-		OPAE_ERR("Error opening %s: %s", _obj->path, strerror(errno));
-		return FPGA_EXCEPTION;
-	}
-	bytes_read = eintr_read(fd, _obj->buffer, _obj->max_size);
+	bytes_read = sysfs_cached_read(_obj->path, _obj->perm, _obj->buffer,
+				       _obj->max_size);
 	if (bytes_read < 0) {
-		close(fd);
+		OPAE_ERR("Error reading %s: %s", _obj->path, strerror(errno));
 		return FPGA_EXCEPTION;
 	}
 	_obj->size = bytes_read;
-	close(fd);
 	return FPGA_OK;
 }
 
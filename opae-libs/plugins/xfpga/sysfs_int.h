@@ -29,6 +29,7 @@
 
 #include <opae/types.h>
 #include <stdint.h>
+#include <dirent.h>
 #include <unistd.h>
 
 #include "types_int.h"
@@ -121,7 +122,11 @@ fpga_result sysfs_deviceid_from_path(const char *sysfspath,
 				uint64_t *deviceid);
 fpga_result sysfs_objectid_from_path(const char *sysfspath,
 				     uint64_t *object_id);
+int sysfs_filter(const struct dirent *de);
 ssize_t eintr_read(int fd, void *buf, size_t count);
+ssize_t sysfs_cached_read(const char *path, int flags, void *buf, size_t count);
+void sysfs_fd_cache_flush(void);
+void sysfs_glob_cache_flush(void);
 ssize_t eintr_write(int fd, void *buf, size_t count);
 fpga_result cat_token_sysfs_path(char *dest, fpga_token token,
 				 const char *path);
@@ -29,6 +29,12 @@
 #endif // HAVE_CONFIG_H
 
 #include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <inttypes.h>
@@ -391,3 +397,296 @@ fpga_result __XFPGA_API__ xfpga_fpgaObjectGetName(fpga_object obj, char *name,
 
 	return res;
 }
+
+#define READ_PLAN_MAX_DEPTH 8
+#define READ_PLAN_VALUE_MAX 64
+
+STATIC int read_plan_parse(const char *buf, ssize_t len, uint64_t *value)
+{
+	char *endptr = NULL;
+
+	if (len <= 0)
+		return -1;
+
+	errno = 0;
+	*value = strtoull(buf, &endptr, 0);
+	if (errno || endptr == buf)
+		return -1;
+
+	// The whole attribute must be the number, save a trailing newline.
+	if (*endptr == '\n')
+		++endptr;
+	return *endptr == '\0' ? 0 : -1;
+}
+
+STATIC void read_plan_free(struct _fpga_read_plan *plan)
+{
+	uint32_t i;
+
+	for (i = 0; i < plan->count; ++i) {
+		close(plan->entries[i].fd);
+		free(plan->entries[i].name);
+	}
+	free(plan->entries);
+	free(plan);
+}
+
+STATIC fpga_result read_plan_add_file(struct _fpga_read_plan *plan,
+				      const char *path, const char *name)
+{
+	char buf[READ_PLAN_VALUE_MAX];
+	struct _fpga_read_plan_entry *entries;
+	uint64_t value = 0;
+	ssize_t len;
+	int fd;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return FPGA_OK; // not readable - not part of the plan
+
+	len = pread(fd, buf, sizeof(buf) - 1, 0);
+	if (len > 0)
+		buf[len] = '\0';
+
+	if (read_plan_parse(buf, len, &value)) {
+		close(fd);
+		return FPGA_OK;
+	}
+
+	if (plan->count == plan->capacity) {
+		uint32_t capacity = plan->capacity ? plan->capacity * 2 : 16;
+
+		entries = realloc(plan->entries, capacity * sizeof(*entries));
+		if (!entries) {
+			OPAE_ERR("Failed to allocate memory for read plan");
+			close(fd);
+			return FPGA_NO_MEMORY;
+		}
+		plan->entries = entries;
+		plan->capacity = capacity;
+	}
+
+	plan->entries[plan->count].name = strdup(name);
+	if (!plan->entries[plan->count].name) {
+		OPAE_ERR("Failed to allocate memory for read plan");
+		close(fd);
+		return FPGA_NO_MEMORY;
+	}
+	plan->entries[plan->count].fd = fd;
+	++plan->count;
+
+	return FPGA_OK;
+}
+
+STATIC fpga_result read_plan_add_dir(struct _fpga_read_plan *plan,
+				     const char *path, const char *prefix,
+				     int depth)
+{
+	struct dirent **namelist = NULL;
+	char child_path[SYSFS_PATH_MAX];
+	char child_name[SYSFS_PATH_MAX];
+	fpga_result res = FPGA_OK;
+	struct stat st;
+	int n;
+	int i;
+
+	if (depth > READ_PLAN_MAX_DEPTH)
+		return FPGA_OK;
+
+	n = scandir(path, &namelist, sysfs_filter, alphasort);
+	if (n < 0) {
+		OPAE_MSG("Error calling scandir: %s", strerror(errno));
+		return FPGA_EXCEPTION;
+	}
+
+	for (i = 0; i < n; ++i) {
+		unsigned char type = namelist[i]->d_type;
+
+		if (res != FPGA_OK)
+			goto next;
+
+		if (snprintf(child_path, sizeof(child_path), "%s/%s",
+			     path, namelist[i]->d_name) >= (int)sizeof(child_path) ||
+		    snprintf(child_name, sizeof(child_name), "%s%s%s",
+			     prefix, *prefix ? "/" : "",
+			     namelist[i]->d_name) >= (int)sizeof(child_name))
+			goto next;
+
+		if (type == DT_UNKNOWN) {
+			// Filesystems without d_type - find out the hard way.
+			if (lstat(child_path, &st))
+				goto next;
+			if (S_ISLNK(st.st_mode))
+				type = DT_LNK;
+			else if (S_ISDIR(st.st_mode))
+				type = DT_DIR;
+			else if (S_ISREG(st.st_mode))
+				type = DT_REG;
+		}
+
+		// Links lead to other devices (or back here) - don't follow.
+		if (type == DT_DIR)
+			res = read_plan_add_dir(plan, child_path, child_name,
+						depth + 1);
+		else if (type == DT_REG)
+			res = read_plan_add_file(plan, child_path, child_name);
+next:
+		free(namelist[i]);
+	}
+	free(namelist);
+
+	return res;
+}
+
+STATIC fpga_result read_plan_add_object(struct _fpga_read_plan *plan,
+					struct _fpga_object *obj,
+					const char *prefix)
+{
+	char name[SYSFS_PATH_MAX];
+	fpga_result res = FPGA_OK;
+	size_t i;
+
+	if (pthread_mutex_lock(&obj->lock)) {
+		OPAE_ERR("pthread_mutex_lock() failed");
+		return FPGA_EXCEPTION;
+	}
+
+	switch (obj->type) {
+	case FPGA_SYSFS_FILE:
+		res = read_plan_add_file(plan, obj->path,
+					 *prefix ? prefix : obj->name);
+		break;
+	case FPGA_SYSFS_DIR:
+		res = read_plan_add_dir(plan, obj->path, prefix, 0);
+		break;
+	case FPGA_SYSFS_LIST:
+		for (i = 0; i < obj->size && res == FPGA_OK; ++i) {
+			struct _fpga_object *sub =
+				(struct _fpga_object *)obj->objects[i];
+
+			if (snprintf(name, sizeof(name), "%s%s%s", prefix,
+				     *prefix ? "/" : "", sub->name) >=
+			    (int)sizeof(name)) {
+				res = FPGA_INVALID_PARAM;
+				break;
+			}
+			res = read_plan_add_object(plan, sub, name);
+		}
+		break;
+	default:
+		res = FPGA_INVALID_PARAM;
+	}
+
+	if (pthread_mutex_unlock(&obj->lock)) {
+		OPAE_ERR("pthread_mutex_unlock() failed");
+	}
+
+	return res;
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaObjectCreateReadPlan(fpga_object obj,
+							fpga_read_plan *plan)
+{
+	struct _fpga_read_plan *_plan;
+	fpga_result res;
+
+	ASSERT_NOT_NULL(obj);
+	ASSERT_NOT_NULL(plan);
+
+	_plan = calloc(1, sizeof(struct _fpga_read_plan));
+	if (!_plan) {
+		OPAE_ERR("Failed to allocate memory for read plan");
+		return FPGA_NO_MEMORY;
+	}
+
+	res = read_plan_add_object(_plan, (struct _fpga_object *)obj, "");
+	if (res == FPGA_OK && !_plan->count)
+		res = FPGA_NOT_FOUND;
+
+	if (res != FPGA_OK) {
+		read_plan_free(_plan);
+		return res;
+	}
+
+	*plan = (fpga_read_plan)_plan;
+	return FPGA_OK;
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaReadPlanGetCount(fpga_read_plan plan,
+						    uint32_t *count)
+{
+	ASSERT_NOT_NULL(plan);
+	ASSERT_NOT_NULL(count);
+
+	*count = ((struct _fpga_read_plan *)plan)->count;
+	return FPGA_OK;
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaReadPlanGetName(fpga_read_plan plan,
+						   uint32_t index, char *name,
+						   size_t max_len)
+{
+	struct _fpga_read_plan *_plan = (struct _fpga_read_plan *)plan;
+	size_t len;
+
+	ASSERT_NOT_NULL(plan);
+	ASSERT_NOT_NULL(name);
+
+	if (index >= _plan->count || !max_len)
+		return FPGA_INVALID_PARAM;
+
+	len = strnlen(_plan->entries[index].name, max_len - 1);
+	memcpy(name, _plan->entries[index].name, len);
+	name[len] = '\0';
+
+	return FPGA_OK;
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaReadPlanRead(fpga_read_plan plan,
+						uint64_t *values,
+						uint32_t count,
+						uint64_t *timestamp_ns)
+{
+	struct _fpga_read_plan *_plan = (struct _fpga_read_plan *)plan;
+	char buf[READ_PLAN_VALUE_MAX];
+	fpga_result res = FPGA_OK;
+	struct timespec ts;
+	ssize_t len;
+	uint32_t i;
+
+	ASSERT_NOT_NULL(plan);
+	ASSERT_NOT_NULL(values);
+
+	if (count > _plan->count)
+		return FPGA_INVALID_PARAM;
+
+	if (timestamp_ns) {
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		*timestamp_ns = (uint64_t)ts.tv_sec * 1000000000ULL +
+				(uint64_t)ts.tv_nsec;
+	}
+
+	// No locks and no path lookups: one pread() per attribute.
+	for (i = 0; i < count; ++i) {
+		len = pread(_plan->entries[i].fd, buf, sizeof(buf) - 1, 0);
+		if (len > 0)
+			buf[len] = '\0';
+		if (read_plan_parse(buf, len, &values[i])) {
+			values[i] = UINT64_MAX;
+			res = FPGA_EXCEPTION;
+		}
+	}
+
+	return res;
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaDestroyReadPlan(fpga_read_plan *plan)
+{
+	ASSERT_NOT_NULL(plan);
+	ASSERT_NOT_NULL(*plan);
+
+	read_plan_free((struct _fpga_read_plan *)*plan);
+	*plan = NULL;
+
+	return FPGA_OK;
+}
@@ -39,13 +39,72 @@
 
 #include "token_list_int.h"
 
-/* global list of tokens we've seen */
-static struct token_map *token_root;
-/* mutex to protect global data structures */
-extern pthread_mutex_t global_lock;
+/*
+ * Global registry of tokens we've seen.
+ * Lookups (the common case, as every enumeration re-adds the same
+ * tokens) take the lock shared; only insertion and cleanup take it
+ * exclusively.
+ */
+#define TOKEN_HASH_BUCKETS 256 // must be a power of 2
+static struct token_map *token_instance_table[TOKEN_HASH_BUCKETS];
+static struct token_map *token_canonical_table[TOKEN_HASH_BUCKETS];
+static pthread_rwlock_t token_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+static inline uint32_t token_instance_hash(uint32_t device_instance,
+					   uint32_t subdev_instance)
+{
+	return (device_instance * 17659 + subdev_instance) &
+	       (TOKEN_HASH_BUCKETS - 1);
+}
+
+static inline uint32_t token_path_hash(const char *path)
+{
+	// FNV-1a
+	uint32_t h = 2166136261u;
+
+	while (*path) {
+		h ^= (uint8_t)*path++;
+		h *= 16777619u;
+	}
+
+	return h & (TOKEN_HASH_BUCKETS - 1);
+}
+
+static struct token_map *token_find(uint32_t idx, const char *sysfspath,
+				    const char *devpath)
+{
+	struct token_map *tmp;
+
+	for (tmp = token_instance_table[idx] ; NULL != tmp ; tmp = tmp->next) {
+		if ((0 == strncmp(sysfspath, tmp->_token.sysfspath,
+						SYSFS_PATH_MAX)) &&
+				(0 == strncmp(devpath, tmp->_token.devpath,
+					      DEV_PATH_MAX))) {
+			return tmp;
+		}
+	}
+
+	return NULL;
+}
+
+static void token_free(struct token_map *tmp)
+{
+	struct error_list *p = tmp->_token.errors;
+
+	// free error list
+	while (p) {
+		struct error_list *q = p->next;
+		free(p);
+		p = q;
+	}
+
+	// invalidate magic (just in case)
+	tmp->_token.magic = FPGA_INVALID_MAGIC;
+	free(tmp);
+}
 
 /**
- * @brief Add entry to linked list for tokens
+ * @brief Add entry to the token registry
  *	Will allocate memory (which is freed by token_cleanup())
  *
  * @param sysfspath
@@ -56,11 +115,15 @@ extern pthread_mutex_t global_lock;
 struct _fpga_token *token_add(const char *sysfspath, const char *devpath)
 {
 	struct token_map *tmp;
+	struct token_map *found;
 	int err = 0;
 	uint32_t device_instance;
 	uint32_t subdev_instance;
+	uint32_t idx;
+	uint32_t cidx;
 	char *endptr = NULL;
 	const char *ptr;
+	char rpath[PATH_MAX] = { 0, };
 	size_t len;
 
 	/* get the device instance id */
@@ -91,31 +154,27 @@ struct _fpga_token *token_add(const char *sysfspath, const char *devpath)
 		return NULL;
 	}
 
-	if (pthread_mutex_lock(&global_lock)) {
-		OPAE_MSG("Failed to lock global mutex");
+	idx = token_instance_hash(device_instance, subdev_instance);
+
+	/* Fast path: the token is already known. */
+	if (pthread_rwlock_rdlock(&token_lock)) {
+		OPAE_MSG("Failed to lock token registry");
 		return NULL;
 	}
 
-	/* Prevent duplicate entries. */
-	for (tmp = token_root ; NULL != tmp ; tmp = tmp->next) {
-		if ((0 == strncmp(sysfspath, tmp->_token.sysfspath,
-						SYSFS_PATH_MAX)) &&
-				(0 == strncmp(devpath, tmp->_token.devpath,
-					      DEV_PATH_MAX))) {
-			err = pthread_mutex_unlock(&global_lock);
-			if (err) {
-				OPAE_ERR("pthread_mutex_unlock() failed: %S", strerror(err));
-			}
-			return &tmp->_token;
-		}
+	found = token_find(idx, sysfspath, devpath);
+
+	err = pthread_rwlock_unlock(&token_lock);
+	if (err) {
+		OPAE_ERR("pthread_rwlock_unlock() failed: %s", strerror(err));
 	}
 
+	if (found)
+		return &found->_token;
+
+	/* Build the new entry without holding the lock. */
 	tmp = malloc(sizeof(struct token_map));
 	if (!tmp) {
-		err = pthread_mutex_unlock(&global_lock);
-		if (err) {
-			OPAE_ERR("pthread_mutex_unlock() failed: %S", strerror(err));
-		}
 		return NULL;
 	}
 
@@ -128,9 +187,6 @@ struct _fpga_token *token_add(const char *sysfspath, const char *devpath)
 		     "%s/errors", sysfspath) < 0) {
 		OPAE_ERR("snprintf buffer overflow");
 		free(tmp);
-		if (pthread_mutex_unlock(&global_lock)) {
-			OPAE_ERR("pthread_mutex_unlock() failed: %S", strerror(err));
-		}
 		return NULL;
 	}
 
@@ -152,12 +208,35 @@ struct _fpga_token *token_add(const char *sysfspath, const char *devpath)
 	memcpy(tmp->_token.devpath, devpath, len);
 	tmp->_token.devpath[len] = '\0';
 
-	tmp->next = token_root;
-	token_root = tmp;
+	/* canonical path, used to find the parent of a port */
+	ptr = realpath(sysfspath, rpath) ? rpath : sysfspath;
+	len = strnlen(ptr, SYSFS_PATH_MAX - 1);
+	memcpy(tmp->canonical_path, ptr, len);
+	tmp->canonical_path[len] = '\0';
+
+	cidx = token_path_hash(tmp->canonical_path);
 
-	err = pthread_mutex_unlock(&global_lock);
+	if (pthread_rwlock_wrlock(&token_lock)) {
+		OPAE_MSG("Failed to lock token registry");
+		token_free(tmp);
+		return NULL;
+	}
+
+	/* Prevent duplicate entries, if another thread raced us here. */
+	found = token_find(idx, sysfspath, devpath);
+	if (found) {
+		token_free(tmp);
+		tmp = found;
+	} else {
+		tmp->next = token_instance_table[idx];
+		token_instance_table[idx] = tmp;
+		tmp->canonical_next = token_canonical_table[cidx];
+		token_canonical_table[cidx] = tmp;
+	}
+
+	err = pthread_rwlock_unlock(&token_lock);
 	if (err) {
-		OPAE_ERR("pthread_mutex_unlock() failed: %S", strerror(err));
+		OPAE_ERR("pthread_rwlock_unlock() failed: %s", strerror(err));
 	}
 
 	return &tmp->_token;
@@ -174,10 +253,9 @@ struct _fpga_token *token_get_parent(struct _fpga_token *_t)
 {
 	char *p;
 	char spath[SYSFS_PATH_MAX] = { 0, };
-	char rpath[PATH_MAX] = { 0, };
 	struct token_map *itr;
+	struct _fpga_token *parent = NULL;
 	int err = 0;
-	char *rptr = NULL;
 	fpga_result res = FPGA_OK;
 
 	p = strstr(_t->sysfspath, FPGA_SYSFS_AFU);
@@ -191,82 +269,53 @@ struct _fpga_token *token_get_parent(struct _fpga_token *_t)
 		return NULL;
 	}
 
-	if (pthread_mutex_lock(&global_lock)) {
-		OPAE_MSG("Failed to lock global mutex");
+	if (pthread_rwlock_rdlock(&token_lock)) {
+		OPAE_MSG("Failed to lock token registry");
 		return NULL;
 	}
 
-	for (itr = token_root ; NULL != itr ; itr = itr->next) {
-		rptr = realpath(itr->_token.sysfspath, rpath);
-		if (rptr && !strncmp(spath, rptr, SYSFS_PATH_MAX)) {
-			err = pthread_mutex_unlock(&global_lock);
-			if (err) {
-				OPAE_ERR("pthread_mutex_unlock() failed: %S", strerror(err));
-			}
-			return &itr->_token;
+	for (itr = token_canonical_table[token_path_hash(spath)] ;
+	     NULL != itr ; itr = itr->canonical_next) {
+		if (!strncmp(spath, itr->canonical_path, SYSFS_PATH_MAX)) {
+			parent = &itr->_token;
+			break;
 		}
 	}
 
-	err = pthread_mutex_unlock(&global_lock);
+	err = pthread_rwlock_unlock(&token_lock);
 	if (err) {
-		OPAE_ERR("pthread_mutex_unlock() failed: %S", strerror(err));
+		OPAE_ERR("pthread_rwlock_unlock() failed: %s", strerror(err));
 	}
 
-	return NULL;
+	return parent;
 }
 
 /*
- * Clean up remaining entries in linked list
+ * Clean up remaining entries in the registry
  * Will delete all remaining entries
  */
 void token_cleanup(void)
 {
 	int err = 0;
-	struct error_list *p;
+	uint32_t i;
 
-	err = pthread_mutex_lock(&global_lock);
+	err = pthread_rwlock_wrlock(&token_lock);
 	if (err) {
-		OPAE_ERR("pthread_mutex_lock() failed: %s", strerror(err));
+		OPAE_ERR("pthread_rwlock_wrlock() failed: %s", strerror(err));
 		return;
 	}
 
-	if (!token_root)
-		goto out_unlock;
-
-	while (token_root->next) {
-		struct token_map *tmp = token_root;
-		token_root = token_root->next;
-
-		// free error list
-		p = tmp->_token.errors;
-		while (p) {
-			struct error_list *q = p->next;
-			free(p);
-			p = q;
+	for (i = 0 ; i < TOKEN_HASH_BUCKETS ; ++i) {
+		while (token_instance_table[i]) {
+			struct token_map *tmp = token_instance_table[i];
+			token_instance_table[i] = tmp->next;
+			token_free(tmp);
 		}
-
-		// invalidate magic (just in case)
-		tmp->_token.magic = FPGA_INVALID_MAGIC;
-		free(tmp);
+		token_canonical_table[i] = NULL;
 	}
 
-	// free error list
-	p = token_root->_token.errors;
-	while (p) {
-		struct error_list *q = p->next;
-		free(p);
-		p = q;
-	}
-
-	// invalidate magic (just in case)
-	token_root->_token.magic = FPGA_INVALID_MAGIC;
-	free(token_root);
-
-	token_root = NULL;
-
-out_unlock:
-	err = pthread_mutex_unlock(&global_lock);
+	err = pthread_rwlock_unlock(&token_lock);
 	if (err) {
-		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+		OPAE_ERR("pthread_rwlock_unlock() failed: %s", strerror(err));
 	}
 }
@@ -42,6 +42,7 @@
 #include <opae/types_enum.h>
 #include <opae/metrics.h>
 #include "metrics/vector.h"
+#include "metrics/metric_index.h"
 
 #define SYSFS_FPGA_CLASS_PATH "/sys/class/fpga"
 #define FPGA_DEV_PATH "/dev"
@@ -148,6 +149,40 @@ struct _fpga_bmc_metric {
 	struct fpga_metric fpga_metric;             // Metric value
 };
 
+// Upper bound on the MMIO regions cached by FPGA_OPEN_MMIO_PREMAP
+#define XFPGA_MAX_MMIO_REGIONS 4
+
+/*
+ * MMIO region mapped at fpgaOpen() time for lock-free access
+ */
+struct _fpga_mmio_region {
+	uint8_t *base;                  // mapped virtual address
+	uint64_t len;                   // region length in bytes
+};
+
+/*
+ * Idle buffer kept pinned by a handle's buffer pool (FPGA_BUF_POOLED)
+ */
+struct _fpga_pooled_buffer {
+	uint64_t addr;       // virtual address
+	uint64_t iova;       // IO address from the DMA map
+	uint64_t len;        // backing footprint, also the mapped length
+	uint64_t page_size;  // backing page size
+	int flags;           // FPGA_BUF_READ_ONLY or 0
+	struct _fpga_pooled_buffer *next;
+};
+
+#define XFPGA_BUFFER_POOL_IDLE_DEFAULT (256UL * 1024 * 1024)
+
+struct _fpga_buffer_pool {
+	struct _fpga_pooled_buffer *idle; // most recently released first
+	uint64_t max_idle_bytes;
+	uint64_t idle_bytes;
+	uint64_t pinned_bytes;
+	uint64_t hits;
+	uint64_t misses;
+};
+
 /** Process-wide unique FPGA handle */
 struct _fpga_handle {
 	pthread_mutex_t lock;
@@ -155,7 +190,6 @@ struct _fpga_handle {
 	fpga_token token;
 
 	int fddev;                      // file descriptor for the device.
-	int fdfpgad;                    // file descriptor for the event daemon.
 	uint32_t num_irqs;              // number of interrupts supported
 	uint32_t irq_set;               // bitmask of irqs set
 	struct wsid_tracker *wsid_root; // wsid information (list)
@@ -170,8 +204,19 @@ struct _fpga_handle {
 	void *bmc_handle;                                    // bmc module handle
 	struct _fpga_bmc_metric *_bmc_metric_cache_value;    // bmc cache values
 	uint64_t num_bmc_metric;                             // num of bmc values
+	metric_index metric_names;                           // qualifier:name -> vector slot
+	uint64_t *metric_slots;                              // metric_num -> vector slot
+	uint64_t num_metric_slots;                           // 0 when too sparse
+	metric_index bmc_metric_names;                       // name -> bmc cache slot
 #define OPAE_FLAG_HAS_MMX512 (1u << 0)
+#define OPAE_FLAG_MMIO_PREMAP (1u << 1)
 	uint32_t flags;
+
+	// MMIO regions indexed by mmio_num (valid with OPAE_FLAG_MMIO_PREMAP)
+	struct _fpga_mmio_region mmio_regions[XFPGA_MAX_MMIO_REGIONS];
+
+	// recycled FPGA_BUF_POOLED buffers
+	struct _fpga_buffer_pool buffer_pool;
 };
 
 /*
@@ -209,13 +254,16 @@ struct wsid_tracker {
 };
 
 /*
- * Global list to store tokens received during enumeration
+ * Global registry to store tokens received during enumeration
  * Since tokens as seen by the API are only void*, we need to keep the actual
- * structs somewhere.
+ * structs somewhere. Each entry is hashed twice: by its
+ * (device_instance, subdev_instance) pair and by its canonical sysfs path.
  */
 struct token_map {
 	struct _fpga_token _token;
-	struct token_map *next;
+	char canonical_path[SYSFS_PATH_MAX]; // realpath() of _token.sysfspath
+	struct token_map *next;           // instance bucket chain
+	struct token_map *canonical_next; // canonical path bucket chain
 };
 
 typedef enum {
@@ -237,6 +285,20 @@ struct _fpga_object {
 	fpga_object *objects;
 };
 
+/*
+ * One attribute of a read plan, kept open for re-reading
+ */
+struct _fpga_read_plan_entry {
+	char *name;	// path relative to the plan's object
+	int fd;
+};
+
+struct _fpga_read_plan {
+	uint32_t count;
+	uint32_t capacity;
+	struct _fpga_read_plan_entry *entries;
+};
+
 typedef char max_path_t[PATH_MAX];
 
 #ifdef __cplusplus
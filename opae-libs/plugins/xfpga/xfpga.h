@@ -52,12 +52,48 @@ fpga_result xfpga_fpgaReadMMIO32(fpga_handle handle, uint32_t mmio_num,
 				 uint64_t offset, uint32_t *value);
 fpga_result xfpga_fpgaWriteMMIO512(fpga_handle handle, uint32_t mmio_num,
 				  uint64_t offset, const void *value);
+fpga_result xfpga_fpgaReadMMIO64Vec(fpga_handle handle, uint32_t mmio_num,
+				    const uint64_t *offsets, uint64_t *values,
+				    uint32_t count);
+fpga_result xfpga_fpgaWriteMMIO64Vec(fpga_handle handle, uint32_t mmio_num,
+				     const uint64_t *offsets,
+				     const uint64_t *values, uint32_t count);
+fpga_result xfpga_fpgaReadMMIO64Range(fpga_handle handle, uint32_t mmio_num,
+				      uint64_t offset, uint64_t *values,
+				      uint32_t count);
+fpga_result xfpga_fpgaWriteMMIO64Range(fpga_handle handle, uint32_t mmio_num,
+				       uint64_t offset, const uint64_t *values,
+				       uint32_t count);
 fpga_result xfpga_fpgaMapMMIO(fpga_handle handle, uint32_t mmio_num,
 			      uint64_t **mmio_ptr);
 fpga_result xfpga_fpgaUnmapMMIO(fpga_handle handle, uint32_t mmio_num);
+fpga_result xfpga_fpgaGetMMIOAccessor(fpga_handle handle, uint32_t mmio_num,
+				      fpga_mmio_accessor *accessor);
 fpga_result xfpga_fpgaEnumerate(const fpga_properties *filters,
 				uint32_t num_filters, fpga_token *tokens,
 				uint32_t max_tokens, uint32_t *num_matches);
+/*
+ * Enumeration cache controls. A max_age_ms of 0 disables the cache,
+ * UINT64_MAX keeps the snapshot until it is invalidated.
+ */
+void xfpga_enum_cache_configure(uint64_t max_age_ms);
+void xfpga_enum_cache_invalidate(void);
+fpga_result xfpga_enum_cache_stats(uint64_t *hits, uint64_t *misses);
+/*
+ * sysfs attribute fd cache controls. At most max_fds attribute fds are
+ * kept open for re-reading; 0 disables the cache.
+ */
+void xfpga_sysfs_fd_cache_configure(uint32_t max_fds);
+fpga_result xfpga_sysfs_fd_cache_stats(uint64_t *hits, uint64_t *misses,
+				       uint32_t *open_fds);
+/*
+ * sysfs glob resolution cache controls. At most max_entries resolved
+ * FPGA_OBJECT_GLOB patterns are remembered; 0 (the default) disables
+ * the cache.
+ */
+void xfpga_sysfs_glob_cache_configure(uint32_t max_entries);
+fpga_result xfpga_sysfs_glob_cache_stats(uint64_t *hits, uint64_t *misses,
+					 uint32_t *entries);
 fpga_result xfpga_fpgaCloneToken(fpga_token src, fpga_token *dst);
 fpga_result xfpga_fpgaDestroyToken(fpga_token *token);
 fpga_result xfpga_fpgaGetNumUmsg(fpga_handle handle, uint64_t *value);
@@ -66,7 +102,17 @@ fpga_result xfpga_fpgaTriggerUmsg(fpga_handle handle, uint64_t value);
 fpga_result xfpga_fpgaGetUmsgPtr(fpga_handle handle, uint64_t **umsg_ptr);
 fpga_result xfpga_fpgaPrepareBuffer(fpga_handle handle, uint64_t len,
 				    void **buf_addr, uint64_t *wsid, int flags);
+/*
+ * Number of 2 MiB and 1 GiB hugepages currently backing buffers
+ * allocated by xfpga_fpgaPrepareBuffer().
+ */
+fpga_result xfpga_buffer_hugepages(uint64_t *pages_2m, uint64_t *pages_1g);
 fpga_result xfpga_fpgaReleaseBuffer(fpga_handle handle, uint64_t wsid);
+fpga_result xfpga_fpgaBufferPoolConfigure(fpga_handle handle,
+					  uint64_t max_idle_bytes);
+fpga_result xfpga_fpgaBufferPoolTrim(fpga_handle handle);
+fpga_result xfpga_fpgaBufferPoolGetStats(fpga_handle handle,
+					 fpga_buffer_pool_stats *stats);
 fpga_result xfpga_fpgaGetIOAddress(fpga_handle handle, uint64_t wsid,
 				   uint64_t *ioaddr);
 fpga_result xfpga_fpgaGetOPAECVersion(fpga_version *version);
@@ -119,6 +165,14 @@ fpga_result xfpga_fpgaObjectRead(fpga_object obj, uint8_t *buffer,
 				 size_t offset, size_t len, int flags);
 fpga_result xfpga_fpgaObjectRead64(fpga_object obj, uint64_t *value, int flags);
 fpga_result xfpga_fpgaObjectWrite64(fpga_object obj, uint64_t value, int flags);
+fpga_result xfpga_fpgaObjectCreateReadPlan(fpga_object obj,
+					   fpga_read_plan *plan);
+fpga_result xfpga_fpgaReadPlanGetCount(fpga_read_plan plan, uint32_t *count);
+fpga_result xfpga_fpgaReadPlanGetName(fpga_read_plan plan, uint32_t index,
+				      char *name, size_t max_len);
+fpga_result xfpga_fpgaReadPlanRead(fpga_read_plan plan, uint64_t *values,
+				   uint32_t count, uint64_t *timestamp_ns);
+fpga_result xfpga_fpgaDestroyReadPlan(fpga_read_plan *plan);
 fpga_result xfpga_fpgaSetUserClock(fpga_handle handle, uint64_t low_clk,
 				   uint64_t high_clk, int flags);
 fpga_result xfpga_fpgaGetUserClock(fpga_handle handle, uint64_t *low_clk,
@@ -145,6 +199,52 @@ fpga_result xfpga_fpgaGetMetricsThresholdInfo(fpga_handle handle,
 			metric_threshold *metric_threshold,
 			uint32_t *num_thresholds);
 
+fpga_result xfpga_fpgaCreateMetricsSession(fpga_handle handle,
+				    const uint64_t *metric_num,
+				    uint64_t num_metric_indexes,
+				    fpga_metrics_session *session);
+
+fpga_result xfpga_fpgaSampleMetricsSession(fpga_metrics_session session,
+				    fpga_metric *metrics);
+
+fpga_result xfpga_fpgaDestroyMetricsSession(fpga_metrics_session *session);
+
+fpga_result xfpga_fpgaCreateMetricsCollector(fpga_handle handle,
+				    const uint64_t *metric_num,
+				    uint64_t num_metric_indexes,
+				    uint32_t period_usec,
+				    uint32_t depth,
+				    fpga_metrics_collector *collector);
+
+fpga_result xfpga_fpgaReadLatestMetrics(fpga_metrics_collector collector,
+				    fpga_metric *metrics,
+				    uint64_t *sequence);
+
+fpga_result xfpga_fpgaReadMetricsHistory(fpga_metrics_collector collector,
+				    uint64_t *cursor,
+				    fpga_metric *metrics,
+				    uint64_t max_samples,
+				    uint64_t *num_samples);
+
+fpga_result xfpga_fpgaDestroyMetricsCollector(fpga_metrics_collector *collector);
+
+fpga_result xfpga_fpgaCreateThresholdMonitor(fpga_handle handle,
+				    const uint64_t *metric_num,
+				    uint64_t num_metric_indexes,
+				    fpga_threshold_callback callback,
+				    void *context,
+				    fpga_event_handle event_handle,
+				    fpga_threshold_monitor *monitor);
+
+fpga_result xfpga_fpgaEvaluateThresholds(fpga_threshold_monitor monitor,
+				    const fpga_metric *metrics,
+				    uint64_t *num_transitions);
+
+fpga_result xfpga_fpgaGetThresholdStates(fpga_threshold_monitor monitor,
+				    uint32_t *states);
+
+fpga_result xfpga_fpgaDestroyThresholdMonitor(fpga_threshold_monitor *monitor);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
@@ -92,6 +92,7 @@ PYBIND11_MODULE(_opae, m) {
   py::enum_<fpga_open_flags>(m, "fpga_open_flags", py::arithmetic(),
                              "OPAE flags for opening resources")
       .value("OPEN_SHARED", FPGA_OPEN_SHARED)
+      .value("OPEN_MMIO_PREMAP", FPGA_OPEN_MMIO_PREMAP)
       .export_values();
 
   py::enum_<fpga_event_type>(m, "fpga_event_type", py::arithmetic(),
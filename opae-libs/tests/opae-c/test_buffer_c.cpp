@@ -119,4 +119,37 @@ TEST_P(buffer_c_p, ioaddr) {
   EXPECT_EQ(fpgaReleaseBuffer(accel_, wsid), FPGA_OK);
 }
 
+/**
+ * @test       pool
+ * @brief      Test: fpgaBufferPoolConfigure, fpgaBufferPoolTrim,
+ *             fpgaBufferPoolGetStats
+ * @details    When a buffer prepared with FPGA_BUF_POOLED is released,<br>
+ *             the next pooled buffer of the same size reuses it,<br>
+ *             and fpgaBufferPoolTrim frees the idle buffers.<br>
+ */
+TEST_P(buffer_c_p, pool) {
+  fpga_buffer_pool_stats stats;
+  void *buf_addr = nullptr;
+  void *reused = nullptr;
+  uint64_t wsid = 0;
+  ASSERT_EQ(fpgaBufferPoolConfigure(accel_, 4 * pg_size_), FPGA_OK);
+  ASSERT_EQ(fpgaPrepareBuffer(accel_, (uint64_t) pg_size_,
+                              &buf_addr, &wsid, FPGA_BUF_POOLED), FPGA_OK);
+  EXPECT_EQ(fpgaReleaseBuffer(accel_, wsid), FPGA_OK);
+  ASSERT_EQ(fpgaPrepareBuffer(accel_, (uint64_t) pg_size_,
+                              &reused, &wsid, FPGA_BUF_POOLED), FPGA_OK);
+  EXPECT_EQ(reused, buf_addr);
+  EXPECT_EQ(fpgaReleaseBuffer(accel_, wsid), FPGA_OK);
+
+  ASSERT_EQ(fpgaBufferPoolGetStats(accel_, &stats), FPGA_OK);
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.idle_bytes, stats.pinned_bytes);
+
+  EXPECT_EQ(fpgaBufferPoolTrim(accel_), FPGA_OK);
+  ASSERT_EQ(fpgaBufferPoolGetStats(accel_, &stats), FPGA_OK);
+  EXPECT_EQ(stats.pinned_bytes, 0);
+  EXPECT_EQ(fpgaBufferPoolGetStats(accel_, nullptr), FPGA_INVALID_PARAM);
+}
+
 INSTANTIATE_TEST_CASE_P(buffer_c, buffer_c_p, ::testing::ValuesIn(test_platform::platforms({})));
@@ -718,6 +718,60 @@ TEST_P(enum_c_p, num_interrupts) {
   EXPECT_EQ(num_matches_, 0);
 }
 
+/**
+ * @test       enum_alloc
+ * @brief      Test: fpgaEnumerateAlloc, fpgaDestroyTokens
+ * @details    fpgaEnumerateAlloc returns an array holding every match<br>
+ *             in a single call, and fpgaDestroyTokens releases it.<br>
+ */
+TEST_P(enum_c_p, enum_alloc) {
+  fpga_token *tokens = nullptr;
+  uint32_t num_tokens = 0;
+
+  EXPECT_EQ(fpgaEnumerate(nullptr, 0, nullptr, 0, &num_matches_), FPGA_OK);
+  EXPECT_EQ(fpgaEnumerateAlloc(nullptr, 0, &tokens, &num_tokens), FPGA_OK);
+  EXPECT_EQ(num_tokens, num_matches_);
+  ASSERT_NE(tokens, nullptr);
+  for (uint32_t i = 0; i < num_tokens; ++i) {
+    EXPECT_NE(nullptr, opae_validate_wrapped_token(tokens[i]));
+  }
+  EXPECT_EQ(fpgaDestroyTokens(&tokens, num_tokens), FPGA_OK);
+  EXPECT_EQ(tokens, nullptr);
+
+  ASSERT_EQ(fpgaPropertiesSetObjectType(filter_, FPGA_ACCELERATOR), FPGA_OK);
+  EXPECT_EQ(fpgaEnumerateAlloc(&filter_, 1, &tokens, &num_tokens), FPGA_OK);
+  EXPECT_EQ(num_tokens, GetNumFpgas());
+  EXPECT_EQ(fpgaDestroyTokens(&tokens, num_tokens), FPGA_OK);
+
+  ASSERT_EQ(fpgaPropertiesSetDeviceID(filter_, invalid_device_.device_id),
+            FPGA_OK);
+  EXPECT_EQ(fpgaEnumerateAlloc(&filter_, 1, &tokens, &num_tokens), FPGA_OK);
+  EXPECT_EQ(num_tokens, 0);
+  EXPECT_EQ(tokens, nullptr);
+  EXPECT_EQ(fpgaDestroyTokens(&tokens, num_tokens), FPGA_OK);
+}
+
+/**
+ * @test       enum_alloc_neg
+ * @brief      Test: fpgaEnumerateAlloc, fpgaDestroyTokens
+ * @details    When given NULL output pointers or inconsistent filter<br>
+ *             arguments, the functions return FPGA_INVALID_PARAM.<br>
+ */
+TEST_P(enum_c_p, enum_alloc_neg) {
+  fpga_token *tokens = nullptr;
+  uint32_t num_tokens = 0;
+
+  EXPECT_EQ(fpgaEnumerateAlloc(nullptr, 0, nullptr, &num_tokens),
+            FPGA_INVALID_PARAM);
+  EXPECT_EQ(fpgaEnumerateAlloc(nullptr, 0, &tokens, nullptr),
+            FPGA_INVALID_PARAM);
+  EXPECT_EQ(fpgaEnumerateAlloc(nullptr, 1, &tokens, &num_tokens),
+            FPGA_INVALID_PARAM);
+  EXPECT_EQ(fpgaEnumerateAlloc(&filter_, 0, &tokens, &num_tokens),
+            FPGA_INVALID_PARAM);
+  EXPECT_EQ(fpgaDestroyTokens(nullptr, 0), FPGA_INVALID_PARAM);
+}
+
 TEST(wrapper, validate) {
   EXPECT_EQ(NULL, opae_validate_wrapped_token(NULL));
   EXPECT_EQ(NULL, opae_validate_wrapped_handle(NULL));
@@ -225,6 +225,98 @@ TEST_P(event_c_p, destroy_err) {
 			  event_handle_), FPGA_OK);
 }
 
+/**
+ * @test       event_set
+ * @brief      Test: fpgaCreateEventSet, fpgaEventSetAdd, fpgaEventSetWait,
+ *             fpgaEventSetRemove, fpgaDestroyEventSet
+ * @details    Given an event set holding two registered event handles,<br>
+ *             when one of them is signaled,<br>
+ *             fpgaEventSetWait reports exactly that handle, its event type,<br>
+ *             context and count, and consumes the count.<br>
+ */
+TEST_P(event_c_p, event_set) {
+  fpga_event_handle eh2 = nullptr;
+  fpga_event_set set = nullptr;
+  std::array<fpga_event_set_event, 4> events;
+  uint32_t num_events = 0;
+  int fd = -1;
+  int ctx = 0;
+  uint64_t val = 3;
+
+  ASSERT_EQ(fpgaCreateEventHandle(&eh2), FPGA_OK);
+  ASSERT_EQ(fpgaRegisterEvent(accel_, FPGA_EVENT_ERROR,
+                              event_handle_, 0), FPGA_OK);
+  ASSERT_EQ(fpgaRegisterEvent(accel_, FPGA_EVENT_ERROR,
+                              eh2, 0), FPGA_OK);
+
+  ASSERT_EQ(fpgaCreateEventSet(&set), FPGA_OK);
+  EXPECT_EQ(fpgaEventSetAdd(set, accel_, event_handle_,
+                            FPGA_EVENT_ERROR, &ctx), FPGA_OK);
+  EXPECT_EQ(fpgaEventSetAdd(set, accel_, eh2,
+                            FPGA_EVENT_ERROR, nullptr), FPGA_OK);
+  EXPECT_EQ(fpgaEventSetAdd(set, accel_, eh2,
+                            FPGA_EVENT_ERROR, nullptr), FPGA_INVALID_PARAM);
+
+  EXPECT_EQ(fpgaEventSetWait(set, events.data(), events.size(),
+                             0, &num_events), FPGA_OK);
+  EXPECT_EQ(num_events, 0);
+
+  ASSERT_EQ(fpgaGetOSObjectFromEventHandle(event_handle_, &fd), FPGA_OK);
+  ASSERT_EQ(write(fd, &val, sizeof(val)), sizeof(val));
+
+  EXPECT_EQ(fpgaEventSetWait(set, events.data(), events.size(),
+                             1000, &num_events), FPGA_OK);
+  ASSERT_EQ(num_events, 1);
+  EXPECT_EQ(events[0].handle, accel_);
+  EXPECT_EQ(events[0].event_handle, event_handle_);
+  EXPECT_EQ(events[0].event_type, FPGA_EVENT_ERROR);
+  EXPECT_EQ(events[0].count, 3);
+  EXPECT_EQ(events[0].context, &ctx);
+
+  EXPECT_EQ(fpgaEventSetWait(set, events.data(), events.size(),
+                             0, &num_events), FPGA_OK);
+  EXPECT_EQ(num_events, 0);
+
+  // A removed source is no longer reported.
+  EXPECT_EQ(fpgaEventSetRemove(set, event_handle_), FPGA_OK);
+  EXPECT_EQ(fpgaEventSetRemove(set, event_handle_), FPGA_NOT_FOUND);
+  ASSERT_EQ(write(fd, &val, sizeof(val)), sizeof(val));
+  EXPECT_EQ(fpgaEventSetWait(set, events.data(), events.size(),
+                             0, &num_events), FPGA_OK);
+  EXPECT_EQ(num_events, 0);
+
+  EXPECT_EQ(fpgaEventSetWait(set, events.data(), 0,
+                             0, &num_events), FPGA_INVALID_PARAM);
+
+  EXPECT_EQ(fpgaEventSetRemove(set, eh2), FPGA_OK);
+  EXPECT_EQ(fpgaDestroyEventSet(&set), FPGA_OK);
+  EXPECT_EQ(set, nullptr);
+
+  EXPECT_EQ(fpgaUnregisterEvent(accel_, FPGA_EVENT_ERROR, eh2), FPGA_OK);
+  EXPECT_EQ(fpgaUnregisterEvent(accel_, FPGA_EVENT_ERROR,
+                                event_handle_), FPGA_OK);
+  EXPECT_EQ(fpgaDestroyEventHandle(&eh2), FPGA_OK);
+}
+
+/**
+ * @test       event_set_err
+ * @brief      Test: fpgaEventSetAdd
+ * @details    When fpgaEventSetAdd is called with an event handle<br>
+ *             that has not been registered,<br>
+ *             the fn returns FPGA_INVALID_PARAM.<br>
+ */
+TEST_P(event_c_p, event_set_err) {
+  fpga_event_set set = nullptr;
+
+  ASSERT_EQ(fpgaCreateEventSet(&set), FPGA_OK);
+  EXPECT_EQ(fpgaEventSetAdd(set, accel_, event_handle_,
+                            FPGA_EVENT_ERROR, nullptr), FPGA_INVALID_PARAM);
+  EXPECT_EQ(fpgaEventSetAdd(set, nullptr, event_handle_,
+                            FPGA_EVENT_ERROR, nullptr), FPGA_INVALID_PARAM);
+  EXPECT_EQ(fpgaDestroyEventSet(&set), FPGA_OK);
+  EXPECT_EQ(fpgaDestroyEventSet(&set), FPGA_INVALID_PARAM);
+}
+
 INSTANTIATE_TEST_CASE_P(event_c, event_c_p, 
                         ::testing::ValuesIn(test_platform::platforms({})));
 
@@ -200,5 +200,101 @@ TEST_P(mmio_c_p, mmio512) {
 }
 #endif // TEST_SUPPORTS_AVX512
 
+/**
+ * @test       mmio64_vec
+ * @brief      Test: fpgaWriteMMIO64Vec, fpgaReadMMIO64Vec,
+ *             fpgaWriteMMIO64Range, fpgaReadMMIO64Range
+ * @details    Write a list of registers in one call,<br>
+ *             read them back with the batched and single-register APIs.<br>
+ *             Values written should equal values read.<br>
+ */
+TEST_P(mmio_c_p, mmio64_vec) {
+  const uint64_t offsets[3] = { CSR_SCRATCHPAD0 + 0x10, CSR_SCRATCHPAD0,
+                                CSR_SCRATCHPAD0 + 0x8 };
+  const uint64_t val_written[3] = { 0xdeadbeef, 0xdecafbad, 0xc0cac01a };
+  uint64_t val_read[3] = { 0, 0, 0 };
+  uint64_t val = 0;
+
+  EXPECT_EQ(fpgaWriteMMIO64Vec(accel_, which_mmio_,
+                               offsets, val_written, 3), FPGA_OK);
+  EXPECT_EQ(fpgaReadMMIO64Vec(accel_, which_mmio_,
+                              offsets, val_read, 3), FPGA_OK);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(val_written[i], val_read[i]);
+    EXPECT_EQ(fpgaReadMMIO64(accel_, which_mmio_, offsets[i], &val), FPGA_OK);
+    EXPECT_EQ(val_written[i], val);
+  }
+
+  EXPECT_EQ(fpgaWriteMMIO64Range(accel_, which_mmio_,
+                                 CSR_SCRATCHPAD0, val_written, 3), FPGA_OK);
+  EXPECT_EQ(fpgaReadMMIO64Range(accel_, which_mmio_,
+                                CSR_SCRATCHPAD0, val_read, 3), FPGA_OK);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(val_written[i], val_read[i]);
+  }
+
+  EXPECT_EQ(fpgaReadMMIO64Vec(accel_, which_mmio_,
+                              nullptr, val_read, 3), FPGA_INVALID_PARAM);
+  EXPECT_EQ(fpgaReadMMIO64Range(nullptr, which_mmio_,
+                                CSR_SCRATCHPAD0, val_read, 3), FPGA_INVALID_PARAM);
+}
+
+/**
+ * @test       accessor
+ * @brief      Test: fpgaGetMMIOAccessor, fpgaAccessorReadMMIO64,
+ *             fpgaAccessorWriteMMIO64, fpgaAccessorReadMMIO32,
+ *             fpgaAccessorWriteMMIO32
+ * @details    The accessor resolves the mapped base and length once.<br>
+ *             Values written through the accessor are read back both<br>
+ *             through the accessor and fpgaReadMMIO64, and misaligned<br>
+ *             or out-of-range offsets, including ones whose end wraps,<br>
+ *             are rejected by the fallback.<br>
+ */
+TEST_P(mmio_c_p, accessor) {
+  fpga_mmio_accessor acc;
+  const uint64_t val64 = 0xdeadbeefdecafbad;
+  const uint32_t val32 = 0xc0cac01a;
+  uint64_t read64 = 0;
+  uint32_t read32 = 0;
+
+  ASSERT_EQ(fpgaGetMMIOAccessor(accel_, which_mmio_, &acc), FPGA_OK);
+  EXPECT_NE(acc.base, nullptr);
+  EXPECT_EQ(acc.len, 0x40000);
+  EXPECT_EQ(acc.handle, accel_);
+  EXPECT_EQ(acc.mmio_num, which_mmio_);
+
+  EXPECT_EQ(fpgaAccessorWriteMMIO64(&acc, CSR_SCRATCHPAD0, val64), FPGA_OK);
+  EXPECT_EQ(fpgaAccessorReadMMIO64(&acc, CSR_SCRATCHPAD0, &read64), FPGA_OK);
+  EXPECT_EQ(val64, read64);
+  read64 = 0;
+  EXPECT_EQ(fpgaReadMMIO64(accel_, which_mmio_,
+                           CSR_SCRATCHPAD0, &read64), FPGA_OK);
+  EXPECT_EQ(val64, read64);
+
+  EXPECT_EQ(fpgaAccessorWriteMMIO32(&acc, CSR_SCRATCHPAD0, val32), FPGA_OK);
+  EXPECT_EQ(fpgaAccessorReadMMIO32(&acc, CSR_SCRATCHPAD0, &read32), FPGA_OK);
+  EXPECT_EQ(val32, read32);
+
+  EXPECT_NE(fpgaAccessorReadMMIO64(&acc, CSR_SCRATCHPAD0 + 1, &read64), FPGA_OK);
+  EXPECT_NE(fpgaAccessorWriteMMIO64(&acc, 0x40000, val64), FPGA_OK);
+
+  // offsets whose end wraps past UINT64_MAX are out of range too
+  EXPECT_NE(fpgaAccessorReadMMIO64(&acc, UINT64_MAX - 7, &read64), FPGA_OK);
+  EXPECT_NE(fpgaAccessorWriteMMIO64(&acc, UINT64_MAX - 7, val64), FPGA_OK);
+  EXPECT_NE(fpgaAccessorReadMMIO32(&acc, UINT64_MAX - 3, &read32), FPGA_OK);
+  EXPECT_NE(fpgaAccessorWriteMMIO32(&acc, UINT64_MAX - 3, val32), FPGA_OK);
+}
+
+/**
+ * @test       accessor_neg
+ * @brief      Test: fpgaGetMMIOAccessor
+ * @details    NULL or invalid arguments return FPGA_INVALID_PARAM.<br>
+ */
+TEST_P(mmio_c_p, accessor_neg) {
+  fpga_mmio_accessor acc;
+  EXPECT_EQ(fpgaGetMMIOAccessor(nullptr, which_mmio_, &acc), FPGA_INVALID_PARAM);
+  EXPECT_EQ(fpgaGetMMIOAccessor(accel_, which_mmio_, nullptr), FPGA_INVALID_PARAM);
+}
+
 INSTANTIATE_TEST_CASE_P(mmio_c, mmio_c_p,
                         ::testing::ValuesIn(test_platform::platforms({ "dfl-n3000","dfl-d5005" })));
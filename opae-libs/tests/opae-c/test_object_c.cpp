@@ -258,6 +258,38 @@ TEST_P(object_c_p, obj_get_size) {
   EXPECT_EQ(value, afu_guid_.size() + 1);
 }
 
+/**
+ * @test       read_plan
+ * @brief      Test: fpgaObjectCreateReadPlan, fpgaReadPlanRead
+ * @details    A read plan compiled from a container object samples<br>
+ *             all of its integer attributes in one call, and<br>
+ *             fpgaDestroyReadPlan releases it.<br>
+ */
+TEST_P(object_c_p, read_plan) {
+  fpga_object errors_obj = nullptr;
+  fpga_read_plan plan = nullptr;
+  uint32_t count = 0;
+  uint64_t ts = 0;
+  char name[256];
+
+  ASSERT_EQ(fpgaHandleGetObject(accel_, "errors", &errors_obj, 0), FPGA_OK);
+  ASSERT_EQ(fpgaObjectCreateReadPlan(errors_obj, &plan), FPGA_OK);
+  ASSERT_EQ(fpgaReadPlanGetCount(plan, &count), FPGA_OK);
+  ASSERT_GT(count, 0);
+  EXPECT_EQ(fpgaReadPlanGetName(plan, 0, name, sizeof(name)), FPGA_OK);
+
+  std::vector<uint64_t> values(count);
+  EXPECT_EQ(fpgaReadPlanRead(plan, values.data(), count, &ts), FPGA_OK);
+  EXPECT_GT(ts, 0);
+
+  EXPECT_EQ(fpgaReadPlanRead(nullptr, values.data(), count, &ts),
+            FPGA_INVALID_PARAM);
+  EXPECT_EQ(fpgaReadPlanGetCount(errors_obj, &count), FPGA_INVALID_PARAM);
+  EXPECT_EQ(fpgaDestroyReadPlan(&plan), FPGA_OK);
+  EXPECT_EQ(plan, nullptr);
+  EXPECT_EQ(fpgaDestroyObject(&errors_obj), FPGA_OK);
+}
+
 INSTANTIATE_TEST_CASE_P(object_c, object_c_p,
                         ::testing::ValuesIn(test_platform::platforms({ "dfl-n3000","dfl-d5005" })));
 
@@ -38,6 +38,10 @@ int opae_plugin_mgr_free_adapter(opae_api_adapter_table *adapter);
 int opae_plugin_mgr_register_adapter(opae_api_adapter_table *adapter);
 int opae_plugin_mgr_for_each_adapter
 	(int (*callback)(const opae_api_adapter_table *, void *), void *context);
+uint32_t opae_plugin_mgr_adapter_count(void);
+uint32_t opae_plugin_mgr_for_each_adapter_parallel(opae_adapter_job job,
+						   void *context,
+						   uint32_t max_adapters);
 int opae_plugin_mgr_configure_plugin(opae_api_adapter_table *adapter,
 				     const char *config);
 int process_cfg_buffer(const char *buffer, const char *filename);
@@ -204,6 +208,44 @@ TEST_P(pluginmgr_c_p, foreach_err) {
   EXPECT_EQ(2, test_plugin_finalize_called);
 }
 
+extern "C" {
+static void test_adapter_job(const opae_api_adapter_table *adapter,
+                             uint32_t index, void *context)
+{
+  const opae_api_adapter_table **seen =
+    (const opae_api_adapter_table **)context;
+  seen[index] = adapter;
+}
+}
+
+/**
+ * @test       foreach_parallel
+ * @brief      Test: opae_plugin_mgr_for_each_adapter_parallel
+ * @details    The job runs once per adapter, and its index is the<br>
+ *             adapter's position in the adapter list. At most<br>
+ *             max_adapters adapters are visited.<br>
+ */
+TEST_P(pluginmgr_c_p, foreach_parallel) {
+  const opae_api_adapter_table *seen[2] = { nullptr, nullptr };
+
+  EXPECT_EQ(2, opae_plugin_mgr_adapter_count());
+  EXPECT_EQ(0, opae_plugin_mgr_for_each_adapter_parallel(nullptr, seen, 2));
+
+  EXPECT_EQ(2, opae_plugin_mgr_for_each_adapter_parallel(test_adapter_job,
+                                                         seen, 2));
+  EXPECT_EQ(adapter_list, seen[0]);
+  EXPECT_EQ(adapter_list->next, seen[1]);
+
+  seen[0] = seen[1] = nullptr;
+  EXPECT_EQ(1, opae_plugin_mgr_for_each_adapter_parallel(test_adapter_job,
+                                                         seen, 1));
+  EXPECT_EQ(adapter_list, seen[0]);
+  EXPECT_EQ(nullptr, seen[1]);
+
+  EXPECT_EQ(0, opae_plugin_mgr_finalize_all());
+  EXPECT_EQ(nullptr, adapter_list);
+}
+
 /**
  * @test       bad_init_all
  * @brief      Test: opae_plugin_mgr_initialize_all
@@ -143,4 +143,37 @@ TEST_P(events_cxx_core, get_os_object) {
   ASSERT_NE(res, -1);
 }
 
+/**
+ * @test event_set_01
+ * Given an open accelerator handle object<br>
+ * And an event_set holding two events registered on it<br>
+ * When I signal one of the events and call event_set::wait()<br>
+ * Then I get exactly that event and its count<br>
+ * And after removing it, it is no longer reported<br>
+ */
+TEST_P(events_cxx_core, event_set_01) {
+  event::ptr_t ev1, ev2;
+  event_set::ptr_t set;
+  ASSERT_NO_THROW(ev1 = event::register_event(handle_, FPGA_EVENT_ERROR));
+  ASSERT_NO_THROW(ev2 = event::register_event(handle_, FPGA_EVENT_ERROR));
+  ASSERT_NO_THROW(set = event_set::create());
+  ASSERT_NO_THROW(set->add(ev1));
+  ASSERT_NO_THROW(set->add(ev2));
+  EXPECT_EQ(set->size(), 2);
+  EXPECT_TRUE(set->wait(0).empty());
+
+  uint64_t val = 2;
+  ASSERT_EQ(write(ev2->os_object(), &val, sizeof(val)), sizeof(val));
+  auto fired = set->wait(1000);
+  ASSERT_EQ(fired.size(), 1);
+  EXPECT_EQ(fired[0].ev, ev2);
+  EXPECT_EQ(fired[0].count, 2);
+
+  ASSERT_NO_THROW(set->remove(ev2));
+  EXPECT_EQ(set->size(), 1);
+  ASSERT_EQ(write(ev2->os_object(), &val, sizeof(val)), sizeof(val));
+  EXPECT_TRUE(set->wait(0).empty());
+  EXPECT_THROW(set->add(nullptr), std::invalid_argument);
+}
+
 INSTANTIATE_TEST_CASE_P(events, events_cxx_core, ::testing::ValuesIn(test_platform::keys(true)));
@@ -196,6 +196,30 @@ TEST_P(handle_cxx_core, mmio_64) {
   EXPECT_EQ(value, 10);
 }
 
+/**
+ * @test mmio_accessor
+ * Values written through a handle::accessor should be visible
+ * through the accessor and through read_csr64.
+ */
+TEST_P(handle_cxx_core, mmio_accessor) {
+  int flags = 0;
+  uint64_t offset = 0x100;
+  uint32_t csr_space = 0;
+
+  handle_ = handle::open(tokens_[0], flags);
+  ASSERT_NE(nullptr, handle_.get());
+
+  mmio_accessor acc = handle_->accessor(csr_space);
+  ASSERT_NO_THROW(acc.write_csr64(offset, 10));
+  EXPECT_EQ(acc.read_csr64(offset), 10);
+  EXPECT_EQ(handle_->read_csr64(offset, csr_space), 10);
+
+  ASSERT_NO_THROW(acc.write_csr32(offset, 20));
+  EXPECT_EQ(acc.read_csr32(offset), 20);
+
+  EXPECT_THROW(acc.read_csr64(offset + 1), invalid_param);
+}
+
 /**
  * @test mmio_ptr
  * Verify that handle::mmio_ptr is able to map mmio and retrieve
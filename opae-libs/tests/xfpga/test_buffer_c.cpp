@@ -31,8 +31,10 @@
 #include <opae/fpga.h>
 
 extern "C" {
-    fpga_result buffer_allocate(void*,uint64_t,int);
-    fpga_result buffer_release(void*,uint64_t);
+    fpga_result buffer_allocate(void**,uint64_t,uint64_t*,int);
+    fpga_result buffer_release(void*,uint64_t,uint64_t);
+    uint64_t buffer_page_size(uint64_t);
+    extern bool buffer_2m_spans_rejected;
     int xfpga_plugin_initialize(void);
     int xfpga_plugin_finalize(void);
 }
@@ -52,6 +54,8 @@ extern "C" {
 #include <opae/mmio.h>
 #include <string>
 #include <algorithm>
+#include <chrono>
+#include <iostream>
 
 
 #define NLB_DSM_SIZE (2 * 1024 * 1024)
@@ -285,6 +289,71 @@ TEST_P(buffer_prepare, write_read) {
   EXPECT_EQ(xfpga_fpgaReleaseBuffer(handle_, wsid), FPGA_OK);
 }
 
+/**
+ * @test       page_size_policy
+ *
+ * @brief      Buffers up to 2 MiB use one 4 KiB or 2 MiB page; larger
+ *             buffers are composed of 2 MiB pages unless rounding up to
+ *             1 GiB pages wastes at most 64 MiB more.
+ *
+ */
+TEST(buffer_c, page_size_policy) {
+  EXPECT_EQ(buffer_page_size(KiB(1)), KiB(4));
+  EXPECT_EQ(buffer_page_size(KiB(4)), KiB(4));
+  EXPECT_EQ(buffer_page_size(KiB(8)), MiB(2));
+  EXPECT_EQ(buffer_page_size(MiB(2)), MiB(2));
+  EXPECT_EQ(buffer_page_size(MiB(3)), MiB(2));
+  EXPECT_EQ(buffer_page_size(MiB(512)), MiB(2));
+  EXPECT_EQ(buffer_page_size(GB - MiB(32)), GB);
+  EXPECT_EQ(buffer_page_size(GB), GB);
+  EXPECT_EQ(buffer_page_size(GB + MiB(2)), MiB(2));
+  EXPECT_EQ(buffer_page_size(2 * GB - MiB(8)), GB);
+}
+
+/**
+ * @test       mixed_sizes
+ *
+ * @brief      Allocating buffers of mixed sizes consumes only as many
+ *             2 MiB hugepages as each buffer needs, no 1 GiB pages, and
+ *             releasing them returns every page.
+ *
+ */
+TEST_P(buffer_prepare, mixed_sizes) {
+  const std::vector<std::pair<uint64_t, uint64_t>> sizes = {
+    { KiB(1), 0 }, { MiB(1), 1 }, { MiB(3), 2 }, { MiB(5), 3 }, { MiB(2), 1 }
+  };
+  std::vector<uint64_t> wsids;
+  uint64_t base_2m = 0, base_1g = 0;
+  uint64_t pages_2m = 0, pages_1g = 0;
+  uint64_t expected_2m = 0;
+
+  ASSERT_EQ(xfpga_buffer_hugepages(&base_2m, &base_1g), FPGA_OK);
+
+  for (auto &s : sizes) {
+    void *buf_addr = nullptr;
+    uint64_t wsid = 0;
+    ASSERT_EQ(xfpga_fpgaPrepareBuffer(handle_, s.first, &buf_addr, &wsid, 0),
+              FPGA_OK);
+    memset(buf_addr, 0xa5, s.first);
+    wsids.push_back(wsid);
+    expected_2m += s.second;
+
+    ASSERT_EQ(xfpga_buffer_hugepages(&pages_2m, &pages_1g), FPGA_OK);
+    EXPECT_EQ(pages_2m - base_2m, expected_2m);
+    EXPECT_EQ(pages_1g, base_1g);
+  }
+
+  for (auto wsid : wsids) {
+    EXPECT_EQ(xfpga_fpgaReleaseBuffer(handle_, wsid), FPGA_OK);
+  }
+
+  ASSERT_EQ(xfpga_buffer_hugepages(&pages_2m, &pages_1g), FPGA_OK);
+  EXPECT_EQ(pages_2m, base_2m);
+  EXPECT_EQ(pages_1g, base_1g);
+
+  EXPECT_EQ(xfpga_buffer_hugepages(nullptr, &pages_1g), FPGA_INVALID_PARAM);
+}
+
 namespace {
 std::vector<buffer_params> params{
     buffer_params{FPGA_INVALID_PARAM, 0, 0},
@@ -292,6 +361,7 @@ std::vector<buffer_params> params{
     buffer_params{FPGA_OK, KiB(4), 0},
     buffer_params{FPGA_OK, MiB(1), 0},
     buffer_params{FPGA_OK, MiB(2), 0},
+    buffer_params{FPGA_OK, MiB(3), 0},
     buffer_params{FPGA_INVALID_PARAM, 11247, FPGA_BUF_PREALLOCATED}};
 }
 
@@ -371,5 +441,255 @@ TEST_P(buffer_c_mock_p, port_dma_map) {
   EXPECT_EQ(res, FPGA_INVALID_PARAM) << "result is " << fpgaErrStr(res);
 }
 
+static uint64_t contiguous_base_2m;
+static int contiguous_maps;
+
+// Like the port driver, only map physically contiguous memory: a buffer
+// made of several 2 MiB pages is refused.
+static int contiguous_dma_map(mock_object *m, int request, va_list argp) {
+  (void)m;
+  (void)request;
+  auto dma_map = va_arg(argp, struct dfl_fpga_port_dma_map *);
+  uint64_t pages_2m = 0, pages_1g = 0;
+
+  ++contiguous_maps;
+  xfpga_buffer_hugepages(&pages_2m, &pages_1g);
+  if (dma_map->length > MiB(2) && pages_2m > contiguous_base_2m) {
+    errno = EINVAL;
+    return -1;
+  }
+  dma_map->iova = dma_map->user_addr;
+  return 0;
+}
+
+/**
+ * @test       port_dma_map_2m_span
+ *
+ * @brief      When the driver refuses to map a buffer made of several
+ *             2 MiB pages, fpgaPrepareBuffer backs it with a 1 GiB page
+ *             instead, and later large buffers use 1 GiB pages directly.
+ *
+ */
+TEST_P(buffer_c_mock_p, port_dma_map_2m_span) {
+  uint64_t pages_2m = 0, pages_1g = 0, base_1g = 0;
+  void *addr1 = nullptr, *addr2 = nullptr;
+  uint64_t wsid1 = 0, wsid2 = 0;
+
+  buffer_2m_spans_rejected = false;
+  ASSERT_EQ(xfpga_buffer_hugepages(&contiguous_base_2m, &base_1g), FPGA_OK);
+  contiguous_maps = 0;
+  system_->register_ioctl_handler(DFL_FPGA_PORT_DMA_MAP, contiguous_dma_map);
+
+  ASSERT_EQ(xfpga_fpgaPrepareBuffer(handle_, MiB(3), &addr1, &wsid1, 0),
+            FPGA_OK);
+  memset(addr1, 0xa5, MiB(3));
+  EXPECT_EQ(contiguous_maps, 2);
+  ASSERT_EQ(xfpga_buffer_hugepages(&pages_2m, &pages_1g), FPGA_OK);
+  EXPECT_EQ(pages_2m, contiguous_base_2m);
+  EXPECT_EQ(pages_1g - base_1g, 1);
+  EXPECT_EQ(buffer_page_size(MiB(3)), GB);
+
+  ASSERT_EQ(xfpga_fpgaPrepareBuffer(handle_, MiB(5), &addr2, &wsid2,
+                                    FPGA_BUF_POOLED), FPGA_OK);
+  EXPECT_EQ(contiguous_maps, 3);
+  ASSERT_EQ(xfpga_buffer_hugepages(&pages_2m, &pages_1g), FPGA_OK);
+  EXPECT_EQ(pages_1g - base_1g, 2);
+
+  // a single 2 MiB page is contiguous and still used
+  void *addr3 = nullptr;
+  uint64_t wsid3 = 0;
+  ASSERT_EQ(xfpga_fpgaPrepareBuffer(handle_, MiB(2), &addr3, &wsid3, 0),
+            FPGA_OK);
+  ASSERT_EQ(xfpga_buffer_hugepages(&pages_2m, &pages_1g), FPGA_OK);
+  EXPECT_EQ(pages_2m - contiguous_base_2m, 1);
+
+  EXPECT_EQ(xfpga_fpgaReleaseBuffer(handle_, wsid1), FPGA_OK);
+  EXPECT_EQ(xfpga_fpgaReleaseBuffer(handle_, wsid2), FPGA_OK);
+  EXPECT_EQ(xfpga_fpgaReleaseBuffer(handle_, wsid3), FPGA_OK);
+  ASSERT_EQ(xfpga_fpgaBufferPoolTrim(handle_), FPGA_OK);
+  ASSERT_EQ(xfpga_buffer_hugepages(&pages_2m, &pages_1g), FPGA_OK);
+  EXPECT_EQ(pages_2m, contiguous_base_2m);
+  EXPECT_EQ(pages_1g, base_1g);
+
+  buffer_2m_spans_rejected = false;
+}
+
+/**
+ * @test       pool_reuse
+ *
+ * @brief      A released FPGA_BUF_POOLED buffer stays pinned and is
+ *             handed out again to a request of the same size class,
+ *             without another DMA map. Buffers of other size classes or
+ *             access modes are not reused.
+ *
+ */
+TEST_P(buffer_c_mock_p, pool_reuse) {
+  fpga_buffer_pool_stats stats;
+  void *addr1 = nullptr, *addr2 = nullptr, *addr3 = nullptr;
+  uint64_t wsid1 = 0, wsid2 = 0, wsid3 = 0;
+  uint64_t ioaddr1 = 0, ioaddr2 = 0;
+
+  ASSERT_EQ(xfpga_fpgaPrepareBuffer(handle_, KiB(8), &addr1, &wsid1,
+                                    FPGA_BUF_POOLED), FPGA_OK);
+  ASSERT_EQ(xfpga_fpgaGetIOAddress(handle_, wsid1, &ioaddr1), FPGA_OK);
+  ASSERT_EQ(xfpga_fpgaBufferPoolGetStats(handle_, &stats), FPGA_OK);
+  EXPECT_EQ(stats.hits, 0);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.pinned_bytes, MiB(2));
+  EXPECT_EQ(stats.idle_bytes, 0);
+
+  EXPECT_EQ(xfpga_fpgaReleaseBuffer(handle_, wsid1), FPGA_OK);
+  ASSERT_EQ(xfpga_fpgaBufferPoolGetStats(handle_, &stats), FPGA_OK);
+  EXPECT_EQ(stats.pinned_bytes, MiB(2));
+  EXPECT_EQ(stats.idle_bytes, MiB(2));
+
+  // same size class: recycled, no DMA map
+  system_->register_ioctl_handler(DFL_FPGA_PORT_DMA_MAP,
+                                  dummy_ioctl<-1, EINVAL>);
+  ASSERT_EQ(xfpga_fpgaPrepareBuffer(handle_, MiB(1), &addr2, &wsid2,
+                                    FPGA_BUF_POOLED), FPGA_OK);
+  EXPECT_EQ(addr2, addr1);
+  ASSERT_EQ(xfpga_fpgaGetIOAddress(handle_, wsid2, &ioaddr2), FPGA_OK);
+  EXPECT_EQ(ioaddr2, ioaddr1);
+  memset(addr2, 0xa5, MiB(2));
+
+  ASSERT_EQ(xfpga_fpgaBufferPoolGetStats(handle_, &stats), FPGA_OK);
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.idle_bytes, 0);
+  EXPECT_EQ(xfpga_fpgaReleaseBuffer(handle_, wsid2), FPGA_OK);
+
+  // read-only buffers and other size classes miss
+  EXPECT_EQ(xfpga_fpgaPrepareBuffer(handle_, MiB(1), &addr3, &wsid3,
+                                    FPGA_BUF_POOLED | FPGA_BUF_READ_ONLY),
+            FPGA_INVALID_PARAM);
+  EXPECT_EQ(xfpga_fpgaPrepareBuffer(handle_, KiB(4), &addr3, &wsid3,
+                                    FPGA_BUF_POOLED), FPGA_INVALID_PARAM);
+  ASSERT_EQ(xfpga_fpgaBufferPoolGetStats(handle_, &stats), FPGA_OK);
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 3);
+  EXPECT_EQ(stats.idle_bytes, MiB(2));
+}
+
+/**
+ * @test       pool_limit
+ *
+ * @brief      Releases beyond the idle limit free the buffer, lowering
+ *             the limit frees idle buffers, and fpgaBufferPoolTrim frees
+ *             them all. Closing the handle drains the pool.
+ *
+ */
+TEST_P(buffer_c_mock_p, pool_limit) {
+  fpga_buffer_pool_stats stats;
+  uint64_t wsids[3];
+  uint64_t base_2m = 0, base_1g = 0;
+  uint64_t pages_2m = 0, pages_1g = 0;
+
+  ASSERT_EQ(xfpga_buffer_hugepages(&base_2m, &base_1g), FPGA_OK);
+  ASSERT_EQ(xfpga_fpgaBufferPoolConfigure(handle_, MiB(4)), FPGA_OK);
+
+  for (auto &w : wsids) {
+    void *addr = nullptr;
+    ASSERT_EQ(xfpga_fpgaPrepareBuffer(handle_, MiB(2), &addr, &w,
+                                      FPGA_BUF_POOLED), FPGA_OK);
+  }
+  for (auto w : wsids) {
+    EXPECT_EQ(xfpga_fpgaReleaseBuffer(handle_, w), FPGA_OK);
+  }
+
+  ASSERT_EQ(xfpga_fpgaBufferPoolGetStats(handle_, &stats), FPGA_OK);
+  EXPECT_EQ(stats.idle_bytes, MiB(4));
+  EXPECT_EQ(stats.pinned_bytes, MiB(4));
+  ASSERT_EQ(xfpga_buffer_hugepages(&pages_2m, &pages_1g), FPGA_OK);
+  EXPECT_EQ(pages_2m - base_2m, 2);
+
+  ASSERT_EQ(xfpga_fpgaBufferPoolConfigure(handle_, MiB(2)), FPGA_OK);
+  ASSERT_EQ(xfpga_fpgaBufferPoolGetStats(handle_, &stats), FPGA_OK);
+  EXPECT_EQ(stats.idle_bytes, MiB(2));
+  EXPECT_EQ(stats.pinned_bytes, MiB(2));
+
+  ASSERT_EQ(xfpga_fpgaBufferPoolTrim(handle_), FPGA_OK);
+  ASSERT_EQ(xfpga_fpgaBufferPoolGetStats(handle_, &stats), FPGA_OK);
+  EXPECT_EQ(stats.idle_bytes, 0);
+  EXPECT_EQ(stats.pinned_bytes, 0);
+  ASSERT_EQ(xfpga_buffer_hugepages(&pages_2m, &pages_1g), FPGA_OK);
+  EXPECT_EQ(pages_2m, base_2m);
+
+  // a pool that keeps nothing idle behaves like unpooled buffers
+  ASSERT_EQ(xfpga_fpgaBufferPoolConfigure(handle_, 0), FPGA_OK);
+  void *addr = nullptr;
+  ASSERT_EQ(xfpga_fpgaPrepareBuffer(handle_, KiB(4), &addr, &wsids[0],
+                                    FPGA_BUF_POOLED), FPGA_OK);
+  EXPECT_EQ(xfpga_fpgaReleaseBuffer(handle_, wsids[0]), FPGA_OK);
+  ASSERT_EQ(xfpga_fpgaBufferPoolGetStats(handle_, &stats), FPGA_OK);
+  EXPECT_EQ(stats.pinned_bytes, 0);
+
+  // the pool is drained on close
+  ASSERT_EQ(xfpga_fpgaBufferPoolConfigure(handle_, MiB(2)), FPGA_OK);
+  ASSERT_EQ(xfpga_fpgaPrepareBuffer(handle_, MiB(2), &addr, &wsids[0],
+                                    FPGA_BUF_POOLED), FPGA_OK);
+  EXPECT_EQ(xfpga_fpgaReleaseBuffer(handle_, wsids[0]), FPGA_OK);
+  EXPECT_EQ(xfpga_fpgaClose(handle_), FPGA_OK);
+  handle_ = nullptr;
+  ASSERT_EQ(xfpga_buffer_hugepages(&pages_2m, &pages_1g), FPGA_OK);
+  EXPECT_EQ(pages_2m, base_2m);
+}
+
+/**
+ * @test       pool_neg
+ *
+ * @brief      FPGA_BUF_POOLED cannot be combined with
+ *             FPGA_BUF_PREALLOCATED, and the pool functions reject
+ *             invalid parameters.
+ *
+ */
+TEST_P(buffer_c_mock_p, pool_neg) {
+  fpga_buffer_pool_stats stats;
+  void *addr = nullptr;
+  uint64_t wsid = 0;
+
+  addr = mmap(NULL, KiB(4), PROT_READ | PROT_WRITE,
+              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  ASSERT_NE(addr, MAP_FAILED);
+  EXPECT_EQ(xfpga_fpgaPrepareBuffer(handle_, KiB(4), &addr, &wsid,
+                                    FPGA_BUF_POOLED | FPGA_BUF_PREALLOCATED),
+            FPGA_INVALID_PARAM);
+  munmap(addr, KiB(4));
+
+  EXPECT_EQ(xfpga_fpgaBufferPoolGetStats(handle_, nullptr),
+            FPGA_INVALID_PARAM);
+  EXPECT_EQ(xfpga_fpgaBufferPoolGetStats(nullptr, &stats),
+            FPGA_INVALID_PARAM);
+  EXPECT_EQ(xfpga_fpgaBufferPoolConfigure(nullptr, 0), FPGA_INVALID_PARAM);
+  EXPECT_EQ(xfpga_fpgaBufferPoolTrim(nullptr), FPGA_INVALID_PARAM);
+}
+
+/**
+ * @test       pool_ns_per_op
+ *
+ * @brief      Measures prepare/release of a short-lived 2 MiB buffer
+ *             with and without the buffer pool.
+ *
+ */
+TEST_P(buffer_c_mock_p, pool_ns_per_op) {
+  const int iterations = 1000;
+
+  for (int flags : { 0, (int)FPGA_BUF_POOLED }) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      void *addr = nullptr;
+      uint64_t wsid = 0;
+      ASSERT_EQ(xfpga_fpgaPrepareBuffer(handle_, MiB(2), &addr, &wsid, flags),
+                FPGA_OK);
+      ASSERT_EQ(xfpga_fpgaReleaseBuffer(handle_, wsid), FPGA_OK);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  end - start).count();
+    std::cout << (flags ? "pooled" : "unpooled") << " prepare/release: "
+              << ns / iterations << " ns/op" << std::endl;
+  }
+}
+
 INSTANTIATE_TEST_CASE_P(buffer_c, buffer_c_mock_p,
                         ::testing::ValuesIn(test_platform::mock_platforms({ "dfl-n3000","dfl-d5005" })));
@@ -33,6 +33,9 @@
 #include <uuid/uuid.h>
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
 #include <cstdlib>
 #include <fstream>
 #include <map>
@@ -40,6 +43,7 @@
 #include <string>
 #include <vector>
 #include <cstdarg>
+#include <unistd.h>
 #include <linux/ioctl.h>
 #include "opae_drv.h"
 #include "types_int.h"
@@ -1070,6 +1074,121 @@ TEST_P(enum_c_p, get_guid) {
 }
 
 
+/**
+ * @test       cache_hit_miss
+ *
+ * @brief      Given the enumeration cache is enabled, the first
+ *             xfpga_fpgaEnumerate() builds the snapshot (a miss) and
+ *             subsequent calls reuse it (hits), returning the same
+ *             matches as the uncached path, including for filtered
+ *             enumerations that exclude accelerators.
+ */
+TEST_P(enum_c_p, cache_hit_miss) {
+  uint64_t hits = 0, misses = 0;
+  uint32_t uncached = 0;
+
+  EXPECT_EQ(xfpga_fpgaEnumerate(nullptr, 0, nullptr, 0, &uncached), FPGA_OK);
+
+  xfpga_enum_cache_configure(UINT64_MAX);
+
+  EXPECT_EQ(xfpga_fpgaEnumerate(nullptr, 0, tokens_.data(), tokens_.size(),
+                                &num_matches_), FPGA_OK);
+  EXPECT_EQ(num_matches_, uncached);
+  EXPECT_EQ(xfpga_fpgaEnumerate(nullptr, 0, nullptr, 0, &num_matches_),
+            FPGA_OK);
+  EXPECT_EQ(num_matches_, uncached);
+
+  ASSERT_EQ(fpgaPropertiesSetObjectType(filter_, FPGA_DEVICE), FPGA_OK);
+  EXPECT_EQ(xfpga_fpgaEnumerate(&filter_, 1, nullptr, 0, &num_matches_),
+            FPGA_OK);
+  EXPECT_EQ(num_matches_, GetNumFpgas());
+
+  EXPECT_EQ(xfpga_enum_cache_stats(&hits, &misses), FPGA_OK);
+  EXPECT_EQ(hits, 2);
+  EXPECT_EQ(misses, 1);
+
+  xfpga_enum_cache_configure(0);
+  EXPECT_EQ(xfpga_enum_cache_stats(&hits, &misses), FPGA_OK);
+  EXPECT_EQ(hits, 0);
+  EXPECT_EQ(misses, 0);
+  EXPECT_EQ(xfpga_enum_cache_stats(nullptr, &misses), FPGA_INVALID_PARAM);
+}
+
+/**
+ * @test       cache_invalidate
+ *
+ * @brief      Given the enumeration cache is enabled, an explicit
+ *             invalidation, opening a handle or an expired staleness
+ *             bound each force the next enumeration to rebuild the
+ *             snapshot.
+ */
+TEST_P(enum_c_p, cache_invalidate) {
+  uint64_t hits = 0, misses = 0;
+  fpga_handle handle = nullptr;
+
+  xfpga_enum_cache_configure(UINT64_MAX);
+
+  ASSERT_EQ(fpgaPropertiesSetObjectType(filter_, FPGA_ACCELERATOR), FPGA_OK);
+  EXPECT_EQ(xfpga_fpgaEnumerate(&filter_, 1, tokens_.data(), 1,
+                                &num_matches_), FPGA_OK);
+  ASSERT_GT(num_matches_, 0);
+
+  xfpga_enum_cache_invalidate();
+  EXPECT_EQ(xfpga_fpgaEnumerate(&filter_, 1, nullptr, 0, &num_matches_),
+            FPGA_OK);
+  EXPECT_EQ(xfpga_enum_cache_stats(&hits, &misses), FPGA_OK);
+  EXPECT_EQ(hits, 0);
+  EXPECT_EQ(misses, 2);
+
+  ASSERT_EQ(xfpga_fpgaOpen(tokens_[0], &handle, 0), FPGA_OK);
+  EXPECT_EQ(xfpga_fpgaEnumerate(&filter_, 1, nullptr, 0, &num_matches_),
+            FPGA_OK);
+  EXPECT_EQ(xfpga_fpgaClose(handle), FPGA_OK);
+  EXPECT_EQ(xfpga_enum_cache_stats(&hits, &misses), FPGA_OK);
+  EXPECT_EQ(misses, 3);
+
+  xfpga_enum_cache_configure(1);
+  EXPECT_EQ(xfpga_fpgaEnumerate(&filter_, 1, nullptr, 0, &num_matches_),
+            FPGA_OK);
+  usleep(2000);
+  EXPECT_EQ(xfpga_fpgaEnumerate(&filter_, 1, nullptr, 0, &num_matches_),
+            FPGA_OK);
+  EXPECT_EQ(xfpga_enum_cache_stats(&hits, &misses), FPGA_OK);
+  EXPECT_EQ(hits, 0);
+  EXPECT_EQ(misses, 5);
+
+  xfpga_enum_cache_configure(0);
+}
+
+/**
+ * @test       cache_ns_per_op
+ *
+ * @brief      Report the average cost of an uncached and a cached
+ *             xfpga_fpgaEnumerate() call.
+ */
+TEST_P(enum_c_p, cache_ns_per_op) {
+  const int iterations = 200;
+
+  auto measure = [&]() {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      EXPECT_EQ(xfpga_fpgaEnumerate(nullptr, 0, nullptr, 0, &num_matches_),
+                FPGA_OK);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               end - start).count() / iterations;
+  };
+
+  auto uncached = measure();
+  xfpga_enum_cache_configure(UINT64_MAX);
+  auto cached = measure();
+  xfpga_enum_cache_configure(0);
+
+  std::cout << "fpgaEnumerate uncached: " << uncached << " ns/op, cached: "
+            << cached << " ns/op" << std::endl;
+}
+
 
 
 INSTANTIATE_TEST_CASE_P(enum_c, enum_c_p, 
@@ -39,6 +39,11 @@ fpga_result driver_register_event(fpga_handle, fpga_event_type, fpga_event_handl
 fpga_result driver_unregister_event(fpga_handle, fpga_event_type, fpga_event_handle);
 int xfpga_plugin_initialize(void);
 int xfpga_plugin_finalize(void);
+extern const char *event_daemon_socket;
+fpga_result event_daemon_register(fpga_handle, uint64_t, fpga_event_type, int);
+fpga_result event_daemon_unregister(fpga_handle, fpga_event_type);
+void event_daemon_release(fpga_handle);
+void event_daemon_finalize(void);
 }
 
 #include "intel-fpga.h"
@@ -48,6 +53,12 @@ int xfpga_plugin_finalize(void);
 #include <thread>
 #include <string>
 #include <cstring>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include "types_int.h"
 #include "gtest/gtest.h"
 #include "mock/test_system.h"
@@ -1294,3 +1305,288 @@ TEST_P(events_mock_p, irq_event_03) {
 
 INSTANTIATE_TEST_CASE_P(events, events_mock_p,
                         ::testing::ValuesIn(test_platform::mock_platforms({ "dfl-n3000","dfl-d5005" })));
+
+/*
+ * A stand-in for fpgad's event API: it listens on a private socket and
+ * records each request exactly as fpgad reads it, one request and at most
+ * one passed descriptor per recvmsg().
+ */
+class stand_in_fpgad {
+ public:
+  enum request_type { REGISTER_EVENT = 0, UNREGISTER_EVENT = 1 };
+
+  struct event_request {
+    request_type type;
+    fpga_event_type event;
+    uint64_t object_id;
+  };
+
+  struct record {
+    event_request req;
+    int fd;
+  };
+
+  stand_in_fpgad(const std::string &path)
+    : path_(path), listen_fd_(-1), connections_(0) {
+    stop_[0] = stop_[1] = -1;
+  }
+
+  ~stand_in_fpgad() {
+    stop();
+    std::lock_guard<std::mutex> guard(lock_);
+    for (auto &r : records_) {
+      if (r.fd >= 0) close(r.fd);
+    }
+  }
+
+  bool start() {
+    struct sockaddr_un addr;
+    unlink(path_.c_str());
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) return false;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path_.c_str(), sizeof(addr.sun_path) - 1);
+    if (bind(listen_fd_, (struct sockaddr *)&addr, sizeof(addr)) ||
+        listen(listen_fd_, 16) || pipe(stop_)) {
+      close(listen_fd_);
+      listen_fd_ = -1;
+      return false;
+    }
+    thread_ = std::thread(&stand_in_fpgad::run, this);
+    return true;
+  }
+
+  // Shut down, hanging up on all clients, as when fpgad exits.
+  void stop() {
+    if (listen_fd_ < 0) return;
+    char c = 0;
+    EXPECT_EQ(write(stop_[1], &c, 1), 1);
+    thread_.join();
+    close(stop_[0]);
+    close(stop_[1]);
+    close(listen_fd_);
+    listen_fd_ = -1;
+    unlink(path_.c_str());
+  }
+
+  bool wait_for(size_t num_records) {
+    std::unique_lock<std::mutex> guard(lock_);
+    return cond_.wait_for(guard, std::chrono::seconds(5), [&] {
+      return records_.size() >= num_records;
+    });
+  }
+
+  std::vector<record> records() {
+    std::lock_guard<std::mutex> guard(lock_);
+    return records_;
+  }
+
+  int connections() {
+    std::lock_guard<std::mutex> guard(lock_);
+    return connections_;
+  }
+
+ private:
+  void run() {
+    std::vector<struct pollfd> pfds;
+    pfds.push_back({stop_[0], POLLIN, 0});
+    pfds.push_back({listen_fd_, POLLIN, 0});
+
+    while (poll(pfds.data(), pfds.size(), -1) >= 0) {
+      if (pfds[0].revents) break;
+      if (pfds[1].revents) {
+        int conn = accept(listen_fd_, nullptr, nullptr);
+        if (conn >= 0) {
+          pfds.push_back({conn, POLLIN, 0});
+          std::lock_guard<std::mutex> guard(lock_);
+          ++connections_;
+        }
+      }
+      for (size_t i = 2; i < pfds.size(); ++i) {
+        if (pfds[i].revents && !receive(pfds[i].fd)) {
+          close(pfds[i].fd);
+          pfds.erase(pfds.begin() + i--);
+        }
+      }
+    }
+
+    for (size_t i = 2; i < pfds.size(); ++i) close(pfds[i].fd);
+  }
+
+  bool receive(int conn) {
+    record r;
+    struct msghdr mh;
+    struct iovec iov;
+    char buf[CMSG_SPACE(sizeof(int))];
+    memset(&mh, 0, sizeof(mh));
+    iov.iov_base = &r.req;
+    iov.iov_len = sizeof(r.req);
+    mh.msg_iov = &iov;
+    mh.msg_iovlen = 1;
+    mh.msg_control = buf;
+    mh.msg_controllen = sizeof(buf);
+    if (recvmsg(conn, &mh, 0) != sizeof(r.req)) return false;
+    struct cmsghdr *cmh = CMSG_FIRSTHDR(&mh);
+    r.fd = -1;
+    if (cmh && cmh->cmsg_type == SCM_RIGHTS)
+      memcpy(&r.fd, CMSG_DATA(cmh), sizeof(int));
+    std::lock_guard<std::mutex> guard(lock_);
+    records_.push_back(r);
+    cond_.notify_all();
+    return true;
+  }
+
+  std::string path_;
+  int listen_fd_;
+  int stop_[2];
+  int connections_;
+  std::thread thread_;
+  std::mutex lock_;
+  std::condition_variable cond_;
+  std::vector<record> records_;
+};
+
+class event_daemon_c : public ::testing::Test {
+ protected:
+  event_daemon_c()
+    : path_("/tmp/fpga_event_socket_test." + std::to_string(getpid())),
+      fpgad_(path_), saved_socket_(nullptr) {}
+
+  virtual void SetUp() override {
+    saved_socket_ = event_daemon_socket;
+    event_daemon_socket = path_.c_str();
+    ASSERT_TRUE(fpgad_.start());
+  }
+
+  virtual void TearDown() override {
+    event_daemon_finalize();
+    event_daemon_socket = saved_socket_;
+    fpgad_.stop();
+    for (auto fd : eventfds_) close(fd);
+  }
+
+  int new_eventfd() {
+    int fd = eventfd(0, 0);
+    eventfds_.push_back(fd);
+    return fd;
+  }
+
+  // Only used as keys by the event daemon connection.
+  fpga_handle fake_handle(uintptr_t n) {
+    return reinterpret_cast<fpga_handle>(n);
+  }
+
+  std::string path_;
+  stand_in_fpgad fpgad_;
+  const char *saved_socket_;
+  std::vector<int> eventfds_;
+};
+
+/**
+ * @test       event_daemon_c.shared_connection
+ * @brief      Test: event_daemon_register, event_daemon_release
+ * @details    When many handles register events with the daemon,<br>
+ *             they share a single connection,<br>
+ *             and each registration passes its eventfd.<br>
+ *             Releasing a handle unregisters only its events.<br>
+ */
+TEST_F(event_daemon_c, shared_connection) {
+  const uintptr_t num_handles = 100;
+  for (uintptr_t i = 1; i <= num_handles; ++i) {
+    ASSERT_EQ(event_daemon_register(fake_handle(i), i, FPGA_EVENT_ERROR,
+                                    new_eventfd()), FPGA_OK);
+  }
+  ASSERT_TRUE(fpgad_.wait_for(num_handles));
+  EXPECT_EQ(fpgad_.connections(), 1);
+
+  auto records = fpgad_.records();
+  for (uintptr_t i = 0; i < num_handles; ++i) {
+    EXPECT_EQ(records[i].req.type, stand_in_fpgad::REGISTER_EVENT);
+    EXPECT_EQ(records[i].req.event, FPGA_EVENT_ERROR);
+    EXPECT_EQ(records[i].req.object_id, i + 1);
+    EXPECT_GE(records[i].fd, 0);
+  }
+
+  event_daemon_release(fake_handle(7));
+  ASSERT_TRUE(fpgad_.wait_for(num_handles + 1));
+  records = fpgad_.records();
+  EXPECT_EQ(records[num_handles].req.type, stand_in_fpgad::UNREGISTER_EVENT);
+  EXPECT_EQ(records[num_handles].req.object_id, 7);
+
+  EXPECT_EQ(event_daemon_unregister(fake_handle(7), FPGA_EVENT_ERROR),
+            FPGA_INVALID_PARAM);
+  EXPECT_EQ(event_daemon_unregister(fake_handle(8), FPGA_EVENT_ERROR),
+            FPGA_OK);
+  EXPECT_EQ(fpgad_.connections(), 1);
+}
+
+/**
+ * @test       event_daemon_c.shared_object
+ * @brief      Test: event_daemon_unregister
+ * @details    When two handles registered the same event of the same<br>
+ *             object and one of them unregisters,<br>
+ *             the daemon ends up holding the other handle's eventfd.<br>
+ */
+TEST_F(event_daemon_c, shared_object) {
+  int fd1 = new_eventfd();
+  int fd2 = new_eventfd();
+  ASSERT_EQ(event_daemon_register(fake_handle(1), 42, FPGA_EVENT_ERROR, fd1),
+            FPGA_OK);
+  ASSERT_EQ(event_daemon_register(fake_handle(2), 42, FPGA_EVENT_ERROR, fd2),
+            FPGA_OK);
+  ASSERT_EQ(event_daemon_unregister(fake_handle(1), FPGA_EVENT_ERROR),
+            FPGA_OK);
+
+  // Two unregisters for (42, error), then the survivor again.
+  ASSERT_TRUE(fpgad_.wait_for(5));
+  auto records = fpgad_.records();
+  EXPECT_EQ(records[2].req.type, stand_in_fpgad::UNREGISTER_EVENT);
+  EXPECT_EQ(records[3].req.type, stand_in_fpgad::UNREGISTER_EVENT);
+  EXPECT_EQ(records[4].req.type, stand_in_fpgad::REGISTER_EVENT);
+  EXPECT_EQ(records[4].req.object_id, 42);
+  ASSERT_GE(records[4].fd, 0);
+
+  uint64_t val = 1;
+  ASSERT_EQ(write(records[4].fd, &val, sizeof(val)), sizeof(val));
+  val = 0;
+  EXPECT_EQ(read(fd2, &val, sizeof(val)), sizeof(val));
+  EXPECT_EQ(val, 1);
+}
+
+/**
+ * @test       event_daemon_c.reconnect
+ * @brief      Test: event_daemon_register
+ * @details    When the daemon restarts,<br>
+ *             the next request reconnects and first replays<br>
+ *             all registrations still held by open handles.<br>
+ */
+TEST_F(event_daemon_c, reconnect) {
+  ASSERT_EQ(event_daemon_register(fake_handle(1), 1, FPGA_EVENT_ERROR,
+                                  new_eventfd()), FPGA_OK);
+  ASSERT_EQ(event_daemon_register(fake_handle(2), 2, FPGA_EVENT_POWER_THERMAL,
+                                  new_eventfd()), FPGA_OK);
+  ASSERT_TRUE(fpgad_.wait_for(2));
+  fpgad_.stop();
+
+  EXPECT_EQ(event_daemon_register(fake_handle(3), 3, FPGA_EVENT_ERROR,
+                                  new_eventfd()), FPGA_NO_DAEMON);
+
+  stand_in_fpgad restarted(path_);
+  ASSERT_TRUE(restarted.start());
+  ASSERT_EQ(event_daemon_register(fake_handle(3), 3, FPGA_EVENT_ERROR,
+                                  new_eventfd()), FPGA_OK);
+  ASSERT_TRUE(restarted.wait_for(3));
+  EXPECT_EQ(restarted.connections(), 1);
+
+  auto records = restarted.records();
+  EXPECT_EQ(records[0].req.object_id, 1);
+  EXPECT_EQ(records[1].req.object_id, 2);
+  EXPECT_EQ(records[1].req.event, FPGA_EVENT_POWER_THERMAL);
+  EXPECT_EQ(records[2].req.object_id, 3);
+  for (auto &r : records) {
+    EXPECT_EQ(r.req.type, stand_in_fpgad::REGISTER_EVENT);
+    EXPECT_GE(r.fd, 0);
+  }
+}
+
@@ -0,0 +1,207 @@
+// Copyright(c) 2020, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif // HAVE_CONFIG_H
+
+extern "C" {
+
+#include <json-c/json.h>
+#include <uuid/uuid.h>
+#include "types_int.h"
+#include "metrics/metrics_int.h"
+#include "metrics/metric_index.h"
+#include "metrics/vector.h"
+#include "opae_int.h"
+}
+
+#include <config.h>
+#include <opae/fpga.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "mock/test_system.h"
+
+using namespace opae::testing;
+
+/**
+ * @test       metric_index_01
+ * @brief      Tests: metric_index_init, metric_index_add, metric_index_find
+ * @details    Keys match without regard to case, qualified and
+ *             unqualified keys are distinct, and the first slot
+ *             added for a key is kept.<br>
+ */
+TEST(metric_index, metric_index_01) {
+  metric_index index;
+  uint64_t slot = 0;
+
+  EXPECT_EQ(FPGA_INVALID_PARAM, metric_index_init(NULL, 4));
+  EXPECT_EQ(FPGA_OK, metric_index_init(&index, 4));
+
+  EXPECT_EQ(FPGA_INVALID_PARAM, metric_index_add(NULL, "power_mgmt", "consumed", 0));
+  EXPECT_EQ(FPGA_INVALID_PARAM, metric_index_add(&index, "power_mgmt", NULL, 0));
+  EXPECT_EQ(FPGA_INVALID_PARAM, metric_index_find(&index, "power_mgmt", "consumed", NULL));
+
+  EXPECT_EQ(FPGA_OK, metric_index_add(&index, "power_mgmt", "consumed", 1));
+  EXPECT_EQ(FPGA_OK, metric_index_add(&index, "thermal_mgmt", "temperature", 2));
+  EXPECT_EQ(FPGA_OK, metric_index_add(&index, NULL, "consumed", 3));
+  EXPECT_EQ(FPGA_OK, metric_index_add(&index, "POWER_MGMT", "Consumed", 4));
+  EXPECT_EQ(3, index.count);
+
+  EXPECT_EQ(FPGA_OK, metric_index_find(&index, "Power_Mgmt", "CONSUMED", &slot));
+  EXPECT_EQ(1, slot);
+  EXPECT_EQ(FPGA_OK, metric_index_find(&index, "thermal_mgmt", "Temperature", &slot));
+  EXPECT_EQ(2, slot);
+  EXPECT_EQ(FPGA_OK, metric_index_find(&index, NULL, "consumed", &slot));
+  EXPECT_EQ(3, slot);
+  EXPECT_EQ(FPGA_NOT_FOUND, metric_index_find(&index, "power_mgmt", "temperature", &slot));
+  EXPECT_EQ(FPGA_NOT_FOUND, metric_index_find(&index, NULL, "temperature", &slot));
+
+  metric_index_free(&index);
+  EXPECT_EQ(FPGA_NOT_FOUND, metric_index_find(&index, "power_mgmt", "consumed", &slot));
+  metric_index_free(&index);
+}
+
+class metric_index_c : public ::testing::Test {
+ protected:
+  metric_index_c() {}
+
+  virtual void SetUp() override {
+    const uint64_t num_sensors = 300;
+    uint64_t metric_num = 0;
+
+    memset(&handle_, 0, sizeof(handle_));
+    handle_.magic = FPGA_HANDLE_MAGIC;
+    ASSERT_EQ(fpga_vector_init(&handle_.fpga_enum_metric_vector), FPGA_OK);
+
+    // a few hundred BMC-style sensors spread over a few groups
+    for (uint64_t i = 0; i < num_sensors; ++i) {
+      std::string group = (i % 2) ? "power_mgmt" : "thermal_mgmt";
+      std::string qualifier = "dcp:" + group;
+      std::string name = "Sensor " + std::to_string(i) + " Reading";
+
+      ASSERT_EQ(add_metric_vector(&handle_.fpga_enum_metric_vector, metric_num++,
+                                  qualifier.c_str(), group.c_str(), "",
+                                  name.c_str(), "", "Volts",
+                                  FPGA_METRIC_DATATYPE_DOUBLE,
+                                  FPGA_METRIC_TYPE_POWER, FPGA_HW_DCP_RC, 0),
+                FPGA_OK);
+      names_.push_back(qualifier + ":" + name);
+    }
+
+    ASSERT_EQ(index_fpga_metrics(&handle_), FPGA_OK);
+  }
+
+  virtual void TearDown() override {
+    free_fpga_enum_metrics_vector(&handle_);
+  }
+
+  struct _fpga_handle handle_;
+  std::vector<std::string> names_;
+};
+
+/**
+ * @test       lookup
+ * @brief      Tests: find_metric_num_name, find_fpga_enum_metric
+ * @details    Indexed lookups by name and by metric_num agree with
+ *             a linear parse_metric_num_name scan.<br>
+ */
+TEST_F(metric_index_c, lookup) {
+  uint64_t metric_num = 0;
+  uint64_t scanned = 0;
+  struct _fpga_enum_metric *_enum_metric = NULL;
+
+  for (size_t i = 0; i < names_.size(); ++i) {
+    std::string upper = names_[i];
+    for (auto &c : upper)
+      c = toupper(c);
+
+    ASSERT_EQ(find_metric_num_name(&handle_, upper.c_str(), &metric_num), FPGA_OK);
+    ASSERT_EQ(parse_metric_num_name(names_[i].c_str(),
+                                    &handle_.fpga_enum_metric_vector,
+                                    &scanned), FPGA_OK);
+    EXPECT_EQ(scanned, metric_num);
+    EXPECT_EQ(i, metric_num);
+
+    _enum_metric = find_fpga_enum_metric(&handle_,
+                                         &handle_.fpga_enum_metric_vector,
+                                         metric_num);
+    ASSERT_NE(nullptr, _enum_metric);
+    EXPECT_EQ(metric_num, _enum_metric->metric_num);
+  }
+
+  EXPECT_EQ(FPGA_NOT_FOUND, find_metric_num_name(&handle_,
+            "dcp:power_mgmt:no such sensor", &metric_num));
+  EXPECT_EQ(FPGA_INVALID_PARAM, find_metric_num_name(&handle_,
+            "no qualifier", &metric_num));
+  EXPECT_EQ(nullptr, find_fpga_enum_metric(&handle_,
+            &handle_.fpga_enum_metric_vector, names_.size()));
+}
+
+/**
+ * @test       lookups_per_sec
+ * @brief      Tests: find_metric_num_name
+ * @details    Prints how many name lookups per second the index and
+ *             a linear parse_metric_num_name scan deliver over a few
+ *             hundred sensors.<br>
+ */
+TEST_F(metric_index_c, lookups_per_sec) {
+  const int iterations = 20;
+  uint64_t metric_num = 0;
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    for (auto &name : names_)
+      parse_metric_num_name(name.c_str(), &handle_.fpga_enum_metric_vector,
+                            &metric_num);
+  }
+  auto mid = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    for (auto &name : names_)
+      find_metric_num_name(&handle_, name.c_str(), &metric_num);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+
+  auto scanned = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     mid - start).count();
+  auto indexed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     end - mid).count();
+  long long lookups = (long long)iterations * names_.size();
+
+  std::cout << names_.size() << " sensors: "
+            << "scan " << (scanned ? lookups * 1000000000LL / scanned : 0)
+            << " lookups/sec, index "
+            << (indexed ? lookups * 1000000000LL / indexed : 0)
+            << " lookups/sec" << std::endl;
+
+  EXPECT_EQ(names_.size() - 1, metric_num);
+}
@@ -46,12 +46,16 @@ extern "C" {
 #include <linux/ioctl.h>
 #include <sys/mman.h>
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdarg>
 #include <cstdlib>
 #include <cstdarg>
+#include <iostream>
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 #include "gtest/gtest.h"
 #include "mock/test_system.h"
@@ -70,6 +74,44 @@ int xfpga_plugin_finalize(void);
 
 using namespace opae::testing;
 
+/*
+ * Prints how many samples of metric_num per second
+ * xfpga_fpgaGetMetricsByIndex and a metrics session deliver.
+ */
+static void print_samples_per_sec(fpga_handle handle, const char *metric_class,
+                                  std::vector<uint64_t> &metric_num) {
+  const int iterations = 2000;
+  std::vector<fpga_metric> metrics(metric_num.size());
+  fpga_metrics_session session = nullptr;
+
+  ASSERT_EQ(xfpga_fpgaCreateMetricsSession(handle, metric_num.data(),
+                                           metric_num.size(), &session),
+            FPGA_OK);
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    xfpga_fpgaGetMetricsByIndex(handle, metric_num.data(), metric_num.size(),
+                                metrics.data());
+  }
+  auto mid = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    xfpga_fpgaSampleMetricsSession(session, metrics.data());
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+
+  auto by_index = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      mid - start).count();
+  auto sampled = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     end - mid).count();
+  std::cout << metric_class << ", " << metric_num.size() << " metrics: "
+            << "by index " << (by_index ? iterations * 1000000000LL / by_index : 0)
+            << " samples/sec, session "
+            << (sampled ? iterations * 1000000000LL / sampled : 0)
+            << " samples/sec" << std::endl;
+
+  EXPECT_EQ(xfpga_fpgaDestroyMetricsSession(&session), FPGA_OK);
+}
+
 int mmio_ioctl(mock_object *m, int request, va_list argp) {
   int retval = -1;
   errno = EINVAL;
@@ -305,6 +347,85 @@ TEST_P(metrics_c_p, test_metric_04) {
   free(metric_array_search);
 }
 
+/**
+* @test    metrics_session
+* @brief   Tests: xfpga_fpgaCreateMetricsSession
+*                 xfpga_fpgaSampleMetricsSession
+*                 xfpga_fpgaDestroyMetricsSession
+* @details A session samples the same BMC metric values as
+*          xfpga_fpgaGetMetricsByIndex, in the order given.
+*
+*/
+TEST_P(metrics_c_p, metrics_session) {
+  uint64_t num_metrics = 0;
+  ASSERT_EQ(FPGA_OK, xfpga_fpgaGetNumMetrics(handle_, &num_metrics));
+  ASSERT_GT(num_metrics, 0);
+
+  // reversed, plus one index that does not exist
+  std::vector<uint64_t> id_array;
+  for (uint64_t i = num_metrics; i > 0; --i)
+    id_array.push_back(i);
+  id_array.push_back(num_metrics + 100);
+
+  std::vector<fpga_metric> expected(id_array.size());
+  std::vector<fpga_metric> sampled(id_array.size());
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaGetMetricsByIndex(handle_, id_array.data(),
+                                                 id_array.size(),
+                                                 expected.data()));
+
+  fpga_metrics_session session = nullptr;
+  ASSERT_EQ(FPGA_OK, xfpga_fpgaCreateMetricsSession(handle_, id_array.data(),
+                                                    id_array.size(), &session));
+  for (int n = 0; n < 2; ++n) {
+    EXPECT_EQ(FPGA_OK, xfpga_fpgaSampleMetricsSession(session, sampled.data()));
+    for (size_t i = 0; i < id_array.size(); ++i) {
+      EXPECT_EQ(sampled[i].metric_num, id_array[i]);
+      EXPECT_EQ(sampled[i].isvalid, expected[i].isvalid) << id_array[i];
+      if (sampled[i].isvalid)
+        EXPECT_DOUBLE_EQ(sampled[i].value.dvalue, expected[i].value.dvalue);
+    }
+  }
+  EXPECT_FALSE(sampled.back().isvalid);
+
+  EXPECT_NE(FPGA_OK, xfpga_fpgaSampleMetricsSession(session, NULL));
+  EXPECT_NE(FPGA_OK, xfpga_fpgaSampleMetricsSession(NULL, sampled.data()));
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaDestroyMetricsSession(&session));
+  EXPECT_EQ(session, nullptr);
+  EXPECT_NE(FPGA_OK, xfpga_fpgaDestroyMetricsSession(&session));
+  EXPECT_NE(FPGA_OK, xfpga_fpgaDestroyMetricsSession(NULL));
+
+  // invalid input
+  EXPECT_NE(FPGA_OK, xfpga_fpgaCreateMetricsSession(NULL, id_array.data(),
+                                                    id_array.size(), &session));
+  EXPECT_NE(FPGA_OK, xfpga_fpgaCreateMetricsSession(handle_, NULL,
+                                                    id_array.size(), &session));
+  EXPECT_NE(FPGA_OK, xfpga_fpgaCreateMetricsSession(handle_, id_array.data(),
+                                                    0, &session));
+  EXPECT_NE(FPGA_OK, xfpga_fpgaCreateMetricsSession(handle_, id_array.data(),
+                                                    id_array.size(), NULL));
+  uint64_t invalid[] = {num_metrics + 1, num_metrics + 2};
+  EXPECT_EQ(FPGA_NOT_FOUND, xfpga_fpgaCreateMetricsSession(handle_, invalid,
+                                                           2, &session));
+}
+
+/**
+* @test    metrics_session_samples_per_sec
+* @brief   Tests: xfpga_fpgaSampleMetricsSession
+* @details Compares BMC metric sampling throughput of
+*          xfpga_fpgaGetMetricsByIndex and a metrics session.
+*
+*/
+TEST_P(metrics_c_p, metrics_session_samples_per_sec) {
+  uint64_t num_metrics = 0;
+  ASSERT_EQ(FPGA_OK, xfpga_fpgaGetNumMetrics(handle_, &num_metrics));
+
+  std::vector<uint64_t> id_array;
+  for (uint64_t i = 1; i <= num_metrics; ++i)
+    id_array.push_back(i);
+
+  print_samples_per_sec(handle_, "BMC", id_array);
+}
+
 INSTANTIATE_TEST_CASE_P(metrics_c, metrics_c_p,
                         ::testing::ValuesIn(test_platform::mock_platforms({"dcp-rc"})));
 
@@ -589,5 +710,157 @@ TEST_P(metrics_afu_c_p, test_afc_metric_04) {
 
   free(metric_array_search);
 }
+/**
+* @test    test_afc_metric_session
+* @brief   Tests: xfpga_fpgaCreateMetricsSession
+*                 xfpga_fpgaSampleMetricsSession
+* @details A session reads the current AFU counter values on every
+*          sample.
+*
+*/
+TEST_P(metrics_afu_c_p, test_afc_metric_session) {
+  create_metric_bbb_dfh();
+  create_metric_bbb_csr();
+
+  uint64_t id_array[] = {3, 1, 2};
+  fpga_metric metric_array[3];
+  fpga_metrics_session session = nullptr;
+
+  ASSERT_EQ(FPGA_OK,
+            xfpga_fpgaCreateMetricsSession(handle_, id_array, 3, &session));
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaSampleMetricsSession(session, metric_array));
+  EXPECT_EQ(metric_array[0].metric_num, 3);
+  EXPECT_TRUE(metric_array[0].isvalid);
+  EXPECT_EQ(metric_array[0].value.ivalue, 0x79);
+  EXPECT_EQ(metric_array[1].value.ivalue, 0x99);
+  EXPECT_EQ(metric_array[2].value.ivalue, 0x89);
+
+  struct metric_bbb_value value_csr = {0};
+  value_csr.eol = 0x0;
+  value_csr.counter_id = 0xa;
+  value_csr.value = 0x100;
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaWriteMMIO64(handle_, 0, 0x128, value_csr.csr));
+
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaSampleMetricsSession(session, metric_array));
+  EXPECT_EQ(metric_array[1].value.ivalue, 0x100);
+
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaDestroyMetricsSession(&session));
+}
+
+/**
+* @test    test_afc_metric_session_samples_per_sec
+* @brief   Tests: xfpga_fpgaSampleMetricsSession
+* @details Compares AFU metric sampling throughput of
+*          xfpga_fpgaGetMetricsByIndex and a metrics session.
+*
+*/
+TEST_P(metrics_afu_c_p, test_afc_metric_session_samples_per_sec) {
+  create_metric_bbb_dfh();
+  create_metric_bbb_csr();
+
+  std::vector<uint64_t> id_array = {1, 2, 3, 4};
+  print_samples_per_sec(handle_, "AFU", id_array);
+}
+
+/**
+* @test    test_afc_metric_collector
+* @brief   Tests: xfpga_fpgaCreateMetricsCollector
+*                 xfpga_fpgaReadLatestMetrics
+*                 xfpga_fpgaReadMetricsHistory
+* @details A collector samples the AFU counters in the background;
+*          readers see the latest sample and can drain the history
+*          while other readers poll concurrently.
+*
+*/
+TEST_P(metrics_afu_c_p, test_afc_metric_collector) {
+  create_metric_bbb_dfh();
+  create_metric_bbb_csr();
+
+  uint64_t id_array[] = {3, 1, 2};
+  fpga_metric metric_array[3];
+  fpga_metric history[8 * 3];
+  fpga_metrics_collector collector = nullptr;
+  uint64_t sequence = 0;
+  uint64_t cursor = 0;
+  uint64_t num_samples = 0;
+  int retries;
+
+  EXPECT_EQ(FPGA_INVALID_PARAM,
+            xfpga_fpgaCreateMetricsCollector(handle_, id_array, 0, 1000, 8,
+                                             &collector));
+  EXPECT_EQ(FPGA_INVALID_PARAM,
+            xfpga_fpgaCreateMetricsCollector(handle_, id_array, 3, 1000,
+                                             1 << 20, &collector));
+
+  ASSERT_EQ(FPGA_OK, xfpga_fpgaCreateMetricsCollector(handle_, id_array, 3,
+                                                      1000, 8, &collector));
+
+  for (retries = 0; retries < 1000; ++retries) {
+    if (xfpga_fpgaReadLatestMetrics(collector, metric_array, &sequence) ==
+        FPGA_OK)
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_LT(retries, 1000);
+  EXPECT_EQ(metric_array[0].metric_num, 3);
+  EXPECT_TRUE(metric_array[0].isvalid);
+  EXPECT_EQ(metric_array[0].value.ivalue, 0x79);
+  EXPECT_EQ(metric_array[1].value.ivalue, 0x99);
+  EXPECT_EQ(metric_array[2].value.ivalue, 0x89);
+
+  std::vector<std::thread> readers;
+  std::atomic<bool> stop(false);
+  std::atomic<int> bad(0);
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&]() {
+      fpga_metric m[3];
+      while (!stop) {
+        if (xfpga_fpgaReadLatestMetrics(collector, m, nullptr) == FPGA_OK &&
+            m[0].value.ivalue != 0x79)
+          ++bad;
+      }
+    });
+  }
+
+  struct metric_bbb_value value_csr = {0};
+  value_csr.eol = 0x0;
+  value_csr.counter_id = 0xa;
+  value_csr.value = 0x100;
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaWriteMMIO64(handle_, 0, 0x128, value_csr.csr));
+
+  for (retries = 0; retries < 1000; ++retries) {
+    if (xfpga_fpgaReadLatestMetrics(collector, metric_array, nullptr) ==
+            FPGA_OK &&
+        metric_array[1].value.ivalue == 0x100)
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_LT(retries, 1000);
+
+  stop = true;
+  for (auto &t : readers)
+    t.join();
+  EXPECT_EQ(0, bad);
+
+  // only the last 8 samples are kept
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaReadMetricsHistory(collector, &cursor, history,
+                                                  8, &num_samples));
+  EXPECT_GT(num_samples, 0);
+  EXPECT_LE(num_samples, 8);
+  EXPECT_GE(cursor, num_samples);
+  EXPECT_EQ(history[(num_samples - 1) * 3].metric_num, 3);
+
+  // drained: nothing new until the next period
+  sequence = cursor;
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaReadMetricsHistory(collector, &cursor, history,
+                                                  0, &num_samples));
+  EXPECT_EQ(0, num_samples);
+  EXPECT_EQ(sequence, cursor);
+
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaDestroyMetricsCollector(&collector));
+  EXPECT_EQ(nullptr, collector);
+  EXPECT_EQ(FPGA_INVALID_PARAM, xfpga_fpgaDestroyMetricsCollector(&collector));
+}
+
 INSTANTIATE_TEST_CASE_P(metrics_c, metrics_afu_c_p,
                         ::testing::ValuesIn(test_platform::mock_platforms({"dcp-rc"})));
@@ -41,6 +41,8 @@ extern "C" {
 #include <config.h>
 #include <opae/fpga.h>
 
+#include <chrono>
+#include <iostream>
 #include <vector>
 #include "gtest/gtest.h"
 #include "sysfs_int.h"
@@ -186,6 +188,64 @@ TEST_P(metrics_max10_c_p, test_metric_max10_2) {
 
   EXPECT_EQ(FPGA_OK, fpga_vector_free(&vector));
 }
+/**
+* @test       test_metric_max10_session
+* @brief      Tests: xfpga_fpgaSampleMetricsSession
+* @details    A session samples the same Max10 power and thermal
+*             values as xfpga_fpgaGetMetricsByIndex, and prints the
+*             sampling throughput of both.
+*
+*/
+TEST_P(metrics_max10_c_p, test_metric_max10_session) {
+  const int iterations = 2000;
+  uint64_t num_metrics = 0;
+  ASSERT_EQ(FPGA_OK, xfpga_fpgaGetNumMetrics(handle_, &num_metrics));
+  ASSERT_GT(num_metrics, 0);
+
+  std::vector<uint64_t> id_array;
+  for (uint64_t i = 1; i <= num_metrics; ++i)
+    id_array.push_back(i);
+  std::vector<fpga_metric> expected(num_metrics);
+  std::vector<fpga_metric> sampled(num_metrics);
+
+  xfpga_fpgaGetMetricsByIndex(handle_, id_array.data(), num_metrics,
+                              expected.data());
+
+  fpga_metrics_session session = nullptr;
+  ASSERT_EQ(FPGA_OK, xfpga_fpgaCreateMetricsSession(handle_, id_array.data(),
+                                                    num_metrics, &session));
+  xfpga_fpgaSampleMetricsSession(session, sampled.data());
+  for (uint64_t i = 0; i < num_metrics; ++i) {
+    EXPECT_EQ(sampled[i].metric_num, id_array[i]);
+    EXPECT_EQ(sampled[i].isvalid, expected[i].isvalid) << id_array[i];
+    if (sampled[i].isvalid)
+      EXPECT_DOUBLE_EQ(sampled[i].value.dvalue, expected[i].value.dvalue);
+  }
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    xfpga_fpgaGetMetricsByIndex(handle_, id_array.data(), num_metrics,
+                                expected.data());
+  }
+  auto mid = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    xfpga_fpgaSampleMetricsSession(session, sampled.data());
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+
+  auto by_index = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      mid - start).count();
+  auto session_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        end - mid).count();
+  std::cout << "FME, " << num_metrics << " metrics: by index "
+            << (by_index ? iterations * 1000000000LL / by_index : 0)
+            << " samples/sec, session "
+            << (session_ns ? iterations * 1000000000LL / session_ns : 0)
+            << " samples/sec" << std::endl;
+
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaDestroyMetricsSession(&session));
+}
+
 INSTANTIATE_TEST_CASE_P(metrics_max10_c, metrics_max10_c_p,
     ::testing::ValuesIn(test_platform::mock_platforms({"dfl-d5005"})));
 
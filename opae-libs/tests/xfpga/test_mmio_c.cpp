@@ -37,6 +37,8 @@
 #include <opae/mmio.h>
 #include <sys/mman.h>
 #include <cstdarg>
+#include <chrono>
+#include <iostream>
 #include <linux/ioctl.h>
 
 #include "xfpga.h"
@@ -120,6 +122,34 @@ out_EINVAL:
     goto out;
 }
 
+int mmio_port_info(mock_object * m, int request, va_list argp){
+    int retval = -1;
+    errno = EINVAL;
+    UNUSED_PARAM(m);
+    UNUSED_PARAM(request);
+    struct dfl_fpga_port_info *pinfo = va_arg(argp, struct dfl_fpga_port_info *);
+    if (!pinfo) {
+      FPGA_MSG("pinfo is NULL");
+      goto out_EINVAL;
+    }
+    if (pinfo->argsz != sizeof(*pinfo)) {
+      FPGA_MSG("wrong structure size");
+      goto out_EINVAL;
+    }
+    pinfo->flags = 0;
+    pinfo->num_regions = 2;
+    pinfo->num_umsgs = 0;
+    retval = 0;
+    errno = 0;
+out:
+    return retval;
+
+out_EINVAL:
+    retval = -1;
+    errno = EINVAL;
+    goto out;
+}
+
 class mmio_c_p
     : public ::testing::TestWithParam<std::string> {
  protected:
@@ -494,5 +524,155 @@ TEST_P (mmio_c_p, test_neg_read_write_512) {
 #endif
 }
 
+/**
+* @test       mmio_c_p
+* @brief      Test: test_read_write_64_vec
+* @details    When the parameters are valid and the drivers are loaded:
+*             xfpga_fpgaWriteMMIO64Vec/Range must write each value at its
+*             offset, xfpga_fpgaReadMMIO64Vec/Range must read them back.
+*/
+TEST_P (mmio_c_p, test_read_write_64_vec) {
+  const uint64_t offsets[4] = { CSR_SCRATCHPAD0 + 0x18, CSR_SCRATCHPAD0,
+                                CSR_SCRATCHPAD0 + 0x10, CSR_SCRATCHPAD0 + 0x8 };
+  const uint64_t values[4] = { 0xdeadbeef, 0xdecafbad, 0xc0cac01a, 0x1 };
+  uint64_t read_values[4] = { 0, 0, 0, 0 };
+  uint64_t value = 0;
+
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaWriteMMIO64Vec(handle_, 0, offsets, values, 4));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(FPGA_OK, xfpga_fpgaReadMMIO64(handle_, 0, offsets[i], &value));
+    EXPECT_EQ(values[i], value);
+  }
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaReadMMIO64Vec(handle_, 0, offsets, read_values, 4));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(values[i], read_values[i]);
+  }
+
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaWriteMMIO64Range(handle_, 0, CSR_SCRATCHPAD0, values, 4));
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaReadMMIO64Range(handle_, 0, CSR_SCRATCHPAD0, read_values, 4));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(FPGA_OK, xfpga_fpgaReadMMIO64(handle_, 0, CSR_SCRATCHPAD0 + i * 8, &value));
+    EXPECT_EQ(values[i], value);
+    EXPECT_EQ(values[i], read_values[i]);
+  }
+
+#ifndef BUILD_ASE
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaUnmapMMIO(handle_, 0));
+#endif
+}
+
+/**
+* @test       mmio_c_p
+* @brief      Test: test_neg_read_write_64_vec
+* @details    A batch containing a misaligned or out-of-region offset
+*             is rejected with FPGA_INVALID_PARAM before any register
+*             is written.
+*/
+TEST_P (mmio_c_p, test_neg_read_write_64_vec) {
+  const uint64_t offsets[2] = { CSR_SCRATCHPAD0, CSR_SCRATCHPAD0 + 1 };
+  const uint64_t oob[2] = { CSR_SCRATCHPAD0, MMIO_OUT_REGION_ADDRESS };
+  const uint64_t values[2] = { 0xdeadbeef, 0xdecafbad };
+  uint64_t read_values[2] = { 0, 0 };
+  uint64_t value = 0;
+
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaWriteMMIO64(handle_, 0, CSR_SCRATCHPAD0, 0));
+  EXPECT_EQ(FPGA_INVALID_PARAM, xfpga_fpgaWriteMMIO64Vec(handle_, 0, offsets, values, 2));
+  EXPECT_EQ(FPGA_INVALID_PARAM, xfpga_fpgaWriteMMIO64Vec(handle_, 0, oob, values, 2));
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaReadMMIO64(handle_, 0, CSR_SCRATCHPAD0, &value));
+  EXPECT_EQ(0, value);
+
+  EXPECT_EQ(FPGA_INVALID_PARAM, xfpga_fpgaReadMMIO64Vec(handle_, 0, offsets, read_values, 2));
+  EXPECT_EQ(FPGA_INVALID_PARAM, xfpga_fpgaReadMMIO64Vec(handle_, 0, nullptr, read_values, 2));
+  EXPECT_EQ(FPGA_INVALID_PARAM, xfpga_fpgaReadMMIO64Range(handle_, 0, CSR_SCRATCHPAD0 + 1, read_values, 2));
+  EXPECT_EQ(FPGA_INVALID_PARAM, xfpga_fpgaReadMMIO64Range(handle_, 0, 0x40000 - 8, read_values, 2));
+  EXPECT_EQ(FPGA_INVALID_PARAM, xfpga_fpgaWriteMMIO64Range(handle_, 0, CSR_SCRATCHPAD0, nullptr, 2));
+  EXPECT_EQ(FPGA_INVALID_PARAM, xfpga_fpgaReadMMIO64Range(NULL, 0, CSR_SCRATCHPAD0, read_values, 2));
+
+#ifndef BUILD_ASE
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaUnmapMMIO(handle_, 0));
+#endif
+}
+
+#ifndef BUILD_ASE
+/**
+* @test       mmio_c_p
+* @brief      Test: test_premap_read_write_64
+* @details    When the handle is opened with FPGA_OPEN_MMIO_PREMAP:
+*             every MMIO region is mapped by xfpga_fpgaOpen, 32/64-bit
+*             reads and writes take the lock-free path and still enforce
+*             alignment and region bounds.
+*/
+TEST_P (mmio_c_p, test_premap_read_write_64) {
+  uint64_t value = 0;
+  uint64_t read_value = 0;
+  uint32_t read_value32 = 0;
+  struct _fpga_handle *h;
+
+  system_->register_ioctl_handler(DFL_FPGA_PORT_GET_INFO, mmio_port_info);
+  ASSERT_EQ(FPGA_OK, xfpga_fpgaClose(handle_));
+  handle_ = nullptr;
+  ASSERT_EQ(FPGA_OK, xfpga_fpgaOpen(tokens_[0], &handle_, FPGA_OPEN_MMIO_PREMAP));
+
+  h = (struct _fpga_handle *)handle_;
+  EXPECT_TRUE(h->flags & OPAE_FLAG_MMIO_PREMAP);
+  EXPECT_FALSE(mmio_map_is_empty(h->mmio_root));
+  EXPECT_NE(nullptr, h->mmio_regions[0].base);
+  EXPECT_EQ(0x40000, h->mmio_regions[0].len);
+
+  for (value = 0; value < 100; value += 10) {
+    EXPECT_EQ(FPGA_OK, xfpga_fpgaWriteMMIO64(handle_, 0, CSR_SCRATCHPAD0, value));
+    EXPECT_EQ(FPGA_OK, xfpga_fpgaReadMMIO64(handle_, 0, CSR_SCRATCHPAD0, &read_value));
+    EXPECT_EQ(read_value, value);
+    EXPECT_EQ(FPGA_OK, xfpga_fpgaWriteMMIO32(handle_, 0, CSR_SCRATCHPAD0, value));
+    EXPECT_EQ(FPGA_OK, xfpga_fpgaReadMMIO32(handle_, 0, CSR_SCRATCHPAD0, &read_value32));
+    EXPECT_EQ(read_value32, value);
+  }
+
+  EXPECT_EQ(FPGA_INVALID_PARAM, xfpga_fpgaReadMMIO64(handle_, 0, CSR_SCRATCHPAD0 + 1, &read_value));
+  EXPECT_EQ(FPGA_INVALID_PARAM, xfpga_fpgaReadMMIO64(handle_, 0, 0x40000, &read_value));
+  EXPECT_EQ(FPGA_INVALID_PARAM, xfpga_fpgaWriteMMIO64(handle_, 0, MMIO_OUT_REGION_ADDRESS, value));
+  EXPECT_EQ(FPGA_INVALID_PARAM, xfpga_fpgaReadMMIO32(handle_, 0, 0x40000, &read_value32));
+
+  // Unmapping drops the cached region; access falls back to lazy mapping.
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaUnmapMMIO(handle_, 0));
+  EXPECT_EQ(nullptr, h->mmio_regions[0].base);
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaReadMMIO64(handle_, 0, CSR_SCRATCHPAD0, &read_value));
+}
+
+/**
+* @test       mmio_c_p
+* @brief      Test: test_premap_ns_per_op
+* @details    Micro-benchmark: reports the ns/op of xfpga_fpgaReadMMIO64
+*             through the locked (lazy mapping) path and through the
+*             FPGA_OPEN_MMIO_PREMAP lock-free path. Timings are only
+*             logged; test_premap_read_write_64 covers the premapped path.
+*/
+TEST_P (mmio_c_p, test_premap_ns_per_op) {
+  const uint64_t iterations = 1000000;
+  uint64_t read_value = 0;
+  uint64_t i;
+
+  auto ns_per_op = [&]() -> double {
+    auto begin = std::chrono::steady_clock::now();
+    for (i = 0; i < iterations; ++i)
+      xfpga_fpgaReadMMIO64(handle_, 0, CSR_SCRATCHPAD0, &read_value);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - begin).count() /
+           iterations;
+  };
+
+  ASSERT_EQ(FPGA_OK, xfpga_fpgaReadMMIO64(handle_, 0, CSR_SCRATCHPAD0, &read_value));
+  double locked = ns_per_op();
+
+  system_->register_ioctl_handler(DFL_FPGA_PORT_GET_INFO, mmio_port_info);
+  ASSERT_EQ(FPGA_OK, xfpga_fpgaClose(handle_));
+  handle_ = nullptr;
+  ASSERT_EQ(FPGA_OK, xfpga_fpgaOpen(tokens_[0], &handle_, FPGA_OPEN_MMIO_PREMAP));
+  double premapped = ns_per_op();
+
+  std::cout << "ReadMMIO64 locked: " << locked << " ns/op, "
+            << "premapped: " << premapped << " ns/op" << std::endl;
+}
+#endif // BUILD_ASE
 
 INSTANTIATE_TEST_CASE_P(mmio_c, mmio_c_p, ::testing::ValuesIn(test_platform::platforms({ "dfl-n3000","dfl-d5005" })));
@@ -29,7 +29,10 @@
 #endif // HAVE_CONFIG_H
 
 #include <uuid/uuid.h>
+#include <chrono>
 #include <fstream>
+#include <iostream>
+#include <vector>
 #include "gtest/gtest.h"
 #include "mock/test_system.h"
 #include "types_int.h"
@@ -275,5 +278,186 @@ TEST_P(sysobject_mock_p, xfpga_fpgaGetSize) {
   EXPECT_EQ(xfpga_fpgaDestroyObject(&object), FPGA_OK);
 }
 
+/**
+ * @test    read_plan
+ * @details A read plan compiled from the FME errors group holds every
+ *          integer attribute below it and samples the current values.
+ */
+TEST_P(sysobject_mock_p, read_plan) {
+  uint32_t num_matches = 0;
+  ASSERT_EQ(xfpga_fpgaEnumerate(&dev_filter_, 1, tokens_.data(), tokens_.size(),
+                                &num_matches),
+            FPGA_OK);
+  ASSERT_GT(num_matches, 0);
+  _fpga_token *tk = static_cast<_fpga_token *>(tokens_[0]);
+  std::string syspath(tk->sysfspath);
+  syspath += "/errors/plan_counter";
+  auto fp = system_->register_file(syspath);
+  ASSERT_NE(fp, nullptr) << strerror(errno);
+  fputs("0x10\n", fp);
+  fflush(fp);
+
+  fpga_object errors;
+  fpga_read_plan plan = nullptr;
+  ASSERT_EQ(xfpga_fpgaTokenGetObject(tokens_[0], "errors", &errors, 0),
+            FPGA_OK);
+  ASSERT_EQ(xfpga_fpgaObjectCreateReadPlan(errors, &plan), FPGA_OK);
+
+  uint32_t count = 0;
+  ASSERT_EQ(xfpga_fpgaReadPlanGetCount(plan, &count), FPGA_OK);
+  ASSERT_GT(count, 0);
+
+  // names are relative to the group and resolve to the same attribute
+  uint32_t counter_index = count;
+  std::vector<std::string> names;
+  char name[SYSFS_PATH_MAX];
+  for (uint32_t i = 0; i < count; ++i) {
+    ASSERT_EQ(xfpga_fpgaReadPlanGetName(plan, i, name, sizeof(name)), FPGA_OK);
+    names.push_back(name);
+    if (names.back() == "plan_counter")
+      counter_index = i;
+  }
+  ASSERT_LT(counter_index, count);
+
+  std::vector<uint64_t> values(count);
+  uint64_t ts0 = 0, ts1 = 0;
+  ASSERT_EQ(xfpga_fpgaReadPlanRead(plan, values.data(), count, &ts0), FPGA_OK);
+  EXPECT_EQ(values[counter_index], 0x10);
+  for (uint32_t i = 0; i < count; ++i) {
+    fpga_object obj;
+    uint64_t value = 0;
+    ASSERT_EQ(xfpga_fpgaTokenGetObject(tokens_[0],
+                                       ("errors/" + names[i]).c_str(),
+                                       &obj, 0), FPGA_OK);
+    EXPECT_EQ(xfpga_fpgaObjectRead64(obj, &value, FPGA_OBJECT_SYNC), FPGA_OK);
+    EXPECT_EQ(values[i], value) << names[i];
+    EXPECT_EQ(xfpga_fpgaDestroyObject(&obj), FPGA_OK);
+  }
+
+  // the plan re-reads the open attribute, it does not cache its value
+  rewind(fp);
+  fputs("0x11\n", fp);
+  fflush(fp);
+  ASSERT_EQ(xfpga_fpgaReadPlanRead(plan, values.data(), count, &ts1), FPGA_OK);
+  EXPECT_EQ(values[counter_index], 0x11);
+  EXPECT_GE(ts1, ts0);
+  fclose(fp);
+
+  EXPECT_EQ(xfpga_fpgaReadPlanRead(plan, values.data(), count + 1, nullptr),
+            FPGA_INVALID_PARAM);
+  EXPECT_EQ(xfpga_fpgaReadPlanGetName(plan, count, name, sizeof(name)),
+            FPGA_INVALID_PARAM);
+  EXPECT_EQ(xfpga_fpgaReadPlanRead(plan, nullptr, count, nullptr),
+            FPGA_INVALID_PARAM);
+
+  EXPECT_EQ(xfpga_fpgaDestroyReadPlan(&plan), FPGA_OK);
+  EXPECT_EQ(plan, nullptr);
+  EXPECT_EQ(xfpga_fpgaDestroyReadPlan(&plan), FPGA_INVALID_PARAM);
+  EXPECT_EQ(xfpga_fpgaDestroyObject(&errors), FPGA_OK);
+}
+
+/**
+ * @test    read_plan_attribute
+ * @details A plan compiled from a single attribute holds that attribute.
+ *          Attributes that are not integers are not part of any plan.
+ */
+TEST_P(sysobject_mock_p, read_plan_attribute) {
+  uint32_t num_matches = 0;
+  ASSERT_EQ(xfpga_fpgaEnumerate(&dev_filter_, 1, tokens_.data(), tokens_.size(),
+                                &num_matches),
+            FPGA_OK);
+  ASSERT_GT(num_matches, 0);
+  _fpga_token *tk = static_cast<_fpga_token *>(tokens_[0]);
+  std::string syspath(tk->sysfspath);
+  syspath += "/testdata";
+  auto fp = system_->register_file(syspath);
+  ASSERT_NE(fp, nullptr) << strerror(errno);
+  fwrite(DATA.c_str(), DATA.size(), 1, fp);
+  fclose(fp);
+
+  fpga_object object;
+  fpga_read_plan plan = nullptr;
+  ASSERT_EQ(xfpga_fpgaTokenGetObject(tokens_[0], "testdata", &object, 0),
+            FPGA_OK);
+  EXPECT_EQ(xfpga_fpgaObjectCreateReadPlan(object, &plan), FPGA_NOT_FOUND);
+  EXPECT_EQ(xfpga_fpgaDestroyObject(&object), FPGA_OK);
+
+  ASSERT_EQ(xfpga_fpgaTokenGetObject(tokens_[0], "bitstream_id", &object, 0),
+            FPGA_OK);
+  ASSERT_EQ(xfpga_fpgaObjectCreateReadPlan(object, &plan), FPGA_OK);
+  uint32_t count = 0;
+  char name[64];
+  uint64_t value = 0;
+  EXPECT_EQ(xfpga_fpgaReadPlanGetCount(plan, &count), FPGA_OK);
+  EXPECT_EQ(count, 1);
+  EXPECT_EQ(xfpga_fpgaReadPlanGetName(plan, 0, name, sizeof(name)), FPGA_OK);
+  EXPECT_STREQ(name, "bitstream_id");
+  EXPECT_EQ(xfpga_fpgaReadPlanRead(plan, &value, 1, nullptr), FPGA_OK);
+  EXPECT_EQ(value, platform_.devices[0].bbs_id);
+  EXPECT_EQ(xfpga_fpgaDestroyReadPlan(&plan), FPGA_OK);
+  EXPECT_EQ(xfpga_fpgaDestroyObject(&object), FPGA_OK);
+}
+
+/**
+ * @test    read_plan_samples_per_sec
+ * @details Compares sampling a group with one read plan against reading
+ *          each of its attributes with fpgaObjectRead64(FPGA_OBJECT_SYNC).
+ */
+TEST_P(sysobject_mock_p, read_plan_samples_per_sec) {
+  const int iterations = 5000;
+  uint32_t num_matches = 0;
+  ASSERT_EQ(xfpga_fpgaEnumerate(&dev_filter_, 1, tokens_.data(), tokens_.size(),
+                                &num_matches),
+            FPGA_OK);
+  ASSERT_GT(num_matches, 0);
+
+  fpga_object errors;
+  fpga_read_plan plan = nullptr;
+  uint32_t count = 0;
+  ASSERT_EQ(xfpga_fpgaTokenGetObject(tokens_[0], "errors", &errors, 0),
+            FPGA_OK);
+  ASSERT_EQ(xfpga_fpgaObjectCreateReadPlan(errors, &plan), FPGA_OK);
+  ASSERT_EQ(xfpga_fpgaReadPlanGetCount(plan, &count), FPGA_OK);
+
+  std::vector<fpga_object> objects(count);
+  char name[SYSFS_PATH_MAX];
+  for (uint32_t i = 0; i < count; ++i) {
+    ASSERT_EQ(xfpga_fpgaReadPlanGetName(plan, i, name, sizeof(name)), FPGA_OK);
+    ASSERT_EQ(xfpga_fpgaObjectGetObject(errors, name, &objects[i], 0),
+              FPGA_OK);
+  }
+
+  std::vector<uint64_t> values(count);
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    for (uint32_t j = 0; j < count; ++j) {
+      ASSERT_EQ(xfpga_fpgaObjectRead64(objects[j], &values[j],
+                                       FPGA_OBJECT_SYNC), FPGA_OK);
+    }
+  }
+  auto mid = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    ASSERT_EQ(xfpga_fpgaReadPlanRead(plan, values.data(), count, nullptr),
+              FPGA_OK);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+
+  auto per_object = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        mid - start).count();
+  auto planned = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     end - mid).count();
+  std::cout << count << " attributes, per-object reads: "
+            << (per_object ? iterations * 1000000000LL / per_object : 0)
+            << " samples/sec, read plan: "
+            << (planned ? iterations * 1000000000LL / planned : 0)
+            << " samples/sec" << std::endl;
+
+  for (auto &obj : objects) {
+    EXPECT_EQ(xfpga_fpgaDestroyObject(&obj), FPGA_OK);
+  }
+  EXPECT_EQ(xfpga_fpgaDestroyReadPlan(&plan), FPGA_OK);
+  EXPECT_EQ(xfpga_fpgaDestroyObject(&errors), FPGA_OK);
+}
+
 INSTANTIATE_TEST_CASE_P(sysobject_c, sysobject_mock_p,
                         ::testing::ValuesIn(test_platform::mock_platforms({ "dfl-n3000","dfl-d5005" })));
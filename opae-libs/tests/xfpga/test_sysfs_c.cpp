@@ -56,13 +56,17 @@ fpga_result re_match_region(const char *fmt, char *inpstr, char type[], size_t,
                             int *num);
 }
 
+#include <chrono>
 #include <fstream>
+#include <iostream>
 #include <opae/enum.h>
 #include <opae/fpga.h>
 #include <opae/properties.h>
 #include <sys/types.h>
+#include <unistd.h>
 #include <uuid/uuid.h>
 #include <string>
+#include <thread>
 #include <vector>
 #include "xfpga.h"
 #include <fcntl.h>
@@ -792,6 +796,229 @@ TEST_P(sysfs_c_mock_p, fpga_sysfs_05) {
 }
 
 
+/**
+ * @test    fd_cache
+ * @details Attribute reads keep their fd open and re-read it with
+ *          pread(), seeing updated values. No more than the configured
+ *          number of fds stays open, and a budget of 0 closes them all.
+ */
+TEST_P(sysfs_c_mock_p, fd_cache) {
+  std::string socket_id = sysfs_fme + std::string("/socket_id");
+  std::string bitstream_id = sysfs_fme + std::string("/bitstream_id");
+  std::string ports_num = sysfs_fme + std::string("/ports_num");
+  uint64_t hits = 0, misses = 0;
+  uint32_t open_fds = 0;
+  uint64_t value = 0;
+  uint32_t u32 = 0;
+
+  xfpga_sysfs_fd_cache_configure(0);
+  xfpga_sysfs_fd_cache_configure(2);
+
+  ASSERT_EQ(sysfs_write_u64_decimal(socket_id.c_str(), 1), FPGA_OK);
+  ASSERT_EQ(sysfs_read_u64(socket_id.c_str(), &value), FPGA_OK);
+  EXPECT_EQ(value, 1);
+  ASSERT_EQ(sysfs_write_u64_decimal(socket_id.c_str(), 7), FPGA_OK);
+  ASSERT_EQ(sysfs_read_u64(socket_id.c_str(), &value), FPGA_OK);
+  EXPECT_EQ(value, 7);
+
+  ASSERT_EQ(xfpga_sysfs_fd_cache_stats(&hits, &misses, &open_fds), FPGA_OK);
+  EXPECT_EQ(hits, 1);
+  EXPECT_EQ(misses, 1);
+  EXPECT_EQ(open_fds, 1);
+
+  EXPECT_EQ(sysfs_read_u64(bitstream_id.c_str(), &value), FPGA_OK);
+  EXPECT_EQ(sysfs_read_u32(ports_num.c_str(), &u32), FPGA_OK);
+  ASSERT_EQ(xfpga_sysfs_fd_cache_stats(&hits, &misses, &open_fds), FPGA_OK);
+  EXPECT_EQ(misses, 3);
+  EXPECT_EQ(open_fds, 2);
+
+  // socket_id was least recently used, so it was closed
+  EXPECT_EQ(sysfs_read_u64(socket_id.c_str(), &value), FPGA_OK);
+  ASSERT_EQ(xfpga_sysfs_fd_cache_stats(&hits, &misses, &open_fds), FPGA_OK);
+  EXPECT_EQ(misses, 4);
+  EXPECT_EQ(open_fds, 2);
+
+  EXPECT_NE(sysfs_read_u64((sysfs_fme + "/no_such_attr").c_str(), &value),
+            FPGA_OK);
+  ASSERT_EQ(xfpga_sysfs_fd_cache_stats(&hits, &misses, &open_fds), FPGA_OK);
+  EXPECT_EQ(open_fds, 2);
+
+  xfpga_sysfs_fd_cache_configure(0);
+  ASSERT_EQ(xfpga_sysfs_fd_cache_stats(&hits, &misses, &open_fds), FPGA_OK);
+  EXPECT_EQ(hits, 0);
+  EXPECT_EQ(misses, 0);
+  EXPECT_EQ(open_fds, 0);
+
+  // uncached reads still work
+  EXPECT_EQ(sysfs_read_u64(socket_id.c_str(), &value), FPGA_OK);
+  EXPECT_EQ(value, 7);
+  ASSERT_EQ(xfpga_sysfs_fd_cache_stats(&hits, &misses, &open_fds), FPGA_OK);
+  EXPECT_EQ(open_fds, 0);
+
+  EXPECT_EQ(xfpga_sysfs_fd_cache_stats(nullptr, &misses, &open_fds),
+            FPGA_INVALID_PARAM);
+  xfpga_sysfs_fd_cache_configure(64);
+}
+
+/**
+ * @test    fd_cache_reads_per_sec
+ * @details Compares fpgaObjectRead64(FPGA_OBJECT_SYNC) throughput with
+ *          the attribute fd cache disabled and enabled.
+ */
+TEST_P(sysfs_c_mock_p, fd_cache_reads_per_sec) {
+  const int iterations = 20000;
+  fpga_object obj = nullptr;
+  uint64_t value = 0;
+
+  ASSERT_EQ(xfpga_fpgaTokenGetObject(tokens_[0], "socket_id", &obj, 0),
+            FPGA_OK);
+
+  for (uint32_t max_fds : { 0u, 64u }) {
+    xfpga_sysfs_fd_cache_configure(max_fds);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      ASSERT_EQ(xfpga_fpgaObjectRead64(obj, &value, FPGA_OBJECT_SYNC),
+                FPGA_OK);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  end - start).count();
+    std::cout << (max_fds ? "cached" : "uncached") << " sync reads: "
+              << (ns ? iterations * 1000000000LL / ns : 0) << " reads/sec"
+              << std::endl;
+  }
+
+  EXPECT_EQ(xfpga_fpgaDestroyObject(&obj), FPGA_OK);
+}
+
+/**
+ * @test    glob_cache
+ * @details FPGA_OBJECT_GLOB lookups of a pattern already resolved are
+ *          served from the glob cache until it is flushed, and a budget
+ *          of 0 disables the cache.
+ */
+TEST_P(sysfs_c_mock_p, glob_cache) {
+  fpga_object container = nullptr;
+  uint64_t hits = 0, misses = 0;
+  uint32_t entries = 0, sz = 0;
+
+  xfpga_sysfs_glob_cache_configure(0);
+  xfpga_sysfs_glob_cache_configure(16);
+  // Directories modified in the current timestamp tick aren't trusted.
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_EQ(xfpga_fpgaTokenGetObject(tokens_[0], "bitstream*", &container,
+                                       FPGA_OBJECT_GLOB),
+              FPGA_OK);
+    EXPECT_EQ(xfpga_fpgaObjectGetSize(container, &sz, 0), FPGA_OK);
+    EXPECT_EQ(sz, 2);
+    EXPECT_EQ(xfpga_fpgaDestroyObject(&container), FPGA_OK);
+  }
+  ASSERT_EQ(xfpga_sysfs_glob_cache_stats(&hits, &misses, &entries), FPGA_OK);
+  EXPECT_EQ(hits, 1);
+  EXPECT_EQ(misses, 1);
+  EXPECT_EQ(entries, 1);
+
+  // patterns that match nothing are not remembered
+  EXPECT_EQ(xfpga_fpgaTokenGetObject(tokens_[0], "no_such_attr*", &container,
+                                     FPGA_OBJECT_GLOB),
+            FPGA_NOT_FOUND);
+  ASSERT_EQ(xfpga_sysfs_glob_cache_stats(&hits, &misses, &entries), FPGA_OK);
+  EXPECT_EQ(misses, 2);
+  EXPECT_EQ(entries, 1);
+
+  sysfs_glob_cache_flush();
+  ASSERT_EQ(xfpga_sysfs_glob_cache_stats(&hits, &misses, &entries), FPGA_OK);
+  EXPECT_EQ(entries, 0);
+
+  ASSERT_EQ(xfpga_fpgaTokenGetObject(tokens_[0], "bitstream*", &container,
+                                     FPGA_OBJECT_GLOB),
+            FPGA_OK);
+  EXPECT_EQ(xfpga_fpgaDestroyObject(&container), FPGA_OK);
+  ASSERT_EQ(xfpga_sysfs_glob_cache_stats(&hits, &misses, &entries), FPGA_OK);
+  EXPECT_EQ(hits, 1);
+  EXPECT_EQ(misses, 3);
+  EXPECT_EQ(entries, 1);
+
+  xfpga_sysfs_glob_cache_configure(0);
+  ASSERT_EQ(xfpga_sysfs_glob_cache_stats(&hits, &misses, &entries), FPGA_OK);
+  EXPECT_EQ(hits, 0);
+  EXPECT_EQ(misses, 0);
+  EXPECT_EQ(entries, 0);
+
+  EXPECT_EQ(xfpga_sysfs_glob_cache_stats(&hits, nullptr, &entries),
+            FPGA_INVALID_PARAM);
+}
+
+/**
+ * @test    glob_cache_add_remove
+ * @details A match added or removed between two FPGA_OBJECT_GLOB
+ *          lookups of the same pattern is seen by the second lookup.
+ */
+TEST_P(sysfs_c_mock_p, glob_cache_add_remove) {
+  _fpga_token *tok = static_cast<_fpga_token *>(tokens_[0]);
+  std::string dir = system_->get_sysfs_path(std::string(tok->sysfspath));
+  std::string added = dir + "/bitstream_added";
+  fpga_object container = nullptr;
+  uint32_t sz = 0;
+
+  xfpga_sysfs_glob_cache_configure(16);
+
+  ASSERT_EQ(xfpga_fpgaTokenGetObject(tokens_[0], "bitstream*", &container,
+                                     FPGA_OBJECT_GLOB),
+            FPGA_OK);
+  EXPECT_EQ(xfpga_fpgaObjectGetSize(container, &sz, 0), FPGA_OK);
+  EXPECT_EQ(sz, 2);
+  EXPECT_EQ(xfpga_fpgaDestroyObject(&container), FPGA_OK);
+
+  std::ofstream(added) << "0x0" << std::endl;
+  ASSERT_EQ(xfpga_fpgaTokenGetObject(tokens_[0], "bitstream*", &container,
+                                     FPGA_OBJECT_GLOB),
+            FPGA_OK);
+  EXPECT_EQ(xfpga_fpgaObjectGetSize(container, &sz, 0), FPGA_OK);
+  EXPECT_EQ(sz, 3);
+  EXPECT_EQ(xfpga_fpgaDestroyObject(&container), FPGA_OK);
+
+  ASSERT_EQ(unlink(added.c_str()), 0);
+  ASSERT_EQ(xfpga_fpgaTokenGetObject(tokens_[0], "bitstream*", &container,
+                                     FPGA_OBJECT_GLOB),
+            FPGA_OK);
+  EXPECT_EQ(xfpga_fpgaObjectGetSize(container, &sz, 0), FPGA_OK);
+  EXPECT_EQ(sz, 2);
+  EXPECT_EQ(xfpga_fpgaDestroyObject(&container), FPGA_OK);
+
+  xfpga_sysfs_glob_cache_configure(0);
+}
+
+/**
+ * @test    glob_cache_lookups_per_sec
+ * @details Compares FPGA_OBJECT_GLOB lookup throughput with the glob
+ *          cache disabled and enabled.
+ */
+TEST_P(sysfs_c_mock_p, glob_cache_lookups_per_sec) {
+  const int iterations = 5000;
+  fpga_object obj = nullptr;
+
+  for (uint32_t max_entries : { 0u, 256u }) {
+    xfpga_sysfs_glob_cache_configure(max_entries);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      ASSERT_EQ(xfpga_fpgaTokenGetObject(tokens_[0], "bitstream_i*", &obj,
+                                         FPGA_OBJECT_GLOB),
+                FPGA_OK);
+      ASSERT_EQ(xfpga_fpgaDestroyObject(&obj), FPGA_OK);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  end - start).count();
+    std::cout << (max_entries ? "cached" : "uncached") << " glob lookups: "
+              << (ns ? iterations * 1000000000LL / ns : 0) << " lookups/sec"
+              << std::endl;
+  }
+  xfpga_sysfs_glob_cache_configure(0);
+}
+
 INSTANTIATE_TEST_CASE_P(sysfs_c, sysfs_c_mock_p,
                         ::testing::ValuesIn(test_platform::mock_platforms({ "dfl-n3000","dfl-d5005" })));
 
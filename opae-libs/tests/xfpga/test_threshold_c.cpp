@@ -46,7 +46,11 @@ extern "C" {
 #include <opae/fpga.h>
 #include <array>
 #include <cstdlib>
+#include <cstring>
 #include <map>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 #include <memory>
 #include <string>
 #include <vector>
@@ -61,6 +65,15 @@ extern "C" {
 extern "C" {
 int xfpga_plugin_initialize(void);
 int xfpga_plugin_finalize(void);
+struct _fpga_threshold_monitor *threshold_monitor_alloc(uint64_t num_metrics);
+void threshold_monitor_free(struct _fpga_threshold_monitor *m);
+uint64_t threshold_monitor_compile(struct _fpga_threshold_monitor *m,
+                                   const char **metric_names,
+                                   const metric_threshold *thresholds,
+                                   uint32_t num_thresholds);
+uint64_t threshold_monitor_evaluate(struct _fpga_threshold_monitor *m,
+                                    const fpga_metric *metrics,
+                                    struct threshold_event *events);
 }
 
 using namespace opae::testing;
@@ -214,6 +227,130 @@ TEST_P(metrics_bmc_threshold_c_p, metrics_threshold_4) {
 
   EXPECT_NE(get_max10_threshold_info(handle_, NULL, &num_thresholds), FPGA_OK);
 }
+/**
+* @test       threshold_monitor
+* @brief      Tests: xfpga_fpgaCreateThresholdMonitor
+*                    xfpga_fpgaEvaluateThresholds
+* @details    A monitor over the BMC metrics reports a transition for
+*             each metric whose thresholds a sample crosses and signals
+*             its event handle; invalid samples change nothing.
+*
+*/
+TEST_P(metrics_bmc_threshold_c_p, threshold_monitor) {
+  uint64_t num_metrics = 0;
+  fpga_event_handle eh = nullptr;
+  fpga_threshold_monitor monitor = nullptr;
+  uint64_t transitions = 0;
+  int fd = -1;
+
+  ASSERT_EQ(xfpga_fpgaGetNumMetrics(handle_, &num_metrics), FPGA_OK);
+  ASSERT_GT(num_metrics, 0);
+  std::vector<uint64_t> ids(num_metrics);
+  for (uint64_t i = 0; i < num_metrics; ++i) ids[i] = i;
+  std::vector<fpga_metric> sample(num_metrics);
+
+  EXPECT_EQ(xfpga_fpgaCreateThresholdMonitor(NULL, ids.data(), num_metrics,
+                                             NULL, NULL, NULL, &monitor),
+            FPGA_INVALID_PARAM);
+  EXPECT_EQ(xfpga_fpgaCreateThresholdMonitor(handle_, ids.data(), 0, NULL,
+                                             NULL, NULL, &monitor),
+            FPGA_INVALID_PARAM);
+
+  ASSERT_EQ(xfpga_fpgaCreateEventHandle(&eh), FPGA_OK);
+  ASSERT_EQ(xfpga_fpgaGetOSObjectFromEventHandle(eh, &fd), FPGA_OK);
+  fpga_result res = xfpga_fpgaCreateThresholdMonitor(
+      handle_, ids.data(), num_metrics, NULL, NULL, eh, &monitor);
+  ASSERT_TRUE(res == FPGA_OK || res == FPGA_NOT_FOUND);
+  if (res == FPGA_NOT_FOUND) {
+    // the platform's SDRs define no thresholds for these metrics
+    EXPECT_EQ(monitor, nullptr);
+    EXPECT_EQ(xfpga_fpgaDestroyEventHandle(&eh), FPGA_OK);
+    return;
+  }
+
+  for (auto &m : sample) {
+    m.value.dvalue = 1e9;
+    m.isvalid = false;
+  }
+  EXPECT_EQ(xfpga_fpgaEvaluateThresholds(monitor, sample.data(), &transitions),
+            FPGA_OK);
+  EXPECT_EQ(transitions, 0);
+
+  for (auto &m : sample) m.isvalid = true;
+  EXPECT_EQ(xfpga_fpgaEvaluateThresholds(monitor, sample.data(), &transitions),
+            FPGA_OK);
+  EXPECT_GT(transitions, 0);
+
+  struct pollfd pfd = {fd, POLLIN, 0};
+  EXPECT_EQ(poll(&pfd, 1, 0), 1);
+
+  // same sample again: no edges
+  EXPECT_EQ(xfpga_fpgaEvaluateThresholds(monitor, sample.data(), &transitions),
+            FPGA_OK);
+  EXPECT_EQ(transitions, 0);
+
+  EXPECT_EQ(xfpga_fpgaDestroyThresholdMonitor(&monitor), FPGA_OK);
+  EXPECT_EQ(monitor, nullptr);
+  EXPECT_EQ(xfpga_fpgaDestroyEventHandle(&eh), FPGA_OK);
+}
+
+struct reentrant_context {
+  fpga_threshold_monitor monitor;
+  std::vector<uint32_t> states;
+  uint64_t calls;
+};
+
+static void query_monitor(uint64_t metric_num, uint32_t prev_state,
+                          uint32_t state, double value, void *context) {
+  (void)metric_num;
+  (void)prev_state;
+  (void)state;
+  (void)value;
+  auto ctx = reinterpret_cast<reentrant_context *>(context);
+  EXPECT_EQ(xfpga_fpgaGetThresholdStates(ctx->monitor, ctx->states.data()),
+            FPGA_OK);
+  ++ctx->calls;
+}
+
+/**
+* @test       threshold_monitor_reentrant
+* @brief      Tests: xfpga_fpgaEvaluateThresholds
+* @details    The callback runs without the monitor lock held, so it
+*             may query the monitor that reported the transition.
+*
+*/
+TEST_P(metrics_bmc_threshold_c_p, threshold_monitor_reentrant) {
+  uint64_t num_metrics = 0;
+  uint64_t transitions = 0;
+  reentrant_context ctx;
+
+  ASSERT_EQ(xfpga_fpgaGetNumMetrics(handle_, &num_metrics), FPGA_OK);
+  ASSERT_GT(num_metrics, 0);
+  std::vector<uint64_t> ids(num_metrics);
+  for (uint64_t i = 0; i < num_metrics; ++i) ids[i] = i;
+  std::vector<fpga_metric> sample(num_metrics);
+
+  ctx.monitor = nullptr;
+  ctx.states.resize(num_metrics);
+  ctx.calls = 0;
+  fpga_result res = xfpga_fpgaCreateThresholdMonitor(
+      handle_, ids.data(), num_metrics, query_monitor, &ctx, NULL,
+      &ctx.monitor);
+  ASSERT_TRUE(res == FPGA_OK || res == FPGA_NOT_FOUND);
+  if (res == FPGA_NOT_FOUND) return;
+
+  for (auto &m : sample) {
+    m.value.dvalue = 1e9;
+    m.isvalid = true;
+  }
+  EXPECT_EQ(xfpga_fpgaEvaluateThresholds(ctx.monitor, sample.data(),
+                                         &transitions),
+            FPGA_OK);
+  EXPECT_EQ(ctx.calls, transitions);
+
+  EXPECT_EQ(xfpga_fpgaDestroyThresholdMonitor(&ctx.monitor), FPGA_OK);
+}
+
 INSTANTIATE_TEST_CASE_P(metrics_threshold_c_c, metrics_bmc_threshold_c_p,
     ::testing::ValuesIn(test_platform::mock_platforms({"dcp-rc"})));
 
@@ -307,3 +444,78 @@ TEST_P(metrics_afu_threshold_c_p, metrics_threshold_6) {
 }
 INSTANTIATE_TEST_CASE_P(metrics_threshold_c_c, metrics_afu_threshold_c_p,
     ::testing::ValuesIn(test_platform::mock_platforms({"dcp-vc"})));
+
+/**
+* @test       threshold_monitor_evaluate
+* @brief      Tests: threshold_monitor_compile, threshold_monitor_evaluate
+* @details    Thresholds are matched to metrics by name without regard
+*             to case. Only state changes are recorded and signalled
+*             through the eventfd, and a crossed threshold stays
+*             set until the value clears its hysteresis.
+*
+*/
+TEST(threshold_monitor, threshold_monitor_evaluate) {
+  struct _fpga_threshold_monitor *m = threshold_monitor_alloc(3);
+  ASSERT_NE(m, nullptr);
+
+  metric_threshold t[2];
+  memset(t, 0, sizeof(t));
+  strcpy(t[0].metric_name, "FPGA Core Temperature");
+  t[0].upper_nc_threshold.is_valid = 1;
+  t[0].upper_nc_threshold.value = 90.0;
+  t[0].upper_c_threshold.is_valid = 1;
+  t[0].upper_c_threshold.value = 100.0;
+  t[0].hysteresis.is_valid = 1;
+  t[0].hysteresis.value = 2.0;
+  strcpy(t[1].metric_name, "12v Voltage");
+  t[1].lower_c_threshold.is_valid = 1;
+  t[1].lower_c_threshold.value = 11.0;
+
+  const char *names[] = {"fpga core temperature", nullptr, "12V VOLTAGE"};
+  m->metric_num[0] = 5;
+  m->metric_num[1] = 6;
+  m->metric_num[2] = 7;
+  EXPECT_EQ(threshold_monitor_compile(m, names, t, 2), 2);
+
+  std::vector<threshold_event> log;
+  m->event_fd = eventfd(0, 0);
+  ASSERT_GE(m->event_fd, 0);
+
+  const double samples[][3] = {
+      {80.0, 0.0, 12.0},   // nothing crossed
+      {91.0, 0.0, 12.0},   // 5: upper non-critical
+      {101.0, 0.0, 10.5},  // 5: upper critical, 7: lower critical
+      {99.5, 0.0, 10.5},   // within hysteresis: no change
+      {97.0, 0.0, 12.0},   // 5: back to non-critical, 7: cleared
+  };
+  const uint64_t expected[] = {0, 1, 2, 0, 2};
+  fpga_metric metrics[3];
+
+  for (size_t s = 0; s < sizeof(expected) / sizeof(expected[0]); ++s) {
+    for (int i = 0; i < 3; ++i) {
+      metrics[i].value.dvalue = samples[s][i];
+      metrics[i].isvalid = true;
+    }
+    threshold_event events[3];
+    uint64_t changed = threshold_monitor_evaluate(m, metrics, events);
+    EXPECT_EQ(changed, expected[s]);
+    log.insert(log.end(), events, events + changed);
+  }
+
+  ASSERT_EQ(log.size(), 5);
+  EXPECT_EQ(log[0].metric_num, 5);
+  EXPECT_EQ(log[0].state, FPGA_THRESHOLD_UPPER_NC);
+  EXPECT_EQ(log[1].state, FPGA_THRESHOLD_UPPER_NC | FPGA_THRESHOLD_UPPER_C);
+  EXPECT_EQ(log[2].metric_num, 7);
+  EXPECT_EQ(log[2].state, FPGA_THRESHOLD_LOWER_C);
+  EXPECT_EQ(log[3].state, FPGA_THRESHOLD_UPPER_NC);
+  EXPECT_EQ(log[4].prev_state, FPGA_THRESHOLD_LOWER_C);
+  EXPECT_EQ(log[4].state, 0);
+
+  uint64_t count = 0;
+  EXPECT_EQ(read(m->event_fd, &count, sizeof(count)), sizeof(count));
+  EXPECT_EQ(count, 5);
+
+  close(m->event_fd);
+  threshold_monitor_free(m);
+}
@@ -40,8 +40,10 @@ int xfpga_plugin_finalize(void);
 #include "types_int.h"
 #include "sysfs_int.h"
 
-
-extern pthread_mutex_t global_lock;
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
 
 using namespace opae::testing;
 
@@ -101,25 +103,35 @@ TEST_P(token_list_c_p, simple_case) {
   EXPECT_EQ(nullptr, parent);
 }
 
-TEST_P(token_list_c_p, invalid_mutex) {
-  pthread_mutex_destroy(&global_lock);
+TEST_P(token_list_c_p, duplicates) {
   auto fme = token_add(sysfs_fme.c_str(), dev_fme.c_str());
-  EXPECT_EQ(fme, nullptr);
-  pthread_mutex_init(&global_lock, NULL);
+  ASSERT_NE(fme, nullptr);
+  EXPECT_EQ(fme, token_add(sysfs_fme.c_str(), dev_fme.c_str()));
+
+  // same sysfs path, different device path: a distinct entry.
+  auto other = token_add(sysfs_fme.c_str(), dev_port.c_str());
+  ASSERT_NE(other, nullptr);
+  EXPECT_NE(other, fme);
+  EXPECT_EQ(other->device_instance, fme->device_instance);
+  EXPECT_EQ(other->subdev_instance, fme->subdev_instance);
+}
 
+TEST_P(token_list_c_p, cleanup) {
+  auto fme = token_add(sysfs_fme.c_str(), dev_fme.c_str());
+  ASSERT_NE(fme, nullptr);
   auto port = token_add(sysfs_port.c_str(), dev_port.c_str());
   ASSERT_NE(port, nullptr);
+  EXPECT_EQ(token_get_parent(port), fme);
 
-  pthread_mutex_destroy(&global_lock);
-  auto parent = token_get_parent(port);
-  EXPECT_EQ(nullptr, parent);
-  pthread_mutex_init(&global_lock, NULL);
-
-  pthread_mutex_destroy(&global_lock);
   token_cleanup();
-  pthread_mutex_init(&global_lock, NULL);
-  parent = token_get_parent(port);
-  EXPECT_EQ(parent, fme);
+
+  port = token_add(sysfs_port.c_str(), dev_port.c_str());
+  ASSERT_NE(port, nullptr);
+  EXPECT_EQ(nullptr, token_get_parent(port));
+
+  fme = token_add(sysfs_fme.c_str(), dev_fme.c_str());
+  ASSERT_NE(fme, nullptr);
+  EXPECT_EQ(token_get_parent(port), fme);
 }
 
 TEST_P(token_list_c_p, invalid_paths) {
@@ -155,5 +167,65 @@ TEST_P(token_list_c_p, invalid_paths) {
   ASSERT_EQ(fme, nullptr);
 }
 
+/**
+ * @test       stress
+ *
+ * @brief      Several threads concurrently register the same few hundred
+ *             simulated port tokens. Every thread must get back the same
+ *             entry for a given path, and the average cost of a lookup
+ *             of an already-registered token is reported.
+ */
+TEST_P(token_list_c_p, stress) {
+  const int num_tokens = 512;
+  const int num_threads = 8;
+  const int rounds = 20;
+  std::vector<std::string> sysfs(num_tokens);
+  std::vector<std::string> dev(num_tokens);
+  std::vector<std::vector<_fpga_token *>> seen(
+      num_threads, std::vector<_fpga_token *>(num_tokens, nullptr));
+
+  for (int i = 0; i < num_tokens; ++i) {
+    sysfs[i] = "/sys/class/fpga_region/region" + std::to_string(i / 4) +
+               "/dfl-port." + std::to_string(i);
+    dev[i] = "/dev/dfl-port." + std::to_string(i);
+  }
+
+  auto worker = [&](int t) {
+    for (int r = 0; r < rounds; ++r) {
+      for (int n = 0; n < num_tokens; ++n) {
+        // each thread walks the tokens in a different order
+        int i = (n * 7 + t * 61) % num_tokens;
+        _fpga_token *tok = token_add(sysfs[i].c_str(), dev[i].c_str());
+        if (!seen[t][i])
+          seen[t][i] = tok;
+        else if (seen[t][i] != tok)
+          seen[t][i] = nullptr;
+      }
+    }
+  };
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t)
+    threads.emplace_back(worker, t);
+  for (auto &th : threads)
+    th.join();
+  auto end = std::chrono::steady_clock::now();
+
+  for (int i = 0; i < num_tokens; ++i) {
+    ASSERT_NE(seen[0][i], nullptr);
+    EXPECT_EQ(seen[0][i]->subdev_instance, (uint32_t)i);
+    for (int t = 1; t < num_threads; ++t)
+      EXPECT_EQ(seen[t][i], seen[0][i]);
+  }
+
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      end - start).count();
+  std::cout << "token_add: " << num_tokens << " tokens, " << num_threads
+            << " threads, "
+            << ns / ((int64_t)num_tokens * num_threads * rounds)
+            << " ns/op" << std::endl;
+}
+
 INSTANTIATE_TEST_CASE_P(token_list_c, token_list_c_p,
                         ::testing::ValuesIn(test_platform::platforms({ "dfl-n3000","dfl-d5005" })));
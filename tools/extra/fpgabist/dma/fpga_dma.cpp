@@ -28,7 +28,6 @@
  * \fpga_dma.cpp
  * \brief FPGA DMA User-mode driver
  */
-#include <iomanip>
 #include <iostream>
 #include <stdbool.h>
 #include <string.h>
@@ -36,6 +35,12 @@
 #include <errno.h>
 #include <unistd.h>
 #include <assert.h>
+#include <climits>
+#include <poll.h>
+#include <sched.h>
+#include <time.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
 #include "fpga_dma_internal.h"
 #include "fpga_dma.h"
 #include "tbb/concurrent_queue.h"
@@ -286,7 +291,8 @@ static void assign_hw_desc(msgdma_sw_desc_t *sw_desc,
 			msgdma_hw_descp_t *hw_descp,
 			bool set_owned_by_hw,
 			uint8_t block_size,
-			uint8_t format) {
+			uint8_t format,
+			bool irq_en) {
 	// MSGDMA dispatcher expects masked host memory addresses
 	if (sw_desc->transfer->transfer_type == HOST_MM_TO_FPGA_ST) {
 		hw_descp->hw_desc->src = sw_desc->transfer->src | 0x1000000000000;
@@ -328,6 +334,7 @@ static void assign_hw_desc(msgdma_sw_desc_t *sw_desc,
 		hw_descp->hw_desc->ctrl.generate_eop = 0;
 	}
 	hw_descp->hw_desc->ctrl.go = 1;
+	hw_descp->hw_desc->ctrl.transfer_irq_en = irq_en ? 1 : 0;
 	if (set_owned_by_hw)
 		hw_descp->hw_desc->owned_by_hw = 1;
 	else
@@ -340,34 +347,52 @@ static void assign_hw_desc(msgdma_sw_desc_t *sw_desc,
 	sw_desc->hw_descp = hw_descp;
 }
 
-static msgdma_sw_desc* init_sw_desc(fpga_dma_transfer_t transfer) {
+// Take a software descriptor from the channel's pool. The semaphore and
+// transfer copy are only created when the pool runs dry; descriptors are
+// returned with put_sw_desc() and freed when the channel is closed.
+static msgdma_sw_desc* get_sw_desc(fpga_dma_handle_t dma_h) {
 	msgdma_sw_desc_t *sw_desc = NULL;
-	sw_desc = (msgdma_sw_desc_t*)calloc((size_t)1, sizeof(msgdma_sw_desc_t));
-	if (!sw_desc)
-		return NULL;
 
-	if (sem_init(&sw_desc->tf_status, 1, TRANSFER_PENDING)) 
-		ON_ERR_GOTO(FPGA_EXCEPTION, out, "sem_init failed");
+	if (!dma_h->sw_desc_pool.try_pop(sw_desc)) {
+		sw_desc = (msgdma_sw_desc_t*)calloc((size_t)1, sizeof(msgdma_sw_desc_t));
+		if (!sw_desc)
+			return NULL;
 
-	sw_desc->transfer = (struct fpga_dma_transfer*)calloc((size_t)1, sizeof(struct fpga_dma_transfer));
-	if (!sw_desc->transfer)
-		ON_ERR_GOTO(FPGA_EXCEPTION, out, "sw_desc transfer alloc failed");
+		if (sem_init(&sw_desc->tf_status, 1, TRANSFER_PENDING)) 
+			ON_ERR_GOTO(FPGA_EXCEPTION, out, "sem_init failed");
 
- 	local_memcpy(sw_desc->transfer, transfer, sizeof(struct fpga_dma_transfer));
+		sw_desc->transfer = (struct fpga_dma_transfer*)calloc((size_t)1, sizeof(struct fpga_dma_transfer));
+		if (!sw_desc->transfer)
+			ON_ERR_GOTO(FPGA_EXCEPTION, out_sem, "sw_desc transfer alloc failed");
+	}
+
+	sw_desc->hw_descp = NULL;
 	sw_desc->kill_worker = false;
 	sw_desc->last = 0;
+	sw_desc->list = NULL;
+	sw_desc->next_seg = NULL;
 	return sw_desc;
 
+out_sem:
+	sem_destroy(&sw_desc->tf_status);
 out:
-	if (sw_desc) {
-		if (sw_desc->transfer)
-			free(sw_desc->transfer);
-		sem_destroy(&sw_desc->tf_status);
-		free(sw_desc);
-	}
+	free(sw_desc);
 	return NULL;
 }
 
+static void put_sw_desc(fpga_dma_handle_t dma_h, msgdma_sw_desc *sw_desc) {
+	dma_h->sw_desc_pool.push(sw_desc);
+}
+
+static msgdma_sw_desc* init_sw_desc(fpga_dma_handle_t dma_h, fpga_dma_transfer_t transfer) {
+	msgdma_sw_desc_t *sw_desc = get_sw_desc(dma_h);
+	if (!sw_desc)
+		return NULL;
+
+ 	local_memcpy(sw_desc->transfer, transfer, sizeof(struct fpga_dma_transfer));
+	return sw_desc;
+}
+
 static fpga_result destroy_sw_desc(msgdma_sw_desc *sw_desc) {
 	if (sem_destroy(&sw_desc->tf_status)) {
 		FPGA_DMA_ERR("sem destroy failed\n");
@@ -379,6 +404,128 @@ static fpga_result destroy_sw_desc(msgdma_sw_desc *sw_desc) {
 	return FPGA_OK;
 }
 
+// Wake the worker waiting on w, if it is asleep
+static void dma_notify(fpga_dma_waiter_t *w) {
+	__atomic_add_fetch(&w->seq, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&w->sleepers, __ATOMIC_SEQ_CST))
+		syscall(SYS_futex, &w->seq, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+// Wait until ready() holds for a condition that a producer signals with
+// dma_notify(). Adaptive modes spin, then yield, then sleep on the futex.
+// The sequence number is sampled before ready() is checked, so a notify
+// that races with going to sleep makes FUTEX_WAIT return immediately.
+template <typename Ready>
+static void dma_wait(fpga_dma_handle_t dma_h, fpga_dma_waiter_t *w, Ready ready) {
+	struct timespec timeout = { 0, FPGA_DMA_WAIT_SLEEP_MS * 1000000L };
+	uint32_t seq;
+	int i;
+
+	if (dma_h->wait_mode == DMA_WAIT_SPIN) {
+		while (!ready())
+			__builtin_ia32_pause();
+		return;
+	}
+
+	for (i = 0; i < FPGA_DMA_WAIT_SPINS; i++) {
+		if (ready())
+			return;
+		__builtin_ia32_pause();
+	}
+
+	for (i = 0; i < FPGA_DMA_WAIT_YIELDS; i++) {
+		if (ready())
+			return;
+		sched_yield();
+	}
+
+	while (1) {
+		seq = __atomic_load_n(&w->seq, __ATOMIC_SEQ_CST);
+		if (ready())
+			return;
+		__atomic_add_fetch(&w->sleepers, 1, __ATOMIC_SEQ_CST);
+		syscall(SYS_futex, &w->seq, FUTEX_WAIT_PRIVATE, seq, &timeout, NULL, 0);
+		__atomic_sub_fetch(&w->sleepers, 1, __ATOMIC_SEQ_CST);
+	}
+}
+
+// Clear the prefetcher interrupt (write 1 to clear)
+static fpga_result dma_irq_ack(fpga_dma_handle_t dma_h) {
+	msgdma_prefetcher_status_t pre_status;
+	pre_status.reg = 0;
+	pre_status.st.irq = 1;
+	return MMIOWrite64Blk(dma_h, PREFETCHER_STATUS(dma_h), (uint64_t)&pre_status.reg, sizeof(pre_status.reg));
+}
+
+// Wait for hardware to hand a descriptor back. The hardware cannot wake a
+// futex, so adaptive mode polls with an exponential backoff; interrupt
+// mode sleeps on the DMA interrupt, re-checking at least every
+// FPGA_DMA_IRQ_POLL_MS in case an interrupt was coalesced.
+static void dma_wait_hw(fpga_dma_handle_t dma_h, msgdma_hw_desc_t *hw_desc) {
+	struct timespec backoff = { 0, 1000 };
+	struct pollfd pfd;
+	uint64_t count;
+	int i;
+
+	for (i = 0; i < FPGA_DMA_WAIT_SPINS; i++) {
+		if (hw_desc->owned_by_hw == 0)
+			return;
+		__builtin_ia32_pause();
+	}
+
+	while (hw_desc->owned_by_hw == 1) {
+		switch (dma_h->wait_mode) {
+		case DMA_WAIT_SPIN:
+			__builtin_ia32_pause();
+			break;
+		case DMA_WAIT_INTERRUPT:
+			pfd.fd = dma_h->irq_fd;
+			pfd.events = POLLIN;
+			pfd.revents = 0;
+			if (poll(&pfd, 1, FPGA_DMA_IRQ_POLL_MS) > 0) {
+				if (read(dma_h->irq_fd, &count, sizeof(count)) < 0) {
+					debug_print("irq read failed: %s\n", strerror(errno));
+				}
+				dma_irq_ack(dma_h);
+			}
+			break;
+		default:
+			nanosleep(&backoff, NULL);
+			if (backoff.tv_nsec < FPGA_DMA_WAIT_MAX_BACKOFF_NS)
+				backoff.tv_nsec *= 2;
+			break;
+		}
+	}
+}
+
+// Enable or disable the prefetcher interrupt; fetching stays enabled
+static fpga_result dma_irq_enable(fpga_dma_handle_t dma_h, bool enable) {
+	msgdma_prefetcher_ctrl_t prefetcher_ctrl;
+	prefetcher_ctrl = {0};
+	prefetcher_ctrl.ct.timeout_val = 0xFF;
+	prefetcher_ctrl.ct.timeout_en = 1;
+	prefetcher_ctrl.ct.fetch_en = 1;
+	prefetcher_ctrl.ct.irq_mask = enable ? 1 : 0;
+	return MMIOWrite64Blk(dma_h, PREFETCHER_CTRL(dma_h), (uint64_t)&prefetcher_ctrl.reg, sizeof(prefetcher_ctrl.reg));
+}
+
+static fpga_result dma_irq_release(fpga_dma_handle_t dma_h) {
+	fpga_result res = FPGA_OK;
+	if (!dma_h->irq_event)
+		return FPGA_OK;
+
+	res = dma_irq_enable(dma_h, false);
+	if (res != FPGA_OK)
+		FPGA_DMA_ERR("disabling DMA interrupt");
+
+	if (fpgaUnregisterEvent(dma_h->fpga_h, FPGA_EVENT_INTERRUPT, dma_h->irq_event) != FPGA_OK)
+		FPGA_DMA_ERR("fpgaUnregisterEvent");
+	fpgaDestroyEventHandle(&dma_h->irq_event);
+	dma_h->irq_event = NULL;
+	dma_h->irq_fd = -1;
+	return res;
+}
+
 // debug utilities
 #if FPGA_DMA_DEBUG
 static void dump_hw_desc(int i, msgdma_hw_desc_t *desc)
@@ -406,27 +553,89 @@ static void dump_hw_desc(int i, msgdma_hw_desc_t *desc)
 }
 #endif
 
-static void dump_hw_desc_log(int i, msgdma_hw_desc_t *desc, ofstream &f)
-{
-	UNUSED(i);
-	UNUSED(desc);
-	UNUSED(f);
-#if FPGA_DMA_DEBUG
-	f << std::setw(10) << std::to_string(desc->format)
-	<< std::setw(10) << std::to_string(desc->block_size)
-	<< std::setw(10) << std::to_string(desc->owned_by_hw)
-	<< std::setw(20) << std::hex << desc->src
-	<< std::setw(20) << std::hex << desc->dst
-	<< std::setw(20) << std::hex << desc->len
-	<< std::setw(20) << std::hex << desc->next_desc << endl;
-#endif
+#ifdef FPGA_DMA_TRACE
+static const char *trace_event_name[] = { "dispatch", "pad", "complete" };
+
+// Record a descriptor event in the channel's trace ring. Writers claim a
+// slot with an atomic increment and publish it by storing its sequence
+// number, so the dispatcher and completion worker never wait on each
+// other and the oldest records are simply overwritten.
+static void dma_trace(fpga_dma_handle_t dma_h, msgdma_trace_event_t event, msgdma_hw_descp_t *hw_descp) {
+	msgdma_hw_desc_t *desc = hw_descp->hw_desc;
+	msgdma_trace_rec_t *rec;
+	uint64_t seq;
+
+	if (!dma_h->trace)
+		return;
+
+	seq = __atomic_fetch_add(&dma_h->trace_head, 1, __ATOMIC_RELAXED);
+	rec = &dma_h->trace[seq & (FPGA_DMA_TRACE_ENTRIES - 1)];
+	__atomic_store_n(&rec->seq, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	rec->tsc = __builtin_ia32_rdtsc();
+	rec->src = desc->src;
+	rec->dst = desc->dst;
+	rec->next_desc = desc->next_desc;
+	rec->len = desc->len;
+	rec->bytes_transferred = desc->bytes_transferred;
+	rec->block_id = hw_descp->hw_block_id;
+	rec->desc_id = hw_descp->hw_desc_id;
+	rec->event = event;
+	rec->format = desc->format;
+	rec->block_size = desc->block_size;
+	rec->owned_by_hw = desc->owned_by_hw;
+	rec->error = desc->error;
+
+	__atomic_store_n(&rec->seq, seq + 1, __ATOMIC_RELEASE);
 }
 
-// Dispatcher worker thread
-// Process transfers from ingress queue. For each transfer,
-// assign a hardware descriptor from a block
-// and populate transfer attributes. Transfer ownership
-// of the block to DMA engine when
+// Print the records still held in the trace ring, oldest first. Records
+// overwritten while they are being read are skipped.
+static void dma_trace_dump(fpga_dma_handle_t dma_h, FILE *f) {
+	msgdma_trace_rec_t rec;
+	uint64_t head, i;
+
+	if (!dma_h->trace)
+		return;
+
+	head = __atomic_load_n(&dma_h->trace_head, __ATOMIC_ACQUIRE);
+	i = head > FPGA_DMA_TRACE_ENTRIES ? head - FPGA_DMA_TRACE_ENTRIES : 0;
+
+	fprintf(f, "%20s %9s %6s %5s %6s %5s %6s %18s %18s %10s %10s %18s %5s\n",
+		"tsc", "event", "block", "desc", "format", "bsize", "own_hw",
+		"src", "dst", "len", "bytes", "next_desc", "error");
+	for (; i < head; i++) {
+		msgdma_trace_rec_t *slot = &dma_h->trace[i & (FPGA_DMA_TRACE_ENTRIES - 1)];
+		if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != i + 1)
+			continue;
+		memcpy(&rec, slot, sizeof(rec));
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != i + 1)
+			continue;
+
+		fprintf(f, "%20lu %9s %6u %5u %6u %5u %6u %18lx %18lx %10x %10x %18lx %5u\n",
+			rec.tsc, trace_event_name[rec.event], rec.block_id, rec.desc_id,
+			rec.format, rec.block_size, rec.owned_by_hw, rec.src, rec.dst,
+			rec.len, rec.bytes_transferred, rec.next_desc, rec.error);
+	}
+}
+#else
+#define dma_trace(dma_h, event, hw_descp)
+#define dma_trace_dump(dma_h, f)
+#endif
+
+// Block being packed by the dispatcher; sw_desc[1..desc_count] hold the
+// software descriptors assigned to it so far
+typedef struct {
+	msgdma_sw_desc_t *sw_desc[FPGA_DMA_BLOCK_SIZE+1];
+	msgdma_sw_desc_t *first_sw_desc;
+	uint64_t desc_count;
+} dispatch_block_t;
+
+// Assign a hardware descriptor in the current block to desc and populate
+// its transfer attributes. Transfer ownership of the block to DMA engine
+// when
 //  a) all descriptors in a block are full OR
 //  b) the block is partially full, but application marked
 //     the current buffer as the last.
@@ -434,110 +643,143 @@ static void dump_hw_desc_log(int i, msgdma_hw_desc_t *desc, ofstream &f)
 // that block are pushed to pending queue, where they await 
 // transfer completion. Invalid hardware descriptors
 // in a partially full block are not used.
-static void *dispatcherWorker(void* dma_handle) {
-	uint64_t desc_count = 1;
-	msgdma_sw_desc_t *sw_desc[FPGA_DMA_BLOCK_SIZE+1];
-	msgdma_sw_desc_t *first_sw_desc;
+static void dispatch_desc(fpga_dma_handle_t dma_h, dispatch_block_t *blk,
+			  msgdma_sw_desc_t *desc) {
+	uint64_t desc_count = blk->desc_count;
+	msgdma_sw_desc_t **sw_desc = blk->sw_desc;
 	msgdma_hw_descp_t *hw_descp;
 	bool is_owned_by_hw;
 	uint8_t block_size = 0;
 	uint8_t format;
 
+	sw_desc[desc_count] = desc;
+
+	// make a note of the first block descriptor
+	// mark it valid only after packing rest of the block
+	if (desc_count == 1)
+		blk->first_sw_desc = sw_desc[desc_count];
+	is_owned_by_hw = (desc_count == 1)  ? false:true;
+
+	// refer prefetcher spec
+	if (desc_count == 1) {
+		if (sw_desc[desc_count]->transfer->is_last_buf)
+			format = 0x3;
+		else
+			format = 0x1;
+	} else if (desc_count == FPGA_DMA_BLOCK_SIZE || sw_desc[desc_count]->transfer->is_last_buf)
+		format = 0x2;
+	else
+		format = 0x0;
+	
+	// assign a free hardware descriptor to this transfer
+	// if a free descriptor isn't available, wait here
+	dma_wait(dma_h, &dma_h->dispatcher_wait, [dma_h] { return !dma_h->free_desc.empty(); });
+	dma_h->free_desc.try_pop(hw_descp);
+
+	sw_desc[desc_count]->id = desc_count;
+	assign_hw_desc(sw_desc[desc_count], hw_descp, is_owned_by_hw, block_size, format,
+		dma_h->wait_mode == DMA_WAIT_INTERRUPT);
+
+	// ready to dispatch the block
+	if ((desc_count == FPGA_DMA_BLOCK_SIZE) /* we have a full block*/ ||
+		sw_desc[desc_count]->transfer->is_last_buf /*app. requested block dispatch for this transfer*/
+		) {
+
+		blk->first_sw_desc->hw_descp->hw_desc->block_size = desc_count - 1;
+		blk->first_sw_desc->hw_descp->hw_desc->owned_by_hw = 1;
+
+		// push valid descriptors to completion queue
+		uint64_t k;
+		for(k=1; k <= desc_count; k++) {
+			dma_trace(dma_h, TRACE_DISPATCH, sw_desc[k]->hw_descp);
+			if(k == desc_count)
+				sw_desc[k]->last = 1;
+			dma_h->pending_queue.push(sw_desc[k]);
+		}
+		dma_notify(&dma_h->completion_wait);
+
+		// Skip invalid descriptors
+		for(k=1; k<= (FPGA_DMA_BLOCK_SIZE-desc_count); k++) {
+			msgdma_hw_descp_t *unused_hw_descp;
+			dma_wait(dma_h, &dma_h->dispatcher_wait, [dma_h] { return !dma_h->free_desc.empty(); });
+			dma_h->free_desc.try_pop(unused_hw_descp);
+			dma_trace(dma_h, TRACE_PAD, unused_hw_descp);
+			dma_h->invalid_desc_queue.push(unused_hw_descp);
+		}
+
+		// reset descriptor count
+		blk->desc_count = 1;
+	} else
+		blk->desc_count++;
+}
+
+// Dispatcher worker thread
+// Process transfers from ingress queue. Each transfer takes one
+// hardware descriptor; a scatter-gather list takes one per segment,
+// packed straight from the list.
+static void *dispatcherWorker(void* dma_handle) {
+	dispatch_block_t blk;
+	msgdma_sw_desc_t *sw_desc;
+	msgdma_sw_desc_t *seg, *next_seg;
+
 	fpga_dma_handle_t dma_h = (fpga_dma_handle_t )dma_handle;
 	if(!dma_h) {
 		FPGA_DMA_ERR("Invalid DMA handle\n");
 		return NULL;
 	}
-
-	// open log file for debug
-	ofstream disp_log;
-	disp_log.open ("disp.log");
-
-	disp_log << std::setw(10) << "format"
-		<< std::setw(10) << "bsize"
-		<< std::setw(10) << "own_hw"
-		<< std::setw(20) << "src"
-		<< std::setw(20) << "dst"
-		<< std::setw(20) << "len"
-		<< std::setw(20) << "next_desc\n";
+	blk.desc_count = 1;
+	blk.first_sw_desc = NULL;
 
 	debug_print("started dispatcher worker\n");
 	while (1) {
 		// wait for a valid transfer
-		while(dma_h->ingress_queue.empty());
-		if (dma_h->ingress_queue.try_pop(sw_desc[desc_count])) {
-			if (sw_desc[desc_count]->kill_worker) {
-				disp_log.close();
-				dma_h->pending_queue.push(sw_desc[desc_count]);
+		dma_wait(dma_h, &dma_h->dispatcher_wait, [dma_h] { return !dma_h->ingress_queue.empty(); });
+		if (dma_h->ingress_queue.try_pop(sw_desc)) {
+			if (sw_desc->kill_worker) {
+				dma_h->pending_queue.push(sw_desc);
+				dma_notify(&dma_h->completion_wait);
 				debug_print("Killing worker\n");
 				break;
 			}
 
-			// make a note of the first block descriptor
-			// mark it valid only after packing rest of the block
-			if (desc_count == 1)
-				first_sw_desc = sw_desc[desc_count];
-			is_owned_by_hw = (desc_count == 1)  ? false:true;
-
-			// refer prefetcher spec
-			if (desc_count == 1) {
-				if (sw_desc[desc_count]->transfer->is_last_buf)
-					format = 0x3;
-				else
-					format = 0x1;
-			} else if (desc_count == FPGA_DMA_BLOCK_SIZE || sw_desc[desc_count]->transfer->is_last_buf)
-				format = 0x2;
-			else
-				format = 0x0;
-			
-			// assign a free hardware descriptor to this transfer
-			// if a free descriptor isn't available, wait here
-			while(dma_h->free_desc.empty());
-			dma_h->free_desc.try_pop(hw_descp);
-
-			sw_desc[desc_count]->id = desc_count;
-			assign_hw_desc(sw_desc[desc_count], hw_descp, is_owned_by_hw, block_size, format);
-
-			// ready to dispatch the block
-			if ((desc_count == FPGA_DMA_BLOCK_SIZE) /* we have a full block*/ ||
-				sw_desc[desc_count]->transfer->is_last_buf /*app. requested block dispatch for this transfer*/
-				) {
-
-				first_sw_desc->hw_descp->hw_desc->block_size = desc_count - 1;
-				first_sw_desc->hw_descp->hw_desc->owned_by_hw = 1;
-
-				// push valid descriptors to completion queue
-				uint64_t k;
-				for(k=1; k <= desc_count; k++) {
-					dump_hw_desc_log(0, sw_desc[k]->hw_descp->hw_desc, disp_log);
-					if(k == desc_count)
-						sw_desc[k]->last = 1;
-					dma_h->pending_queue.push(sw_desc[k]);
-				}
-
-				// Skip invalid descriptors
-				for(k=1; k<= (FPGA_DMA_BLOCK_SIZE-desc_count); k++) {
-					msgdma_hw_descp_t *unused_hw_descp;
-					while(dma_h->free_desc.empty());
-					dma_h->free_desc.try_pop(unused_hw_descp);
-					dump_hw_desc_log(0, unused_hw_descp->hw_desc, disp_log);
-					dma_h->invalid_desc_queue.push(unused_hw_descp);
-				}
+			if (!sw_desc->next_seg) {
+				dispatch_desc(dma_h, &blk, sw_desc);
+				continue;
+			}
 
-				// reset descriptor count
-				desc_count = 1;
-			} else
-				desc_count++;
+			// A segment may complete and be recycled as soon as its
+			// block is dispatched, so read the link first
+			for (seg = sw_desc->next_seg; seg; seg = next_seg) {
+				next_seg = seg->next_seg;
+				dispatch_desc(dma_h, &blk, seg);
+			}
 		}
 	}
 
 	return dma_h;
 }
 
+// Signal completion of a transfer or scatter-gather list: invoke its
+// callback and recycle it, or wake the caller blocked on it
+static void complete_sw_desc(fpga_dma_handle_t dma_h, msgdma_sw_desc_t *sw_desc) {
+	if (sw_desc->transfer->cb) {
+		fpga_dma_transfer_status_t status;
+		status.eop_arrived = sw_desc->transfer->eop_arrived;
+		status.bytes_transferred = sw_desc->transfer->bytes_transferred;
+		sw_desc->transfer->cb(sw_desc->transfer->context, status);
+		put_sw_desc(dma_h, sw_desc);
+	} else {
+		// mark transfer complete
+		sem_post(&sw_desc->tf_status);
+	}
+}
+
 // Completion worker thread
 // Poll descriptors in pending queue. When the descriptor is marked 
 // complete in hw, return the hardware descriptor to free pool and invoke
-// callback associated with the corresponding buffer transfer
+// callback associated with the corresponding buffer transfer. Segments of
+// a scatter-gather list are accumulated into the list, which completes
+// once with its last segment.
 static void *completionWorker(void* dma_handle) {
 	fpga_dma_handle_t dma_h = (fpga_dma_handle_t )dma_handle;
 	uint64_t i;
@@ -546,15 +788,30 @@ static void *completionWorker(void* dma_handle) {
 		return NULL;
 	}
 	msgdma_sw_desc_t *sw_desc;
+	msgdma_sw_desc_t *list;
+	msgdma_hw_desc_t *hw_desc;
+	bool list_end;
 
 	debug_print("started completion worker\n");
 	while (1) {
-		while(dma_h->pending_queue.empty());
+		dma_wait(dma_h, &dma_h->completion_wait, [dma_h] { return !dma_h->pending_queue.empty(); });
 		if (dma_h->pending_queue.try_pop(sw_desc)) {
-			if (sw_desc->kill_worker)
+			if (sw_desc->kill_worker) {
+				put_sw_desc(dma_h, sw_desc);
 				break;
-			while(sw_desc->hw_descp->hw_desc->owned_by_hw == 1);
-			sw_desc->hw_descp->hw_desc->owned_by_hw = 0;
+			}
+			hw_desc = sw_desc->hw_descp->hw_desc;
+			dma_wait_hw(dma_h, hw_desc);
+			dma_trace(dma_h, TRACE_COMPLETE, sw_desc->hw_descp);
+			if (hw_desc->error) {
+				FPGA_DMA_ERR("descriptor completed with error");
+				dma_trace_dump(dma_h, stderr);
+			}
+
+			// latch the status before the descriptor is reused
+			sw_desc->transfer->eop_arrived = hw_desc->eop_arrived;
+			sw_desc->transfer->bytes_transferred = hw_desc->bytes_transferred;
+			hw_desc->owned_by_hw = 0;
 
 			// return hw_descp to free pool
 			dma_h->free_desc.push(sw_desc->hw_descp);
@@ -566,16 +823,20 @@ static void *completionWorker(void* dma_handle) {
 					dma_h->free_desc.push(unused_hw_descp);
 				}
 			}
-
-			if (sw_desc->transfer->cb) {
-				fpga_dma_transfer_status_t status;
-				status.eop_arrived = sw_desc->hw_descp->hw_desc->eop_arrived;
-				status.bytes_transferred = sw_desc->hw_descp->hw_desc->bytes_transferred;
-				sw_desc->transfer->cb(sw_desc->transfer->context, status);
-				destroy_sw_desc(sw_desc);
+			dma_notify(&dma_h->dispatcher_wait);
+
+			if (sw_desc->list) {
+				list = sw_desc->list;
+				list_end = !sw_desc->next_seg;
+				list->transfer->bytes_transferred += sw_desc->transfer->bytes_transferred;
+				if (sw_desc->transfer->eop_arrived)
+					list->transfer->eop_arrived = true;
+				put_sw_desc(dma_h, sw_desc);
+				if (!list_end)
+					continue;
+				sw_desc = list;
 			}
-			// mark transfer complete
-			sem_post(&sw_desc->tf_status);
+			complete_sw_desc(dma_h, sw_desc);
 		}
 	}
 	return dma_h;
@@ -848,6 +1109,20 @@ fpga_result fpgaDMAOpen(fpga_handle fpga, uint64_t dma_channel_index, fpga_dma_h
 		nxt->next = chan;
 	}
 
+	dma_h->wait_mode = DMA_WAIT_ADAPTIVE;
+	dma_h->irq_event = NULL;
+	dma_h->irq_fd = -1;
+
+#ifdef FPGA_DMA_TRACE
+	dma_h->trace = NULL;
+	dma_h->trace_head = 0;
+	if (getenv("FPGA_DMA_TRACE")) {
+		dma_h->trace = (msgdma_trace_rec_t*)calloc(FPGA_DMA_TRACE_ENTRIES, sizeof(msgdma_trace_rec_t));
+		if (!dma_h->trace)
+			ON_ERR_GOTO(FPGA_NO_MEMORY, rel_buf, "allocating trace ring");
+	}
+#endif
+
 	// Start worker threads
 	if (pthread_create(&dma_h->ingress_id, NULL, dispatcherWorker, (void*)dma_h) != 0) {
 		res = FPGA_EXCEPTION;
@@ -858,17 +1133,31 @@ fpga_result fpgaDMAOpen(fpga_handle fpga, uint64_t dma_channel_index, fpga_dma_h
 		// send a dummy transfer to kill dispatcher
 		void *th_retval;
 		res = fpgaDMATransferInit(&dummy_transfer);
-		ON_ERR_GOTO(FPGA_NO_MEMORY, rel_buf, "allocating dummy transfer");
+		ON_ERR_GOTO(res, rel_buf, "allocating dummy transfer");
 
-		static msgdma_sw_desc* sw_desc = init_sw_desc(dummy_transfer);
-		if(!sw_desc)
-			ON_ERR_GOTO(FPGA_NO_MEMORY, rel_buf, "init sw desc");
+		msgdma_sw_desc* sw_desc = init_sw_desc(dma_h, dummy_transfer);
+		if(!sw_desc) {
+			res = FPGA_NO_MEMORY;
+			ON_ERR_GOTO(res, rel_buf, "init sw desc");
+		}
 		sw_desc->kill_worker = true;
 		dma_h->ingress_queue.push(sw_desc);
+		dma_notify(&dma_h->dispatcher_wait);
 
 		// wait workers to die
 		if (pthread_join(dma_h->ingress_id, &th_retval))
 			ON_ERR_GOTO(FPGA_EXCEPTION, rel_buf, "pthread_join for dispatcher");
+
+		// the dispatcher handed the kill descriptor on to the
+		// completion queue, which has no worker to recycle it
+		msgdma_sw_desc *pooled;
+		while (dma_h->pending_queue.try_pop(pooled))
+			destroy_sw_desc(pooled);
+		while (dma_h->sw_desc_pool.try_pop(pooled))
+			destroy_sw_desc(pooled);
+
+		res = FPGA_EXCEPTION;
+		ON_ERR_GOTO(res, rel_buf, "pthread_create completionWorker");
 	}
 
 	pthread_mutex_destroy(&dma_h->dma_mutex);
@@ -884,13 +1173,19 @@ rel_buf:
 		free(dummy_transfer);
 	}
 	for(i=0; i< FPGA_DMA_MAX_BLOCKS; i++) {
-		res = fpgaReleaseBuffer(dma_h->fpga_h, dma_h->block_mem[i].block_wsid);
-		ON_ERR_GOTO(res, out, "fpgaReleaseBuffer");
+		// keep res: it is the reason we are unwinding
+		fpga_result rel_res = fpgaReleaseBuffer(dma_h->fpga_h, dma_h->block_mem[i].block_wsid);
+		ON_ERR_GOTO(rel_res, out, "fpgaReleaseBuffer");
 	}
 out:
 	if (dma_h->block_mem)
 		free(dma_h->block_mem);
 
+#ifdef FPGA_DMA_TRACE
+	free(dma_h->trace);
+	dma_h->trace = NULL;
+#endif
+
 	if (!dma_found) {
 		delete dma_h;
 		res = FPGA_NOT_FOUND;
@@ -949,7 +1244,8 @@ fpga_result fpgaDMAClose(fpga_dma_handle_t dma_h) {
 	// send a dummy transfer to kill worker threads
 	fpga_dma_transfer_t dummy_transfer;
 	fpgaDMATransferInit(&dummy_transfer);
-	static msgdma_sw_desc* sw_desc = init_sw_desc(dummy_transfer);
+	msgdma_sw_desc* sw_desc;
+	sw_desc = init_sw_desc(dma_h, dummy_transfer);
 	if(!sw_desc) {
 		//TODO: kill dummy transfer?
 		fpgaDMATransferDestroy(&dummy_transfer);
@@ -958,6 +1254,7 @@ fpga_result fpgaDMAClose(fpga_dma_handle_t dma_h) {
 	}
 	sw_desc->kill_worker = true;
 	dma_h->ingress_queue.push(sw_desc);
+	dma_notify(&dma_h->dispatcher_wait);
 
 	// wait workers to die
 	if (pthread_join(dma_h->ingress_id, &th_retval)) {
@@ -969,6 +1266,13 @@ fpga_result fpgaDMAClose(fpga_dma_handle_t dma_h) {
 	}
 	fpgaDMATransferDestroy(&dummy_transfer);
 
+	// free recycled software descriptors
+	msgdma_sw_desc *pooled;
+	while (dma_h->sw_desc_pool.try_pop(pooled))
+		destroy_sw_desc(pooled);
+
+	dma_irq_release(dma_h);
+
 	// stop dispatcher
 	msgdma_ctrl_t ctrl;
 	ctrl = {0};
@@ -1012,7 +1316,10 @@ fpga_result fpgaDMAClose(fpga_dma_handle_t dma_h) {
 out:
 	// Make sure double-close fails
 	dma_h->dma_channel = INVALID_CHANNEL;
-	free((void*)dma_h);
+#ifdef FPGA_DMA_TRACE
+	free(dma_h->trace);
+#endif
+	delete dma_h;
 	return res;
 }
 
@@ -1031,6 +1338,66 @@ fpga_result fpgaGetDMAChannelType(fpga_dma_handle_t dma, fpga_dma_channel_type_t
 	return FPGA_OK;
 }
 
+fpga_result fpgaDMASetWaitMode(fpga_dma_handle_t dma, fpga_dma_wait_mode_t mode, uint32_t irq_vector) {
+	fpga_result res = FPGA_OK;
+	if (!dma) {
+		FPGA_DMA_ERR("Invalid DMA handle");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if (mode >= FPGA_MAX_WAIT_MODE) {
+		FPGA_DMA_ERR("Invalid wait mode");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if (mode == DMA_WAIT_INTERRUPT && !dma->irq_event) {
+		res = fpgaCreateEventHandle(&dma->irq_event);
+		ON_ERR_GOTO(res, out, "fpgaCreateEventHandle");
+
+		res = fpgaRegisterEvent(dma->fpga_h, FPGA_EVENT_INTERRUPT, dma->irq_event, irq_vector);
+		ON_ERR_GOTO(res, out_destroy, "fpgaRegisterEvent");
+
+		res = fpgaGetOSObjectFromEventHandle(dma->irq_event, &dma->irq_fd);
+		ON_ERR_GOTO(res, out_unregister, "fpgaGetOSObjectFromEventHandle");
+
+		res = dma_irq_enable(dma, true);
+		ON_ERR_GOTO(res, out_unregister, "enabling DMA interrupt");
+	} else if (mode != DMA_WAIT_INTERRUPT) {
+		res = dma_irq_release(dma);
+	}
+
+	dma->wait_mode = mode;
+
+	// let sleeping workers pick up the new mode
+	dma_notify(&dma->dispatcher_wait);
+	dma_notify(&dma->completion_wait);
+	return res;
+
+out_unregister:
+	fpgaUnregisterEvent(dma->fpga_h, FPGA_EVENT_INTERRUPT, dma->irq_event);
+out_destroy:
+	fpgaDestroyEventHandle(&dma->irq_event);
+	dma->irq_event = NULL;
+	dma->irq_fd = -1;
+out:
+	return res;
+}
+
+fpga_result fpgaDMAGetWaitMode(fpga_dma_handle_t dma, fpga_dma_wait_mode_t *mode) {
+	if (!dma) {
+		FPGA_DMA_ERR("Invalid DMA handle");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if (!mode) {
+		FPGA_DMA_ERR("Invalid pointer to wait mode");
+		return FPGA_INVALID_PARAM;
+	}
+
+	*mode = dma->wait_mode;
+	return FPGA_OK;
+}
+
 fpga_result fpgaDMATransferInit(fpga_dma_transfer_t *transfer_p) {
 	fpga_result res = FPGA_OK;
 	fpga_dma_transfer_t tmp;
@@ -1337,73 +1704,190 @@ fpga_result fpgaDMATransferCheckEopArrived(fpga_dma_transfer_t transfer, bool *e
 	return FPGA_OK;
 }
 
-fpga_result fpgaDMATransfer(fpga_dma_handle_t dma, fpga_dma_transfer_t transfer) {
-	if (!dma) {
-		FPGA_DMA_ERR("Invalid DMA handle");
-		return FPGA_INVALID_PARAM;
-	}
-
-	if (!transfer) {
-		FPGA_DMA_ERR("Invalid DMA transfer");
-		return FPGA_INVALID_PARAM;
-	}
-
-	if (!(transfer->transfer_type == HOST_MM_TO_FPGA_ST ||
-		transfer->transfer_type == FPGA_ST_TO_HOST_MM ||
-		transfer->transfer_type == HOST_MM_TO_FPGA_MM ||
-		transfer->transfer_type == FPGA_MM_TO_HOST_MM)) {
+// Check that a transfer, or one segment of a scatter-gather list, can be
+// carried out on the channel
+static fpga_result check_transfer(fpga_dma_handle_t dma, fpga_dma_transfer_type_t type,
+				  fpga_dma_tx_ctrl_t tx_ctrl, fpga_dma_rx_ctrl_t rx_ctrl,
+				  uint64_t len) {
+	if (!(type == HOST_MM_TO_FPGA_ST ||
+		type == FPGA_ST_TO_HOST_MM ||
+		type == HOST_MM_TO_FPGA_MM ||
+		type == FPGA_MM_TO_HOST_MM)) {
 		FPGA_DMA_ERR("Transfer unsupported");
 		return FPGA_NOT_SUPPORTED;
 	}
 
 	if (dma->ch_type == MM &&
-		(transfer->transfer_type != HOST_MM_TO_FPGA_MM &&
-		transfer->transfer_type != FPGA_MM_TO_HOST_MM)) {
+		(type != HOST_MM_TO_FPGA_MM &&
+		type != FPGA_MM_TO_HOST_MM)) {
 		FPGA_DMA_ERR("Incompatible transfer on memory-to-memory channel");
 		return FPGA_INVALID_PARAM;
 	}
 
-	if (dma->ch_type == RX_ST && transfer->transfer_type == HOST_MM_TO_FPGA_ST) {
+	if (dma->ch_type == RX_ST && type == HOST_MM_TO_FPGA_ST) {
 		FPGA_DMA_ERR("Incompatible transfer on stream to memory channel");
 		return FPGA_INVALID_PARAM;
 	}
 
-	if (dma->ch_type == TX_ST && transfer->transfer_type == FPGA_ST_TO_HOST_MM) {
+	if (dma->ch_type == TX_ST && type == FPGA_ST_TO_HOST_MM) {
 		FPGA_DMA_ERR("Incompatible transfer on memory to stream channel");
 		return FPGA_INVALID_PARAM;
 	}
 
 	// Avalon ST does not allow signalling of partial data for non-packet transfers (transfers without SOP/EOP).
-	if (((transfer->tx_ctrl == TX_NO_PACKET && dma->ch_type == TX_ST) || 
-		(transfer->rx_ctrl == RX_NO_PACKET && dma->ch_type == RX_ST)) && ((transfer->len % 64) != 0)) {
+	if (((tx_ctrl == TX_NO_PACKET && dma->ch_type == TX_ST) || 
+		(rx_ctrl == RX_NO_PACKET && dma->ch_type == RX_ST)) && ((len % 64) != 0)) {
 		FPGA_DMA_ERR("Incompatible transfer length for transfer type NO_PKT");
 		return FPGA_INVALID_PARAM;
 	}
 	// Partial data transfer is not permitted for MM TO MM transfers
-	if ((dma->ch_type == MM ) && (transfer->len % 64) != 0) {
+	if ((dma->ch_type == MM ) && (len % 64) != 0) {
                 FPGA_DMA_ERR("Incompatible transfer length for MM to MM transfers");
                 return FPGA_INVALID_PARAM;
         }
 
+	return FPGA_OK;
+}
+
+fpga_result fpgaDMATransfer(fpga_dma_handle_t dma, fpga_dma_transfer_t transfer) {
+	fpga_result res;
+
+	if (!dma) {
+		FPGA_DMA_ERR("Invalid DMA handle");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if (!transfer) {
+		FPGA_DMA_ERR("Invalid DMA transfer");
+		return FPGA_INVALID_PARAM;
+	}
+
+	res = check_transfer(dma, transfer->transfer_type, transfer->tx_ctrl,
+			     transfer->rx_ctrl, transfer->len);
+	if (res != FPGA_OK)
+		return res;
+
 	// create a copy of the buffer and enqueue to ingress queue
-	msgdma_sw_desc *sw_desc = init_sw_desc(transfer);
+	msgdma_sw_desc *sw_desc = init_sw_desc(dma, transfer);
 	if (!sw_desc)
 		return FPGA_EXCEPTION;
 	dma->ingress_queue.push(sw_desc);
+	dma_notify(&dma->dispatcher_wait);
 
 	// Blocking transfer
-	if (!sw_desc->transfer->cb) {
+	if (!transfer->cb) {
 		sem_wait(&sw_desc->tf_status);
 		// copy over EOP and transferred bytes
-		transfer->eop_arrived = sw_desc->hw_descp->hw_desc->eop_arrived;
-		transfer->bytes_transferred = sw_desc->hw_descp->hw_desc->bytes_transferred;
-		return destroy_sw_desc(sw_desc);
+		transfer->eop_arrived = sw_desc->transfer->eop_arrived;
+		transfer->bytes_transferred = sw_desc->transfer->bytes_transferred;
+		put_sw_desc(dma, sw_desc);
 	}
-	if (sem_destroy(&sw_desc->tf_status)) {
-		FPGA_DMA_ERR("sem destroy failed\n");
+	return FPGA_OK;
+}
+
+fpga_result fpgaDMATransferSG(fpga_dma_handle_t dma, fpga_dma_transfer_t transfer,
+			      const fpga_dma_sg_entry_t *sg, size_t count) {
+	msgdma_sw_desc_t *head;
+	msgdma_sw_desc_t *seg;
+	msgdma_sw_desc_t **tail;
+	fpga_result res;
+	size_t i;
+
+	if (!dma) {
+		FPGA_DMA_ERR("Invalid DMA handle");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if (!transfer) {
+		FPGA_DMA_ERR("Invalid DMA transfer");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if (!sg || !count) {
+		FPGA_DMA_ERR("Invalid scatter-gather list");
+		return FPGA_INVALID_PARAM;
+	}
+
+	for (i = 0; i < count; i++) {
+		res = check_transfer(dma, transfer->transfer_type, sg[i].tx_ctrl,
+				     transfer->rx_ctrl, sg[i].len);
+		if (res != FPGA_OK)
+			return res;
+	}
+
+	// the head carries the callback and collects the status of the list
+	head = init_sw_desc(dma, transfer);
+	if (!head)
+		return FPGA_NO_MEMORY;
+	head->transfer->eop_arrived = false;
+	head->transfer->bytes_transferred = 0;
+
+	tail = &head->next_seg;
+	for (i = 0; i < count; i++) {
+		seg = get_sw_desc(dma);
+		if (!seg) {
+			res = FPGA_NO_MEMORY;
+			ON_ERR_GOTO(res, out_release, "allocating segment descriptor");
+		}
+		seg->transfer->transfer_type = transfer->transfer_type;
+		seg->transfer->rx_ctrl = transfer->rx_ctrl;
+		seg->transfer->tx_ctrl = sg[i].tx_ctrl;
+		seg->transfer->src = sg[i].src;
+		seg->transfer->dst = sg[i].dst;
+		seg->transfer->len = sg[i].len;
+		seg->transfer->cb = NULL;
+		seg->transfer->is_last_buf = (i == count - 1) && transfer->is_last_buf;
+		seg->list = head;
+		*tail = seg;
+		tail = &seg->next_seg;
+	}
+
+	dma->ingress_queue.push(head);
+	dma_notify(&dma->dispatcher_wait);
+
+	// Blocking transfer
+	if (!transfer->cb) {
+		sem_wait(&head->tf_status);
+		transfer->eop_arrived = head->transfer->eop_arrived;
+		transfer->bytes_transferred = head->transfer->bytes_transferred;
+		put_sw_desc(dma, head);
+	}
+	return FPGA_OK;
+
+out_release:
+	for (seg = head->next_seg; seg; seg = head->next_seg) {
+		head->next_seg = seg->next_seg;
+		put_sw_desc(dma, seg);
+	}
+	put_sw_desc(dma, head);
+	return res;
+}
+
+fpga_result fpgaDMATraceDump(fpga_dma_handle_t dma, const char *filename) {
+	if (!dma) {
+		FPGA_DMA_ERR("Invalid DMA handle");
+		return FPGA_INVALID_PARAM;
+	}
+
+#ifdef FPGA_DMA_TRACE
+	FILE *f;
+
+	if (!dma->trace)
+		return FPGA_NOT_SUPPORTED;
+
+	f = filename ? fopen(filename, "w") : stderr;
+	if (!f) {
+		FPGA_DMA_ERR("Unable to open trace file");
 		return FPGA_EXCEPTION;
 	}
+	dma_trace_dump(dma, f);
+	if (filename)
+		fclose(f);
 	return FPGA_OK;
+#else
+	UNUSED(filename);
+	return FPGA_NOT_SUPPORTED;
+#endif
 }
 
 fpga_result fpgaDMAInvalidate(fpga_dma_handle_t dma) {
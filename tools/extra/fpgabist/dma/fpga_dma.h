@@ -93,6 +93,42 @@ fpga_result fpgaDMAClose(fpga_dma_handle_t dma);
 */
 fpga_result fpgaGetDMAChannelType(fpga_dma_handle_t dma, fpga_dma_channel_type_t *ch_type);
 
+/**
+* fpgaDMASetWaitMode
+*
+* @brief                  Select how the channel's worker threads wait
+*
+*                         DMA_WAIT_SPIN busy-polls the work queues and the
+*                         hardware descriptors (one core per worker thread,
+*                         even when idle). DMA_WAIT_ADAPTIVE (the default)
+*                         spins briefly, then yields, then sleeps until work
+*                         is queued; hardware completions are polled with a
+*                         bounded backoff. DMA_WAIT_INTERRUPT behaves like
+*                         DMA_WAIT_ADAPTIVE, but waits for completions on
+*                         the DMA interrupt.
+*
+*                         Must be called while no transfers are outstanding
+*                         on the channel.
+*
+* @param[in]  dma         DMA channel handle
+* @param[in]  mode        Wait strategy
+* @param[in]  irq_vector  User interrupt vector of the channel; only used
+*                         for DMA_WAIT_INTERRUPT
+* @returns                FPGA_OK on success, return code otherwise
+*/
+fpga_result fpgaDMASetWaitMode(fpga_dma_handle_t dma, fpga_dma_wait_mode_t mode, uint32_t irq_vector);
+
+/**
+* fpgaDMAGetWaitMode
+*
+* @brief                  Query the channel's wait strategy
+*
+* @param[in]  dma         DMA channel handle
+* @param[out] mode        Pointer to wait strategy
+* @returns                FPGA_OK on success, return code otherwise
+*/
+fpga_result fpgaDMAGetWaitMode(fpga_dma_handle_t dma, fpga_dma_wait_mode_t *mode);
+
 /**
 * fpgaDMATransferInit
 *
@@ -316,6 +352,56 @@ fpga_result fpgaDMATransferSetLast(fpga_dma_transfer_t transfer, bool is_last_bu
 */
 fpga_result fpgaDMATransfer(fpga_dma_handle_t dma, const fpga_dma_transfer_t transfer);
 
+/**
+* fpgaDMATransferSG
+*
+* @brief                  Perform a scatter-gather DMA transfer
+*
+*                         Submits count segments as one list. Transfer type,
+*                         RX control, callback and the last-buffer flag are
+*                         taken from transfer; source, destination, length and
+*                         TX control from each segment. Every segment takes one
+*                         hardware descriptor, and the last-buffer flag applies
+*                         to the final segment.
+*
+*                         Completion is signalled once for the whole list. The
+*                         callback, if set, receives the total bytes transferred
+*                         and whether any segment saw EOP; without a callback
+*                         the call blocks and stores both in transfer.
+*
+*                         The segment array is not referenced after the call
+*                         returns.
+*
+* @param[dma] dma         DMA handle
+* @param[in]  transfer    Transfer attribute object for the list
+* @param[in]  sg          Array of segments
+* @param[in]  count       Number of segments in sg
+*
+* @returns                FPGA_OK on success, return code otherwise
+*/
+fpga_result fpgaDMATransferSG(fpga_dma_handle_t dma, fpga_dma_transfer_t transfer,
+			      const fpga_dma_sg_entry_t *sg, size_t count);
+
+/**
+* fpgaDMATraceDump
+*
+* @brief                  Write the channel's descriptor trace
+*
+*                         Prints the most recent descriptor dispatch, padding
+*                         and completion events, oldest first. The trace is
+*                         only available when the library is built with
+*                         FPGA_DMA_TRACE and the FPGA_DMA_TRACE environment
+*                         variable is set when the channel is opened. It is
+*                         also printed to stderr when a descriptor completes
+*                         with an error.
+*
+* @param[dma] dma         DMA handle
+* @param[in]  filename    File to write, or NULL for stderr
+*
+* @returns                FPGA_OK on success, FPGA_NOT_SUPPORTED if tracing
+*                         is not enabled, return code otherwise
+*/
+fpga_result fpgaDMATraceDump(fpga_dma_handle_t dma, const char *filename);
 
 /**
 * fpgaDMAInvalidate
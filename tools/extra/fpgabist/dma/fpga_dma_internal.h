@@ -39,7 +39,6 @@
 #include "tbb/concurrent_queue.h"
 #include "x86-sse2.h"
 #include <iostream>
-#include <fstream>
 
 
 using namespace std;
@@ -119,6 +118,21 @@ using namespace tbb;
 
 #define HOST_MEM_MASK(dma_h) (dma_h->ch_type == MM ? 0x1000000000000 : 0x0)
 
+// Adaptive wait: pause iterations and sched_yield() calls before sleeping
+#define FPGA_DMA_WAIT_SPINS 4096
+#define FPGA_DMA_WAIT_YIELDS 64
+// Upper bound of a futex sleep, as a guard against lost wakeups
+#define FPGA_DMA_WAIT_SLEEP_MS 100
+// Longest backoff when polling a hardware descriptor
+#define FPGA_DMA_WAIT_MAX_BACKOFF_NS 64000
+// Interrupt wait timeout, after which the descriptor is polled again
+#define FPGA_DMA_IRQ_POLL_MS 1
+
+// Records kept by the descriptor trace ring; must be a power of two.
+// The ring is built in with FPGA_DMA_TRACE and allocated only when the
+// FPGA_DMA_TRACE environment variable is set when a channel is opened.
+#define FPGA_DMA_TRACE_ENTRIES 4096
+
 // Convenience macros
 #ifdef FPGA_DMA_DEBUG
 #define debug_print(fmt, ...) \
@@ -145,6 +159,32 @@ typedef enum {
 	TRANSFER_COMPLETE = 1
 } fpga_transf_status_t;
 
+// Descriptor trace events
+typedef enum {
+	TRACE_DISPATCH = 0, // descriptor handed to hardware
+	TRACE_PAD,          // unused descriptor skipped in a partial block
+	TRACE_COMPLETE      // descriptor returned by hardware
+} msgdma_trace_event_t;
+
+// Descriptor trace record. seq is written last: it holds the record's
+// position in the trace plus one once the record is complete.
+typedef struct {
+	uint64_t seq;
+	uint64_t tsc;
+	uint64_t src;
+	uint64_t dst;
+	uint64_t next_desc;
+	uint32_t len;
+	uint32_t bytes_transferred;
+	uint16_t block_id;
+	uint8_t desc_id;
+	uint8_t event;
+	uint8_t format;
+	uint8_t block_size;
+	uint8_t owned_by_hw;
+	uint8_t error;
+} msgdma_trace_rec_t;
+
 // DFH Features
 typedef struct __attribute__ ((__packed__)) {
 	uint64_t dfh;
@@ -316,6 +356,12 @@ struct fpga_dma_transfer {
 	bool is_last_buf;
 };
 
+// Wakeup channel for a worker thread; seq is the futex word
+typedef struct {
+	volatile uint32_t seq;
+	volatile uint32_t sleepers;
+} fpga_dma_waiter_t;
+
 // Pointer to hardware descriptor, with additional metadata for use by driver
 typedef struct msgdma_hw_descp {
 	//metadata for debug
@@ -332,6 +378,10 @@ typedef struct msgdma_sw_desc {
 	sem_t tf_status; // When locked, the transfer in progress
 	bool kill_worker;
 	uint64_t last;
+	// Scatter-gather lists: the head descriptor carries the list's
+	// attributes and completion; segments point back at it
+	struct msgdma_sw_desc *list; // head of the list this segment belongs to
+	struct msgdma_sw_desc *next_seg; // next segment; NULL ends the list
 } msgdma_sw_desc_t;
 
 // DMA handle
@@ -351,6 +401,8 @@ struct fpga_dma_handle {
 	concurrent_queue<struct msgdma_sw_desc*> pending_queue;	
 	concurrent_queue<struct msgdma_hw_descp*> free_desc;
 	concurrent_queue<struct msgdma_hw_descp*> invalid_desc_queue;
+	// recycled software descriptors
+	concurrent_queue<struct msgdma_sw_desc*> sw_desc_pool;
 	// channel type
 	fpga_dma_channel_type_t ch_type;
         #define INVALID_CHANNEL (0x7fffffffffffffffULL)
@@ -361,6 +413,17 @@ struct fpga_dma_handle {
 	sem_t dma_init;
 	volatile bool invalidate;
 	volatile bool terminate;
+	// worker wait strategy
+	volatile fpga_dma_wait_mode_t wait_mode;
+	fpga_dma_waiter_t dispatcher_wait; // ingress_queue and free_desc
+	fpga_dma_waiter_t completion_wait; // pending_queue
+	fpga_event_handle irq_event;
+	int irq_fd;
+#ifdef FPGA_DMA_TRACE
+	// descriptor trace ring; NULL unless enabled at open
+	msgdma_trace_rec_t *trace;
+	uint64_t trace_head;
+#endif
 };
 
 // Prefetcher ctrl register
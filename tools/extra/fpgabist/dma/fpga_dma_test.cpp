@@ -56,7 +56,7 @@ static void printUsage()
 "     fpga_dma_test [-h] [-B <bus>] [-D <device>] [-F <function>] [-S <segment>]\n"
 "                   -l <loopback on/off> -s <data size (bytes)> -p <payload size (bytes)>\n"
 "                   -r <transfer direction> -t <transfer type> [-f <decimation factor>]\n"
-"                   -a <FPGA local memory address>\n\n"
+"                   -a <FPGA local memory address> [-w <wait mode>] [-i <irq vector>] [-b] [-g]\n\n"
 "         -h,--help           Print this help\n"
 "         -v,--version        Print version and exit\n"
 "         -B,--bus            Set target bus number\n"
@@ -77,8 +77,16 @@ static void printUsage()
 "            fixed            Deterministic length transfer\n"
 "            packet           Packet transfer\n"
 "         -f,--decim_factor  Optional decimation factor\n\n"
+"         -w,--wait_mode      How DMA workers wait for work and completions\n"
+"            spin             Busy-poll (lowest latency, one core per worker)\n"
+"            adaptive         Spin, then yield, then sleep (default)\n"
+"            interrupt        Sleep on the DMA interrupt (requires -i)\n"
+"         -i,--irq            DMA interrupt vector used by interrupt wait mode\n"
+"         -g,--sg             Submit the data as one scatter-gather list of payload-sized\n"
+"                             segments instead of one transfer per payload (loopback off only)\n\n"
 "         Below options are only valid when -r/--direction is set to mtom:\n\n"
-"         -a,--fpga_addr      Address in FPGA local memory (hex format)\n\n"
+"         -a,--fpga_addr      Address in FPGA local memory (hex format)\n"
+"         -b,--bench          Report throughput, latency and CPU use for each wait mode\n\n"
 );
 
 	exit(1);
@@ -105,13 +113,17 @@ static void parse_args(struct config *config, int argc, char *argv[])
 			{"loopback", required_argument, 0, 'l'},
 			{"decim_factor", required_argument, 0, 'f'},
 			{"fpga_addr", required_argument, 0, 'a'},
+			{"wait_mode", required_argument, 0, 'w'},
+			{"irq", required_argument, 0, 'i'},
+			{"bench", no_argument, 0, 'b'},
+			{"sg", no_argument, 0, 'g'},
       {"version", no_argument, 0, 'v'},
 			{0, 0, 0, 0}
 		};
 		char *endptr;
 		const char *tmp_optarg;
 
-		c = getopt_long(argc, argv, "hB:D:F:S:s:p:r:l:f:t:a:v", options, NULL);
+		c = getopt_long(argc, argv, "hB:D:F:S:s:p:r:l:f:t:a:w:i:bgv", options, NULL);
 		if (c == -1) {
 			break;
 		}
@@ -258,6 +270,37 @@ static void parse_args(struct config *config, int argc, char *argv[])
 			debug_print("fpga local memory address = %lx\n", (uint64_t)config->fpga_addr);
 			break;
 
+		case 'w':    /* wait mode */
+			if (NULL == tmp_optarg)
+				break;
+			if (!STR_CONST_CMP(tmp_optarg, "spin")) {
+				config->wait_mode = DMA_WAIT_SPIN;
+			} else if (!STR_CONST_CMP(tmp_optarg, "adaptive")) {
+				config->wait_mode = DMA_WAIT_ADAPTIVE;
+			} else if (!STR_CONST_CMP(tmp_optarg, "interrupt")) {
+				config->wait_mode = DMA_WAIT_INTERRUPT;
+			} else {
+				fprintf(stderr, "Invalid wait mode\n");
+				printUsage();
+			}
+			debug_print("wait mode = %d\n", config->wait_mode);
+			break;
+
+		case 'i':    /* DMA interrupt vector */
+			if (NULL == tmp_optarg)
+				break;
+			config->irq_vector = (int) strtoul(tmp_optarg, &endptr, 0);
+			debug_print("irq vector = %d\n", config->irq_vector);
+			break;
+
+		case 'b':    /* wait mode benchmark */
+			config->bench = true;
+			break;
+
+		case 'g':    /* scatter-gather submission */
+			config->sg = true;
+			break;
+
     case 'v':    /* version */
         cout << "fpga_dma_test " << OPAE_VERSION
              << " " << OPAE_GIT_COMMIT_HASH;
@@ -290,6 +333,10 @@ int main(int argc, char *argv[]) {
 	 	.loopback = DMA_INVAL_LOOPBACK,
 		.decim_factor = CONFIG_UNINIT,
 		.fpga_addr = CONFIG_UNINIT,
+		.wait_mode = DMA_WAIT_ADAPTIVE,
+		.irq_vector = -1,
+		.bench = false,
+		.sg = false,
 	};
 
 	parse_args(&config, argc, argv);
@@ -316,6 +363,21 @@ int main(int argc, char *argv[]) {
 		}
 	}
 
+	if(config.wait_mode == DMA_WAIT_INTERRUPT && config.irq_vector < 0) {
+		cout << "Interrupt wait mode requires a DMA interrupt vector (-i/--irq)" << endl;
+		exit(1);
+	}
+
+	if(config.bench && config.direction != DMA_MTOM) {
+		cout << "Wait mode benchmark is only supported for mtom" << endl;
+		exit(1);
+	}
+
+	if(config.sg && config.loopback == DMA_LOOPBACK_ON) {
+		cout << "Scatter-gather submission is not supported in loopback mode" << endl;
+		exit(1);
+	}
+
 	// must specify direction when loopback is turned off
 	if(config.loopback == DMA_LOOPBACK_OFF && config.direction == DMA_INVAL_DIRECTION) {
 		printUsage();
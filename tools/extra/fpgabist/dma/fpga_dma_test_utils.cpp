@@ -28,7 +28,12 @@
  * \brief DMA test utils
  */
 #include <iostream>
+#include <iomanip>
 #include <cmath>
+#include <vector>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/resource.h>
 #include "fpga_dma_test_utils.h"
 #include "fpga_dma_common.h"
 
@@ -386,6 +391,36 @@ out:
 	return res;
 }
 
+// Move data_size bytes as one blocking scatter-gather list of payload-sized
+// segments; only the memory side addresses advance
+static fpga_result sg_transfer(fpga_dma_handle_t dma_h, fpga_dma_transfer_t transfer,
+			       fpga_dma_transfer_type_t type, uint64_t src, uint64_t dst,
+			       fpga_dma_tx_ctrl_t tx_ctrl, fpga_dma_rx_ctrl_t rx_ctrl,
+			       struct config *config) {
+	std::vector<fpga_dma_sg_entry_t> sg;
+	uint64_t total_size = config->data_size;
+
+	while(total_size > 0) {
+		fpga_dma_sg_entry_t seg;
+		seg.src = src;
+		seg.dst = dst;
+		seg.len = MIN(total_size, config->payload_size);
+		seg.tx_ctrl = tx_ctrl;
+		sg.push_back(seg);
+		total_size -= seg.len;
+		if(type != FPGA_ST_TO_HOST_MM)
+			src += seg.len;
+		if(type != HOST_MM_TO_FPGA_ST)
+			dst += seg.len;
+	}
+
+	fpgaDMATransferSetTransferType(transfer, type);
+	fpgaDMATransferSetRxControl(transfer, rx_ctrl);
+	fpgaDMATransferSetLast(transfer, true);
+	fpgaDMATransferSetTransferCallback(transfer, NULL, NULL);
+	return fpgaDMATransferSG(dma_h, transfer, sg.data(), sg.size());
+}
+
 static fpga_result non_loopback_test(fpga_handle afc_h, fpga_dma_handle_t dma_h, struct config *config) {
 	fpga_dma_transfer_t transfer;
 	fpga_result res = FPGA_OK;
@@ -427,6 +462,12 @@ static fpga_result non_loopback_test(fpga_handle afc_h, fpga_dma_handle_t dma_h,
 		int64_t tid = ceil((double)config->data_size /(double)config->payload_size);
 		uint64_t src = battrs.iova; // host memory addr
 		uint64_t dst = config->fpga_addr; // fpga memory addr
+		if(config->sg) {
+			res = sg_transfer(dma_h, transfer, HOST_MM_TO_FPGA_MM, src, dst,
+					  TX_NO_PACKET, RX_NO_PACKET, config);
+			ON_ERR_GOTO(res, free_transfer, "transfer error");
+			total_size = 0;
+		}
 		while(total_size > 0) {
 			uint64_t transfer_bytes = MIN(total_size, config->payload_size);
 			//debug_print("Transfer src=%lx, dst=%lx, bytes=%ld\n", (uint64_t)src, (uint64_t)0, transfer_bytes);
@@ -462,6 +503,12 @@ static fpga_result non_loopback_test(fpga_handle afc_h, fpga_dma_handle_t dma_h,
 		tid = ceil((double)config->data_size / (double)config->payload_size);
 		src = config->fpga_addr;
 		dst = battrs.iova;
+		if(config->sg) {
+			res = sg_transfer(dma_h, transfer, FPGA_MM_TO_HOST_MM, src, dst,
+					  TX_NO_PACKET, RX_NO_PACKET, config);
+			ON_ERR_GOTO(res, free_transfer, "transfer error");
+			total_size = 0;
+		}
 		while(total_size > 0) {
 			uint64_t transfer_bytes = MIN(total_size, config->payload_size);
 
@@ -509,6 +556,12 @@ static fpga_result non_loopback_test(fpga_handle afc_h, fpga_dma_handle_t dma_h,
 		uint64_t total_size = config->data_size;
 		int64_t tid = ceil(config->data_size / config->payload_size);
 		uint64_t src = battrs.iova;
+		if(config->sg) {
+			res = sg_transfer(dma_h, transfer, HOST_MM_TO_FPGA_ST, src, 0,
+					  tx_ctrl, RX_NO_PACKET, config);
+			ON_ERR_GOTO(res, free_transfer, "transfer error");
+			total_size = 0;
+		}
 		while(total_size > 0) {
 			uint64_t transfer_bytes = MIN(total_size, config->payload_size);
 			//debug_print("Transfer src=%lx, dst=%lx, bytes=%ld\n", (uint64_t)src, (uint64_t)0, transfer_bytes);
@@ -556,6 +609,12 @@ static fpga_result non_loopback_test(fpga_handle afc_h, fpga_dma_handle_t dma_h,
 		uint64_t total_size = config->data_size;
 		int64_t tid = ceil(config->data_size / config->payload_size);
 		uint64_t dst = battrs.iova;
+		if(config->sg) {
+			res = sg_transfer(dma_h, transfer, FPGA_ST_TO_HOST_MM, 0, dst,
+					  TX_NO_PACKET, rx_ctrl, config);
+			ON_ERR_GOTO(res, free_transfer, "transfer error");
+			total_size = 0;
+		}
 		while(total_size > 0) {
 			uint64_t transfer_bytes = MIN(total_size, config->payload_size);
 
@@ -605,6 +664,153 @@ out:
 	return res;
 }
 
+// return user + system CPU time consumed by the process, in seconds
+static double getCpuTime(void) {
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return (double)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+	       (double)(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000000.0;
+}
+
+static const char *wait_mode_name(fpga_dma_wait_mode_t mode) {
+	switch (mode) {
+	case DMA_WAIT_SPIN:
+		return "spin";
+	case DMA_WAIT_ADAPTIVE:
+		return "adaptive";
+	case DMA_WAIT_INTERRUPT:
+		return "interrupt";
+	default:
+		return "unknown";
+	}
+}
+
+static fpga_result set_wait_mode(fpga_dma_handle_t dma_h, fpga_dma_wait_mode_t mode, struct config *config) {
+	uint32_t irq_vector = config->irq_vector < 0 ? 0 : (uint32_t)config->irq_vector;
+	return fpgaDMASetWaitMode(dma_h, mode, irq_vector);
+}
+
+// Issue one host to FPGA memory transfer of size bytes; blocks when last is set
+static fpga_result mtom_write(fpga_dma_handle_t dma_h, fpga_dma_transfer_t transfer,
+			      uint64_t src, uint64_t dst, uint64_t size, bool last) {
+	fpgaDMATransferSetSrc(transfer, src);
+	fpgaDMATransferSetDst(transfer, dst);
+	fpgaDMATransferSetLen(transfer, size);
+	fpgaDMATransferSetTransferType(transfer, HOST_MM_TO_FPGA_MM);
+	fpgaDMATransferSetLast(transfer, last);
+	if(last)
+		fpgaDMATransferSetTransferCallback(transfer, NULL, NULL);
+	else
+		fpgaDMATransferSetTransferCallback(transfer, transferComplete, NULL);
+	return fpgaDMATransfer(dma_h, transfer);
+}
+
+// For each wait mode measure the CPU burned by idle workers, the latency
+// of blocking single-payload transfers and the throughput and CPU
+// utilization of a bulk transfer of data_size bytes.
+static fpga_result wait_mode_benchmark(fpga_handle afc_h, fpga_dma_handle_t dma_h, struct config *config) {
+	fpga_dma_transfer_t transfer = NULL;
+	fpga_result res = FPGA_OK;
+	struct timespec start, end;
+	std::vector<double> lat(BENCH_LATENCY_ITERS);
+	int m;
+
+	struct buf_attrs battrs = {
+		.va = NULL,
+		.iova = 0,
+		.wsid = 0,
+		.size = 0
+	};
+
+	battrs.size = config->data_size;
+	res = allocate_buffer(afc_h, &battrs);
+	ON_ERR_GOTO(res, out, "allocating buffer");
+	fill_buffer((unsigned char *)battrs.va, config->data_size);
+
+	res = fpgaDMATransferInit(&transfer);
+	ON_ERR_GOTO(res, out, "allocating transfer");
+
+	std::cout << std::left << std::setw(10) << "mode"
+		  << std::right << std::setw(12) << "idle CPU %"
+		  << std::setw(14) << "lat mean us"
+		  << std::setw(13) << "lat p99 us"
+		  << std::setw(10) << "MB/s"
+		  << std::setw(10) << "CPU %" << std::endl;
+
+	for(m = DMA_WAIT_SPIN; m < FPGA_MAX_WAIT_MODE; m++) {
+		fpga_dma_wait_mode_t mode = (fpga_dma_wait_mode_t)m;
+		uint64_t payload = MIN(config->payload_size, config->data_size);
+		double cpu_start, idle_cpu, bulk_cpu, wall, sum;
+		uint64_t total_size, src, dst;
+		int i;
+
+		if(mode == DMA_WAIT_INTERRUPT && config->irq_vector < 0) {
+			std::cout << std::left << std::setw(10) << wait_mode_name(mode)
+				  << " skipped (no -i/--irq given)" << std::endl;
+			continue;
+		}
+
+		res = set_wait_mode(dma_h, mode, config);
+		ON_ERR_GOTO(res, free_transfer, "setting wait mode");
+
+		// idle: workers have nothing to do
+		cpu_start = getCpuTime();
+		sleep(BENCH_IDLE_SECONDS);
+		idle_cpu = (getCpuTime() - cpu_start) * 100.0 / BENCH_IDLE_SECONDS;
+
+		// latency: one blocking payload at a time
+		for(i = 0; i < BENCH_LATENCY_ITERS; i++) {
+			clock_gettime(CLOCK_MONOTONIC, &start);
+			res = mtom_write(dma_h, transfer, battrs.iova, config->fpga_addr, payload, true);
+			clock_gettime(CLOCK_MONOTONIC, &end);
+			ON_ERR_GOTO(res, free_transfer, "transfer error");
+			lat[i] = getTime(start, end) * 1000000.0;
+		}
+		sum = 0;
+		for(i = 0; i < BENCH_LATENCY_ITERS; i++)
+			sum += lat[i];
+		std::sort(lat.begin(), lat.end());
+
+		// throughput: data_size bytes split into payload-sized transfers
+		cpu_start = getCpuTime();
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		total_size = config->data_size;
+		src = battrs.iova;
+		dst = config->fpga_addr;
+		while(total_size > 0) {
+			uint64_t transfer_bytes = MIN(total_size, config->payload_size);
+			res = mtom_write(dma_h, transfer, src, dst, transfer_bytes, total_size == transfer_bytes);
+			ON_ERR_GOTO(res, free_transfer, "transfer error");
+			total_size -= transfer_bytes;
+			src += transfer_bytes;
+			dst += transfer_bytes;
+		}
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		wall = getTime(start, end);
+		bulk_cpu = (getCpuTime() - cpu_start) * 100.0 / wall;
+
+		std::cout << std::left << std::setw(10) << wait_mode_name(mode)
+			  << std::right << std::fixed << std::setprecision(1)
+			  << std::setw(12) << idle_cpu
+			  << std::setw(14) << sum / BENCH_LATENCY_ITERS
+			  << std::setw(13) << lat[(BENCH_LATENCY_ITERS * 99) / 100]
+			  << std::setw(10) << getBandwidth(config->data_size, wall)
+			  << std::setw(10) << bulk_cpu << std::endl;
+	}
+
+	// leave the channel in the mode that was asked for
+	res = set_wait_mode(dma_h, config->wait_mode, config);
+	ON_ERR_GOTO(res, free_transfer, "setting wait mode");
+
+free_transfer:
+	if(transfer)
+		fpgaDMATransferDestroy(&transfer);
+out:
+	if(battrs.va)
+		free_buffer(afc_h, &battrs);
+	return res;
+}
+
 fpga_result configure_numa(fpga_token afc_token, bool cpu_affinity, bool memory_affinity)
 {
 	fpga_result res = FPGA_OK;
@@ -776,10 +982,18 @@ fpga_result do_action(struct config *config, fpga_token afc_tok)
 		ON_ERR_GOTO(res, out_dma_close, "fpgaDMAOpen");
 		debug_print("opened memory to memory channel\n");
 
-		// Run test
-		res = non_loopback_test(afc_h, dma_h, config);
-		ON_ERR_GOTO(res, out_dma_close, "fpgaDMAOpen");
-		debug_print("non loopback test success\n");
+		res = set_wait_mode(dma_h, config->wait_mode, config);
+		ON_ERR_GOTO(res, out_dma_close, "fpgaDMASetWaitMode");
+
+		if(config->bench) {
+			res = wait_mode_benchmark(afc_h, dma_h, config);
+			ON_ERR_GOTO(res, out_dma_close, "wait mode benchmark");
+		} else {
+			// Run test
+			res = non_loopback_test(afc_h, dma_h, config);
+			ON_ERR_GOTO(res, out_dma_close, "fpgaDMAOpen");
+			debug_print("non loopback test success\n");
+		}
 	} else {
 		if(config->loopback == DMA_LOOPBACK_OFF) {
 			if(config->direction == DMA_MTOS) {
@@ -794,6 +1008,9 @@ fpga_result do_action(struct config *config, fpga_token afc_tok)
 				debug_print("opened stream to memory channel\n");
 			}
 
+			res = set_wait_mode(dma_h, config->wait_mode, config);
+			ON_ERR_GOTO(res, out_dma_close, "fpgaDMASetWaitMode");
+
 			// Run test
 			res = non_loopback_test(afc_h, dma_h, config);
 			ON_ERR_GOTO(res, out_dma_close, "fpgaDMAOpen");
@@ -805,6 +1022,12 @@ fpga_result do_action(struct config *config, fpga_token afc_tok)
 			res = fpgaDMAOpen(afc_h, 1, &rx_dma_h);
 			ON_ERR_GOTO(res, out_rx_close, "fpgaDMAOpen rx");
 
+			res = set_wait_mode(tx_dma_h, config->wait_mode, config);
+			ON_ERR_GOTO(res, out_rx_close, "fpgaDMASetWaitMode tx");
+
+			res = set_wait_mode(rx_dma_h, config->wait_mode, config);
+			ON_ERR_GOTO(res, out_rx_close, "fpgaDMASetWaitMode rx");
+
 			// Run test
 			res = loopback_test(afc_h, tx_dma_h, rx_dma_h, config);
 			ON_ERR_GOTO(res, out_rx_close, "loopback test failed");
@@ -57,6 +57,8 @@
 #define MAX_DECIM_FACTOR (0xFFFF)
 #define CONFIG_UNINIT (0)
 #define BEAT_SIZE (64) // bytes
+#define BENCH_LATENCY_ITERS (1000)
+#define BENCH_IDLE_SECONDS (1)
 
 #define FPGA_DMA_TWO_TO_ONE_MUX_CSR (0x40)
 #define FPGA_DMA_ONE_TO_TWO_MUX_CSR (0x50)
@@ -99,6 +101,10 @@ struct config {
 	enum dma_loopback loopback;
 	uint16_t decim_factor;
 	uint64_t fpga_addr;
+	fpga_dma_wait_mode_t wait_mode;
+	int irq_vector;
+	bool bench;
+	bool sg;
 };
 
 typedef union {
@@ -81,6 +81,22 @@ typedef enum {
 	MM
 } fpga_dma_channel_type_t;
 
+// Worker thread wait strategies
+typedef enum {
+	DMA_WAIT_SPIN = 0,  // busy-poll; lowest latency, one core per worker
+	DMA_WAIT_ADAPTIVE,  // spin, then yield, then sleep until work arrives
+	DMA_WAIT_INTERRUPT, // adaptive, but block on the DMA IRQ for completions
+	FPGA_MAX_WAIT_MODE
+} fpga_dma_wait_mode_t;
+
+// One segment of a scatter-gather transfer list
+typedef struct {
+	uint64_t src;
+	uint64_t dst;
+	uint64_t len;
+	fpga_dma_tx_ctrl_t tx_ctrl; // SOP/EOP generation; TX transfers only
+} fpga_dma_sg_entry_t;
+
 // Opaque object that describes a DMA transfer
 typedef struct fpga_dma_transfer *fpga_dma_transfer_t;
 
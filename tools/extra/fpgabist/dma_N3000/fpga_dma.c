@@ -117,6 +117,38 @@ void *local_memcpy(void *dst, void *src, size_t n)
 #endif
 }
 
+/**
+ * local_memcpy_nt
+ *
+ * @brief                memcpy using non-temporal stores where both ends are
+ * cache line aligned, so data streamed through the bounce buffers does not
+ * evict the caller's working set
+ * @param[in] dst        Pointer to the destination memory
+ * @param[in] src        Pointer to the source memory
+ * @param[in] n          Size in bytes
+ * @return dst
+ *
+ */
+static void *local_memcpy_nt(void *dst, void *src, size_t n)
+{
+#ifndef USE_MEMCPY
+	if (IS_CL_ALIGNED(src) && IS_CL_ALIGNED(dst) && n >= MIN_SSE2_SIZE) {
+		aligned_block_copy_nt_sse2((int64_t * __restrict) dst,
+					   (int64_t * __restrict) src,
+					   ALIGN_TO_CL(n));
+		// drain the write-combining buffers before the data is
+		// handed to the DMA engine or back to the caller
+		__asm__ __volatile__("sfence" ::: "memory");
+		if (n != ALIGN_TO_CL(n))
+			local_memcpy((void *)((uint64_t)dst + ALIGN_TO_CL(n)),
+				     (void *)((uint64_t)src + ALIGN_TO_CL(n)),
+				     n - ALIGN_TO_CL(n));
+		return dst;
+	}
+#endif
+	return local_memcpy(dst, src, n);
+}
+
 /*
  * macro for checking return codes
  */
@@ -524,6 +556,9 @@ static fpga_result _do_dma(fpga_dma_handle dma_h, uint64_t dst, uint64_t src,
 				segment_size = count;
 				count = 0; // transfer below will move the
 					   // remainder of the buffer
+				// last segment; the alignment transfer above
+				// may have cleared the interrupt request
+				desc.control.transfer_irq_en = intr_en ? 1 : 0;
 			}
 			// buffers do not end on 4CL boundary so transfer only
 			// up to the last 4CL boundary leaving a segment at the
@@ -601,9 +636,14 @@ fpga_result fpgaDmaOpen(fpga_handle fpga, int dma_idx, fpga_dma_handle *dma_p)
 	if (!dma_h) {
 		return FPGA_NO_MEMORY;
 	}
+	memset(dma_h, 0, sizeof(*dma_h));
 	dma_h->fpga_h = fpga;
 	for (i = 0; i < FPGA_DMA_MAX_BUF; i++)
 		dma_h->dma_buf_ptr[i] = NULL;
+	pthread_mutex_init(&dma_h->async_lock, NULL);
+	pthread_cond_init(&dma_h->async_cond, NULL);
+	dma_h->async_res = FPGA_OK;
+	dma_h->bufs_free = FPGA_DMA_MAX_BUF;
 	dma_h->mmio_num = 0;
 	dma_h->mmio_offset = 0;
 	dma_h->cur_ase_page = 0xffffffffffffffffUll;
@@ -668,8 +708,9 @@ fpga_result fpgaDmaOpen(fpga_handle fpga, int dma_idx, fpga_dma_handle *dma_p)
 		ON_ERR_GOTO(res, rel_buf, "fpgaGetIOAddress");
 	}
 
-	// Allocate magic number buffer
-	res = fpgaPrepareBuffer(dma_h->fpga_h, FPGA_DMA_ALIGN_BYTES,
+	// Allocate magic number buffer, one cache line per slot
+	res = fpgaPrepareBuffer(dma_h->fpga_h,
+				FPGA_DMA_ALIGN_BYTES * FPGA_DMA_MAGIC_SLOTS,
 				(void **)&(dma_h->magic_buf),
 				&dma_h->magic_wsid, 0);
 	ON_ERR_GOTO(res, out, "fpgaPrepareBuffer");
@@ -677,7 +718,8 @@ fpga_result fpgaDmaOpen(fpga_handle fpga, int dma_idx, fpga_dma_handle *dma_p)
 	res = fpgaGetIOAddress(dma_h->fpga_h, dma_h->magic_wsid,
 			       &dma_h->magic_iova);
 	ON_ERR_GOTO(res, rel_buf, "fpgaGetIOAddress");
-	memset((void *)dma_h->magic_buf, 0, FPGA_DMA_ALIGN_BYTES);
+	memset((void *)dma_h->magic_buf, 0,
+	       FPGA_DMA_ALIGN_BYTES * FPGA_DMA_MAGIC_SLOTS);
 
 	// turn on global interrupts
 	msgdma_ctrl_t ctrl = {0};
@@ -720,8 +762,11 @@ rel_buf:
 		ON_ERR_GOTO(res, out, "fpgaReleaseBuffer");
 	}
 out:
-	if (!dma_found)
+	if (!dma_found) {
+		pthread_cond_destroy(&dma_h->async_cond);
+		pthread_mutex_destroy(&dma_h->async_lock);
 		free(dma_h);
+	}
 	return res;
 }
 
@@ -1560,12 +1605,634 @@ out_spl:
 	return res;
 }
 
+/**
+ * transferPinned
+ *
+ * @brief                Moves data between the FPGA and a host buffer that is
+ * already mapped for DMA, without staging it in the bounce buffers
+ * @param[in] dma_h      Handle to the FPGA DMA object
+ * @param[in] dst        Destination address
+ * @param[in] src        Source address
+ * @param[in] count      Size in bytes
+ * @param[in] type       HOST_TO_FPGA_MM or FPGA_TO_HOST_MM
+ * @param[in] host_iova  IO address of the host side of the transfer
+ * @return fpga_result FPGA_OK on success, return code otherwise
+ *
+ */
+static fpga_result transferPinned(fpga_dma_handle dma_h, uint64_t dst,
+				  uint64_t src, size_t count,
+				  fpga_dma_transfer_t type, uint64_t host_iova)
+{
+	fpga_result res = FPGA_OK;
+	uint64_t fpga_addr = (type == HOST_TO_FPGA_MM) ? dst : src;
+	uint64_t count_left = count;
+	uint64_t len;
+
+	// the engine needs both ends 64-byte aligned once the head is done
+	if ((fpga_addr % FPGA_DMA_ALIGN_BYTES)
+	    != (host_iova % FPGA_DMA_ALIGN_BYTES)) {
+		debug_print("host and FPGA alignment differ, using bounce buffers\n");
+		if (type == HOST_TO_FPGA_MM)
+			return transferHostToFpga(dma_h, dst, src, count, type);
+		return transferFpgaToHost(dma_h, dst, src, count, type);
+	}
+
+	if (!IS_DMA_ALIGNED(fpga_addr)) {
+		len = min(count_left, FPGA_DMA_ALIGN_BYTES
+					      - (fpga_addr % FPGA_DMA_ALIGN_BYTES));
+		if (type == HOST_TO_FPGA_MM)
+			res = _ase_host_to_fpga(dma_h, &dst, &src, len);
+		else
+			res = _ase_fpga_to_host(dma_h, &src, &dst, len);
+		ON_ERR_GOTO(res, out, "pinned transfer head failed");
+		host_iova += len;
+		count_left -= len;
+	}
+
+	if (count_left >= FPGA_DMA_ALIGN_BYTES) {
+		uint64_t dma_bytes = count_left
+				     & ~((uint64_t)FPGA_DMA_ALIGN_BYTES - 1);
+		uint64_t off;
+
+		for (off = 0; off < dma_bytes; off += len) {
+			bool last = (off + fpga_dma_buf_size >= dma_bytes);
+
+			len = min(dma_bytes - off, fpga_dma_buf_size);
+			if (type == HOST_TO_FPGA_MM)
+				res = _do_dma(dma_h, dst + off,
+					      (host_iova + off)
+						      | FPGA_DMA_HOST_MASK,
+					      len, last, type,
+					      last /*intr_en */);
+			else
+				res = _do_dma(dma_h,
+					      (host_iova + off)
+						      | FPGA_DMA_HOST_MASK,
+					      src + off, len, 0, type,
+					      false /*intr_en */);
+			ON_ERR_GOTO(res, out, "pinned transfer failed");
+		}
+
+		// Host writes are only known to have landed once the magic
+		// number written after them is visible.
+		if (type == HOST_TO_FPGA_MM) {
+			res = poll_interrupt(dma_h);
+			ON_ERR_GOTO(res, out, "pinned transfer failed");
+		} else {
+			res = _issue_magic(dma_h);
+			ON_ERR_GOTO(res, out, "Magic number issue failed");
+			_wait_magic(dma_h);
+		}
+
+		dst += dma_bytes;
+		src += dma_bytes;
+		count_left -= dma_bytes;
+	}
+
+	if (count_left) {
+		if (type == HOST_TO_FPGA_MM)
+			res = _ase_host_to_fpga(dma_h, &dst, &src, count_left);
+		else
+			res = _ase_fpga_to_host(dma_h, &src, &dst, count_left);
+		ON_ERR_GOTO(res, out, "pinned transfer tail failed");
+	}
+
+out:
+	return res;
+}
+
+#define MAGIC_SLOT(dma_h, n)                                                   \
+	((dma_h)->magic_buf + (n) * (FPGA_DMA_ALIGN_BYTES / sizeof(uint64_t)))
+
+// Bounce buffers claimed by the submission thread since the last fence
+typedef struct {
+	uint32_t first_buf;
+	uint32_t num_bufs;
+} dma_async_batch_t;
+
+/**
+ * _async_get_buf
+ *
+ * @brief                Claims the next bounce buffer in ring order, waiting
+ * for the completion thread to release one if none is free
+ * @param[in] dma_h      Handle to the FPGA DMA object
+ * @param[in/out] batch  Unfenced buffers; the claimed buffer is added
+ * @return index of the claimed bounce buffer
+ *
+ */
+static uint32_t _async_get_buf(fpga_dma_handle dma_h, dma_async_batch_t *batch)
+{
+	uint32_t b;
+
+	pthread_mutex_lock(&dma_h->async_lock);
+	while (!dma_h->bufs_free)
+		pthread_cond_wait(&dma_h->async_cond, &dma_h->async_lock);
+	dma_h->bufs_free--;
+	pthread_mutex_unlock(&dma_h->async_lock);
+
+	b = dma_h->buf_head;
+	dma_h->buf_head = (b + 1) % FPGA_DMA_MAX_BUF;
+	if (!batch->num_bufs)
+		batch->first_buf = b;
+	batch->num_bufs++;
+	return b;
+}
+
+/**
+ * _async_fence
+ *
+ * @brief                Queues a magic number write behind the descriptors
+ * sent so far and hands it to the completion thread
+ * @param[in] dma_h      Handle to the FPGA DMA object
+ * @param[in/out] batch  Bounce buffers released when the fence lands; reset
+ * @param[in] req        Request the descriptors belong to
+ * @param[in] last       True if the fence finishes req
+ * @param[in] res        Status of the descriptors covered by the fence
+ * @return fpga_result FPGA_OK on success, return code otherwise
+ *
+ */
+static fpga_result _async_fence(fpga_dma_handle dma_h, dma_async_batch_t *batch,
+				dma_async_req_t *req, bool last,
+				fpga_result res)
+{
+	dma_async_fence_t *fence;
+	uint32_t idx;
+
+	pthread_mutex_lock(&dma_h->async_lock);
+	while (dma_h->num_fences == FPGA_DMA_ASYNC_FENCES)
+		pthread_cond_wait(&dma_h->async_cond, &dma_h->async_lock);
+	idx = (dma_h->fence_head + dma_h->num_fences) % FPGA_DMA_ASYNC_FENCES;
+	pthread_mutex_unlock(&dma_h->async_lock);
+
+	fence = &dma_h->fences[idx];
+	fence->first_buf = batch->first_buf;
+	fence->num_bufs = batch->num_bufs;
+	fence->req = req;
+	fence->last = last;
+	fence->res = res;
+	fence->issued = false;
+
+	// Descriptors complete in order, so even after an error the magic
+	// write tells us the hardware is done with the bounce buffers.
+	*MAGIC_SLOT(dma_h, idx + 1) = 0x0ULL;
+	res = _do_dma(dma_h,
+		      (dma_h->magic_iova + (idx + 1) * FPGA_DMA_ALIGN_BYTES)
+			      | FPGA_DMA_WF_HOST_MASK,
+		      FPGA_DMA_WF_ROM_MAGIC_NO_MASK, 64, 1, FPGA_TO_HOST_MM,
+		      true /*intr_en */);
+	if (res == FPGA_OK)
+		fence->issued = true;
+	else if (fence->res == FPGA_OK)
+		fence->res = res;
+
+	pthread_mutex_lock(&dma_h->async_lock);
+	dma_h->num_fences++;
+	pthread_cond_broadcast(&dma_h->async_cond);
+	pthread_mutex_unlock(&dma_h->async_lock);
+
+	batch->num_bufs = 0;
+	return res;
+}
+
+/**
+ * _async_wait_fence
+ *
+ * @brief                Sleeps on the DMA interrupt until a magic number slot
+ * is written
+ * @param[in] dma_h      Handle to the FPGA DMA object
+ * @param[in] slot       Magic number slot of the fence
+ * @return fpga_result FPGA_OK on success, return code otherwise
+ *
+ */
+static fpga_result _async_wait_fence(fpga_dma_handle dma_h,
+				     volatile uint64_t *slot)
+{
+	struct pollfd pfd = {0};
+	fpga_result res = FPGA_OK;
+	uint64_t waited = 0;
+	uint64_t count = 0;
+	int poll_res;
+
+	res = fpgaGetOSObjectFromEventHandle(dma_h->eh, &pfd.fd);
+	ON_ERR_RETURN(res, "fpgaGetOSObjectFromEventHandle failed\n");
+	pfd.events = POLLIN;
+
+	while (*slot != FPGA_DMA_WF_MAGIC_NO) {
+		if (waited >= FPGA_DMA_TIMEOUT_MSEC) {
+			fprintf(stderr, "Poll(interrupt) timeout \n");
+			return FPGA_EXCEPTION;
+		}
+		poll_res = poll(&pfd, 1, FPGA_DMA_ASYNC_POLL_MSEC);
+		if (poll_res < 0 && errno != EINTR) {
+			fprintf(stderr, "Poll error errno = %s\n",
+				strerror(errno));
+			return FPGA_EXCEPTION;
+		} else if (poll_res > 0) {
+			if (read(pfd.fd, &count, sizeof(count)) < 0) {
+				debug_print("interrupt read failed: %s\n",
+					    strerror(errno));
+			}
+			clear_interrupt(dma_h);
+		} else {
+			waited += FPGA_DMA_ASYNC_POLL_MSEC;
+		}
+	}
+	return FPGA_OK;
+}
+
+/**
+ * _async_drain
+ *
+ * @brief                Fences the descriptors sent so far and waits for every
+ * outstanding fence to land, so that MMIO through the ASE window cannot
+ * overtake queued DMA to the same addresses
+ * @param[in] dma_h      Handle to the FPGA DMA object
+ * @param[in/out] batch  Unfenced buffers of req; fenced and reset
+ * @param[in] req        Request the descriptors belong to
+ * @return fpga_result FPGA_OK on success, return code otherwise
+ *
+ */
+static fpga_result _async_drain(fpga_dma_handle dma_h, dma_async_batch_t *batch,
+				dma_async_req_t *req)
+{
+	fpga_result res = FPGA_OK;
+
+	if (batch->num_bufs)
+		res = _async_fence(dma_h, batch, req, false, FPGA_OK);
+
+	pthread_mutex_lock(&dma_h->async_lock);
+	while (dma_h->num_fences)
+		pthread_cond_wait(&dma_h->async_cond, &dma_h->async_lock);
+	pthread_mutex_unlock(&dma_h->async_lock);
+	return res;
+}
+
+/**
+ * _async_submit
+ *
+ * @brief                Sends the descriptors for one asynchronous request,
+ * copying host data into bounce buffers as they become free, and queues
+ * the fence that completes it
+ * @param[in] dma_h      Handle to the FPGA DMA object
+ * @param[in] req        Request to send
+ * @return fpga_result FPGA_OK on success, return code otherwise
+ *
+ */
+static fpga_result _async_submit(fpga_dma_handle dma_h, dma_async_req_t *req)
+{
+	dma_async_batch_t batch = {0, 0};
+	fpga_result res = FPGA_OK;
+	uint64_t dst = req->dst;
+	uint64_t src = req->src;
+	uint64_t count = req->count;
+	uint64_t len;
+	uint32_t b;
+
+	if (req->type == FPGA_TO_FPGA_MM) {
+		if (!IS_DMA_ALIGNED(dst) || !IS_DMA_ALIGNED(src)
+		    || !IS_DMA_ALIGNED(count)) {
+			// The unaligned path bounces through host memory and
+			// waits on the interrupt itself, so let the pipeline
+			// drain first.
+			res = _async_drain(dma_h, &batch, req);
+			ON_ERR_GOTO(res, out, "async drain failed");
+			res = transferFpgaToFpga(dma_h, dst, src, count,
+						 FPGA_TO_FPGA_MM);
+			goto out;
+		}
+		while (count) {
+			len = min(count, fpga_dma_buf_size);
+			res = _do_dma(dma_h, dst, src, len, 0, req->type,
+				      false /*intr_en */);
+			ON_ERR_GOTO(res, out, "FPGA_TO_FPGA_MM Transfer failed");
+			src += len;
+			dst += len;
+			count -= len;
+		}
+		goto out;
+	}
+
+	// Head and tail bytes go through the ASE window straight away, so
+	// earlier requests must have landed first to keep requests ordered.
+	if ((req->type == HOST_TO_FPGA_MM && !IS_DMA_ALIGNED(dst))
+	    || (req->type == FPGA_TO_HOST_MM && !IS_DMA_ALIGNED(src))) {
+		res = _async_drain(dma_h, &batch, req);
+		ON_ERR_GOTO(res, out, "async drain failed");
+	}
+
+	if (req->type == HOST_TO_FPGA_MM && !IS_DMA_ALIGNED(dst)) {
+		len = min(count, FPGA_DMA_ALIGN_BYTES
+					 - (dst % FPGA_DMA_ALIGN_BYTES));
+		res = _ase_host_to_fpga(dma_h, &dst, &src, len);
+		ON_ERR_GOTO(res, out, "HOST_TO_FPGA_MM Transfer failed\n");
+		count -= len;
+	} else if (req->type == FPGA_TO_HOST_MM && !IS_DMA_ALIGNED(src)) {
+		len = min(count, FPGA_DMA_ALIGN_BYTES
+					 - (src % FPGA_DMA_ALIGN_BYTES));
+		res = _ase_fpga_to_host(dma_h, &src, &dst, len);
+		ON_ERR_GOTO(res, out, "FPGA_TO_HOST_MM Transfer failed");
+		count -= len;
+	}
+
+	while (count >= FPGA_DMA_ALIGN_BYTES) {
+		len = min(count & ~((uint64_t)FPGA_DMA_ALIGN_BYTES - 1),
+			  fpga_dma_buf_size);
+		b = _async_get_buf(dma_h, &batch);
+		if (req->type == HOST_TO_FPGA_MM) {
+			local_memcpy_nt(dma_h->dma_buf_ptr[b], (void *)src, len);
+			dma_h->buf_copy_len[b] = 0;
+			res = _do_dma(dma_h, dst,
+				      dma_h->dma_buf_iova[b]
+					      | FPGA_DMA_HOST_MASK,
+				      len, 0, req->type, false /*intr_en */);
+		} else {
+			dma_h->buf_copy_dst[b] = dst;
+			dma_h->buf_copy_len[b] = len;
+			res = _do_dma(dma_h,
+				      dma_h->dma_buf_iova[b]
+					      | FPGA_DMA_HOST_MASK,
+				      src, len, 0, req->type,
+				      false /*intr_en */);
+		}
+		ON_ERR_GOTO(res, out, "async transfer failed");
+		src += len;
+		dst += len;
+		count -= len;
+
+		// Fence small groups so buffers cycle back to this stage
+		// while the hardware still has the rest of the ring queued.
+		if (batch.num_bufs == FPGA_DMA_FENCE_BUFS) {
+			res = _async_fence(dma_h, &batch, req, false, FPGA_OK);
+			ON_ERR_GOTO(res, out, "async fence failed");
+		}
+	}
+
+	if (count) {
+		res = _async_drain(dma_h, &batch, req);
+		ON_ERR_GOTO(res, out, "async drain failed");
+		if (req->type == HOST_TO_FPGA_MM)
+			res = _ase_host_to_fpga(dma_h, &dst, &src, count);
+		else
+			res = _ase_fpga_to_host(dma_h, &src, &dst, count);
+		ON_ERR_GOTO(res, out, "async transfer failed");
+	}
+
+out:
+	return _async_fence(dma_h, &batch, req, true, res);
+}
+
+static void *_async_submit_worker(void *arg)
+{
+	fpga_dma_handle dma_h = (fpga_dma_handle)arg;
+	dma_async_req_t *req;
+
+	pthread_mutex_lock(&dma_h->async_lock);
+	while (1) {
+		while ((!dma_h->queue_head || dma_h->sync_active)
+		       && !dma_h->async_stop)
+			pthread_cond_wait(&dma_h->async_cond,
+					  &dma_h->async_lock);
+		req = dma_h->queue_head;
+		if (!req)
+			break;
+		dma_h->queue_head = req->next;
+		if (!dma_h->queue_head)
+			dma_h->queue_tail = NULL;
+		pthread_mutex_unlock(&dma_h->async_lock);
+
+		_async_submit(dma_h, req);
+
+		pthread_mutex_lock(&dma_h->async_lock);
+	}
+	dma_h->submit_running = false;
+	pthread_cond_broadcast(&dma_h->async_cond);
+	pthread_mutex_unlock(&dma_h->async_lock);
+	return NULL;
+}
+
+static void *_async_complete_worker(void *arg)
+{
+	fpga_dma_handle dma_h = (fpga_dma_handle)arg;
+	dma_async_fence_t *fence;
+	dma_async_req_t *req;
+	fpga_result res;
+	uint32_t idx;
+	uint32_t i;
+	bool last;
+	uint32_t b;
+
+	pthread_mutex_lock(&dma_h->async_lock);
+	while (1) {
+		while (!dma_h->num_fences && dma_h->submit_running)
+			pthread_cond_wait(&dma_h->async_cond,
+					  &dma_h->async_lock);
+		if (!dma_h->num_fences)
+			break;
+		idx = dma_h->fence_head;
+		fence = &dma_h->fences[idx];
+		pthread_mutex_unlock(&dma_h->async_lock);
+
+		res = fence->res;
+		if (fence->issued) {
+			fpga_result wres =
+				_async_wait_fence(dma_h, MAGIC_SLOT(dma_h, idx + 1));
+			if (res == FPGA_OK)
+				res = wres;
+		}
+
+		// Copy out FPGA to host data while the submission thread
+		// keeps the hardware busy with later descriptors, handing
+		// each buffer back as soon as it is drained.
+		for (i = 0; i < fence->num_bufs; i++) {
+			b = (fence->first_buf + i) % FPGA_DMA_MAX_BUF;
+			if (dma_h->buf_copy_len[b] && res == FPGA_OK)
+				local_memcpy_nt((void *)dma_h->buf_copy_dst[b],
+						dma_h->dma_buf_ptr[b],
+						dma_h->buf_copy_len[b]);
+			pthread_mutex_lock(&dma_h->async_lock);
+			dma_h->bufs_free++;
+			pthread_cond_broadcast(&dma_h->async_cond);
+			pthread_mutex_unlock(&dma_h->async_lock);
+		}
+		// the slot may be reused once the fence is retired
+		req = fence->req;
+		last = fence->last;
+
+		pthread_mutex_lock(&dma_h->async_lock);
+		dma_h->fence_head = (idx + 1) % FPGA_DMA_ASYNC_FENCES;
+		dma_h->num_fences--;
+		if (res != FPGA_OK && req->res == FPGA_OK)
+			req->res = res;
+		if (res != FPGA_OK && !req->result
+		    && dma_h->async_res == FPGA_OK)
+			dma_h->async_res = res;
+		pthread_cond_broadcast(&dma_h->async_cond);
+
+		if (last) {
+			pthread_mutex_unlock(&dma_h->async_lock);
+			if (req->result)
+				*req->result = req->res;
+			if (req->cb)
+				req->cb(req->context);
+			free(req);
+			pthread_mutex_lock(&dma_h->async_lock);
+			dma_h->async_pending--;
+			pthread_cond_broadcast(&dma_h->async_cond);
+		}
+	}
+	pthread_mutex_unlock(&dma_h->async_lock);
+	return NULL;
+}
+
+// Called with async_lock held
+static fpga_result _async_start(fpga_dma_handle dma_h)
+{
+	dma_h->submit_running = true;
+	if (pthread_create(&dma_h->complete_thread, NULL,
+			   _async_complete_worker, dma_h)) {
+		dma_h->submit_running = false;
+		return FPGA_EXCEPTION;
+	}
+
+	if (pthread_create(&dma_h->submit_thread, NULL, _async_submit_worker,
+			   dma_h)) {
+		dma_h->submit_running = false;
+		pthread_cond_broadcast(&dma_h->async_cond);
+		pthread_mutex_unlock(&dma_h->async_lock);
+		pthread_join(dma_h->complete_thread, NULL);
+		pthread_mutex_lock(&dma_h->async_lock);
+		return FPGA_EXCEPTION;
+	}
+
+	dma_h->async_started = true;
+	return FPGA_OK;
+}
+
+// Wait for outstanding asynchronous transfers and keep new ones queued
+// until _async_resume(), so the pinned path has the engine, the
+// bounce buffers and the interrupt to itself.
+static void _async_quiesce(fpga_dma_handle dma_h)
+{
+	pthread_mutex_lock(&dma_h->async_lock);
+	while (dma_h->async_pending || dma_h->sync_active)
+		pthread_cond_wait(&dma_h->async_cond, &dma_h->async_lock);
+	dma_h->sync_active = true;
+	pthread_mutex_unlock(&dma_h->async_lock);
+}
+
+static void _async_resume(fpga_dma_handle dma_h)
+{
+	pthread_mutex_lock(&dma_h->async_lock);
+	dma_h->sync_active = false;
+	pthread_cond_broadcast(&dma_h->async_cond);
+	pthread_mutex_unlock(&dma_h->async_lock);
+}
+
+// True when called from a completion callback, where waiting for the
+// pipeline would wait on the calling thread itself.
+static bool _async_in_callback(fpga_dma_handle dma_h)
+{
+	bool in_cb;
+
+	pthread_mutex_lock(&dma_h->async_lock);
+	in_cb = dma_h->async_started
+		&& pthread_equal(pthread_self(), dma_h->complete_thread);
+	pthread_mutex_unlock(&dma_h->async_lock);
+	return in_cb;
+}
+
+/**
+ * _async_enqueue
+ *
+ * @brief                Queues a transfer on the pipeline, starting the
+ * pipeline threads on first use
+ * @param[in] dma_h      Handle to the FPGA DMA object
+ * @param[in] dst        Destination address
+ * @param[in] src        Source address
+ * @param[in] count      Size in bytes
+ * @param[in] type       Direction of transfer
+ * @param[in] cb         Completion callback, or NULL
+ * @param[in] context    Argument for cb
+ * @param[out] result    Set to the status of the transfer before cb runs;
+ * NULL for asynchronous callers, who get errors from later calls instead
+ * @return fpga_result FPGA_OK on success, return code otherwise
+ *
+ */
+static fpga_result _async_enqueue(fpga_dma_handle dma_h, uint64_t dst,
+				  uint64_t src, size_t count,
+				  fpga_dma_transfer_t type,
+				  fpga_dma_transfer_cb cb, void *context,
+				  fpga_result *result)
+{
+	fpga_result res = FPGA_OK;
+	dma_async_req_t *req;
+
+	req = (dma_async_req_t *)malloc(sizeof(*req));
+	if (!req)
+		return FPGA_NO_MEMORY;
+	req->dst = dst;
+	req->src = src;
+	req->count = count;
+	req->type = type;
+	req->cb = cb;
+	req->context = context;
+	req->res = FPGA_OK;
+	req->result = result;
+	req->next = NULL;
+
+	pthread_mutex_lock(&dma_h->async_lock);
+	if (!result && dma_h->async_res != FPGA_OK) {
+		res = dma_h->async_res;
+		dma_h->async_res = FPGA_OK;
+		goto out_free;
+	}
+
+	if (!dma_h->async_started) {
+		res = _async_start(dma_h);
+		ON_ERR_GOTO(res, out_free, "starting async workers");
+	}
+
+	if (dma_h->queue_tail)
+		dma_h->queue_tail->next = req;
+	else
+		dma_h->queue_head = req;
+	dma_h->queue_tail = req;
+	dma_h->async_pending++;
+	pthread_cond_broadcast(&dma_h->async_cond);
+	pthread_mutex_unlock(&dma_h->async_lock);
+	return FPGA_OK;
+
+out_free:
+	pthread_mutex_unlock(&dma_h->async_lock);
+	free(req);
+	return res;
+}
+
+struct _sync_wait {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	bool done;
+};
+
+static void _sync_complete(void *context)
+{
+	struct _sync_wait *w = (struct _sync_wait *)context;
+
+	pthread_mutex_lock(&w->lock);
+	w->done = true;
+	pthread_cond_signal(&w->cond);
+	pthread_mutex_unlock(&w->lock);
+}
+
 fpga_result fpgaDmaTransferSync(fpga_dma_handle dma_h, uint64_t dst,
 				uint64_t src, size_t count,
 				fpga_dma_transfer_t type)
 {
 
 	fpga_result res = FPGA_OK;
+	fpga_result xfer_res = FPGA_OK;
+	struct _sync_wait w = {PTHREAD_MUTEX_INITIALIZER,
+			       PTHREAD_COND_INITIALIZER, false};
 
 	if (!dma_h)
 		return FPGA_INVALID_PARAM;
@@ -1580,39 +2247,72 @@ fpga_result fpgaDmaTransferSync(fpga_dma_handle dma_h, uint64_t dst,
 	if (!dma_h->fpga_h)
 		return FPGA_INVALID_PARAM;
 
-	if (type == HOST_TO_FPGA_MM) {
-		res = transferHostToFpga(dma_h, dst, src, count,
-					 HOST_TO_FPGA_MM);
-	} else if (type == FPGA_TO_HOST_MM) {
-		res = transferFpgaToHost(dma_h, dst, src, count,
-					 FPGA_TO_HOST_MM);
-	} else if (type == FPGA_TO_FPGA_MM) {
-		res = transferFpgaToFpga(dma_h, dst, src, count,
-					 FPGA_TO_FPGA_MM);
-	} else {
-		return FPGA_NOT_SUPPORTED;
-	}
+	if (_async_in_callback(dma_h))
+		return FPGA_BUSY;
 
-	return res;
+	// Run on the copy / DMA / copy-out pipeline and wait for it, so
+	// host copies overlap with the hardware even for a single call.
+	res = _async_enqueue(dma_h, dst, src, count, type, _sync_complete, &w,
+			     &xfer_res);
+	if (res != FPGA_OK)
+		return res;
+
+	pthread_mutex_lock(&w.lock);
+	while (!w.done)
+		pthread_cond_wait(&w.cond, &w.lock);
+	pthread_mutex_unlock(&w.lock);
+	pthread_cond_destroy(&w.cond);
+	pthread_mutex_destroy(&w.lock);
+
+	return xfer_res;
 }
 
-#pragma GCC diagnostic ignored "-Wunused-parameter"
-#pragma GCC diagnostic ignored "-Wunused-value"
-#define UNUSED(...) (void)(__VA_ARGS__)
+fpga_result fpgaDmaTransferSyncPinned(fpga_dma_handle dma_h, uint64_t dst,
+				      uint64_t src, size_t count,
+				      fpga_dma_transfer_t type,
+				      uint64_t host_iova)
+{
+	fpga_result res = FPGA_OK;
+
+	if (!dma_h)
+		return FPGA_INVALID_PARAM;
+
+	if (!(type == HOST_TO_FPGA_MM || type == FPGA_TO_HOST_MM))
+		return FPGA_INVALID_PARAM;
+
+	if (!dma_h->fpga_h)
+		return FPGA_INVALID_PARAM;
+
+	if (_async_in_callback(dma_h))
+		return FPGA_BUSY;
 
-fpga_result fpgaDmaTransferAsync(fpga_dma_handle dma, uint64_t dst,
+	_async_quiesce(dma_h);
+	res = transferPinned(dma_h, dst, src, count, type, host_iova);
+	_async_resume(dma_h);
+	return res;
+}
+
+fpga_result fpgaDmaTransferAsync(fpga_dma_handle dma_h, uint64_t dst,
 				 uint64_t src, size_t count,
 				 fpga_dma_transfer_t type,
 				 fpga_dma_transfer_cb cb, void *context)
 {
-	// TODO
-	UNUSED(dma, dst, src, count, type, cb, context);
-	return FPGA_NOT_SUPPORTED;
+	if (!dma_h)
+		return FPGA_INVALID_PARAM;
+
+	if (type >= FPGA_MAX_TRANSFER_TYPE)
+		return FPGA_INVALID_PARAM;
+
+	if (!dma_h->fpga_h)
+		return FPGA_INVALID_PARAM;
+
+	return _async_enqueue(dma_h, dst, src, count, type, cb, context, NULL);
 }
 
 fpga_result fpgaDmaClose(fpga_dma_handle dma_h)
 {
 	fpga_result res = FPGA_OK;
+	fpga_result async_res = FPGA_OK;
 	int i = 0;
 	int sigres;
 	if (!dma_h) {
@@ -1624,6 +2324,18 @@ fpga_result fpgaDmaClose(fpga_dma_handle dma_h)
 		goto out;
 	}
 
+	// finish queued asynchronous transfers and stop the workers
+	if (dma_h->async_started) {
+		pthread_mutex_lock(&dma_h->async_lock);
+		dma_h->async_stop = true;
+		pthread_cond_broadcast(&dma_h->async_cond);
+		pthread_mutex_unlock(&dma_h->async_lock);
+		pthread_join(dma_h->submit_thread, NULL);
+		pthread_join(dma_h->complete_thread, NULL);
+		dma_h->async_started = false;
+		async_res = dma_h->async_res;
+	}
+
 	if (CsrControl) {
 		sigres = sigaction(SIGHUP, &old_action, NULL);
 		if (sigres < 0) {
@@ -1652,8 +2364,12 @@ fpga_result fpgaDmaClose(fpga_dma_handle dma_h)
 	ON_ERR_GOTO(res, out, "MMIOWrite32Blk");
 
 out:
+	if (res == FPGA_OK)
+		res = async_res;
 	// Ensure double close will fail
 	dma_h->fpga_h = 0;
+	pthread_cond_destroy(&dma_h->async_cond);
+	pthread_mutex_destroy(&dma_h->async_lock);
 	free((void *)dma_h);
 	return res;
 }
@@ -29,7 +29,12 @@
  * \brief FPGA DMA BBB API Header
  *
  * Known Limitations
- * - Supports only synchronous (blocking) transfers
+ * - Synchronous transfers are queued behind outstanding asynchronous
+ *   transfers on the same handle
+ * - Pinned transfers wait for all outstanding asynchronous transfers on the
+ *   same handle before they start
+ * - Synchronous and pinned transfers return FPGA_BUSY when called from an
+ *   asynchronous completion callback of the same handle
  */
 
 #ifndef __FPGA_DMA_H__
@@ -77,7 +82,9 @@ fpga_result fpgaDmaOpen(fpga_handle fpga, int dma_idx, fpga_dma_handle *dma);
  *
  * @brief             Perform a blocking copy of 'count' bytes from memory area
  * pointed by src to memory area pointed by dst where fpga_dma_transfer_t
- * specifies the type of memory transfer.
+ * specifies the type of memory transfer. The host side is copied through
+ * the internal bounce buffers on a pipeline, so copies into (or out of)
+ * one buffer overlap with DMA on the others.
  * @param[in] dma     Handle to the FPGA DMA object
  * @param[in] dst     Address of the destination buffer
  * @param[in] src     Address of the source buffer
@@ -88,18 +95,50 @@ fpga_result fpgaDmaOpen(fpga_handle fpga, int dma_idx, fpga_dma_handle *dma);
  * Copy data from memory mapped FPGA interface to host memory User must specify
  * valid src and dst. FPGA_TO_FPGA_MM - Copy data between memory mapped FPGA
  * interfaces User must specify valid src and dst.
- * @return fpga_result FPGA_OK on success, return code otherwise
+ * @return fpga_result FPGA_OK on success, FPGA_BUSY if called from an
+ * asynchronous completion callback of the same handle, return code otherwise
  *
  */
 fpga_result fpgaDmaTransferSync(fpga_dma_handle dma, uint64_t dst, uint64_t src,
 				size_t count, fpga_dma_transfer_t type);
 
 /**
- * fpgaDmaTransferAsync (Not supported)
+ * fpgaDmaTransferSyncPinned
+ *
+ * @brief             Same as fpgaDmaTransferSync(), but the host side of a
+ * HOST_TO_FPGA_MM or FPGA_TO_HOST_MM transfer lies in a buffer allocated
+ * with fpgaPrepareBuffer(). The DMA engine then reads or writes that buffer
+ * directly instead of copying through the internal bounce buffers. Only
+ * the unaligned head and tail (less than 64 bytes each) go through MMIO.
+ * If the host and FPGA addresses are not equally aligned modulo 64 bytes,
+ * the transfer falls back to the bounce buffers.
+ * @param[in] dma     Handle to the FPGA DMA object
+ * @param[in] dst     Address of the destination buffer
+ * @param[in] src     Address of the source buffer
+ * @param[in] count   Size in bytes
+ * @param[in] type    HOST_TO_FPGA_MM or FPGA_TO_HOST_MM
+ * @param[in] host_iova IO address of the host side (src for HOST_TO_FPGA_MM,
+ * dst for FPGA_TO_HOST_MM): the address returned by fpgaGetIOAddress() for
+ * the buffer plus the offset of the host address within it
+ * @return fpga_result FPGA_OK on success, FPGA_BUSY if called from an
+ * asynchronous completion callback of the same handle, return code otherwise
+ *
+ */
+fpga_result fpgaDmaTransferSyncPinned(fpga_dma_handle dma, uint64_t dst,
+				      uint64_t src, size_t count,
+				      fpga_dma_transfer_t type,
+				      uint64_t host_iova);
+
+/**
+ * fpgaDmaTransferAsync
  *
  * @brief             Perform a non-blocking copy of 'count' bytes from memory
  * area pointed by src to memory area pointed by dst where fpga_dma_transfer_t
- * specifies the type of memory transfer.
+ * specifies the type of memory transfer. The transfer is queued and the
+ * call returns immediately; transfers on a handle complete in the order
+ * they were queued. Host buffers must stay valid until the callback runs.
+ * An error hit by an earlier asynchronous transfer is returned by the next
+ * call, which then does not queue its transfer, or by fpgaDmaClose().
  * @param[in] dma     Handle to the FPGA DMA object
  * @param[in] dst     Address of the destination buffer
  * @param[in] src     Address of the source buffer
@@ -110,7 +149,10 @@ fpga_result fpgaDmaTransferSync(fpga_dma_handle dma, uint64_t dst, uint64_t src,
  * Copy data from memory mapped FPGA interface to host memory User must specify
  * valid src and dst. FPGA_TO_FPGA_MM - Copy data between memory mapped FPGA
  * interfaces User must specify valid src and dst.
- * @param[in] cb      Callback to invoke when DMA transfer is complete
+ * @param[in] cb      Callback to invoke when DMA transfer is complete, or
+ * NULL. It runs on an internal thread; fpgaDmaTransferSync() and
+ * fpgaDmaTransferSyncPinned() on the same handle return FPGA_BUSY there,
+ * and it must not call fpgaDmaClose() on the same handle.
  * @param[in] context Pointer to define user-defined context
  * @return fpga_result FPGA_OK on success, return code otherwise
  *
@@ -123,7 +165,8 @@ fpga_result fpgaDmaTransferAsync(fpga_dma_handle dma, uint64_t dst,
 /**
  * fpgaDmaClose
  *
- * @brief           Close the DMA BBB handle.
+ * @brief           Close the DMA BBB handle. Queued asynchronous transfers
+ *                  are completed first.
  *
  * @param[in] dma   DMA object handle
  * @returns         FPGA_OK on success, return code otherwise
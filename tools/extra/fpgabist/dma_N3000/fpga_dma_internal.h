@@ -33,7 +33,9 @@
 #define __FPGA_DMA_INT_H__
 
 #include <opae/fpga.h>
+#include <pthread.h>
 #include "x86-sse2.h"
+#include "fpga_dma.h"
 
 #ifdef CHECK_DELAYS
 #pragma message "Compiled with -DCHECK_DELAYS.  Not to be used in production"
@@ -159,6 +161,47 @@
 
 #define FPGA_DMA_MAX_BUF 8
 
+// Completion fences that may be outstanding for asynchronous transfers.
+// Each fence owns one magic number slot; slot 0 is kept for the
+// synchronous path.
+#define FPGA_DMA_ASYNC_FENCES 16
+#define FPGA_DMA_MAGIC_SLOTS (FPGA_DMA_ASYNC_FENCES + 1)
+
+// Upper bound on a single interrupt wait before the magic slot is
+// re-checked, in case the interrupt was cleared together with an
+// earlier one
+#define FPGA_DMA_ASYNC_POLL_MSEC 10
+
+// Bounce buffers covered by one fence. Smaller groups hand buffers back
+// to the copy stages sooner at the cost of one magic write per group.
+#define FPGA_DMA_FENCE_BUFS (FPGA_DMA_MAX_BUF / 4)
+
+// Queued asynchronous transfer
+typedef struct _dma_async_req_t {
+	uint64_t dst;
+	uint64_t src;
+	size_t count;
+	fpga_dma_transfer_t type;
+	fpga_dma_transfer_cb cb;
+	void *context;
+	// status of the request; copied to *result, if set, before cb runs
+	fpga_result res;
+	fpga_result *result;
+	struct _dma_async_req_t *next;
+} dma_async_req_t;
+
+// Magic number write queued behind a group of descriptors. When it lands,
+// the bounce buffers of the group are drained and released and, if last
+// is set, req is completed.
+typedef struct {
+	uint32_t first_buf;
+	uint32_t num_bufs;
+	bool issued;
+	bool last;
+	fpga_result res;
+	dma_async_req_t *req;
+} dma_async_fence_t;
+
 typedef struct __attribute__((__packed__)) {
 	uint64_t dfh;
 	uint64_t feature_uuid_lo;
@@ -200,6 +243,27 @@ struct _dma_handle_t {
 	uint64_t *dma_buf_ptr[FPGA_DMA_MAX_BUF];
 	uint64_t dma_buf_wsid[FPGA_DMA_MAX_BUF];
 	uint64_t dma_buf_iova[FPGA_DMA_MAX_BUF];
+	// asynchronous transfers; async_lock guards everything below
+	// except buf_head, which only the submission thread touches
+	pthread_mutex_t async_lock;
+	pthread_cond_t async_cond;
+	pthread_t submit_thread;
+	pthread_t complete_thread;
+	bool async_started;
+	bool async_stop;
+	bool submit_running;
+	bool sync_active;
+	dma_async_req_t *queue_head;
+	dma_async_req_t *queue_tail;
+	uint64_t async_pending;
+	fpga_result async_res;
+	dma_async_fence_t fences[FPGA_DMA_ASYNC_FENCES];
+	uint32_t fence_head;
+	uint32_t num_fences;
+	uint32_t buf_head;
+	uint32_t bufs_free;
+	uint64_t buf_copy_dst[FPGA_DMA_MAX_BUF];
+	uint64_t buf_copy_len[FPGA_DMA_MAX_BUF];
 };
 
 typedef union {
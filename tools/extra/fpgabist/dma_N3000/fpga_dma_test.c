@@ -40,6 +40,7 @@
 #include <errno.h>
 #include <stdbool.h>
 #include <sys/stat.h>
+#include <pthread.h>
 #ifndef USE_ASE
 #include <hwloc.h>
 #endif
@@ -64,6 +65,8 @@ extern double buf_full_count;
 char cbuf[2048];
 #endif
 
+#define ASYNC_OVERLAP_SIZE  (4 * 1024 * 1024)
+
 #define DMA_BUF_SIZE_MAX    (1023 * 1024)
 #define DMA_BUF_SIZE_MIN    128
 extern uint64_t fpga_dma_buf_size;
@@ -80,6 +83,7 @@ bool use_advise = false;
 bool do_not_verify = false;
 bool cpu_affinity = false;
 bool memory_affinity = false;
+bool pinned_sweep_en = false;
 
 /*
  * macro for checking return codes
@@ -104,6 +108,7 @@ struct config {
         uint64_t size;
         char guid[48];
     } target;
+    uint64_t async_size;
 }
 config = {
     .target = {
@@ -111,13 +116,14 @@ config = {
         .dma = 0,
         .size = TEST_TOTAL_SIZE,
         .guid = {0}
-    }
+    },
+    .async_size = 0
 };
 
 /*
  *  *  * Parse command line arguments
  *   *   */
-#define GETOPT_STRING ":B:D:S:s:G:mpc2nayCMv"
+#define GETOPT_STRING ":B:D:S:s:G:A:mpc2nayCMZv"
 fpga_result parse_args(int argc, char *argv[])
 {
     struct option longopts[] = {
@@ -126,6 +132,7 @@ fpga_result parse_args(int argc, char *argv[])
         {"size", required_argument, NULL, 'S'},
         {"bufsize", required_argument, NULL, 's'},
         {"guid", required_argument, NULL, 'G'},
+        {"async", required_argument, NULL, 'A'},
 	{"version", no_argument, NULL, 'v'},
 	{NULL, 0, NULL, 0}
     };
@@ -207,6 +214,19 @@ fpga_result parse_args(int argc, char *argv[])
             if (tmp_optarg)
                 memcpy(config.target.guid, tmp_optarg, buf_size);
             break;
+		case 'A':   /* async benchmark transfer size */
+			if (NULL == tmp_optarg)
+				break;
+			endptr = NULL;
+			config.async_size = (uint64_t)strtoull(tmp_optarg,
+							       &endptr, 0);
+			if (endptr != tmp_optarg + strnlen(tmp_optarg, 16)
+			    || !config.async_size) {
+				fprintf(stderr, "invalid async size: %s\n",
+					tmp_optarg);
+				return FPGA_EXCEPTION;
+			}
+			break;
 		case 'm':
 			use_malloc = true;
 			break;
@@ -234,6 +254,9 @@ fpga_result parse_args(int argc, char *argv[])
 		case 'M':
 			memory_affinity = true;
 			break;
+		case 'Z':
+			pinned_sweep_en = true;
+			break;
 
 		case 'v':
 			printf("fpga_dma_N3000_test %s %s%s\n",
@@ -576,6 +599,312 @@ fpga_result ddr_sweep(fpga_dma_handle dma_h, uint64_t mem_size, uint64_t ptr_ali
 	return FPGA_OK;
 }
 
+struct async_done {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	uint64_t count;
+};
+
+static void async_complete(void *context)
+{
+	struct async_done *done = (struct async_done *)context;
+
+	pthread_mutex_lock(&done->lock);
+	done->count++;
+	pthread_cond_signal(&done->cond);
+	pthread_mutex_unlock(&done->lock);
+}
+
+/*
+ * Move 'size' bytes in 'xfer_size' pieces, either one blocking transfer at
+ * a time or with every piece queued up front and in flight together.
+ */
+static fpga_result async_pass(fpga_dma_handle dma_h, uint64_t dst,
+			      uint64_t src, uint64_t size, uint64_t xfer_size,
+			      fpga_dma_transfer_t type, bool async,
+			      double *seconds)
+{
+	struct async_done done = {PTHREAD_MUTEX_INITIALIZER,
+				  PTHREAD_COND_INITIALIZER, 0};
+	struct timespec start, end;
+	fpga_result res = FPGA_OK;
+	uint64_t submitted = 0;
+	uint64_t off;
+	uint64_t len;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (off = 0; off < size; off += len) {
+		len = size - off < xfer_size ? size - off : xfer_size;
+		if (async) {
+			res = fpgaDmaTransferAsync(dma_h, dst + off, src + off,
+						   len, type, async_complete,
+						   &done);
+			if (res != FPGA_OK)
+				break;
+			submitted++;
+		} else {
+			res = fpgaDmaTransferSync(dma_h, dst + off, src + off,
+						  len, type);
+			if (res != FPGA_OK)
+				break;
+		}
+	}
+
+	pthread_mutex_lock(&done.lock);
+	while (done.count < submitted)
+		pthread_cond_wait(&done.cond, &done.lock);
+	pthread_mutex_unlock(&done.lock);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	*seconds = getTime(start, end);
+	return res;
+}
+
+fpga_result async_sweep(fpga_dma_handle dma_h, uint64_t mem_size,
+			uint64_t xfer_size)
+{
+	fpga_result res = FPGA_OK;
+	double seconds;
+	int i;
+	static const fpga_dma_transfer_t types[] = {HOST_TO_FPGA_MM,
+						    FPGA_TO_HOST_MM};
+	static const char *names[] = {"Host to FPGA", "FPGA to Host"};
+
+	uint64_t *dma_buf_ptr = malloc_aligned(getpagesize(), mem_size);
+	if (dma_buf_ptr == NULL) {
+		printf("Unable to allocate %ld bytes of memory", mem_size);
+		return FPGA_NO_MEMORY;
+	}
+	fill_buffer((char *)dma_buf_ptr, mem_size);
+
+	printf("Async sweep: %ld bytes in %ld byte transfers\n", mem_size,
+	       xfer_size);
+	for (i = 0; i < 2; i++) {
+		uint64_t dst = types[i] == HOST_TO_FPGA_MM ? 0x0
+							   : (uint64_t)dma_buf_ptr;
+		uint64_t src = types[i] == HOST_TO_FPGA_MM ? (uint64_t)dma_buf_ptr
+							   : 0x0;
+
+		printf("%s, synchronous\n", names[i]);
+		res = async_pass(dma_h, dst, src, mem_size, xfer_size,
+				 types[i], false, &seconds);
+		ON_ERR_GOTO(res, out, "fpgaDmaTransferSync");
+		report_bandwidth(mem_size, seconds);
+
+		if (types[i] == FPGA_TO_HOST_MM)
+			clear_buffer((char *)dma_buf_ptr, mem_size);
+
+		printf("%s, asynchronous\n", names[i]);
+		res = async_pass(dma_h, dst, src, mem_size, xfer_size,
+				 types[i], true, &seconds);
+		ON_ERR_GOTO(res, out, "fpgaDmaTransferAsync");
+		report_bandwidth(mem_size, seconds);
+	}
+
+	printf("Verifying buffer..\n");
+	res = verify_buffer((char *)dma_buf_ptr, mem_size);
+
+out:
+	free_aligned(dma_buf_ptr);
+	return res;
+}
+
+/*
+ * Queue overlapping host to FPGA writes with unaligned heads and tails
+ * without waiting in between, then read the region back. Every byte must
+ * hold the data of the last write that covered it.
+ */
+fpga_result async_overlap(fpga_dma_handle dma_h, uint64_t mem_size)
+{
+	struct async_done done = {PTHREAD_MUTEX_INITIALIZER,
+				  PTHREAD_COND_INITIALIZER, 0};
+	fpga_result res = FPGA_OK;
+	uint64_t submitted = 0;
+	uint64_t size = mem_size < ASYNC_OVERLAP_SIZE ? mem_size
+						      : ASYNC_OVERLAP_SIZE;
+	char *src = NULL;
+	char *expected = NULL;
+	int i;
+	const struct {
+		uint64_t dst;
+		uint64_t src;
+		uint64_t len;
+	} writes[] = {
+		{0, 0, size},
+		{3, 64, size / 2 + 5},
+		{61, 7, 130},
+		{size / 2 - 7, 1, size / 4},
+		{size / 2 + 64, size / 4, 61},
+		{size - 67, 13, 67},
+	};
+
+	if (size < ASE_TEST_BUF_SIZE) {
+		printf("Async overlap: skipped, needs %d bytes\n",
+		       ASE_TEST_BUF_SIZE);
+		return FPGA_OK;
+	}
+
+	src = malloc_aligned(getpagesize(), size);
+	expected = malloc_aligned(getpagesize(), size);
+	if (src == NULL || expected == NULL) {
+		printf("Unable to allocate %ld bytes of memory", size);
+		res = FPGA_NO_MEMORY;
+		goto out;
+	}
+	fill_buffer(src, size);
+
+	printf("Async overlap: %ld bytes in %d unaligned writes\n", size,
+	       (int)(sizeof(writes) / sizeof(writes[0])));
+	for (i = 0; i < (int)(sizeof(writes) / sizeof(writes[0])); i++) {
+		memcpy(expected + writes[i].dst, src + writes[i].src,
+		       writes[i].len);
+		res = fpgaDmaTransferAsync(dma_h, writes[i].dst,
+					   (uint64_t)src + writes[i].src,
+					   writes[i].len, HOST_TO_FPGA_MM,
+					   async_complete, &done);
+		if (res != FPGA_OK)
+			break;
+		submitted++;
+	}
+
+	pthread_mutex_lock(&done.lock);
+	while (done.count < submitted)
+		pthread_cond_wait(&done.cond, &done.lock);
+	pthread_mutex_unlock(&done.lock);
+	ON_ERR_GOTO(res, out, "fpgaDmaTransferAsync");
+
+	clear_buffer(src, size);
+	res = fpgaDmaTransferSync(dma_h, (uint64_t)src, 0x0, size,
+				  FPGA_TO_HOST_MM);
+	ON_ERR_GOTO(res, out, "fpgaDmaTransferSync FPGA_TO_HOST_MM");
+
+	if (memcmp(src, expected, size)) {
+		fprintf(stderr, "Async overlap: FPGA data out of order\n");
+		res = FPGA_EXCEPTION;
+		ON_ERR_GOTO(res, out, "async_overlap");
+	}
+	printf("Async overlap: PASS\n");
+
+out:
+	if (src)
+		free_aligned(src);
+	if (expected)
+		free_aligned(expected);
+	return res;
+}
+
+static inline void report_gbps(const char *mode, size_t size, double seconds)
+{
+	printf("\r%-10s %lf GB/s\n", mode,
+	       (double)size / ((double)seconds * 1000 * 1000 * 1000));
+}
+
+/*
+ * Report how much of the host copy the bounce path hides behind DMA:
+ * 100% means it runs as fast as zero-copy DMA alone, 0% means copy and DMA
+ * run back to back.
+ */
+static void report_overlap(const char *dir, double copy, double dma,
+			   double bounce)
+{
+	double hidden = (copy + dma - bounce) / (copy < dma ? copy : dma);
+
+	if (hidden < 0.0)
+		hidden = 0.0;
+	if (hidden > 1.0)
+		hidden = 1.0;
+	printf("%s copy/DMA overlap: %.1lf%% (copy %lf s, DMA %lf s, bounce %lf s)\n",
+	       dir, hidden * 100.0, copy, dma, bounce);
+}
+
+/*
+ * Compare the bounce-buffer path with zero-copy DMA straight from a buffer
+ * pinned with fpgaPrepareBuffer, and time a plain host copy of the same
+ * size to show how much of it the bounce path overlaps with DMA. Buffers
+ * larger than a page need hugepages.
+ */
+fpga_result pinned_sweep(fpga_handle afc_h, fpga_dma_handle dma_h,
+			 uint64_t mem_size)
+{
+	fpga_result res = FPGA_OK;
+	struct timespec start, end;
+	uint64_t *buf = NULL;
+	uint64_t wsid = 0;
+	uint64_t iova = 0;
+	int zero_copy;
+	double h2f[2], f2h[2];
+	double copy;
+	char *scratch;
+
+	res = fpgaPrepareBuffer(afc_h, mem_size, (void **)&buf, &wsid, 0);
+	if (res != FPGA_OK) {
+		printf("Unable to pin %ld bytes (are hugepages configured?)\n",
+		       mem_size);
+		return res;
+	}
+	res = fpgaGetIOAddress(afc_h, wsid, &iova);
+	ON_ERR_GOTO(res, out_release, "fpgaGetIOAddress");
+
+	scratch = (char *)malloc(mem_size);
+	if (!scratch) {
+		res = FPGA_NO_MEMORY;
+		ON_ERR_GOTO(res, out_release, "allocating copy buffer");
+	}
+	clear_buffer(scratch, mem_size);
+	fill_buffer((char *)buf, mem_size);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	memcpy(scratch, buf, mem_size);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	copy = getTime(start, end);
+	free(scratch);
+	printf("Host copy:           ");
+	report_gbps("memcpy", mem_size, copy);
+
+	for (zero_copy = 0; zero_copy < 2; zero_copy++) {
+		const char *mode = zero_copy ? "zero-copy" : "bounce";
+
+		fill_buffer((char *)buf, mem_size);
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		if (zero_copy)
+			res = fpgaDmaTransferSyncPinned(dma_h, 0x0,
+							(uint64_t)buf, mem_size,
+							HOST_TO_FPGA_MM, iova);
+		else
+			res = fpgaDmaTransferSync(dma_h, 0x0, (uint64_t)buf,
+						  mem_size, HOST_TO_FPGA_MM);
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		ON_ERR_GOTO(res, out_release, "Host to FPGA");
+		h2f[zero_copy] = getTime(start, end);
+		printf("Pinned Host to FPGA: ");
+		report_gbps(mode, mem_size, h2f[zero_copy]);
+
+		clear_buffer((char *)buf, mem_size);
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		if (zero_copy)
+			res = fpgaDmaTransferSyncPinned(dma_h, (uint64_t)buf,
+							0x0, mem_size,
+							FPGA_TO_HOST_MM, iova);
+		else
+			res = fpgaDmaTransferSync(dma_h, (uint64_t)buf, 0x0,
+						  mem_size, FPGA_TO_HOST_MM);
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		ON_ERR_GOTO(res, out_release, "FPGA to Host");
+		f2h[zero_copy] = getTime(start, end);
+		printf("Pinned FPGA to Host: ");
+		report_gbps(mode, mem_size, f2h[zero_copy]);
+
+		res = verify_buffer((char *)buf, mem_size);
+		ON_ERR_GOTO(res, out_release, "verify_buffer");
+	}
+
+	report_overlap("Host to FPGA", copy, h2f[1], h2f[0]);
+	report_overlap("FPGA to Host", copy, f2h[1], f2h[0]);
+
+out_release:
+	fpgaReleaseBuffer(afc_h, wsid);
+	return res;
+}
+
 static void usage(void)
 {
 	printf("Usage: fpga_dma_test <use_ase = 1 (simulation only), 0 (hardware)> [options]\n");
@@ -593,6 +922,8 @@ static void usage(void)
 	printf("\t-D\tSelect DMA to test\n");
 	printf("\t-S\tSet memory test size\n");
 	printf("\t-G\tSet AFU GUID\n");
+	printf("\t-Z\tCompare bounce-buffered and zero-copy DMA from a pinned buffer and report copy/DMA overlap\n");
+	printf("\t-A\tCompare synchronous and asynchronous throughput using transfers of this size, then check that overlapping unaligned async writes land in order\n");
 }
 
 static int check_config()
@@ -867,6 +1198,21 @@ int main(int argc, char *argv[])
 		ON_ERR_GOTO(res, out_dma_close, "ddr_sweep");
 	}
 
+	if (pinned_sweep_en) {
+		res = pinned_sweep(afc_h, dma_h,
+				   use_ase ? count : config.target.size);
+		ON_ERR_GOTO(res, out_dma_close, "pinned_sweep");
+	}
+
+	if (config.async_size) {
+		res = async_sweep(dma_h, use_ase ? count : config.target.size,
+				  config.async_size);
+		ON_ERR_GOTO(res, out_dma_close, "async_sweep");
+
+		res = async_overlap(dma_h, use_ase ? count : config.target.size);
+		ON_ERR_GOTO(res, out_dma_close, "async_overlap");
+	}
+
 	free(verify_buf);
 
 out_dma_close:
@@ -364,11 +364,21 @@ out_destroy:
 	return res;
 }
 
+STATIC void opae_vfio_destroy_iova_blocks(struct opae_vfio_iova_block *b)
+{
+	while (b) {
+		struct opae_vfio_iova_block *trash = b;
+		b = b->next;
+		free(trash);
+	}
+}
+
 STATIC void opae_vfio_destroy_iova_range(struct opae_vfio_iova_range *r)
 {
 	while (r) {
 		struct opae_vfio_iova_range *trash = r;
 		r = r->next;
+		opae_vfio_destroy_iova_blocks(trash->free_blocks);
 		free(trash);
 	}
 }
@@ -382,8 +392,18 @@ STATIC void opae_vfio_destroy(struct opae_vfio *v)
 	opae_vfio_group_destroy(&v->group);
 	opae_vfio_destroy_iova_range(v->cont_ranges);
 	v->cont_ranges = NULL;
-	opae_vfio_destroy_buffer(v->cont_fd, v->cont_buffers);
-	v->cont_buffers = NULL;
+	if (v->cont_buffers) {
+		uint32_t i;
+		for (i = 0 ; i < OPAE_VFIO_BUFFER_BUCKETS ; ++i)
+			opae_vfio_destroy_buffer(v->cont_fd,
+						 v->cont_buffers[i]);
+		free(v->cont_buffers);
+		v->cont_buffers = NULL;
+	}
+	if (v->cont_buffers_iova) {
+		free(v->cont_buffers_iova);
+		v->cont_buffers_iova = NULL;
+	}
 
 	if (v->cont_fd >= 0) {
 		close(v->cont_fd);
@@ -407,6 +427,19 @@ STATIC void opae_vfio_destroy(struct opae_vfio *v)
 		ERR("pthread_mutex_destroy() failed\n");
 }
 
+STATIC struct opae_vfio_iova_block *
+opae_vfio_create_iova_block(uint64_t start, uint64_t end)
+{
+	struct opae_vfio_iova_block *b;
+	b = malloc(sizeof(*b));
+	if (b) {
+		b->start = start;
+		b->end = end;
+		b->next = NULL;
+	}
+	return b;
+}
+
 STATIC struct opae_vfio_iova_range *
 opae_vfio_create_iova_range(uint64_t start, uint64_t end)
 {
@@ -415,8 +448,12 @@ opae_vfio_create_iova_range(uint64_t start, uint64_t end)
 	if (r) {
 		r->start = start;
 		r->end = end;
-		r->next_ptr = r->start;
+		r->free_blocks = opae_vfio_create_iova_block(start, end);
 		r->next = NULL;
+		if (!r->free_blocks) {
+			free(r);
+			return NULL;
+		}
 	}
 	return r;
 }
@@ -488,27 +525,154 @@ out_free:
 	return iova_list;
 }
 
+#define IOVA_2M (2UL * 1024 * 1024)
+#define IOVA_1G (1024UL * 1024 * 1024)
+
+/*
+ * Buffers spanning a large page get an IOVA aligned to that page size,
+ * so that the IOMMU can map them with large pages.
+ */
+STATIC uint64_t opae_vfio_iova_alignment(uint64_t size, uint64_t page_size)
+{
+	if (size >= IOVA_1G)
+		return IOVA_1G;
+	if (size >= IOVA_2M)
+		return IOVA_2M;
+	return page_size;
+}
+
+/*
+ * Carve size bytes at the given alignment from the first free block
+ * of range that can hold them (first fit).
+ */
+STATIC int opae_vfio_iova_carve(struct opae_vfio_iova_range *range,
+				uint64_t size,
+				uint64_t align,
+				uint64_t *iova)
+{
+	struct opae_vfio_iova_block **pb;
+	struct opae_vfio_iova_block *b;
+	struct opae_vfio_iova_block *tail;
+	uint64_t aligned;
+
+	for (pb = &range->free_blocks ; *pb ; pb = &(*pb)->next) {
+		b = *pb;
+
+		aligned = (b->start + (align - 1)) & ~(align - 1);
+		if (aligned < b->start || aligned > b->end)
+			continue; // wrapped, or no aligned offset in b
+		if (b->end - aligned < size - 1)
+			continue;
+
+		if (aligned > b->start) {
+			if (b->end - aligned > size - 1) {
+				// free space remains on both sides
+				tail = opae_vfio_create_iova_block(
+						aligned + size, b->end);
+				if (!tail) {
+					ERR("malloc failed\n");
+					return 1;
+				}
+				tail->next = b->next;
+				b->next = tail;
+			}
+			b->end = aligned - 1;
+		} else if (b->end - aligned > size - 1) {
+			b->start = aligned + size;
+		} else {
+			*pb = b->next;
+			free(b);
+		}
+
+		*iova = aligned;
+		return 0;
+	}
+
+	return 2;
+}
+
 STATIC int opae_vfio_iova_reserve(struct opae_vfio *v,
 				  uint64_t *size,
 				  uint64_t *iova)
 {
 	uint64_t page_size;
+	uint64_t align;
 	struct opae_vfio_iova_range *range;
 
 	page_size = sysconf(_SC_PAGE_SIZE);
 	*size = page_size + ((*size - 1) & ~(page_size - 1));
 
+	align = opae_vfio_iova_alignment(*size, page_size);
+
 	for (range = v->cont_ranges ; range ; range = range->next) {
-		if (range->next_ptr + *size <= range->end) {
-			*iova = range->next_ptr;
-			range->next_ptr += *size;
+		if (!opae_vfio_iova_carve(range, *size, align, iova))
 			return 0;
-		}
 	}
 
 	return 2;
 }
 
+/*
+ * Return [iova, iova + size) to the free list of its range,
+ * merging it with the neighboring free blocks.
+ */
+STATIC int opae_vfio_iova_release(struct opae_vfio *v,
+				  uint64_t iova,
+				  uint64_t size)
+{
+	struct opae_vfio_iova_range *range;
+	struct opae_vfio_iova_block **pb;
+	struct opae_vfio_iova_block *prev = NULL;
+	struct opae_vfio_iova_block *next;
+	struct opae_vfio_iova_block *b;
+	uint64_t last = iova + size - 1;
+
+	for (range = v->cont_ranges ; range ; range = range->next) {
+		if (iova >= range->start && last <= range->end)
+			break;
+	}
+
+	if (!range) {
+		ERR("IOVA 0x%lx not in any range\n", iova);
+		return 1;
+	}
+
+	for (pb = &range->free_blocks ; *pb && (*pb)->start < iova ;
+	     pb = &(*pb)->next)
+		prev = *pb;
+	next = *pb;
+
+	if ((prev && prev->end >= iova) || (next && next->start <= last)) {
+		ERR("IOVA 0x%lx already free\n", iova);
+		return 2;
+	}
+
+	if (prev && prev->end + 1 == iova) {
+		prev->end = last;
+		if (next && last + 1 == next->start) {
+			prev->end = next->end;
+			prev->next = next->next;
+			free(next);
+		}
+		return 0;
+	}
+
+	if (next && last + 1 == next->start) {
+		next->start = iova;
+		return 0;
+	}
+
+	b = opae_vfio_create_iova_block(iova, last);
+	if (!b) {
+		ERR("malloc failed\n");
+		return 3;
+	}
+	b->next = next;
+	*pb = b;
+
+	return 0;
+}
+
 STATIC struct opae_vfio_buffer *
 opae_vfio_create_buffer(uint8_t *vaddr,
 			size_t size,
@@ -521,10 +685,59 @@ opae_vfio_create_buffer(uint8_t *vaddr,
 		b->buffer_size = size;
 		b->buffer_iova = iova;
 		b->next = NULL;
+		b->iova_next = NULL;
 	}
 	return b;
 }
 
+STATIC uint32_t opae_vfio_buffer_hash(uint64_t key)
+{
+	// Fibonacci hashing of the page number
+	return (uint32_t)(((key >> 12) * 0x9e3779b97f4a7c15ULL) >> 54) &
+		(OPAE_VFIO_BUFFER_BUCKETS - 1);
+}
+
+STATIC void opae_vfio_buffer_insert(struct opae_vfio *v,
+				    struct opae_vfio_buffer *b)
+{
+	uint32_t h = opae_vfio_buffer_hash((uint64_t)b->buffer_ptr);
+	uint32_t hi = opae_vfio_buffer_hash(b->buffer_iova);
+
+	b->next = v->cont_buffers[h];
+	v->cont_buffers[h] = b;
+
+	b->iova_next = v->cont_buffers_iova[hi];
+	v->cont_buffers_iova[hi] = b;
+}
+
+/*
+ * Unlink the buffer at virtual address buf from both indexes.
+ */
+STATIC struct opae_vfio_buffer *
+opae_vfio_buffer_remove(struct opae_vfio *v, uint8_t *buf)
+{
+	struct opae_vfio_buffer **pb;
+	struct opae_vfio_buffer *b;
+
+	pb = &v->cont_buffers[opae_vfio_buffer_hash((uint64_t)buf)];
+	while (*pb && (*pb)->buffer_ptr != buf)
+		pb = &(*pb)->next;
+
+	b = *pb;
+	if (!b)
+		return NULL;
+	*pb = b->next;
+	b->next = NULL;
+
+	pb = &v->cont_buffers_iova[opae_vfio_buffer_hash(b->buffer_iova)];
+	while (*pb != b)
+		pb = &(*pb)->iova_next;
+	*pb = b->iova_next;
+	b->iova_next = NULL;
+
+	return b;
+}
+
 STATIC void
 opae_vfio_destroy_buffer(int fd, struct opae_vfio_buffer *b)
 {
@@ -603,6 +816,10 @@ int opae_vfio_buffer_allocate(struct opae_vfio *v,
 		return 4;
 	}
 
+	// The reserved IOVA range is ours; map it without the lock.
+	if (pthread_mutex_unlock(&v->lock))
+		ERR("pthread_mutex_unlock() failed\n");
+
 	if (*size > (2 * 1024 * 1024))
 		vaddr = mmap(ADDR, *size, PROT_READ|PROT_WRITE,
 			     FLAGS_1G, 0, 0);
@@ -615,8 +832,15 @@ int opae_vfio_buffer_allocate(struct opae_vfio *v,
 
 	if (vaddr == MAP_FAILED) {
 		ERR("mmap() failed\n");
-		pthread_mutex_unlock(&v->lock);
-		return 5;
+		res = 5;
+		goto out_release_iova;
+	}
+
+	node = opae_vfio_create_buffer(vaddr, *size, ioaddr);
+	if (!node) {
+		ERR("malloc failed\n");
+		res = 6;
+		goto out_munmap;
 	}
 
 	memset(&dma_map, 0, sizeof(dma_map));
@@ -631,27 +855,25 @@ int opae_vfio_buffer_allocate(struct opae_vfio *v,
 		ERR("ioctl(%d, VFIO_IOMMU_MAP_DMA, &dma_map)\n",
 		    v->cont_fd);
 		res = 5;
-		goto out_munmap;
+		goto out_free_node;
 	}
 
-	node = opae_vfio_create_buffer(vaddr, *size, ioaddr);
-	if (!node) {
-		ERR("malloc failed\n");
-		res = 6;
+	if (pthread_mutex_lock(&v->lock)) {
+		ERR("pthread_mutex_lock() failed\n");
+		res = 3;
 		goto out_unmap_ioctl;
 	}
 
-	node->next = v->cont_buffers;
-	v->cont_buffers = node;
+	opae_vfio_buffer_insert(v, node);
+
+	if (pthread_mutex_unlock(&v->lock))
+		ERR("pthread_mutex_unlock() failed\n");
 
 	if (buf)
 		*buf = vaddr;
 	if (iova)
 		*iova = ioaddr;
 
-	if (pthread_mutex_unlock(&v->lock))
-		ERR("pthread_mutex_unlock() failed\n");
-
 	return 0;
 
 out_unmap_ioctl:
@@ -660,8 +882,16 @@ out_unmap_ioctl:
 	dma_unmap.iova = ioaddr;
 	dma_unmap.size = *size;
 	ioctl(v->cont_fd, VFIO_IOMMU_UNMAP_DMA, &dma_unmap);
+out_free_node:
+	free(node);
 out_munmap:
 	munmap(vaddr, *size);
+out_release_iova:
+	if (pthread_mutex_lock(&v->lock)) {
+		ERR("pthread_mutex_lock() failed\n");
+		return res;
+	}
+	opae_vfio_iova_release(v, ioaddr, *size);
 	if (pthread_mutex_unlock(&v->lock))
 		ERR("pthread_mutex_unlock() failed\n");
 	return res;
@@ -671,8 +901,8 @@ int opae_vfio_buffer_free(struct opae_vfio *v,
 			  uint8_t *buf)
 {
 	struct opae_vfio_buffer *b;
-	struct opae_vfio_buffer *prev = NULL;
-	int res = 0;
+	uint64_t ioaddr;
+	size_t size;
 
 	if (!v) {
 		ERR("NULL param\n");
@@ -684,22 +914,64 @@ int opae_vfio_buffer_free(struct opae_vfio *v,
 		return 2;
 	}
 
-	for (b = v->cont_buffers ; b ; prev = b, b = b->next) {
-		if (b->buffer_ptr == buf) {
-			if (!prev) { // b == v->cont_buffers
-				v->cont_buffers = b->next;
-			} else {
-				prev->next = b->next;
-			}
-			b->next = NULL;
-			opae_vfio_destroy_buffer(v->cont_fd, b);
-			goto out_unlock;
-		}
+	b = opae_vfio_buffer_remove(v, buf);
+
+	if (pthread_mutex_unlock(&v->lock))
+		ERR("pthread_mutex_unlock() failed\n");
+
+	if (!b)
+		return 3;
+
+	ioaddr = b->buffer_iova;
+	size = b->buffer_size;
+
+	// Unlinked, so no other thread can reach b; unmap without the lock.
+	opae_vfio_destroy_buffer(v->cont_fd, b);
+
+	// Only now that the DMA mapping is gone may the IOVA be reused.
+	if (pthread_mutex_lock(&v->lock)) {
+		ERR("pthread_mutex_lock() failed\n");
+		return 2;
+	}
+
+	opae_vfio_iova_release(v, ioaddr, size);
+
+	if (pthread_mutex_unlock(&v->lock))
+		ERR("pthread_mutex_unlock() failed\n");
+
+	return 0;
+}
+
+int opae_vfio_buffer_find_iova(struct opae_vfio *v,
+			       uint64_t iova,
+			       uint8_t **buf,
+			       size_t *size)
+{
+	struct opae_vfio_buffer *b;
+	int res = 2;
+
+	if (!v) {
+		ERR("NULL param\n");
+		return 1;
 	}
 
-	res = 3;
+	if (pthread_mutex_lock(&v->lock)) {
+		ERR("pthread_mutex_lock() failed\n");
+		return 3;
+	}
+
+	for (b = v->cont_buffers_iova[opae_vfio_buffer_hash(iova)] ;
+	     b ; b = b->iova_next) {
+		if (b->buffer_iova == iova) {
+			if (buf)
+				*buf = b->buffer_ptr;
+			if (size)
+				*size = b->buffer_size;
+			res = 0;
+			break;
+		}
+	}
 
-out_unlock:
 	if (pthread_mutex_unlock(&v->lock))
 		ERR("pthread_mutex_unlock() failed\n");
 
@@ -759,6 +1031,16 @@ STATIC int opae_vfio_init(struct opae_vfio *v,
 		goto out_destroy_attr;
 	}
 
+	v->cont_buffers = calloc(OPAE_VFIO_BUFFER_BUCKETS,
+				 sizeof(struct opae_vfio_buffer *));
+	v->cont_buffers_iova = calloc(OPAE_VFIO_BUFFER_BUCKETS,
+				      sizeof(struct opae_vfio_buffer *));
+	if (!v->cont_buffers || !v->cont_buffers_iova) {
+		ERR("calloc() failed\n");
+		res = 4;
+		goto out_destroy_container;
+	}
+
 	v->cont_device = strdup("/dev/vfio/vfio");
 	v->cont_pciaddr = strdup(pciaddr);
 	v->cont_fd = open(v->cont_device, O_RDWR);
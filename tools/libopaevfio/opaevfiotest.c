@@ -24,7 +24,9 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 #include <opae/vfio.h>
 
@@ -86,6 +88,7 @@ void allocate_bufs(struct opae_vfio *v)
 	uint64_t iova_4k;
 	uint64_t iova_2m;
 	uint64_t iova_1g;
+	uint8_t *found = NULL;
 
 	sz_4k = 4096;
 	buf_4k_virt = NULL;
@@ -114,6 +117,11 @@ void allocate_bufs(struct opae_vfio *v)
 		printf("whoops 1G!\n");
 	}
 
+	if (opae_vfio_buffer_find_iova(v, iova_2m, &found, NULL) ||
+	    found != buf_2m_virt) {
+		printf("whoops 2M find iova!\n");
+	}
+
 	if (opae_vfio_buffer_free(v, buf_2m_virt)) {
 		printf("whoops 2M free!\n");
 	}
@@ -125,6 +133,60 @@ void allocate_bufs(struct opae_vfio *v)
 	}
 }
 
+#define CHURN_ITERATIONS 1000000
+#define CHURN_LIVE       64
+
+/*
+ * Allocate and free many short-lived buffers, keeping up to
+ * CHURN_LIVE of them alive at a time. IOVA space must be reclaimed
+ * for this to run to completion.
+ */
+void churn(struct opae_vfio *v)
+{
+	uint8_t *virt[CHURN_LIVE];
+	size_t size;
+	uint64_t iova;
+	struct timespec start, end;
+	uint64_t ns;
+	int i;
+	int slot;
+
+	memset(virt, 0, sizeof(virt));
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	for (i = 0 ; i < CHURN_ITERATIONS ; ++i) {
+		slot = rand() % CHURN_LIVE;
+
+		if (virt[slot]) {
+			if (opae_vfio_buffer_free(v, virt[slot])) {
+				printf("whoops churn free %d\n", i);
+				break;
+			}
+			virt[slot] = NULL;
+			continue;
+		}
+
+		size = (rand() & 1) ? 4096 : 2 * 1024 * 1024;
+		if (opae_vfio_buffer_allocate(v, &size, &virt[slot], &iova)) {
+			printf("whoops churn alloc %d\n", i);
+			virt[slot] = NULL;
+			break;
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	for (slot = 0 ; slot < CHURN_LIVE ; ++slot) {
+		if (virt[slot] && opae_vfio_buffer_free(v, virt[slot]))
+			printf("whoops churn free\n");
+	}
+
+	ns = (end.tv_sec - start.tv_sec) * 1000000000UL +
+	     end.tv_nsec - start.tv_nsec;
+	printf("churn: %d ops %lu ns/op\n", i, i ? ns / i : 0);
+}
+
 #define CSR_SRC_ADDR      (AFU_OFFSET + 0x0120)
 #define CSR_DST_ADDR      (AFU_OFFSET + 0x0128)
 #define CSR_CTL           (AFU_OFFSET + 0x0138)
@@ -223,7 +285,7 @@ int main(int argc, char *argv[])
 
 	if (argc < 3) {
 		printf("usage: opaevfiotest 0000:00:00.0 <test>\n");
-		printf("\n\twhere <test> is one of { dfh, buf, nlb0 }\n");
+		printf("\n\twhere <test> is one of { dfh, buf, nlb0, churn }\n");
 		return 1;
 	}
 
@@ -238,6 +300,8 @@ int main(int argc, char *argv[])
 		allocate_bufs(&v);
 	else if (!strcmp(argv[2], "nlb0"))
 		nlb0(&v);
+	else if (!strcmp(argv[2], "churn"))
+		churn(&v);
 
 	opae_vfio_close(&v);
 